@@ -0,0 +1,458 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/api/BranchGauge.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "include/exps/run.hpp"
+#include "include/predictors/BPUSet.hpp"
+#include "include/predictors/Domains.hpp"
+#include "include/predictors/HistoryPHT.hpp"
+#include "include/predictors/Rekey.hpp"
+#include "include/utils/Cipher.hpp"
+#include "include/utils/Leakage.hpp"
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Spec.hpp"
+#include "include/utils/Utils.hpp"
+
+uint64_t NUMBER_MAX_BRANCHES = 1e8;
+uint64_t RANDOM_SEED = 0;
+uint64_t SHARD_INDEX = 0;
+uint64_t SHARD_COUNT = 1;
+bool COMMON_RANDOM = false;
+bool BASELINE = false;
+
+struct bg_predictors {
+  BPUSet *bpus;
+  uint64_t domains;
+};
+
+struct bg_table {
+  uint64_t rows = 0;
+  uint64_t columns = 0;
+  std::vector<uint64_t> values;
+};
+
+// whether a predictor is in the set
+static bool selected(bg_predictors *set, uint64_t type) {
+  if (set == nullptr) {
+    return false;
+  }
+  for (uint64_t i = 0; i < set->bpus->size(); i++) {
+    if (set->bpus->getType(i) == type) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// copy the address set of an attack to the buffer of the caller
+static int copySet(const std::pair<std::vector<uint64_t>, uint64_t> &result,
+                   uint64_t *addrs, uint64_t capacity, uint64_t *size,
+                   uint64_t *accesses) {
+  *size = result.first.size();
+  *accesses = result.second;
+  if (result.first.size() > capacity) {
+    return BG_ECAPACITY;
+  }
+  std::copy(result.first.begin(), result.first.end(), addrs);
+  return BG_OK;
+}
+
+int bg_api_version(void) { return BG_API_VERSION; }
+
+void bg_default_config(bg_config *config) {
+  ExperimentSpec spec;
+  config->counter_bits = spec.counter_bits;
+  config->counter_nums = spec.counter_nums;
+  config->buffer_ways = spec.buffer_ways;
+  config->buffer_sets = spec.buffer_sets;
+  config->addr_space = spec.addr_space;
+  config->policy = spec.policy;
+  config->pht_model = spec.pht.model;
+  config->pht_history = spec.pht.history;
+  config->tage_tables = spec.pht.tage_tables;
+  config->tage_min_history = spec.pht.tage_min_history;
+  config->tage_max_history = spec.pht.tage_max_history;
+  config->tage_tag_bits = spec.pht.tage_tag_bits;
+  config->rekey_accesses = spec.rekey.accesses;
+  config->rekey_mispredicts = spec.rekey.mispredicts;
+  config->rekey_domain_switch = spec.rekey.domain_switch;
+  config->cipher = spec.cipher.type;
+  config->cipher_rounds = spec.cipher.rounds;
+  config->btb_levels = spec.btb.levels.size();
+  for (uint64_t i = 0; i < BG_BTB_MAX_LEVELS; i++) {
+    BTBLevelConfig level;
+    config->btb_sets[i] = level.sets;
+    config->btb_ways[i] = level.ways;
+    config->btb_policy[i] = level.policy;
+    config->btb_keyed[i] = level.keyed;
+  }
+  config->btb_inclusion = spec.btb.inclusion;
+  config->domains = NUM_ATTACK_DOMAINS;
+  config->seed = 0;
+}
+
+int bg_parse_type(const char *name, uint64_t *type) {
+  return BPUSet::parseType(name, *type) ? BG_OK : BG_EINVAL;
+}
+
+int bg_create(const bg_config *config, const uint64_t *types, uint64_t count,
+              bg_predictors **set) {
+  *set = nullptr;
+  PHTConfig pht;
+  pht.model = config->pht_model;
+  pht.history = config->pht_history;
+  pht.tage_tables = config->tage_tables;
+  pht.tage_min_history = config->tage_min_history;
+  pht.tage_max_history = config->tage_max_history;
+  pht.tage_tag_bits = config->tage_tag_bits;
+  RekeyConfig rekey;
+  rekey.accesses = config->rekey_accesses;
+  rekey.mispredicts = config->rekey_mispredicts;
+  rekey.domain_switch = config->rekey_domain_switch != 0;
+  CipherConfig cipher;
+  cipher.type = (CipherType)config->cipher;
+  cipher.rounds = config->cipher_rounds;
+  BTBConfig btb;
+  btb.inclusion = config->btb_inclusion;
+  for (uint64_t i = 0; i < config->btb_levels && i < BG_BTB_MAX_LEVELS; i++) {
+    BTBLevelConfig level;
+    level.sets = config->btb_sets[i];
+    level.ways = config->btb_ways[i];
+    level.policy = (ReplacementPolicy)config->btb_policy[i];
+    level.keyed = config->btb_keyed[i] != 0;
+    if (config->btb_policy[i] > ReplacementPolicy::REPL_RANDOM) {
+      return BG_EINVAL;
+    }
+    btb.levels.push_back(level);
+  }
+  if (config->counter_bits == 0 || config->counter_nums == 0 ||
+      config->buffer_ways == 0 || config->buffer_sets == 0 ||
+      config->addr_space == 0 || config->addr_space > 64 ||
+      config->policy > ReplacementPolicy::REPL_RANDOM ||
+      config->domains < NUM_ATTACK_DOMAINS || config->domains > MAX_DOMAINS ||
+      config->cipher >= CipherType::NUM_CIPHER_TYPES ||
+      config->cipher_rounds > cipherRounds(cipher.type) ||
+      config->btb_levels > BG_BTB_MAX_LEVELS || !checkBTBConfig(btb) ||
+      !checkPHTConfig(pht, config->counter_bits, config->counter_nums)) {
+    return BG_EINVAL;
+  }
+  // every predictor at most once
+  std::vector<uint64_t> selection(types, types + count);
+  std::vector<bool> seen(NUM_BPU_TYPES, false);
+  for (uint64_t type : selection) {
+    if (type >= NUM_BPU_TYPES || seen[type]) {
+      return BG_EINVAL;
+    }
+    seen[type] = true;
+  }
+  if (selection.empty()) {
+    return BG_EINVAL;
+  }
+  RANDOM_SEED = config->seed;
+  *set = new bg_predictors;
+  (*set)->bpus = new BPUSet(
+      selection, config->counter_bits, config->counter_nums,
+      config->buffer_ways, config->buffer_sets, config->addr_space,
+      (ReplacementPolicy)config->policy, pht, rekey, cipher, btb,
+      config->domains);
+  (*set)->domains = config->domains;
+  return BG_OK;
+}
+
+void bg_destroy(bg_predictors *set) {
+  if (set != nullptr) {
+    delete set->bpus;
+    delete set;
+  }
+}
+
+void bg_seed(uint64_t seed) { srand(seed); }
+
+void bg_set_max_branches(uint64_t max_branches) {
+  NUMBER_MAX_BRANCHES = max_branches;
+}
+
+int bg_reset(bg_predictors *set, uint64_t type) {
+  if (!selected(set, type)) {
+    return BG_EINVAL;
+  }
+  set->bpus->reset(type);
+  return BG_OK;
+}
+
+int bg_occupancy(bg_predictors *set, uint64_t type, uint64_t *pht,
+                 uint64_t *btb) {
+  if (!selected(set, type)) {
+    return BG_EINVAL;
+  }
+  *pht = set->bpus->getPHTOccupancy(type);
+  *btb = set->bpus->getBTBOccupancy(type);
+  return BG_OK;
+}
+
+int bg_btb_level(bg_predictors *set, uint64_t type, const uint64_t *pcs,
+                 const uint64_t *domains, uint64_t count, uint64_t *levels) {
+  if (!selected(set, type)) {
+    return BG_EINVAL;
+  }
+  for (uint64_t i = 0; domains != nullptr && i < count; i++) {
+    if (domains[i] >= set->domains) {
+      return BG_EINVAL;
+    }
+  }
+  for (uint64_t i = 0; i < count; i++) {
+    uint64_t domain = domains != nullptr
+                          ? domains[i]
+                          : (uint64_t)SecurityDomain::DOM_ATTACKER;
+    levels[i] = set->bpus->getBTBLevel(type, pcs[i], domain);
+  }
+  return BG_OK;
+}
+
+int bg_lookup_pht(bg_predictors *set, uint64_t type, const uint64_t *pcs,
+                  const uint8_t *taken, const uint64_t *domains,
+                  uint64_t count, uint8_t *correct, uint64_t *hits) {
+  if (!selected(set, type)) {
+    return BG_EINVAL;
+  }
+  for (uint64_t i = 0; domains != nullptr && i < count; i++) {
+    if (domains[i] >= set->domains) {
+      return BG_EINVAL;
+    }
+  }
+  uint64_t total = 0;
+  for (uint64_t i = 0; i < count; i++) {
+    uint64_t domain = domains != nullptr
+                          ? domains[i]
+                          : (uint64_t)SecurityDomain::DOM_ATTACKER;
+    bool hit = set->bpus->lookupPHT(type, pcs[i], taken[i] != 0, domain);
+    if (correct != nullptr) {
+      correct[i] = hit;
+    }
+    total += hit;
+  }
+  *hits = total;
+  return BG_OK;
+}
+
+int bg_lookup_btb(bg_predictors *set, uint64_t type, const uint64_t *pcs,
+                  const uint64_t *targets, const uint64_t *domains,
+                  uint64_t count, int8_t *outcomes, uint64_t *hits) {
+  if (!selected(set, type)) {
+    return BG_EINVAL;
+  }
+  for (uint64_t i = 0; domains != nullptr && i < count; i++) {
+    if (domains[i] >= set->domains) {
+      return BG_EINVAL;
+    }
+  }
+  uint64_t total = 0;
+  for (uint64_t i = 0; i < count; i++) {
+    uint64_t domain = domains != nullptr
+                          ? domains[i]
+                          : (uint64_t)SecurityDomain::DOM_ATTACKER;
+    int outcome = set->bpus->lookupBTB(type, pcs[i], targets[i], domain);
+    if (outcomes != nullptr) {
+      outcomes[i] = outcome;
+    }
+    total += outcome == 1;
+  }
+  *hits = total;
+  return BG_OK;
+}
+
+int bg_pht_timing(bg_predictors *set, uint64_t type, uint64_t num_loops,
+                  uint64_t counter_bits, uint64_t victim_addr, uint64_t *addr,
+                  uint64_t *accesses) {
+  if (!selected(set, type)) {
+    return BG_EINVAL;
+  }
+  std::tie(*addr, *accesses) =
+      set->bpus->PHTTiming(type, num_loops, counter_bits, victim_addr);
+  return BG_OK;
+}
+
+int bg_pht_speculative(bg_predictors *set, uint64_t type, uint64_t num_loops,
+                       uint64_t counter_bits, uint64_t victim_addr,
+                       uint64_t *addr, uint64_t *accesses) {
+  if (!selected(set, type)) {
+    return BG_EINVAL;
+  }
+  std::tie(*addr, *accesses) =
+      set->bpus->PHTSpeculative(type, num_loops, counter_bits, victim_addr);
+  return BG_OK;
+}
+
+int bg_btb_timing(bg_predictors *set, uint64_t type, uint64_t num_loops,
+                  uint64_t victim_addr, uint64_t target_addr, uint64_t *addr,
+                  uint64_t *accesses) {
+  if (!selected(set, type)) {
+    return BG_EINVAL;
+  }
+  std::tie(*addr, *accesses) =
+      set->bpus->BTBTiming(type, num_loops, victim_addr, target_addr);
+  return BG_OK;
+}
+
+int bg_btb_speculative(bg_predictors *set, uint64_t type, uint64_t num_loops,
+                       uint64_t victim_addr, uint64_t target_addr,
+                       uint64_t covert_channel, uint64_t *addr,
+                       uint64_t *accesses) {
+  if (!selected(set, type)) {
+    return BG_EINVAL;
+  }
+  std::tie(*addr, *accesses) = set->bpus->BTBSpeculative(
+      type, num_loops, victim_addr, target_addr, covert_channel);
+  return BG_OK;
+}
+
+int bg_btb_prune(bg_predictors *set, uint64_t type, uint64_t num_loops,
+                 uint64_t victim_addr, uint64_t prune_size,
+                 uint64_t eviction_size, uint64_t *addrs, uint64_t capacity,
+                 uint64_t *size, uint64_t *accesses) {
+  if (!selected(set, type)) {
+    return BG_EINVAL;
+  }
+  return copySet(set->bpus->BTBPrune(type, num_loops, victim_addr, prune_size,
+                                     eviction_size),
+                 addrs, capacity, size, accesses);
+}
+
+int bg_pht_occupancy_attack(bg_predictors *set, uint64_t type,
+                            uint64_t num_loops, uint64_t counter_bits,
+                            uint64_t prune_size, uint64_t occupancy_size,
+                            uint64_t *addrs, uint64_t capacity,
+                            uint64_t *size, uint64_t *accesses) {
+  if (!selected(set, type)) {
+    return BG_EINVAL;
+  }
+  return copySet(set->bpus->PHTOccupancy(type, num_loops, counter_bits,
+                                         prune_size, occupancy_size),
+                 addrs, capacity, size, accesses);
+}
+
+int bg_btb_occupancy_attack(bg_predictors *set, uint64_t type,
+                            uint64_t num_loops, uint64_t prune_size,
+                            uint64_t occupancy_size, uint64_t *addrs,
+                            uint64_t capacity, uint64_t *size,
+                            uint64_t *accesses) {
+  if (!selected(set, type)) {
+    return BG_EINVAL;
+  }
+  return copySet(set->bpus->BTBOccupancy(type, num_loops, prune_size,
+                                         occupancy_size),
+                 addrs, capacity, size, accesses);
+}
+
+int bg_run_spec(const char *spec, uint64_t seed, uint64_t shard_index,
+                uint64_t shard_count, const char *output, bg_table **table) {
+  *table = nullptr;
+  if (shard_count == 0 || shard_index >= shard_count) {
+    return BG_EINVAL;
+  }
+  std::istringstream in(spec);
+  ExperimentSpec experiment;
+  if (!parseSpec(in, "<api>", experiment)) {
+    return BG_ESPEC;
+  }
+  // the trials of a baseline spec depend on all trials before them
+  if (experiment.baseline && shard_count > 1) {
+    return BG_EINVAL;
+  }
+  RANDOM_SEED = experiment.seeded ? experiment.seed : seed;
+  SHARD_INDEX = shard_index;
+  SHARD_COUNT = shard_count;
+  ResultWriter *writer = nullptr;
+  if (output != nullptr) {
+    writer = new ResultWriter(ResultFormat::FMT_TEXT, output);
+  }
+  std::vector<std::vector<uint64_t>> rows;
+  bool known = runSpec(experiment, writer, nullptr, nullptr, nullptr, &rows);
+  if (writer != nullptr) {
+    writer->close();
+    delete writer;
+  }
+  SHARD_INDEX = 0;
+  SHARD_COUNT = 1;
+  if (!known) {
+    return BG_ESPEC;
+  }
+  *table = new bg_table;
+  (*table)->rows = rows.size();
+  (*table)->columns = rows.empty() ? 0 : rows[0].size();
+  for (const std::vector<uint64_t> &row : rows) {
+    (*table)->values.insert((*table)->values.end(), row.begin(), row.end());
+  }
+  return BG_OK;
+}
+
+int bg_table_shape(const bg_table *table, uint64_t *rows, uint64_t *columns) {
+  if (table == nullptr) {
+    return BG_EINVAL;
+  }
+  *rows = table->rows;
+  *columns = table->columns;
+  return BG_OK;
+}
+
+const uint64_t *bg_table_data(const bg_table *table) {
+  return table != nullptr ? table->values.data() : nullptr;
+}
+
+void bg_table_free(bg_table *table) { delete table; }
+
+int bg_mutual_information(const uint64_t *counts, uint64_t secrets,
+                          uint64_t observations, double z, double *plug_in,
+                          double *miller_madow, double *lower,
+                          double *upper) {
+  if (counts == nullptr || secrets == 0 || observations == 0) {
+    return BG_EINVAL;
+  }
+  LeakageEstimator estimate(secrets, observations);
+  estimate.add(counts);
+  std::pair<double, double> bounds = estimate.bounds(z);
+  *plug_in = estimate.plugIn();
+  *miller_madow = estimate.millerMadow();
+  *lower = bounds.first;
+  *upper = bounds.second;
+  return BG_OK;
+}
+
+int bg_channel_capacity(const uint64_t *counts, uint64_t secrets,
+                        uint64_t observations, double *bits) {
+  if (counts == nullptr || secrets == 0 || observations == 0) {
+    return BG_EINVAL;
+  }
+  LeakageEstimator estimate(secrets, observations);
+  estimate.add(counts);
+  *bits = estimate.capacity();
+  return BG_OK;
+}
@@ -0,0 +1,406 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/19
+// =============================================================================
+// The prune and occupancy attacks as scheduled processes (see Scheduler.hpp).
+// The attacker runs the algorithm of the scripts of attacks/*.cpp, but no
+// longer alternates with the victim by construction: the victim loops over
+// its secret branch in a process of its own, and the noise tenants loop over
+// their working sets in the domains after it. The scheduler interleaves them
+// in time slices and flushes the predictor on a domain switch if the schedule
+// says so. The attacker of the prune attack waits for the victim by ending
+// its slice; the occupancy attacks have no victim step, their set is only
+// disturbed by the noise. The accesses of an attack are the lookups of the
+// attacker and the victim, as in the scripts.
+// =============================================================================
+#include "include/predictors/BPUSet.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "include/predictors/Domains.hpp"
+#include "include/utils/Counters.hpp"
+#include "include/utils/Scheduler.hpp"
+#include "include/utils/Utils.hpp"
+
+// the victim: its secret branch in a loop
+static Process victim(Scheduler &scheduler, uint64_t victim_addr,
+                      uint64_t &total_access) {
+  for (;;) {
+    scheduler.lookupBTB(victim_addr, -1);
+    total_access++;
+    co_await scheduler.tick();
+  }
+}
+
+// a noise tenant looping over its working set of loop branches
+static Process noise(Scheduler &scheduler, const uint64_t *working_set,
+                     uint64_t num_branches) {
+  for (uint64_t cursor = 0;; cursor++) {
+    uint64_t pc = working_set[cursor % num_branches];
+    // loop branch of 2 to 5 iterations
+    uint64_t trips = (pc >> 2) % 4 + 2;
+    bool taken = (cursor / num_branches) % trips != 0;
+    scheduler.lookupPHT(pc, taken);
+    scheduler.lookupBTB(pc, pc + 64);
+    co_await scheduler.tick();
+  }
+}
+
+// prune-based attack
+static Process pruneAttacker(Scheduler &scheduler, BPUSet *bpus,
+                             uint64_t type, uint64_t num_loops,
+                             uint64_t victim_addr, uint64_t prune_size,
+                             uint64_t eviction_size,
+                             std::vector<uint64_t> &eviction_set,
+                             uint64_t &total_access) {
+  uint64_t buffer_ways = bpus->getBufferWays();
+  uint64_t current_loop = 0;
+  std::vector<uint64_t> prune_set;
+#ifdef LIMITED_BRANCH_ACCESS
+  while (current_loop < num_loops && eviction_set.size() < eviction_size &&
+         total_access < NUMBER_MAX_BRANCHES) {
+#else
+  while (current_loop < num_loops && eviction_set.size() < eviction_size) {
+#endif
+    uint64_t attacker_addr =
+        bpus->attackAddr(type, AttackKind::ATK_BTBPrune, victim_addr);
+    // attacker addr should not be in the eviction set
+    if (std::find(eviction_set.begin(), eviction_set.end(), attacker_addr) !=
+        eviction_set.end()) {
+      continue;
+    }
+    prune_set.push_back(attacker_addr);
+    // generate the prune set with the size of $prune_size$
+    if (prune_set.size() < prune_size) {
+      current_loop++;
+      continue;
+    }
+    // remove self conflict
+    uint64_t self_conflict = 1;
+    while (self_conflict != 0) {
+      // initial prune set state to $valid$
+      for (uint64_t addr : prune_set) {
+        scheduler.lookupBTB(addr, -1);
+        total_access++;
+        co_await scheduler.tick();
+      }
+      // check the prune set $hit$ or $miss$, keep the $hit$ ones
+      self_conflict = 0;
+      uint64_t kept = 0;
+      for (uint64_t i = 0; i < prune_set.size(); i++) {
+        int timing = scheduler.lookupBTB(prune_set[i], -1);
+        total_access++;
+        co_await scheduler.tick();
+        if (timing == -1 && prune_set.size() - self_conflict > buffer_ways) {
+          self_conflict++;
+        } else {
+          prune_set[kept++] = prune_set[i];
+        }
+      }
+      prune_set.resize(kept);
+    }
+    // let the victim run
+    co_await scheduler.yield();
+    // check the prune set $hit$ or $miss$
+    for (uint64_t addr : prune_set) {
+      int timing = scheduler.lookupBTB(addr, -1);
+      total_access++;
+      co_await scheduler.tick();
+      if (timing == -1) {
+        eviction_set.push_back(addr);
+      }
+    }
+    prune_set.clear();
+    current_loop++;
+  }
+}
+
+// occupancy-based attack
+static Process phtOccupancyAttacker(Scheduler &scheduler, BPUSet *bpus,
+                                    uint64_t type, uint64_t num_loops,
+                                    uint64_t counter_bits, uint64_t prune_size,
+                                    uint64_t occupancy_size,
+                                    std::vector<uint64_t> &occupancy_set,
+                                    uint64_t &total_access) {
+  uint64_t total_check = std::exp2(counter_bits) / 2;
+  uint64_t current_loop = 0;
+  std::vector<uint64_t> prune_set;
+#ifdef LIMITED_BRANCH_ACCESS
+  while (current_loop < num_loops && occupancy_set.size() < occupancy_size &&
+         total_access < NUMBER_MAX_BRANCHES) {
+#else
+  while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
+#endif
+    uint64_t attacker_addr =
+        bpus->attackAddr(type, AttackKind::ATK_PHTOccupancy, 0);
+    // attacker addr should not be in the occupancy set
+    if (std::find(occupancy_set.begin(), occupancy_set.end(), attacker_addr) !=
+        occupancy_set.end()) {
+      continue;
+    }
+    prune_set.push_back(attacker_addr);
+    // generate the prune set with the size of $prune_size$
+    if (prune_set.size() < prune_size) {
+      current_loop++;
+      continue;
+    }
+    // remove self conflict in the prune set: train the first address of a
+    // pair not taken and the second taken, then look up the first again
+    uint64_t self_conflict = 1;
+    while (self_conflict != 0) {
+      self_conflict = 0;
+      for (uint64_t idx_i = 0; idx_i < prune_set.size(); idx_i++) {
+        for (uint64_t idx_j = idx_i + 1; idx_j < prune_set.size(); idx_j++) {
+          for (uint64_t i = 0; i < total_check; i++) {
+            scheduler.lookupPHT(prune_set[idx_i], false);
+            total_access++;
+            co_await scheduler.tick();
+          }
+          for (uint64_t i = 0; i < total_check; i++) {
+            scheduler.lookupPHT(prune_set[idx_j], true);
+            total_access++;
+            co_await scheduler.tick();
+          }
+          bool timing = scheduler.lookupPHT(prune_set[idx_i], false);
+          total_access++;
+          co_await scheduler.tick();
+          if (!timing) {
+            prune_set.erase(prune_set.begin() + idx_j);
+            self_conflict++;
+          }
+        }
+      }
+    }
+    // initial prune set state to $valid$
+    for (uint64_t addr : prune_set) {
+      for (uint64_t i = 0; i < total_check; i++) {
+        scheduler.lookupPHT(addr, true);
+        total_access++;
+        co_await scheduler.tick();
+      }
+    }
+    // access the occupancy set
+    for (uint64_t addr : occupancy_set) {
+      for (uint64_t i = 0; i < total_check; i++) {
+        scheduler.lookupPHT(addr, false);
+        total_access++;
+        co_await scheduler.tick();
+      }
+    }
+    // check the addr $hit$ or $miss$
+    for (uint64_t addr : prune_set) {
+      bool timing = scheduler.lookupPHT(addr, true);
+      total_access++;
+      co_await scheduler.tick();
+      if (timing) {
+        occupancy_set.push_back(addr);
+      }
+    }
+    prune_set.clear();
+    current_loop++;
+  }
+}
+
+static Process btbOccupancyAttacker(Scheduler &scheduler, BPUSet *bpus,
+                                    uint64_t type, uint64_t num_loops,
+                                    uint64_t prune_size,
+                                    uint64_t occupancy_size,
+                                    std::vector<uint64_t> &occupancy_set,
+                                    uint64_t &total_access) {
+  uint64_t current_loop = 0;
+  std::vector<uint64_t> prune_set;
+#ifdef LIMITED_BRANCH_ACCESS
+  while (current_loop < num_loops && occupancy_set.size() < occupancy_size &&
+         total_access < NUMBER_MAX_BRANCHES) {
+#else
+  while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
+#endif
+    uint64_t attacker_addr =
+        bpus->attackAddr(type, AttackKind::ATK_BTBOccupancy, 0);
+    // attacker addr should not be in the occupancy set
+    if (std::find(occupancy_set.begin(), occupancy_set.end(), attacker_addr) !=
+        occupancy_set.end()) {
+      continue;
+    }
+    prune_set.push_back(attacker_addr);
+    // generate the prune set with the size of $prune_size$
+    if (prune_set.size() < prune_size) {
+      current_loop++;
+      continue;
+    }
+    // remove self conflict
+    uint64_t self_conflict = 1;
+    while (self_conflict != 0) {
+      // initial prune set state to $valid$
+      for (uint64_t addr : prune_set) {
+        scheduler.lookupBTB(addr, -1);
+        total_access++;
+        co_await scheduler.tick();
+      }
+      // check the prune set $hit$ or $miss$, keep the $hit$ ones
+      self_conflict = 0;
+      uint64_t kept = 0;
+      for (uint64_t i = 0; i < prune_set.size(); i++) {
+        int timing = scheduler.lookupBTB(prune_set[i], -1);
+        total_access++;
+        co_await scheduler.tick();
+        if (timing == -1) {
+          self_conflict++;
+        } else {
+          prune_set[kept++] = prune_set[i];
+        }
+      }
+      prune_set.resize(kept);
+    }
+    // check conflict with the occupancy set
+    for (uint64_t addr : occupancy_set) {
+      scheduler.lookupBTB(addr, -1);
+      total_access++;
+      co_await scheduler.tick();
+    }
+    // check the prune set $hit$ or $miss$
+    for (uint64_t addr : prune_set) {
+      int timing = scheduler.lookupBTB(addr, -1);
+      total_access++;
+      co_await scheduler.tick();
+      if (timing == 1) {
+        occupancy_set.push_back(addr);
+      }
+    }
+    prune_set.clear();
+    current_loop++;
+  }
+}
+
+uint64_t BPUSet::attackAddr(uint64_t type, uint64_t attack,
+                            uint64_t victim_addr) {
+  // LS-BP and STBPU: any address, their index takes every address bit
+  if (attack == AttackKind::ATK_NONE || type == BPUType::BPU_LSBP ||
+      type == BPUType::BPU_STBPU) {
+    return randomAddr(addr_mask);
+  }
+  // the baseline and XOR-BP: a random tag in the attacker's set of the victim
+  if (attack == AttackKind::ATK_BTBPrune &&
+      (type == BPUType::BPU_BaseBPU || type == BPUType::BPU_XorBP)) {
+    uint64_t attacker_set =
+        getBTBSet(type, victim_addr, SecurityDomain::DOM_ATTACKER);
+    uint64_t attacker_tag = randomAddr(addr_mask) >> offset_btb >> btb_set_bits;
+    return attacker_set << offset_btb |
+           attacker_tag << offset_btb << btb_set_bits;
+  }
+  uint64_t offset =
+      attack == AttackKind::ATK_PHTOccupancy ? offset_pht : offset_btb;
+  return (randomAddr(addr_mask) >> offset) << offset;
+}
+
+// noise tenants of a schedule: a working set of random branches each
+static void spawnNoise(Scheduler &scheduler, BPUSet *bpus, uint64_t type,
+                       const AttackSchedule &schedule,
+                       std::vector<uint64_t> &working_sets) {
+  working_sets.resize(schedule.noise * schedule.noise_branches);
+  for (uint64_t &pc : working_sets) {
+    pc = bpus->attackAddr(type, AttackKind::ATK_NONE, 0);
+  }
+  for (uint64_t i = 0; i < schedule.noise; i++) {
+    scheduler.spawn(noise(scheduler,
+                          working_sets.data() + i * schedule.noise_branches,
+                          schedule.noise_branches),
+                    NUM_ATTACK_DOMAINS + i, true);
+  }
+}
+
+std::pair<std::vector<uint64_t>, uint64_t> BPUSet::scheduledBTBPrune(
+    uint64_t type, uint64_t num_loops, uint64_t victim_addr,
+    uint64_t prune_size, uint64_t eviction_size) {
+#ifdef ATTACK
+  std::cout << "== BTBPrune (scheduled) ==" << std::endl;
+#endif
+  uint64_t total_access = 0;
+  std::vector<uint64_t> eviction_set;
+  std::vector<uint64_t> working_sets;
+  Scheduler scheduler(this, type, schedule->config);
+  scheduler.spawn(pruneAttacker(scheduler, this, type, num_loops, victim_addr,
+                                prune_size, eviction_size, eviction_set,
+                                total_access),
+                  SecurityDomain::DOM_ATTACKER);
+  scheduler.spawn(victim(scheduler, victim_addr, total_access),
+                  SecurityDomain::DOM_VICTIM, true);
+  spawnNoise(scheduler, this, type, *schedule, working_sets);
+  scheduler.run(-1);
+#ifdef ATTACK
+  std::cout << std::dec << "total_access: " << total_access << std::endl;
+  std::cout << std::dec << "eviction_set: " << eviction_set.size() << std::endl;
+#endif
+  return std::make_pair(eviction_set, total_access);
+}
+
+std::pair<std::vector<uint64_t>, uint64_t> BPUSet::scheduledPHTOccupancy(
+    uint64_t type, uint64_t num_loops, uint64_t counter_bits,
+    uint64_t prune_size, uint64_t occupancy_size) {
+#ifdef ATTACK
+  std::cout << "== PHTOccupancy (scheduled) ==" << std::endl;
+#endif
+  uint64_t total_access = 0;
+  std::vector<uint64_t> occupancy_set;
+  std::vector<uint64_t> working_sets;
+  Scheduler scheduler(this, type, schedule->config);
+  scheduler.spawn(phtOccupancyAttacker(scheduler, this, type, num_loops,
+                                       counter_bits, prune_size,
+                                       occupancy_size, occupancy_set,
+                                       total_access),
+                  SecurityDomain::DOM_ATTACKER);
+  spawnNoise(scheduler, this, type, *schedule, working_sets);
+  scheduler.run(-1);
+#ifdef ATTACK
+  std::cout << std::dec << "total_access: " << total_access << std::endl;
+  std::cout << std::dec << "occupancy_set: " << occupancy_set.size()
+            << std::endl;
+#endif
+  return std::make_pair(occupancy_set, total_access);
+}
+
+std::pair<std::vector<uint64_t>, uint64_t> BPUSet::scheduledBTBOccupancy(
+    uint64_t type, uint64_t num_loops, uint64_t prune_size,
+    uint64_t occupancy_size) {
+#ifdef ATTACK
+  std::cout << "== BTBOccupancy (scheduled) ==" << std::endl;
+#endif
+  uint64_t total_access = 0;
+  std::vector<uint64_t> occupancy_set;
+  std::vector<uint64_t> working_sets;
+  Scheduler scheduler(this, type, schedule->config);
+  scheduler.spawn(btbOccupancyAttacker(scheduler, this, type, num_loops,
+                                       prune_size, occupancy_size,
+                                       occupancy_set, total_access),
+                  SecurityDomain::DOM_ATTACKER);
+  spawnNoise(scheduler, this, type, *schedule, working_sets);
+  scheduler.run(-1);
+#ifdef ATTACK
+  std::cout << std::dec << "total_access: " << total_access << std::endl;
+  std::cout << std::dec << "occupancy_set: " << occupancy_set.size()
+            << std::endl;
+#endif
+  return std::make_pair(occupancy_set, total_access);
+}
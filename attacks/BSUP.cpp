@@ -31,6 +31,7 @@
 #include <iostream>
 #include <vector>
 
+#include "include/utils/Counters.hpp"
 #include "include/utils/Utils.hpp"
 
 // reuse-based attack
@@ -48,11 +49,9 @@ std::pair<uint64_t, uint64_t> BSUP::PHTTiming(uint64_t num_loops,
   while (gen_set.size() < num_loops) {
 #endif
     uint64_t attacker_set = rand() % counter_nums;
-    uint64_t attacker_tag =
-        victim_addr >> offset_pht >> (int)std::log2(counter_nums);
+    uint64_t attacker_tag = victim_addr >> offset_pht >> pht_set_bits;
     uint64_t attacker_addr = attacker_set << offset_pht |
-                             attacker_tag << offset_pht
-                                          << (int)std::log2(counter_nums);
+                             attacker_tag << offset_pht << pht_set_bits;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
     //   continue;
@@ -61,6 +60,7 @@ std::pair<uint64_t, uint64_t> BSUP::PHTTiming(uint64_t num_loops,
     uint64_t total_check = std::exp2(counter_bits) / 2;
     for (uint64_t i = 0; i < total_check; i++) {
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -75,11 +75,13 @@ std::pair<uint64_t, uint64_t> BSUP::PHTTiming(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_1 =
           this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
       total_access++;
 
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -94,6 +96,7 @@ std::pair<uint64_t, uint64_t> BSUP::PHTTiming(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_2 =
           this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
       total_access++;
@@ -144,11 +147,9 @@ std::pair<uint64_t, uint64_t> BSUP::PHTSpeculative(uint64_t num_loops,
   while (gen_set.size() < num_loops) {
 #endif
     uint64_t attacker_set = rand() % counter_nums;
-    uint64_t attacker_tag =
-        victim_addr >> offset_pht >> (int)std::log2(counter_nums);
+    uint64_t attacker_tag = victim_addr >> offset_pht >> pht_set_bits;
     uint64_t attacker_addr = attacker_set << offset_pht |
-                             attacker_tag << offset_pht
-                                          << (int)std::log2(counter_nums);
+                             attacker_tag << offset_pht << pht_set_bits;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
     //   continue;
@@ -157,6 +158,7 @@ std::pair<uint64_t, uint64_t> BSUP::PHTSpeculative(uint64_t num_loops,
     uint64_t total_check = std::exp2(counter_bits) / 2;
     for (uint64_t i = 0; i < total_check; i++) {
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -171,11 +173,13 @@ std::pair<uint64_t, uint64_t> BSUP::PHTSpeculative(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_1 =
           this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
       total_access++;
 
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -190,6 +194,7 @@ std::pair<uint64_t, uint64_t> BSUP::PHTSpeculative(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_2 =
           this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
       total_access++;
@@ -243,8 +248,7 @@ std::pair<uint64_t, uint64_t> BSUP::BTBTiming(uint64_t num_loops,
     uint64_t attacker_tag =
         getBTBTag(victim_addr, SecurityDomain::DOM_ATTACKER);
     uint64_t attacker_addr = attacker_set << offset_btb |
-                             attacker_tag << offset_btb
-                                          << (int)std::log2(buffer_sets);
+                             attacker_tag << offset_btb << btb_set_bits;
     uint64_t attacker_target = -1;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
@@ -252,6 +256,7 @@ std::pair<uint64_t, uint64_t> BSUP::BTBTiming(uint64_t num_loops,
     // }
     gen_set.push_back(attacker_addr);
     // initial state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
     // train the BTB to $mispredict$
@@ -259,6 +264,7 @@ std::pair<uint64_t, uint64_t> BSUP::BTBTiming(uint64_t num_loops,
                     SecurityDomain::DOM_ATTACKER);
     total_access++;
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     uint64_t timing =
         this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
@@ -316,8 +322,7 @@ std::pair<uint64_t, uint64_t> BSUP::BTBSpeculative(uint64_t num_loops,
     uint64_t attacker_tag =
         getBTBTag(victim_addr, SecurityDomain::DOM_ATTACKER);
     uint64_t attacker_addr = attacker_set << offset_btb |
-                             attacker_tag << offset_btb
-                                          << (int)std::log2(buffer_sets);
+                             attacker_tag << offset_btb << btb_set_bits;
     uint64_t attacker_target = -1;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
@@ -325,6 +330,7 @@ std::pair<uint64_t, uint64_t> BSUP::BTBSpeculative(uint64_t num_loops,
     // }
     gen_set.push_back(attacker_addr);
     // initial state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
     // train the BTB to $mispredict$
@@ -332,6 +338,7 @@ std::pair<uint64_t, uint64_t> BSUP::BTBSpeculative(uint64_t num_loops,
                     SecurityDomain::DOM_ATTACKER);
     total_access++;
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     uint64_t timing =
         this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
@@ -361,13 +368,14 @@ std::pair<uint64_t, uint64_t> BSUP::BTBSpeculative(uint64_t num_loops,
       std::cout << std::hex << "attacker_addr: " << attacker_addr << std::endl;
 #endif
 // find covert channel
+      COUNT_PHASE(AttackPhase::PHASE_PROBE);
 #ifdef LIMITED_BRANCH_ACCESS
       while (gen_set.size() + tar_set.size() < num_loops &&
              total_access < NUMBER_MAX_BRANCHES) {
 #else
       while (gen_set.size() + tar_set.size() < num_loops) {
 #endif
-        uint64_t attacker_target = rand() & ((1ULL << addr_space) - 1);
+        uint64_t attacker_target = randomAddr(addr_mask);
         // if (std::find(tar_set.begin(), tar_set.end(), attacker_target) !=
         //     tar_set.end()) {
         //   continue;
@@ -423,7 +431,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BSUP::BTBPrune(
   while (current_loop < num_loops && eviction_set.size() < eviction_size) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_btb) << offset_btb;
+        (randomAddr(addr_mask) >> offset_btb) << offset_btb;
     // attacker addr should not be in the prune set and eviction set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -440,6 +448,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BSUP::BTBPrune(
       continue;
     }
     // remove self conflict
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     int self_conflict = 1;
     while (self_conflict != 0) {
       // initial prune set state to $valid$
@@ -462,9 +471,11 @@ std::pair<std::vector<uint64_t>, uint64_t> BSUP::BTBPrune(
       self_conflict = collision;
     }
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     this->lookupBTB(victim_addr, -1, SecurityDomain::DOM_VICTIM);
     total_access++;
     // check the prune set $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing = this->lookupBTB(addr, -1, SecurityDomain::DOM_ATTACKER);
       total_access++;
@@ -514,7 +525,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BSUP::PHTOccupancy(
   while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_pht) << offset_pht;
+        (randomAddr(addr_mask) >> offset_pht) << offset_pht;
     // attacker addr should not be in the prune set and occupancy set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -532,6 +543,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BSUP::PHTOccupancy(
     }
     uint64_t total_check = std::exp2(counter_bits) / 2;
     // remove self conflict in the prune set
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     auto checkTwoAddrConflict = [&](uint64_t addr1, uint64_t addr2) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr1, false, SecurityDomain::DOM_ATTACKER);
@@ -561,6 +573,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BSUP::PHTOccupancy(
       self_confilct = collision;
     }
     // initial prune set state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     for (uint64_t &addr : prune_set) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr, true, SecurityDomain::DOM_ATTACKER);
@@ -568,6 +581,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BSUP::PHTOccupancy(
       }
     }
     // access the occupancy set
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     for (uint64_t &addr : occupancy_set) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr, false, SecurityDomain::DOM_ATTACKER);
@@ -575,6 +589,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BSUP::PHTOccupancy(
       }
     }
     // check the addr $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing =
           this->lookupPHT(addr, true, SecurityDomain::DOM_ATTACKER);
@@ -635,7 +650,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BSUP::BTBOccupancy(
   while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_btb) << offset_btb;
+        (randomAddr(addr_mask) >> offset_btb) << offset_btb;
     // attacker addr should not be in the prune set and occupancy set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -652,6 +667,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BSUP::BTBOccupancy(
       continue;
     }
     // remove self conflict
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     int self_conflict = 1;
     while (self_conflict != 0) {
       // initial prune set state to $valid$
@@ -674,11 +690,13 @@ std::pair<std::vector<uint64_t>, uint64_t> BSUP::BTBOccupancy(
       self_conflict = collision;
     }
     // check conflict with the occupancy set
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     for (uint64_t &addr : occupancy_set) {
       this->lookupBTB(addr, -1, SecurityDomain::DOM_ATTACKER);
       total_access++;
     }
     // check the prune set $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing = this->lookupBTB(addr, -1, SecurityDomain::DOM_ATTACKER);
       total_access++;
@@ -29,6 +29,8 @@
 #include <utility>
 #include <vector>
 
+#include "include/utils/Counters.hpp"
+
 // reuse-based attack
 std::pair<uint64_t, uint64_t> BaseBPU::PHTTiming(uint64_t num_loops,
                                                  uint64_t counter_bits,
@@ -52,6 +54,7 @@ std::pair<uint64_t, uint64_t> BaseBPU::PHTTiming(uint64_t num_loops,
     uint64_t total_check = std::exp2(counter_bits) / 2;
     for (uint64_t i = 0; i < total_check; i++) {
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, true);
         total_access++;
@@ -62,6 +65,7 @@ std::pair<uint64_t, uint64_t> BaseBPU::PHTTiming(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing = this->lookupPHT(victim_addr, true);
       total_access++;
       // check the timing $hit$ or $miss$
@@ -107,6 +111,7 @@ std::pair<uint64_t, uint64_t> BaseBPU::PHTSpeculative(uint64_t num_loops,
     uint64_t total_check = std::exp2(counter_bits) / 2;
     for (uint64_t i = 0; i < total_check; i++) {
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, true);
         total_access++;
@@ -117,6 +122,7 @@ std::pair<uint64_t, uint64_t> BaseBPU::PHTSpeculative(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing = this->lookupPHT(victim_addr, true);
       total_access++;
       // check the timing $hit$ or $miss$
@@ -161,12 +167,14 @@ std::pair<uint64_t, uint64_t> BaseBPU::BTBTiming(uint64_t num_loops,
     // }
     gen_set.push_back(attacker_addr);
     // initial state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     this->lookupBTB(victim_addr, target_addr);
     total_access++;
     // train the BTB to $mispredict$
     this->lookupBTB(attacker_addr, attacker_target);
     total_access++;
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     uint64_t timing = this->lookupBTB(victim_addr, target_addr);
     total_access++;
     // check the timing $hit$ or $miss$
@@ -211,12 +219,14 @@ std::pair<uint64_t, uint64_t> BaseBPU::BTBSpeculative(uint64_t num_loops,
     // }
     gen_set.push_back(attacker_addr);
     // initial state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     this->lookupBTB(victim_addr, target_addr);
     total_access++;
     // train the BTB to $mispredict$
     this->lookupBTB(attacker_addr, attacker_target);
     total_access++;
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     uint64_t timing = this->lookupBTB(victim_addr, target_addr);
     total_access++;
     // check the timing $hit$ or $miss$
@@ -229,6 +239,7 @@ std::pair<uint64_t, uint64_t> BaseBPU::BTBSpeculative(uint64_t num_loops,
       std::cout << std::hex << "attacker_addr: " << attacker_addr << std::endl;
 #endif
 // find covert channel
+      COUNT_PHASE(AttackPhase::PHASE_PROBE);
 #ifdef LIMITED_BRANCH_ACCESS
       while (gen_set.size() + tar_set.size() < num_loops &&
              total_access < NUMBER_MAX_BRANCHES) {
@@ -288,11 +299,9 @@ std::pair<std::vector<uint64_t>, uint64_t> BaseBPU::BTBPrune(
   while (current_loop < num_loops && eviction_set.size() < eviction_size) {
 #endif
     uint64_t attacker_set = getBTBSet(victim_addr);
-    uint64_t attacker_tag = (rand() & ((1ULL << addr_space) - 1)) >>
-                            offset_btb >> (int)std::log2(buffer_sets);
+    uint64_t attacker_tag = randomAddr(addr_mask) >> offset_btb >> btb_set_bits;
     uint64_t attacker_addr = attacker_set << offset_btb |
-                             attacker_tag << offset_btb
-                                          << (int)std::log2(buffer_sets);
+                             attacker_tag << offset_btb << btb_set_bits;
     // attacker addr should not be in the prune set and eviction set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -309,6 +318,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BaseBPU::BTBPrune(
       continue;
     }
     // remove self conflict
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     int self_conflict = 1;
     while (self_conflict != 0) {
       // initial prune set state to $valid$
@@ -330,9 +340,11 @@ std::pair<std::vector<uint64_t>, uint64_t> BaseBPU::BTBPrune(
       self_conflict = collision;
     }
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     this->lookupBTB(victim_addr, -1);
     total_access++;
     // check the prune set $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing = this->lookupBTB(addr, -1);
       total_access++;
@@ -371,7 +383,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BaseBPU::PHTOccupancy(
   while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_pht) << offset_pht;
+        (randomAddr(addr_mask) >> offset_pht) << offset_pht;
     // attacker addr should not be in the prune set and occupancy set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -389,6 +401,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BaseBPU::PHTOccupancy(
     }
     uint64_t total_check = std::exp2(counter_bits) / 2;
     // remove self conflict in the prune set
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     auto checkTwoAddrConflict = [&](uint64_t addr1, uint64_t addr2) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr1, false);
@@ -417,6 +430,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BaseBPU::PHTOccupancy(
       self_confilct = collision;
     }
     // initial prune set state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     for (uint64_t &addr : prune_set) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr, true);
@@ -424,6 +438,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BaseBPU::PHTOccupancy(
       }
     }
     // access the occupancy set
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     for (uint64_t &addr : occupancy_set) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr, false);
@@ -431,6 +446,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BaseBPU::PHTOccupancy(
       }
     }
     // check the addr $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing = this->lookupPHT(addr, true);
       total_access++;
@@ -489,7 +505,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BaseBPU::BTBOccupancy(
   while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_btb) << offset_btb;
+        (randomAddr(addr_mask) >> offset_btb) << offset_btb;
     // attacker addr should not be in the prune set and occupancy set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -506,6 +522,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BaseBPU::BTBOccupancy(
       continue;
     }
     // remove self conflict
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     int self_conflict = 1;
     while (self_conflict != 0) {
       // initial prune set state to $valid$
@@ -527,11 +544,13 @@ std::pair<std::vector<uint64_t>, uint64_t> BaseBPU::BTBOccupancy(
       self_conflict = collision;
     }
     // check conflict with the occupancy set
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     for (uint64_t &addr : occupancy_set) {
       this->lookupBTB(addr, -1);
       total_access++;
     }
     // check the prune set $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing = this->lookupBTB(addr, -1);
       total_access++;
@@ -32,6 +32,7 @@
 #include <iostream>
 #include <vector>
 
+#include "include/utils/Counters.hpp"
 #include "include/utils/Utils.hpp"
 
 // reuse-based attack
@@ -49,7 +50,7 @@ std::pair<uint64_t, uint64_t> HyBP::PHTTiming(uint64_t num_loops,
   while (gen_set.size() < num_loops) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_pht) << offset_pht;
+        (randomAddr(addr_mask) >> offset_pht) << offset_pht;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
     //   continue;
@@ -58,6 +59,7 @@ std::pair<uint64_t, uint64_t> HyBP::PHTTiming(uint64_t num_loops,
     uint64_t total_check = std::exp2(counter_bits) / 2;
     for (uint64_t i = 0; i < total_check; i++) {
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -72,11 +74,13 @@ std::pair<uint64_t, uint64_t> HyBP::PHTTiming(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_1 =
           this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
       total_access++;
 
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -91,6 +95,7 @@ std::pair<uint64_t, uint64_t> HyBP::PHTTiming(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_2 =
           this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
       total_access++;
@@ -141,7 +146,7 @@ std::pair<uint64_t, uint64_t> HyBP::PHTSpeculative(uint64_t num_loops,
   while (gen_set.size() < num_loops) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_pht) << offset_pht;
+        (randomAddr(addr_mask) >> offset_pht) << offset_pht;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
     //   continue;
@@ -150,6 +155,7 @@ std::pair<uint64_t, uint64_t> HyBP::PHTSpeculative(uint64_t num_loops,
     uint64_t total_check = std::exp2(counter_bits) / 2;
     for (uint64_t i = 0; i < total_check; i++) {
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -164,11 +170,13 @@ std::pair<uint64_t, uint64_t> HyBP::PHTSpeculative(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_1 =
           this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
       total_access++;
 
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -183,6 +191,7 @@ std::pair<uint64_t, uint64_t> HyBP::PHTSpeculative(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_2 =
           this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
       total_access++;
@@ -233,7 +242,7 @@ std::pair<uint64_t, uint64_t> HyBP::BTBTiming(uint64_t num_loops,
   while (gen_set.size() < num_loops) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_btb) << offset_btb;
+        (randomAddr(addr_mask) >> offset_btb) << offset_btb;
     uint64_t attacker_target = -1;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
@@ -241,6 +250,7 @@ std::pair<uint64_t, uint64_t> HyBP::BTBTiming(uint64_t num_loops,
     // }
     gen_set.push_back(attacker_addr);
     // initial state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
     // train the BTB to $mispredict$
@@ -248,6 +258,7 @@ std::pair<uint64_t, uint64_t> HyBP::BTBTiming(uint64_t num_loops,
                     SecurityDomain::DOM_ATTACKER);
     total_access++;
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     uint64_t timing =
         this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
@@ -302,7 +313,7 @@ std::pair<uint64_t, uint64_t> HyBP::BTBSpeculative(uint64_t num_loops,
   while (gen_set.size() + tar_set.size() < num_loops) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_btb) << offset_btb;
+        (randomAddr(addr_mask) >> offset_btb) << offset_btb;
     uint64_t attacker_target = -1;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
@@ -310,6 +321,7 @@ std::pair<uint64_t, uint64_t> HyBP::BTBSpeculative(uint64_t num_loops,
     // }
     gen_set.push_back(attacker_addr);
     // initial state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
     // train the BTB to $mispredict$
@@ -317,6 +329,7 @@ std::pair<uint64_t, uint64_t> HyBP::BTBSpeculative(uint64_t num_loops,
                     SecurityDomain::DOM_ATTACKER);
     total_access++;
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     uint64_t timing =
         this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
@@ -346,13 +359,14 @@ std::pair<uint64_t, uint64_t> HyBP::BTBSpeculative(uint64_t num_loops,
       std::cout << std::hex << "attacker_addr: " << attacker_addr << std::endl;
 #endif
 // find covert channel
+      COUNT_PHASE(AttackPhase::PHASE_PROBE);
 #ifdef LIMITED_BRANCH_ACCESS
       while (gen_set.size() + tar_set.size() < num_loops &&
              total_access < NUMBER_MAX_BRANCHES) {
 #else
       while (gen_set.size() + tar_set.size() < num_loops) {
 #endif
-        uint64_t attacker_target = rand() & ((1ULL << addr_space) - 1);
+        uint64_t attacker_target = randomAddr(addr_mask);
         // if (std::find(tar_set.begin(), tar_set.end(), attacker_target) !=
         //     tar_set.end()) {
         //   continue;
@@ -408,7 +422,7 @@ std::pair<std::vector<uint64_t>, uint64_t> HyBP::BTBPrune(
   while (current_loop < num_loops && eviction_set.size() < eviction_size) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_btb) << offset_btb;
+        (randomAddr(addr_mask) >> offset_btb) << offset_btb;
     // attacker addr should not be in the prune set and eviction set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -425,6 +439,7 @@ std::pair<std::vector<uint64_t>, uint64_t> HyBP::BTBPrune(
       continue;
     }
     // remove self conflict
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     int self_conflict = 1;
     while (self_conflict != 0) {
       // initial prune set state to $valid$
@@ -447,9 +462,11 @@ std::pair<std::vector<uint64_t>, uint64_t> HyBP::BTBPrune(
       self_conflict = collision;
     }
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     this->lookupBTB(victim_addr, -1, SecurityDomain::DOM_VICTIM);
     total_access++;
     // check the prune set $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing = this->lookupBTB(addr, -1, SecurityDomain::DOM_ATTACKER);
       total_access++;
@@ -499,7 +516,7 @@ std::pair<std::vector<uint64_t>, uint64_t> HyBP::PHTOccupancy(
   while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_pht) << offset_pht;
+        (randomAddr(addr_mask) >> offset_pht) << offset_pht;
     // attacker addr should not be in the prune set and occupancy set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -517,6 +534,7 @@ std::pair<std::vector<uint64_t>, uint64_t> HyBP::PHTOccupancy(
     }
     uint64_t total_check = std::exp2(counter_bits) / 2;
     // remove self conflict in the prune set
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     auto checkTwoAddrConflict = [&](uint64_t addr1, uint64_t addr2) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr1, false, SecurityDomain::DOM_ATTACKER);
@@ -546,6 +564,7 @@ std::pair<std::vector<uint64_t>, uint64_t> HyBP::PHTOccupancy(
       self_confilct = collision;
     }
     // initial prune set state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     for (uint64_t &addr : prune_set) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr, true, SecurityDomain::DOM_ATTACKER);
@@ -553,6 +572,7 @@ std::pair<std::vector<uint64_t>, uint64_t> HyBP::PHTOccupancy(
       }
     }
     // access the occupancy set
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     for (uint64_t &addr : occupancy_set) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr, false, SecurityDomain::DOM_ATTACKER);
@@ -560,6 +580,7 @@ std::pair<std::vector<uint64_t>, uint64_t> HyBP::PHTOccupancy(
       }
     }
     // check the addr $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing =
           this->lookupPHT(addr, true, SecurityDomain::DOM_ATTACKER);
@@ -620,7 +641,7 @@ std::pair<std::vector<uint64_t>, uint64_t> HyBP::BTBOccupancy(
   while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_btb) << offset_btb;
+        (randomAddr(addr_mask) >> offset_btb) << offset_btb;
     // attacker addr should not be in the prune set and occupancy set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -637,6 +658,7 @@ std::pair<std::vector<uint64_t>, uint64_t> HyBP::BTBOccupancy(
       continue;
     }
     // remove self conflict
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     int self_conflict = 1;
     while (self_conflict != 0) {
       // initial prune set state to $valid$
@@ -659,11 +681,13 @@ std::pair<std::vector<uint64_t>, uint64_t> HyBP::BTBOccupancy(
       self_conflict = collision;
     }
     // check conflict with the occupancy set
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     for (uint64_t &addr : occupancy_set) {
       this->lookupBTB(addr, -1, SecurityDomain::DOM_ATTACKER);
       total_access++;
     }
     // check the prune set $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing = this->lookupBTB(addr, -1, SecurityDomain::DOM_ATTACKER);
       total_access++;
@@ -30,6 +30,7 @@
 #include <iostream>
 #include <vector>
 
+#include "include/utils/Counters.hpp"
 #include "include/utils/Utils.hpp"
 
 // reuse-based attack
@@ -48,7 +49,7 @@ std::pair<uint64_t, uint64_t> LSBP::PHTTiming(uint64_t num_loops,
 #else
   while (gen_set.size() < num_loops) {
 #endif
-    uint64_t attacker_addr = rand() & ((1ULL << addr_space) - 1);
+    uint64_t attacker_addr = randomAddr(addr_mask);
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
     //   continue;
@@ -57,6 +58,7 @@ std::pair<uint64_t, uint64_t> LSBP::PHTTiming(uint64_t num_loops,
     uint64_t total_check = std::exp2(counter_bits) / 2;
     for (uint64_t i = 0; i < total_check; i++) {
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, true, victim_pid,
                         SecurityDomain::DOM_VICTIM);
@@ -74,6 +76,7 @@ std::pair<uint64_t, uint64_t> LSBP::PHTTiming(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing = this->lookupPHT(victim_addr, true, victim_pid,
                                         SecurityDomain::DOM_VICTIM);
       total_access++;
@@ -127,7 +130,7 @@ std::pair<uint64_t, uint64_t> LSBP::PHTSpeculative(uint64_t num_loops,
 #else
   while (gen_set.size() < num_loops) {
 #endif
-    uint64_t attacker_addr = rand() & ((1ULL << addr_space) - 1);
+    uint64_t attacker_addr = randomAddr(addr_mask);
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
     //   continue;
@@ -136,6 +139,7 @@ std::pair<uint64_t, uint64_t> LSBP::PHTSpeculative(uint64_t num_loops,
     uint64_t total_check = std::exp2(counter_bits) / 2;
     for (uint64_t i = 0; i < total_check; i++) {
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, true, victim_pid,
                         SecurityDomain::DOM_VICTIM);
@@ -153,6 +157,7 @@ std::pair<uint64_t, uint64_t> LSBP::PHTSpeculative(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing = this->lookupPHT(victim_addr, true, victim_pid,
                                         SecurityDomain::DOM_VICTIM);
       total_access++;
@@ -207,12 +212,13 @@ std::pair<uint64_t, uint64_t> LSBP::BTBTiming(uint64_t num_loops,
 #endif
     uint64_t attacker_addr = victim_addr;
     uint64_t attacker_target = -1;
-    uint64_t attacker_pid = rand() & ((1ULL << addr_space) - 1);
+    uint64_t attacker_pid = randomAddr(addr_mask);
 #ifdef RANDOM_KEY
-    this->index_keys = {rand() & ((1ULL << addr_space) - 1),
-                        rand() & ((1ULL << addr_space) - 1)};
+    keys[SecurityDomain::DOM_ATTACKER].index_key = randomAddr(addr_mask);
+    keys[SecurityDomain::DOM_VICTIM].index_key = randomAddr(addr_mask);
 #else
-    this->index_keys = {EncryptionKey::KEY_0, EncryptionKey::KEY_1};
+    keys[SecurityDomain::DOM_ATTACKER].index_key = EncryptionKey::KEY_0;
+    keys[SecurityDomain::DOM_VICTIM].index_key = EncryptionKey::KEY_1;
 #endif
     // check if the attacker address is in the buffer or same as the victim
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_pid) !=
@@ -224,6 +230,7 @@ std::pair<uint64_t, uint64_t> LSBP::BTBTiming(uint64_t num_loops,
     }
     gen_set.push_back(attacker_pid);
     // initial state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     this->lookupBTB(victim_addr, target_addr, victim_pid,
                     SecurityDomain::DOM_VICTIM);
     total_access++;
@@ -232,6 +239,7 @@ std::pair<uint64_t, uint64_t> LSBP::BTBTiming(uint64_t num_loops,
                     SecurityDomain::DOM_ATTACKER);
     total_access++;
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     uint64_t timing = this->lookupBTB(victim_addr, target_addr, victim_pid,
                                       SecurityDomain::DOM_VICTIM);
     total_access++;
@@ -293,12 +301,13 @@ std::pair<uint64_t, uint64_t> LSBP::BTBSpeculative(uint64_t num_loops,
 #endif
     uint64_t attacker_addr = victim_addr;
     uint64_t attacker_target = -1;
-    uint64_t attacker_pid = rand() & ((1ULL << addr_space) - 1);
+    uint64_t attacker_pid = randomAddr(addr_mask);
 #ifdef RANDOM_KEY
-    this->index_keys = {rand() & ((1ULL << addr_space) - 1),
-                        rand() & ((1ULL << addr_space) - 1)};
+    keys[SecurityDomain::DOM_ATTACKER].index_key = randomAddr(addr_mask);
+    keys[SecurityDomain::DOM_VICTIM].index_key = randomAddr(addr_mask);
 #else
-    this->index_keys = {EncryptionKey::KEY_0, EncryptionKey::KEY_1};
+    keys[SecurityDomain::DOM_ATTACKER].index_key = EncryptionKey::KEY_0;
+    keys[SecurityDomain::DOM_VICTIM].index_key = EncryptionKey::KEY_1;
 #endif
     // check if the attacker address is in the buffer or same as the victim
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_pid) !=
@@ -310,6 +319,7 @@ std::pair<uint64_t, uint64_t> LSBP::BTBSpeculative(uint64_t num_loops,
     }
     gen_set.push_back(attacker_pid);
     // initial state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     this->lookupBTB(victim_addr, target_addr, victim_pid,
                     SecurityDomain::DOM_VICTIM);
     total_access++;
@@ -318,6 +328,7 @@ std::pair<uint64_t, uint64_t> LSBP::BTBSpeculative(uint64_t num_loops,
                     SecurityDomain::DOM_ATTACKER);
     total_access++;
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     uint64_t timing = this->lookupBTB(victim_addr, target_addr, victim_pid,
                                       SecurityDomain::DOM_VICTIM);
     total_access++;
@@ -349,6 +360,7 @@ std::pair<uint64_t, uint64_t> LSBP::BTBSpeculative(uint64_t num_loops,
       std::cout << std::hex << "attacker_addr: " << attacker_addr << std::endl;
 #endif
 // find covert channel
+      COUNT_PHASE(AttackPhase::PHASE_PROBE);
 #ifdef LIMITED_BRANCH_ACCESS
       while (gen_set.size() + tar_set.size() < num_loops &&
              total_access < NUMBER_MAX_BRANCHES) {
@@ -413,7 +425,7 @@ std::pair<std::vector<uint64_t>, uint64_t> LSBP::BTBPrune(
 #else
   while (current_loop < num_loops && eviction_set.size() < eviction_size) {
 #endif
-    uint64_t attacker_addr = rand() & ((1ULL << addr_space) - 1);
+    uint64_t attacker_addr = randomAddr(addr_mask);
     // attacker addr should not be in the prune set and eviction set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -430,6 +442,7 @@ std::pair<std::vector<uint64_t>, uint64_t> LSBP::BTBPrune(
       continue;
     }
     // remove self conflict
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     int self_conflict = 1;
     while (self_conflict != 0) {
       // initial prune set state to $valid$
@@ -452,9 +465,11 @@ std::pair<std::vector<uint64_t>, uint64_t> LSBP::BTBPrune(
       self_conflict = collision;
     }
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     this->lookupBTB(victim_addr, -1, victim_pid, SecurityDomain::DOM_VICTIM);
     total_access++;
     // check the prune set $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing =
           this->lookupBTB(addr, -1, attacker_pid, SecurityDomain::DOM_ATTACKER);
@@ -506,7 +521,7 @@ std::pair<std::vector<uint64_t>, uint64_t> LSBP::PHTOccupancy(
 #else
   while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
 #endif
-    uint64_t attacker_addr = rand() & ((1ULL << addr_space) - 1);
+    uint64_t attacker_addr = randomAddr(addr_mask);
     // attacker addr should not be in the prune set and occupancy set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -524,6 +539,7 @@ std::pair<std::vector<uint64_t>, uint64_t> LSBP::PHTOccupancy(
     }
     uint64_t total_check = std::exp2(counter_bits) / 2;
     // remove self conflict in the prune set
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     auto checkTwoAddrConflict = [&](uint64_t addr1, uint64_t addr2) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr1, false, attacker_pid,
@@ -555,6 +571,7 @@ std::pair<std::vector<uint64_t>, uint64_t> LSBP::PHTOccupancy(
       self_confilct = collision;
     }
     // initial prune set state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     for (uint64_t &addr : prune_set) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr, true, attacker_pid, SecurityDomain::DOM_ATTACKER);
@@ -562,6 +579,7 @@ std::pair<std::vector<uint64_t>, uint64_t> LSBP::PHTOccupancy(
       }
     }
     // access the occupancy set
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     for (uint64_t &addr : occupancy_set) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr, false, attacker_pid,
@@ -570,6 +588,7 @@ std::pair<std::vector<uint64_t>, uint64_t> LSBP::PHTOccupancy(
       }
     }
     // check the addr $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing = this->lookupPHT(addr, true, attacker_pid,
                                         SecurityDomain::DOM_ATTACKER);
@@ -631,7 +650,7 @@ std::pair<std::vector<uint64_t>, uint64_t> LSBP::BTBOccupancy(
 #else
   while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
 #endif
-    uint64_t attacker_addr = rand() & ((1ULL << addr_space) - 1);
+    uint64_t attacker_addr = randomAddr(addr_mask);
     // attacker addr should not be in the prune set and occupancy set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -648,6 +667,7 @@ std::pair<std::vector<uint64_t>, uint64_t> LSBP::BTBOccupancy(
       continue;
     }
     // remove self conflict
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     int self_conflict = 1;
     while (self_conflict != 0) {
       // initial prune set state to $valid$
@@ -670,11 +690,13 @@ std::pair<std::vector<uint64_t>, uint64_t> LSBP::BTBOccupancy(
       self_conflict = collision;
     }
     // check conflict with the occupancy set
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     for (uint64_t &addr : occupancy_set) {
       this->lookupBTB(addr, -1, attacker_pid, SecurityDomain::DOM_ATTACKER);
       total_access++;
     }
     // check the prune set $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing =
           this->lookupBTB(addr, -1, attacker_pid, SecurityDomain::DOM_ATTACKER);
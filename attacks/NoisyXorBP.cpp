@@ -32,6 +32,7 @@
 #include <iostream>
 #include <vector>
 
+#include "include/utils/Counters.hpp"
 #include "include/utils/Utils.hpp"
 
 // reuse-based attack
@@ -49,11 +50,9 @@ std::pair<uint64_t, uint64_t> NoisyXorBP::PHTTiming(uint64_t num_loops,
   while (gen_set.size() < num_loops) {
 #endif
     uint64_t attacker_set = rand() % counter_nums;
-    uint64_t attacker_tag =
-        victim_addr >> offset_pht >> (int)std::log2(counter_nums);
+    uint64_t attacker_tag = victim_addr >> offset_pht >> pht_set_bits;
     uint64_t attacker_addr = attacker_set << offset_pht |
-                             attacker_tag << offset_pht
-                                          << (int)std::log2(counter_nums);
+                             attacker_tag << offset_pht << pht_set_bits;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
     //   continue;
@@ -62,6 +61,7 @@ std::pair<uint64_t, uint64_t> NoisyXorBP::PHTTiming(uint64_t num_loops,
     uint64_t total_check = std::exp2(counter_bits) / 2;
     for (uint64_t i = 0; i < total_check; i++) {
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -76,11 +76,13 @@ std::pair<uint64_t, uint64_t> NoisyXorBP::PHTTiming(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_1 =
           this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
       total_access++;
 
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -95,6 +97,7 @@ std::pair<uint64_t, uint64_t> NoisyXorBP::PHTTiming(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_2 =
           this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
       total_access++;
@@ -145,11 +148,9 @@ std::pair<uint64_t, uint64_t> NoisyXorBP::PHTSpeculative(uint64_t num_loops,
   while (gen_set.size() < num_loops) {
 #endif
     uint64_t attacker_set = rand() % counter_nums;
-    uint64_t attacker_tag =
-        victim_addr >> offset_pht >> (int)std::log2(counter_nums);
+    uint64_t attacker_tag = victim_addr >> offset_pht >> pht_set_bits;
     uint64_t attacker_addr = attacker_set << offset_pht |
-                             attacker_tag << offset_pht
-                                          << (int)std::log2(counter_nums);
+                             attacker_tag << offset_pht << pht_set_bits;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
     //   continue;
@@ -158,6 +159,7 @@ std::pair<uint64_t, uint64_t> NoisyXorBP::PHTSpeculative(uint64_t num_loops,
     uint64_t total_check = std::exp2(counter_bits) / 2;
     for (uint64_t i = 0; i < total_check; i++) {
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -172,11 +174,13 @@ std::pair<uint64_t, uint64_t> NoisyXorBP::PHTSpeculative(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_1 =
           this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
       total_access++;
 
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -191,6 +195,7 @@ std::pair<uint64_t, uint64_t> NoisyXorBP::PHTSpeculative(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_2 =
           this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
       total_access++;
@@ -241,7 +246,7 @@ std::pair<uint64_t, uint64_t> NoisyXorBP::BTBTiming(uint64_t num_loops,
   while (gen_set.size() < num_loops) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_btb) << offset_btb;
+        (randomAddr(addr_mask) >> offset_btb) << offset_btb;
     uint64_t attacker_target = -1;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
@@ -249,6 +254,7 @@ std::pair<uint64_t, uint64_t> NoisyXorBP::BTBTiming(uint64_t num_loops,
     // }
     gen_set.push_back(attacker_addr);
     // initial state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
     // train the BTB to $mispredict$
@@ -256,6 +262,7 @@ std::pair<uint64_t, uint64_t> NoisyXorBP::BTBTiming(uint64_t num_loops,
                     SecurityDomain::DOM_ATTACKER);
     total_access++;
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     uint64_t timing =
         this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
@@ -309,7 +316,7 @@ std::pair<uint64_t, uint64_t> NoisyXorBP::BTBSpeculative(
   while (gen_set.size() + tar_set.size() < num_loops) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_btb) << offset_btb;
+        (randomAddr(addr_mask) >> offset_btb) << offset_btb;
     uint64_t attacker_target = -1;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
@@ -317,6 +324,7 @@ std::pair<uint64_t, uint64_t> NoisyXorBP::BTBSpeculative(
     // }
     gen_set.push_back(attacker_addr);
     // initial state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
     // train the BTB to $mispredict$
@@ -324,6 +332,7 @@ std::pair<uint64_t, uint64_t> NoisyXorBP::BTBSpeculative(
                     SecurityDomain::DOM_ATTACKER);
     total_access++;
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     uint64_t timing =
         this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
@@ -353,13 +362,14 @@ std::pair<uint64_t, uint64_t> NoisyXorBP::BTBSpeculative(
       std::cout << std::hex << "attacker_addr: " << attacker_addr << std::endl;
 #endif
 // find covert channel
+      COUNT_PHASE(AttackPhase::PHASE_PROBE);
 #ifdef LIMITED_BRANCH_ACCESS
       while (gen_set.size() + tar_set.size() < num_loops &&
              total_access < NUMBER_MAX_BRANCHES) {
 #else
       while (gen_set.size() + tar_set.size() < num_loops) {
 #endif
-        uint64_t attacker_target = rand() & ((1ULL << addr_space) - 1);
+        uint64_t attacker_target = randomAddr(addr_mask);
         // if (std::find(tar_set.begin(), tar_set.end(), attacker_target) !=
         //     tar_set.end()) {
         //   continue;
@@ -415,7 +425,7 @@ std::pair<std::vector<uint64_t>, uint64_t> NoisyXorBP::BTBPrune(
   while (current_loop < num_loops && eviction_set.size() < eviction_size) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_btb) << offset_btb;
+        (randomAddr(addr_mask) >> offset_btb) << offset_btb;
     // attacker addr should not be in the prune set and eviction set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -432,6 +442,7 @@ std::pair<std::vector<uint64_t>, uint64_t> NoisyXorBP::BTBPrune(
       continue;
     }
     // remove self conflict
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     int self_conflict = 1;
     while (self_conflict != 0) {
       // initial prune set state to $valid$
@@ -454,9 +465,11 @@ std::pair<std::vector<uint64_t>, uint64_t> NoisyXorBP::BTBPrune(
       self_conflict = collision;
     }
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     this->lookupBTB(victim_addr, -1, SecurityDomain::DOM_VICTIM);
     total_access++;
     // check the prune set $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing = this->lookupBTB(addr, -1, SecurityDomain::DOM_ATTACKER);
       total_access++;
@@ -506,7 +519,7 @@ std::pair<std::vector<uint64_t>, uint64_t> NoisyXorBP::PHTOccupancy(
   while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_pht) << offset_pht;
+        (randomAddr(addr_mask) >> offset_pht) << offset_pht;
     // attacker addr should not be in the prune set and occupancy set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -524,6 +537,7 @@ std::pair<std::vector<uint64_t>, uint64_t> NoisyXorBP::PHTOccupancy(
     }
     uint64_t total_check = std::exp2(counter_bits) / 2;
     // remove self conflict in the prune set
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     auto checkTwoAddrConflict = [&](uint64_t addr1, uint64_t addr2) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr1, false, SecurityDomain::DOM_ATTACKER);
@@ -553,6 +567,7 @@ std::pair<std::vector<uint64_t>, uint64_t> NoisyXorBP::PHTOccupancy(
       self_confilct = collision;
     }
     // initial prune set state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     for (uint64_t &addr : prune_set) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr, true, SecurityDomain::DOM_ATTACKER);
@@ -560,6 +575,7 @@ std::pair<std::vector<uint64_t>, uint64_t> NoisyXorBP::PHTOccupancy(
       }
     }
     // access the occupancy set
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     for (uint64_t &addr : occupancy_set) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr, false, SecurityDomain::DOM_ATTACKER);
@@ -567,6 +583,7 @@ std::pair<std::vector<uint64_t>, uint64_t> NoisyXorBP::PHTOccupancy(
       }
     }
     // check the addr $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing =
           this->lookupPHT(addr, true, SecurityDomain::DOM_ATTACKER);
@@ -627,7 +644,7 @@ std::pair<std::vector<uint64_t>, uint64_t> NoisyXorBP::BTBOccupancy(
   while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_btb) << offset_btb;
+        (randomAddr(addr_mask) >> offset_btb) << offset_btb;
     // attacker addr should not be in the prune set and occupancy set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -644,6 +661,7 @@ std::pair<std::vector<uint64_t>, uint64_t> NoisyXorBP::BTBOccupancy(
       continue;
     }
     // remove self conflict
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     int self_conflict = 1;
     while (self_conflict != 0) {
       // initial prune set state to $valid$
@@ -666,11 +684,13 @@ std::pair<std::vector<uint64_t>, uint64_t> NoisyXorBP::BTBOccupancy(
       self_conflict = collision;
     }
     // check conflict with the occupancy set
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     for (uint64_t &addr : occupancy_set) {
       this->lookupBTB(addr, -1, SecurityDomain::DOM_ATTACKER);
       total_access++;
     }
     // check the prune set $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing = this->lookupBTB(addr, -1, SecurityDomain::DOM_ATTACKER);
       total_access++;
@@ -32,6 +32,7 @@
 #include <iostream>
 #include <vector>
 
+#include "include/utils/Counters.hpp"
 #include "include/utils/Utils.hpp"
 
 // reuse-based attack
@@ -48,7 +49,7 @@ std::pair<uint64_t, uint64_t> STBPU::PHTTiming(uint64_t num_loops,
 #else
   while (gen_set.size() < num_loops) {
 #endif
-    uint64_t attacker_addr = rand() & ((1ULL << addr_space) - 1);
+    uint64_t attacker_addr = randomAddr(addr_mask);
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
     //   continue;
@@ -57,6 +58,7 @@ std::pair<uint64_t, uint64_t> STBPU::PHTTiming(uint64_t num_loops,
     uint64_t total_check = std::exp2(counter_bits) / 2;
     for (uint64_t i = 0; i < total_check; i++) {
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -71,11 +73,13 @@ std::pair<uint64_t, uint64_t> STBPU::PHTTiming(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_1 =
           this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
       total_access++;
 
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -90,6 +94,7 @@ std::pair<uint64_t, uint64_t> STBPU::PHTTiming(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_2 =
           this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
       total_access++;
@@ -139,7 +144,7 @@ std::pair<uint64_t, uint64_t> STBPU::PHTSpeculative(uint64_t num_loops,
 #else
   while (gen_set.size() < num_loops) {
 #endif
-    uint64_t attacker_addr = rand() & ((1ULL << addr_space) - 1);
+    uint64_t attacker_addr = randomAddr(addr_mask);
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
     //   continue;
@@ -148,6 +153,7 @@ std::pair<uint64_t, uint64_t> STBPU::PHTSpeculative(uint64_t num_loops,
     uint64_t total_check = std::exp2(counter_bits) / 2;
     for (uint64_t i = 0; i < total_check; i++) {
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -162,11 +168,13 @@ std::pair<uint64_t, uint64_t> STBPU::PHTSpeculative(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_1 =
           this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
       total_access++;
 
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -181,6 +189,7 @@ std::pair<uint64_t, uint64_t> STBPU::PHTSpeculative(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_2 =
           this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
       total_access++;
@@ -230,7 +239,7 @@ std::pair<uint64_t, uint64_t> STBPU::BTBTiming(uint64_t num_loops,
 #else
   while (gen_set.size() < num_loops) {
 #endif
-    uint64_t attacker_addr = rand() & ((1ULL << addr_space) - 1);
+    uint64_t attacker_addr = randomAddr(addr_mask);
     uint64_t attacker_target = -1;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
@@ -238,6 +247,7 @@ std::pair<uint64_t, uint64_t> STBPU::BTBTiming(uint64_t num_loops,
     // }
     gen_set.push_back(attacker_addr);
     // initial state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
     // train the BTB to $mispredict$
@@ -245,6 +255,7 @@ std::pair<uint64_t, uint64_t> STBPU::BTBTiming(uint64_t num_loops,
                     SecurityDomain::DOM_ATTACKER);
     total_access++;
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     uint64_t timing =
         this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
@@ -298,7 +309,7 @@ std::pair<uint64_t, uint64_t> STBPU::BTBSpeculative(uint64_t num_loops,
 #else
   while (gen_set.size() + tar_set.size() < num_loops) {
 #endif
-    uint64_t attacker_addr = rand() & ((1ULL << addr_space) - 1);
+    uint64_t attacker_addr = randomAddr(addr_mask);
     uint64_t attacker_target = -1;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
@@ -306,6 +317,7 @@ std::pair<uint64_t, uint64_t> STBPU::BTBSpeculative(uint64_t num_loops,
     // }
     gen_set.push_back(attacker_addr);
     // initial state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
     // train the BTB to $mispredict$
@@ -313,6 +325,7 @@ std::pair<uint64_t, uint64_t> STBPU::BTBSpeculative(uint64_t num_loops,
                     SecurityDomain::DOM_ATTACKER);
     total_access++;
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     uint64_t timing =
         this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
@@ -342,13 +355,14 @@ std::pair<uint64_t, uint64_t> STBPU::BTBSpeculative(uint64_t num_loops,
       std::cout << std::hex << "attacker_addr: " << attacker_addr << std::endl;
 #endif
 // find covert channel
+      COUNT_PHASE(AttackPhase::PHASE_PROBE);
 #ifdef LIMITED_BRANCH_ACCESS
       while (gen_set.size() + tar_set.size() < num_loops &&
              total_access < NUMBER_MAX_BRANCHES) {
 #else
       while (gen_set.size() + tar_set.size() < num_loops) {
 #endif
-        uint64_t attacker_target = rand() & ((1ULL << addr_space) - 1);
+        uint64_t attacker_target = randomAddr(addr_mask);
         // if (std::find(tar_set.begin(), tar_set.end(), attacker_target) !=
         //     tar_set.end()) {
         //   continue;
@@ -403,7 +417,7 @@ std::pair<std::vector<uint64_t>, uint64_t> STBPU::BTBPrune(
 #else
   while (current_loop < num_loops && eviction_set.size() < eviction_size) {
 #endif
-    uint64_t attacker_addr = rand() & ((1ULL << addr_space) - 1);
+    uint64_t attacker_addr = randomAddr(addr_mask);
     // attacker addr should not be in the prune set and eviction set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -420,6 +434,7 @@ std::pair<std::vector<uint64_t>, uint64_t> STBPU::BTBPrune(
       continue;
     }
     // remove self conflict
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     int self_conflict = 1;
     while (self_conflict != 0) {
       // initial prune set state to $valid$
@@ -442,9 +457,11 @@ std::pair<std::vector<uint64_t>, uint64_t> STBPU::BTBPrune(
       self_conflict = collision;
     }
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     this->lookupBTB(victim_addr, -1, SecurityDomain::DOM_VICTIM);
     total_access++;
     // check the prune set $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing = this->lookupBTB(addr, -1, SecurityDomain::DOM_ATTACKER);
       total_access++;
@@ -493,7 +510,7 @@ std::pair<std::vector<uint64_t>, uint64_t> STBPU::PHTOccupancy(
 #else
   while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
 #endif
-    uint64_t attacker_addr = rand() & ((1ULL << addr_space) - 1);
+    uint64_t attacker_addr = randomAddr(addr_mask);
     // attacker addr should not be in the prune set and occupancy set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -511,6 +528,7 @@ std::pair<std::vector<uint64_t>, uint64_t> STBPU::PHTOccupancy(
     }
     uint64_t total_check = std::exp2(counter_bits) / 2;
     // remove self conflict in the prune set
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     auto checkTwoAddrConflict = [&](uint64_t addr1, uint64_t addr2) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr1, false, SecurityDomain::DOM_ATTACKER);
@@ -540,6 +558,7 @@ std::pair<std::vector<uint64_t>, uint64_t> STBPU::PHTOccupancy(
       self_confilct = collision;
     }
     // initial prune set state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     for (uint64_t &addr : prune_set) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr, true, SecurityDomain::DOM_ATTACKER);
@@ -547,6 +566,7 @@ std::pair<std::vector<uint64_t>, uint64_t> STBPU::PHTOccupancy(
       }
     }
     // access the occupancy set
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     for (uint64_t &addr : occupancy_set) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr, false, SecurityDomain::DOM_ATTACKER);
@@ -554,6 +574,7 @@ std::pair<std::vector<uint64_t>, uint64_t> STBPU::PHTOccupancy(
       }
     }
     // check the addr $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing =
           this->lookupPHT(addr, true, SecurityDomain::DOM_ATTACKER);
@@ -613,7 +634,7 @@ std::pair<std::vector<uint64_t>, uint64_t> STBPU::BTBOccupancy(
 #else
   while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
 #endif
-    uint64_t attacker_addr = rand() & ((1ULL << addr_space) - 1);
+    uint64_t attacker_addr = randomAddr(addr_mask);
     // attacker addr should not be in the prune set and occupancy set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -630,6 +651,7 @@ std::pair<std::vector<uint64_t>, uint64_t> STBPU::BTBOccupancy(
       continue;
     }
     // remove self conflict
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     int self_conflict = 1;
     while (self_conflict != 0) {
       // initial prune set state to $valid$
@@ -652,11 +674,13 @@ std::pair<std::vector<uint64_t>, uint64_t> STBPU::BTBOccupancy(
       self_conflict = collision;
     }
     // check conflict with the occupancy set
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     for (uint64_t &addr : occupancy_set) {
       this->lookupBTB(addr, -1, SecurityDomain::DOM_ATTACKER);
       total_access++;
     }
     // check the prune set $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing = this->lookupBTB(addr, -1, SecurityDomain::DOM_ATTACKER);
       total_access++;
@@ -32,6 +32,7 @@
 #include <utility>
 #include <vector>
 
+#include "include/utils/Counters.hpp"
 #include "include/utils/Utils.hpp"
 
 // reuse-based attack
@@ -50,11 +51,9 @@ std::pair<uint64_t, uint64_t> XorBP::PHTTiming(uint64_t num_loops,
 #endif
     uint64_t attacker_set =
         getPHTSet(victim_addr, SecurityDomain::DOM_ATTACKER);
-    uint64_t attacker_tag =
-        victim_addr >> offset_pht >> (int)std::log2(counter_nums);
+    uint64_t attacker_tag = victim_addr >> offset_pht >> pht_set_bits;
     uint64_t attacker_addr = attacker_set << offset_pht |
-                             attacker_tag << offset_pht
-                                          << (int)std::log2(counter_nums);
+                             attacker_tag << offset_pht << pht_set_bits;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
     //   continue;
@@ -63,6 +62,7 @@ std::pair<uint64_t, uint64_t> XorBP::PHTTiming(uint64_t num_loops,
     uint64_t total_check = std::exp2(counter_bits) / 2;
     for (uint64_t i = 0; i < total_check; i++) {
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -77,11 +77,13 @@ std::pair<uint64_t, uint64_t> XorBP::PHTTiming(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_1 =
           this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
       total_access++;
 
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -96,6 +98,7 @@ std::pair<uint64_t, uint64_t> XorBP::PHTTiming(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_2 =
           this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
       total_access++;
@@ -147,11 +150,9 @@ std::pair<uint64_t, uint64_t> XorBP::PHTSpeculative(uint64_t num_loops,
 #endif
     uint64_t attacker_set =
         getPHTSet(victim_addr, SecurityDomain::DOM_ATTACKER);
-    uint64_t attacker_tag =
-        victim_addr >> offset_pht >> (int)std::log2(counter_nums);
+    uint64_t attacker_tag = victim_addr >> offset_pht >> pht_set_bits;
     uint64_t attacker_addr = attacker_set << offset_pht |
-                             attacker_tag << offset_pht
-                                          << (int)std::log2(counter_nums);
+                             attacker_tag << offset_pht << pht_set_bits;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
     //   continue;
@@ -160,6 +161,7 @@ std::pair<uint64_t, uint64_t> XorBP::PHTSpeculative(uint64_t num_loops,
     uint64_t total_check = std::exp2(counter_bits) / 2;
     for (uint64_t i = 0; i < total_check; i++) {
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -174,11 +176,13 @@ std::pair<uint64_t, uint64_t> XorBP::PHTSpeculative(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_1 =
           this->lookupPHT(victim_addr, true, SecurityDomain::DOM_VICTIM);
       total_access++;
 
       // initial state to $valid$
+      COUNT_PHASE(AttackPhase::PHASE_INIT);
       for (uint64_t j = 0; j < total_check; j++) {
         this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
         total_access++;
@@ -193,6 +197,7 @@ std::pair<uint64_t, uint64_t> XorBP::PHTSpeculative(uint64_t num_loops,
         total_access++;
       }
       // victim access
+      COUNT_PHASE(AttackPhase::PHASE_VICTIM);
       uint64_t timing_2 =
           this->lookupPHT(victim_addr, false, SecurityDomain::DOM_VICTIM);
       total_access++;
@@ -244,12 +249,9 @@ std::pair<uint64_t, uint64_t> XorBP::BTBTiming(uint64_t num_loops,
 #endif
     uint64_t attacker_set =
         getBTBSet(victim_addr, SecurityDomain::DOM_ATTACKER);
-    uint64_t attacker_tag =
-        rand() & (((1ULL << addr_space) - 1) >> offset_btb >>
-                  (int)std::log2(buffer_sets));
+    uint64_t attacker_tag = randomAddr(btb_tag_mask);
     uint64_t attacker_addr = attacker_set << offset_btb |
-                             attacker_tag << offset_btb
-                                          << (int)std::log2(buffer_sets);
+                             attacker_tag << offset_btb << btb_set_bits;
     uint64_t attacker_target = -1;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
@@ -257,6 +259,7 @@ std::pair<uint64_t, uint64_t> XorBP::BTBTiming(uint64_t num_loops,
     // }
     gen_set.push_back(attacker_addr);
     // initial state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
     // train the BTB to $mispredict$
@@ -264,6 +267,7 @@ std::pair<uint64_t, uint64_t> XorBP::BTBTiming(uint64_t num_loops,
                     SecurityDomain::DOM_ATTACKER);
     total_access++;
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     uint64_t timing =
         this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
@@ -319,11 +323,9 @@ std::pair<uint64_t, uint64_t> XorBP::BTBSpeculative(uint64_t num_loops,
 #endif
     uint64_t attacker_set =
         getBTBSet(victim_addr, SecurityDomain::DOM_ATTACKER);
-    uint64_t attacker_tag = (rand() & ((1ULL << addr_space) - 1)) >>
-                            offset_btb >> (int)std::log2(buffer_sets);
+    uint64_t attacker_tag = randomAddr(addr_mask) >> offset_btb >> btb_set_bits;
     uint64_t attacker_addr = attacker_set << offset_btb |
-                             attacker_tag << offset_btb
-                                          << (int)std::log2(buffer_sets);
+                             attacker_tag << offset_btb << btb_set_bits;
     uint64_t attacker_target = -1;
     // if (std::find(gen_set.begin(), gen_set.end(), attacker_addr) !=
     //     gen_set.end()) {
@@ -331,6 +333,7 @@ std::pair<uint64_t, uint64_t> XorBP::BTBSpeculative(uint64_t num_loops,
     // }
     gen_set.push_back(attacker_addr);
     // initial state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
     // train the BTB to $mispredict$
@@ -338,6 +341,7 @@ std::pair<uint64_t, uint64_t> XorBP::BTBSpeculative(uint64_t num_loops,
                     SecurityDomain::DOM_ATTACKER);
     total_access++;
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     uint64_t timing =
         this->lookupBTB(victim_addr, target_addr, SecurityDomain::DOM_VICTIM);
     total_access++;
@@ -367,13 +371,14 @@ std::pair<uint64_t, uint64_t> XorBP::BTBSpeculative(uint64_t num_loops,
       std::cout << std::hex << "attacker_addr: " << attacker_addr << std::endl;
 #endif
 // find covert channel
+      COUNT_PHASE(AttackPhase::PHASE_PROBE);
 #ifdef LIMITED_BRANCH_ACCESS
       while (gen_set.size() + tar_set.size() < num_loops &&
              total_access < NUMBER_MAX_BRANCHES) {
 #else
       while (gen_set.size() + tar_set.size() < num_loops) {
 #endif
-        uint64_t attacker_target = rand() & ((1ULL << addr_space) - 1);
+        uint64_t attacker_target = randomAddr(addr_mask);
         // if (std::find(tar_set.begin(), tar_set.end(), attacker_target) !=
         //     tar_set.end()) {
         //   continue;
@@ -430,11 +435,9 @@ std::pair<std::vector<uint64_t>, uint64_t> XorBP::BTBPrune(
 #endif
     uint64_t attacker_set =
         getBTBSet(victim_addr, SecurityDomain::DOM_ATTACKER);
-    uint64_t attacker_tag = (rand() & ((1ULL << addr_space) - 1)) >>
-                            offset_btb >> (int)std::log2(buffer_sets);
+    uint64_t attacker_tag = randomAddr(addr_mask) >> offset_btb >> btb_set_bits;
     uint64_t attacker_addr = attacker_set << offset_btb |
-                             attacker_tag << offset_btb
-                                          << (int)std::log2(buffer_sets);
+                             attacker_tag << offset_btb << btb_set_bits;
     // attacker addr should not be in the prune set and eviction set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -451,6 +454,7 @@ std::pair<std::vector<uint64_t>, uint64_t> XorBP::BTBPrune(
       continue;
     }
     // remove self conflict
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     int self_conflict = 1;
     while (self_conflict != 0) {
       // initial prune set state to $valid$
@@ -473,9 +477,11 @@ std::pair<std::vector<uint64_t>, uint64_t> XorBP::BTBPrune(
       self_conflict = collision;
     }
     // victim access
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     this->lookupBTB(victim_addr, -1, SecurityDomain::DOM_VICTIM);
     total_access++;
     // check the prune set $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing = this->lookupBTB(addr, -1, SecurityDomain::DOM_ATTACKER);
       total_access++;
@@ -525,7 +531,7 @@ std::pair<std::vector<uint64_t>, uint64_t> XorBP::PHTOccupancy(
   while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_pht) << offset_pht;
+        (randomAddr(addr_mask) >> offset_pht) << offset_pht;
     // attacker addr should not be in the prune set and occupancy set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -543,6 +549,7 @@ std::pair<std::vector<uint64_t>, uint64_t> XorBP::PHTOccupancy(
     }
     uint64_t total_check = std::exp2(counter_bits) / 2;
     // remove self conflict in the prune set
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     auto checkTwoAddrConflict = [&](uint64_t addr1, uint64_t addr2) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr1, false, SecurityDomain::DOM_ATTACKER);
@@ -572,6 +579,7 @@ std::pair<std::vector<uint64_t>, uint64_t> XorBP::PHTOccupancy(
       self_confilct = collision;
     }
     // initial prune set state to $valid$
+    COUNT_PHASE(AttackPhase::PHASE_INIT);
     for (uint64_t &addr : prune_set) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr, true, SecurityDomain::DOM_ATTACKER);
@@ -579,6 +587,7 @@ std::pair<std::vector<uint64_t>, uint64_t> XorBP::PHTOccupancy(
       }
     }
     // access the occupancy set
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     for (uint64_t &addr : occupancy_set) {
       for (uint64_t i = 0; i < total_check; i++) {
         this->lookupPHT(addr, false, SecurityDomain::DOM_ATTACKER);
@@ -586,6 +595,7 @@ std::pair<std::vector<uint64_t>, uint64_t> XorBP::PHTOccupancy(
       }
     }
     // check the addr $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing =
           this->lookupPHT(addr, true, SecurityDomain::DOM_ATTACKER);
@@ -646,7 +656,7 @@ std::pair<std::vector<uint64_t>, uint64_t> XorBP::BTBOccupancy(
   while (current_loop < num_loops && occupancy_set.size() < occupancy_size) {
 #endif
     uint64_t attacker_addr =
-        ((rand() & ((1ULL << addr_space) - 1)) >> offset_btb) << offset_btb;
+        (randomAddr(addr_mask) >> offset_btb) << offset_btb;
     // attacker addr should not be in the prune set and occupancy set
     // if (std::find(prune_set.begin(), prune_set.end(), attacker_addr) !=
     //     prune_set.end()) {
@@ -663,6 +673,7 @@ std::pair<std::vector<uint64_t>, uint64_t> XorBP::BTBOccupancy(
       continue;
     }
     // remove self conflict
+    COUNT_PHASE(AttackPhase::PHASE_REMOVE);
     int self_conflict = 1;
     while (self_conflict != 0) {
       // initial prune set state to $valid$
@@ -685,11 +696,13 @@ std::pair<std::vector<uint64_t>, uint64_t> XorBP::BTBOccupancy(
       self_conflict = collision;
     }
     // check conflict with the occupancy set
+    COUNT_PHASE(AttackPhase::PHASE_VICTIM);
     for (uint64_t &addr : occupancy_set) {
       this->lookupBTB(addr, -1, SecurityDomain::DOM_ATTACKER);
       total_access++;
     }
     // check the prune set $hit$ or $miss$
+    COUNT_PHASE(AttackPhase::PHASE_PROBE);
     for (uint64_t &addr : prune_set) {
       uint64_t timing = this->lookupBTB(addr, -1, SecurityDomain::DOM_ATTACKER);
       total_access++;
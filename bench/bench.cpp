@@ -0,0 +1,535 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Microbenchmarks of the hot paths of the simulator: the PHT and BTB lookups
+// of every predictor (hit, mispredict and replacement paths), the PHT lookups
+// of every direction model, the PHT index derivation, the QARMA-64 cipher and
+// the attack kernels. All inputs are drawn from a fixed seed, so two builds
+// run exactly the same operations.
+//
+// Every benchmark prints one line of space-separated key=value pairs:
+//   bench=<name> predictor=<name|-> ops=<n> ns=<n> ns_per_op=<x>
+//   ops_per_sec=<x>
+// where an op is a lookup (a branch access for the attack kernels), an index
+// derivation or a cipher call.
+// =============================================================================
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "include/predictors/BPUSet.hpp"
+#include "include/utils/Cipher.hpp"
+#include "include/utils/Llbc.hpp"
+#include "include/utils/Qarma64.hpp"
+#include "include/utils/Spec.hpp"
+#include "include/utils/Sweep.hpp"
+#include "include/utils/Utils.hpp"
+
+uint64_t NUMBER_MAX_BRANCHES = 1e6;
+uint64_t RANDOM_SEED = 1;
+uint64_t SHARD_INDEX = 0;
+uint64_t SHARD_COUNT = 1;
+bool COMMON_RANDOM = false;
+bool BASELINE = false;
+
+// number of distinct branches of the hit and mispredict paths
+#define BENCH_HOT_BRANCHES 64
+
+// number of distinct branches of the replacement path (16x of the BTB)
+#define BENCH_COLD_BRANCHES 65536
+
+// results of the benchmarks, kept alive against dead code elimination
+volatile uint64_t bench_sink = 0;
+
+// benchmarks whose "<bench>/<predictor>" contains the filter
+std::string bench_filter = "";
+
+void usage() {
+  std::cout << "Usage: ./branch-gauge-bench [options]" << std::endl
+            << "Options:" << std::endl
+            << "  --ops <n>       operations of each lookup and cipher "
+               "benchmark (default: 1000000)"
+            << std::endl
+            << "  --budget <n>    branch accesses of each attack kernel "
+               "(default: 1000000)"
+            << std::endl
+            << "  --seed <seed>   seed of keys and inputs (default: 1)"
+            << std::endl
+            << "  --filter <s>    run the benchmarks whose <bench>/<predictor> "
+               "contains s"
+            << std::endl;
+}
+
+// time a benchmark body returning its number of operations
+template <typename Body>
+void bench(const std::string &name, const std::string &predictor, Body body) {
+  if ((name + "/" + predictor).find(bench_filter) == std::string::npos) {
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  uint64_t ops = body();
+  auto end = std::chrono::steady_clock::now();
+  uint64_t ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  double ns_per_op = ops ? (double)ns / ops : 0;
+  double ops_per_sec = ns ? ops * 1e9 / ns : 0;
+  std::cout << "bench=" << name << " predictor=" << predictor
+            << " ops=" << ops << " ns=" << ns << std::fixed
+            << std::setprecision(2) << " ns_per_op=" << ns_per_op
+            << std::setprecision(0) << " ops_per_sec=" << ops_per_sec
+            << std::endl;
+}
+
+// lookup paths and index derivation of a predictor
+void benchLookups(BPUSet *bpus, uint64_t type, uint64_t counter_bits,
+                  const std::vector<uint64_t> &addrs, uint64_t ops) {
+  std::string predictor = BPU_NAMES[type];
+  uint64_t attacker = SecurityDomain::DOM_ATTACKER;
+  uint64_t victim = SecurityDomain::DOM_VICTIM;
+
+  // PHT hit: always-taken branches on trained counters
+  bpus->reset(type);
+  for (uint64_t i = 0; i < 2 * BENCH_HOT_BRANCHES; i++) {
+    bpus->lookupPHT(type, addrs[i % BENCH_HOT_BRANCHES], true, attacker);
+  }
+  bench("lookupPHT/hit", predictor, [&]() {
+    uint64_t hits = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+      hits += bpus->lookupPHT(type, addrs[i % BENCH_HOT_BRANCHES], true,
+                              attacker);
+    }
+    bench_sink = bench_sink + hits;
+    return ops;
+  });
+
+  // PHT mispredict: a branch alternating around the weakly not-taken counter
+  bpus->reset(type);
+  bpus->lookupPHT(type, addrs[0], false, attacker);
+  for (uint64_t i = 1; i < (1ULL << (counter_bits - 1)); i++) {
+    bpus->lookupPHT(type, addrs[0], true, attacker);
+  }
+  bench("lookupPHT/miss", predictor, [&]() {
+    uint64_t hits = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+      hits += bpus->lookupPHT(type, addrs[0], i % 2 == 0, attacker);
+    }
+    bench_sink = bench_sink + hits;
+    return ops;
+  });
+
+  // BTB hit: branches with fixed targets
+  bpus->reset(type);
+  for (uint64_t i = 0; i < BENCH_HOT_BRANCHES; i++) {
+    bpus->lookupBTB(type, addrs[i], addrs[i + 1], attacker);
+  }
+  bench("lookupBTB/hit", predictor, [&]() {
+    int64_t hits = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+      uint64_t branch = i % BENCH_HOT_BRANCHES;
+      hits += bpus->lookupBTB(type, addrs[branch], addrs[branch + 1], attacker);
+    }
+    bench_sink = bench_sink + hits;
+    return ops;
+  });
+
+  // BTB mispredict: a branch alternating between two targets
+  bpus->reset(type);
+  bpus->lookupBTB(type, addrs[0], addrs[1], attacker);
+  bench("lookupBTB/miss", predictor, [&]() {
+    int64_t hits = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+      hits += bpus->lookupBTB(type, addrs[0], addrs[i % 2], attacker);
+    }
+    bench_sink = bench_sink + hits;
+    return ops;
+  });
+
+  // BTB replacement: more distinct branches than entries, every lookup evicts
+  bpus->reset(type);
+  for (uint64_t i = 0; i < BENCH_COLD_BRANCHES; i++) {
+    bpus->lookupBTB(type, addrs[i], addrs[i], attacker);
+  }
+  bench("lookupBTB/replace", predictor, [&]() {
+    int64_t hits = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+      uint64_t branch = i % BENCH_COLD_BRANCHES;
+      hits += bpus->lookupBTB(type, addrs[branch], addrs[branch], attacker);
+    }
+    bench_sink = bench_sink + hits;
+    return ops;
+  });
+
+  // index derivation: two PHT sets per collision check
+  bench("index/pht", predictor, [&]() {
+    uint64_t collisions = 0;
+    uint64_t sets = 0;
+    for (; sets < ops; sets += 2) {
+      uint64_t branch = sets % BENCH_COLD_BRANCHES;
+      collisions += bpus->checkPHTSetCollision(type, addrs[branch], attacker,
+                                               addrs[branch + 1], victim);
+    }
+    bench_sink = bench_sink + collisions;
+    return sets;
+  });
+
+  // index derivation of a batch of PHT sets (vectorized for STBPU)
+  std::vector<uint64_t> batch(addrs.begin(),
+                              addrs.begin() + BENCH_COLD_BRANCHES);
+  std::vector<uint64_t> batch_sets;
+  bench("index/pht-batch", predictor, [&]() {
+    uint64_t sets = 0;
+    uint64_t sum = 0;
+    for (; sets < ops; sets += batch.size()) {
+      bpus->getPHTSets(type, batch, attacker, batch_sets);
+      sum += batch_sets[sets % batch.size()];
+    }
+    bench_sink = bench_sink + sum;
+    return sets;
+  });
+}
+
+// PHT lookups of every direction model on loops of different trip counts
+void benchModels(const ExperimentSpec &spec, const std::vector<uint64_t> &addrs,
+                 uint64_t ops) {
+  for (uint64_t model = 0; model < PHTModel::NUM_PHT_MODELS; model++) {
+    PHTConfig pht;
+    pht.model = model;
+    BPUSet *bpus = new BPUSet(BPUSet::allTypes(), spec.counter_bits,
+                              spec.counter_nums, spec.buffer_ways,
+                              spec.buffer_sets, spec.addr_space, spec.policy,
+                              pht);
+    for (uint64_t index = 0; index < bpus->size(); index++) {
+      uint64_t type = bpus->getType(index);
+      bpus->reset(type);
+      bench("lookupPHT/" + std::string(PHT_MODEL_NAMES[model]),
+            BPU_NAMES[type], [&]() {
+              uint64_t hits = 0;
+              for (uint64_t i = 0; i < ops; i++) {
+                uint64_t branch = i % BENCH_HOT_BRANCHES;
+                uint64_t trips = branch % 4 + 2;
+                bool taken = (i / BENCH_HOT_BRANCHES) % trips != 0;
+                hits += bpus->lookupPHT(type, addrs[branch], taken,
+                                        SecurityDomain::DOM_ATTACKER);
+              }
+              bench_sink = bench_sink + hits;
+              return ops;
+            });
+    }
+    delete bpus;
+  }
+}
+
+// PHT and BTB lookups of the keyed predictors under rekey policies, the
+// domain switches every 64 lookups
+void benchRekey(const ExperimentSpec &spec, const std::vector<uint64_t> &addrs,
+                uint64_t ops) {
+  std::vector<RekeyConfig> configs(3);
+  configs[1].accesses = 100;
+  configs[2].mispredicts = 16;
+  configs[2].domain_switch = true;
+  std::vector<uint64_t> types = {BPUType::BPU_NoisyXorBP, BPUType::BPU_STBPU,
+                                 BPUType::BPU_HyBP};
+  for (const RekeyConfig &rekey : configs) {
+    BPUSet *bpus = new BPUSet(types, spec.counter_bits, spec.counter_nums,
+                              spec.buffer_ways, spec.buffer_sets,
+                              spec.addr_space, spec.policy, PHTConfig(), rekey);
+    for (uint64_t type : types) {
+      bpus->reset(type);
+      bench("lookup/rekey/" + rekeyName(rekey), BPU_NAMES[type], [&]() {
+        uint64_t hits = 0;
+        for (uint64_t i = 0; i < ops; i++) {
+          uint64_t branch = i % BENCH_HOT_BRANCHES;
+          uint64_t domain = (i >> 6) & 1;
+          hits += bpus->lookupPHT(type, addrs[branch], i & 1, domain);
+          hits += bpus->lookupBTB(type, addrs[branch], addrs[branch] + 64,
+                                  domain) == 1;
+        }
+        bench_sink = bench_sink + hits;
+        return 2 * ops;
+      });
+    }
+    delete bpus;
+  }
+}
+
+// BTB lookups of a single-level BTB and of 3-level hierarchies (L0 and L1 in
+// front of the BTB) of every inclusion: hot branches served by the L0, and
+// more distinct branches than entries, every lookup evicts
+void benchLevels(const ExperimentSpec &spec, const std::vector<uint64_t> &addrs,
+                 uint64_t ops) {
+  std::vector<BTBConfig> configs(1 + BTBInclusion::NUM_BTB_INCLUSIONS);
+  for (uint64_t i = 1; i < configs.size(); i++) {
+    configs[i].levels.resize(2);
+    configs[i].levels[0].sets = 16;
+    configs[i].levels[1].sets = 256;
+    configs[i].levels[1].keyed = true;
+    configs[i].inclusion = i - 1;
+  }
+  uint64_t attacker = SecurityDomain::DOM_ATTACKER;
+  for (const BTBConfig &btb : configs) {
+    BPUSet *bpus = new BPUSet(BPUSet::allTypes(), spec.counter_bits,
+                              spec.counter_nums, spec.buffer_ways,
+                              spec.buffer_sets, spec.addr_space, spec.policy,
+                              PHTConfig(), RekeyConfig(), CipherConfig(), btb);
+    for (uint64_t index = 0; index < bpus->size(); index++) {
+      uint64_t type = bpus->getType(index);
+      bpus->reset(type);
+      for (uint64_t i = 0; i < BENCH_HOT_BRANCHES; i++) {
+        bpus->lookupBTB(type, addrs[i], addrs[i + 1], attacker);
+      }
+      bench("lookupBTB/levels/" + btbName(btb) + "/hit", BPU_NAMES[type],
+            [&]() {
+              int64_t hits = 0;
+              for (uint64_t i = 0; i < ops; i++) {
+                uint64_t branch = i % BENCH_HOT_BRANCHES;
+                hits += bpus->lookupBTB(type, addrs[branch],
+                                        addrs[branch + 1], attacker);
+              }
+              bench_sink = bench_sink + hits;
+              return ops;
+            });
+      bpus->reset(type);
+      for (uint64_t i = 0; i < BENCH_COLD_BRANCHES; i++) {
+        bpus->lookupBTB(type, addrs[i], addrs[i], attacker);
+      }
+      bench("lookupBTB/levels/" + btbName(btb) + "/replace", BPU_NAMES[type],
+            [&]() {
+              int64_t hits = 0;
+              for (uint64_t i = 0; i < ops; i++) {
+                uint64_t branch = i % BENCH_COLD_BRANCHES;
+                hits += bpus->lookupBTB(type, addrs[branch], addrs[branch],
+                                        attacker);
+              }
+              bench_sink = bench_sink + hits;
+              return ops;
+            });
+    }
+    delete bpus;
+  }
+}
+
+// attack kernels of a predictor, one run each from the fixed seed
+void benchAttacks(BPUSet *bpus, uint64_t type, uint64_t counter_bits,
+                  uint64_t victim_addr, uint64_t target_addr,
+                  uint64_t covert_channel) {
+  std::string predictor = BPU_NAMES[type];
+  uint64_t num_loops = 1e9;
+  // attack arguments of the collision experiments
+  ExperimentSpec prune, pht, btb;
+  defaultSpec("prune-btb-collision", 0, 1, prune);
+  defaultSpec("occupancy-pht-collision", 0, 1, pht);
+  defaultSpec("occupancy-btb-collision", 0, 1, btb);
+  // every kernel starts from the same random stream and cleared tables
+  auto kernel = [&](const std::string &name, auto attack) {
+    srand(deriveSeed(RANDOM_SEED, name));
+    bpus->reset(type);
+    bench(name, predictor, [&]() { return attack().second; });
+  };
+  kernel("attack/PHTTiming", [&]() {
+    return bpus->PHTTiming(type, num_loops, counter_bits, victim_addr);
+  });
+  kernel("attack/PHTSpeculative", [&]() {
+    return bpus->PHTSpeculative(type, num_loops, counter_bits, victim_addr);
+  });
+  kernel("attack/BTBTiming", [&]() {
+    return bpus->BTBTiming(type, num_loops, victim_addr, target_addr);
+  });
+  kernel("attack/BTBSpeculative", [&]() {
+    return bpus->BTBSpeculative(type, num_loops, victim_addr, target_addr,
+                                covert_channel);
+  });
+  kernel("attack/BTBPrune", [&]() {
+    return bpus->BTBPrune(type, num_loops, victim_addr, prune.prune_size, 4);
+  });
+  kernel("attack/PHTOccupancy", [&]() {
+    return bpus->PHTOccupancy(type, num_loops, counter_bits, pht.prune_size,
+                              pht.occupancy_size);
+  });
+  kernel("attack/BTBOccupancy", [&]() {
+    return bpus->BTBOccupancy(type, num_loops, btb.prune_size,
+                              btb.occupancy_size);
+  });
+}
+
+// QARMA-64 in the configuration of HyBP (1 round) and the full cipher
+void benchQarma(const std::vector<uint64_t> &addrs, uint64_t ops) {
+  QARMA *qarma = new QARMA();
+  uint64_t tweak = addrs[0];
+  uint64_t w0 = addrs[1];
+  uint64_t k0 = addrs[2];
+  for (int rounds : {1, 7}) {
+    std::string suffix = "/r" + std::to_string(rounds);
+    bench("qarma64_enc" + suffix, "-", [&]() {
+      uint64_t text = 0;
+      for (uint64_t i = 0; i < ops; i++) {
+        text ^= qarma->qarma64_enc(addrs[i % BENCH_COLD_BRANCHES], tweak, w0,
+                                   k0, rounds);
+      }
+      bench_sink = bench_sink + text;
+      return ops;
+    });
+    bench("qarma64_dec" + suffix, "-", [&]() {
+      uint64_t text = 0;
+      for (uint64_t i = 0; i < ops; i++) {
+        text ^= qarma->qarma64_dec(addrs[i % BENCH_COLD_BRANCHES], tweak, w0,
+                                   k0, rounds);
+      }
+      bench_sink = bench_sink + text;
+      return ops;
+    });
+  }
+  delete qarma;
+}
+
+// LLBC of BSUP on targets of the address space, one block at a time and in
+// batches
+void benchLlbc(uint64_t addr_space, const std::vector<uint64_t> &addrs,
+               uint64_t ops) {
+  LLBC llbc(addrs[0], addr_space);
+  std::string suffix = "/w" + std::to_string(addr_space);
+  bench("llbc_enc" + suffix, "-", [&]() {
+    uint64_t text = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+      text ^= llbc.encrypt(addrs[i % BENCH_COLD_BRANCHES]);
+    }
+    bench_sink = bench_sink + text;
+    return ops;
+  });
+  bench("llbc_dec" + suffix, "-", [&]() {
+    uint64_t text = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+      text ^= llbc.decrypt(addrs[i % BENCH_COLD_BRANCHES]);
+    }
+    bench_sink = bench_sink + text;
+    return ops;
+  });
+  std::vector<uint64_t> texts(BENCH_COLD_BRANCHES);
+  bench("llbc_enc_batch" + suffix, "-", [&]() {
+    uint64_t blocks = 0;
+    for (; blocks < ops; blocks += BENCH_COLD_BRANCHES) {
+      llbc.encryptBatch(addrs.data(), BENCH_COLD_BRANCHES, texts.data());
+    }
+    bench_sink = bench_sink + texts[0];
+    return blocks;
+  });
+}
+
+// index ciphers (see Cipher.hpp), one block at a time and in batches
+void benchCiphers(const std::vector<uint64_t> &addrs, uint64_t ops) {
+  CipherKey key = {addrs[0], addrs[1], addrs[2]};
+  std::vector<uint64_t> texts(BENCH_COLD_BRANCHES);
+  for (const CipherConfig &config :
+       {CipherConfig{CipherType::CIPHER_QARMA64, 1},
+        CipherConfig{CipherType::CIPHER_QARMA64, 0},
+        CipherConfig{CipherType::CIPHER_PRINCE, 0}}) {
+    BlockCipher *cipher = BlockCipher::create(config);
+    std::string suffix = "/" + cipherName(config);
+    bench("cipher_enc" + suffix, "-", [&]() {
+      uint64_t text = 0;
+      for (uint64_t i = 0; i < ops; i++) {
+        text ^= cipher->encrypt(addrs[i % BENCH_COLD_BRANCHES], key);
+      }
+      bench_sink = bench_sink + text;
+      return ops;
+    });
+    bench("cipher_dec" + suffix, "-", [&]() {
+      uint64_t text = 0;
+      for (uint64_t i = 0; i < ops; i++) {
+        text ^= cipher->decrypt(addrs[i % BENCH_COLD_BRANCHES], key);
+      }
+      bench_sink = bench_sink + text;
+      return ops;
+    });
+    bench("cipher_enc_batch" + suffix, "-", [&]() {
+      uint64_t blocks = 0;
+      for (; blocks < ops; blocks += BENCH_COLD_BRANCHES) {
+        cipher->encryptBatch(addrs.data(), BENCH_COLD_BRANCHES, key,
+                             texts.data());
+      }
+      bench_sink = bench_sink + texts[0];
+      return blocks;
+    });
+    delete cipher;
+  }
+}
+
+int main(int argc, char **argv) {
+  uint64_t ops = 1e6;
+  for (int i = 1; i < argc; i++) {
+    std::string option = argv[i];
+    if (i + 1 == argc) {
+      usage();
+      return 1;
+    } else if (option == "--ops") {
+      ops = std::stoull(argv[++i]);
+    } else if (option == "--budget") {
+      NUMBER_MAX_BRANCHES = std::stoull(argv[++i]);
+    } else if (option == "--seed") {
+      RANDOM_SEED = std::stoull(argv[++i]);
+    } else if (option == "--filter") {
+      bench_filter = argv[++i];
+    } else {
+      usage();
+      return 1;
+    }
+  }
+  // geometry of the experiments
+  ExperimentSpec spec;
+  std::cout << "# branch-gauge-bench seed=" << RANDOM_SEED << " ops=" << ops
+            << " budget=" << NUMBER_MAX_BRANCHES
+            << " counter_bits=" << spec.counter_bits
+            << " counter_nums=" << spec.counter_nums
+            << " buffer_ways=" << spec.buffer_ways
+            << " buffer_sets=" << spec.buffer_sets
+            << " addr_space=" << spec.addr_space << std::endl;
+
+  // inputs of the benchmarks
+  srand(deriveSeed(RANDOM_SEED, "bench"));
+  std::vector<uint64_t> addrs;
+  for (uint64_t i = 0; i <= BENCH_COLD_BRANCHES; i++) {
+    addrs.push_back(rand() & ((1ULL << spec.addr_space) - 1));
+  }
+  uint64_t victim_addr = addrs[0];
+  uint64_t target_addr = addrs[1];
+  uint64_t covert_channel = addrs[2];
+
+  BPUSet *bpus = new BPUSet(BPUSet::allTypes(), spec.counter_bits,
+                            spec.counter_nums, spec.buffer_ways,
+                            spec.buffer_sets, spec.addr_space, spec.policy);
+  for (uint64_t i = 0; i < bpus->size(); i++) {
+    uint64_t type = bpus->getType(i);
+    uint64_t counter_bits = bpus->getCounterBits(type, spec.counter_bits);
+    benchLookups(bpus, type, counter_bits, addrs, ops);
+    benchAttacks(bpus, type, counter_bits, victim_addr, target_addr,
+                 covert_channel);
+  }
+  delete bpus;
+  benchModels(spec, addrs, ops);
+  benchRekey(spec, addrs, ops);
+  benchLevels(spec, addrs, ops);
+  benchLlbc(spec.addr_space, addrs, ops);
+  benchQarma(addrs, ops);
+  benchCiphers(addrs, ops);
+}
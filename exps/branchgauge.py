@@ -0,0 +1,307 @@
+# Copyright 2025 iamywang
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# =============================================================================
+# BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+# Branch Predictors
+
+# author: iamywang
+# date: 2026/10/18
+# =============================================================================
+# ctypes binding of libbranchgauge (include/api/BranchGauge.h). Lookups take
+# numpy arrays and pass their buffers to the library without copies, and
+# run_spec() returns the table of a spec as a (rows, columns) matrix.
+#
+#   bg = BranchGauge('build/libbranchgauge.so')
+#   with bg.predictors(['XorBP', 'STBPU'], seed=42) as bpus:
+#       hits = bpus.lookup_pht('STBPU', pcs, taken)
+#   table = bg.run_spec(open('exps/specs/tenants-interference.ini').read())
+# =============================================================================
+import ctypes
+
+import numpy as np
+
+u64 = ctypes.c_uint64
+u64p = ctypes.POINTER(u64)
+
+BG_OK = 0
+BG_ECAPACITY = -3
+
+# most BTB levels in front of the BTB (BG_BTB_MAX_LEVELS in BranchGauge.h)
+BG_BTB_MAX_LEVELS = 3
+
+# fixed-point scale of the rare modes (RARE_SCALE in Spec.hpp)
+RARE_SCALE = 1e14
+
+
+class Config(ctypes.Structure):
+    _fields_ = [(name, u64) for name in (
+        'counter_bits', 'counter_nums', 'buffer_ways', 'buffer_sets',
+        'addr_space', 'policy', 'pht_model', 'pht_history', 'tage_tables',
+        'tage_min_history', 'tage_max_history', 'tage_tag_bits',
+        'rekey_accesses', 'rekey_mispredicts', 'rekey_domain_switch',
+        'cipher', 'cipher_rounds', 'btb_levels')] + [
+        (name, u64 * BG_BTB_MAX_LEVELS) for name in (
+            'btb_sets', 'btb_ways', 'btb_policy', 'btb_keyed')] + [
+        (name, u64) for name in ('btb_inclusion', 'domains', 'seed')]
+
+
+def _check(status):
+    if status != BG_OK:
+        raise RuntimeError('libbranchgauge: error %d' % status)
+
+
+def _buffer(array, dtype):
+    # contiguous array of dtype, copied only if the caller's is not
+    return np.ascontiguousarray(array, dtype=dtype)
+
+
+def _pointer(array, ctype):
+    return array.ctypes.data_as(ctypes.POINTER(ctype))
+
+
+def _parse_type(lib, predictor):
+    # BPUType of a predictor name, values pass through
+    if isinstance(predictor, int):
+        return predictor
+    value = u64()
+    _check(lib.bg_parse_type(predictor.encode(), ctypes.byref(value)))
+    return value.value
+
+
+def _joint_counts(values, secrets):
+    # the 2^secrets * (secrets + 1) joint counts of a mutual-information mode
+    counts = _buffer(values, np.uint64).ravel()
+    if counts.size != 2 ** secrets * (secrets + 1):
+        raise ValueError('expected %d joint counts' %
+                         (2 ** secrets * (secrets + 1)))
+    return counts
+
+
+def rare_rate(values, repeats):
+    """collision rate, standard error and 95% confidence interval from the
+    (hits, estimate, square) values of a predictor in a row of a rare mode"""
+    rate = values[1] / RARE_SCALE / repeats
+    variance = max(values[2] / RARE_SCALE / repeats - rate * rate, 0.0)
+    error = (variance / repeats) ** 0.5
+    return rate, error, (max(rate - 1.96 * error, 0.0), rate + 1.96 * error)
+
+
+class Predictors:
+    def __init__(self, lib, handle):
+        self.lib = lib
+        self.handle = handle
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def close(self):
+        if self.handle:
+            self.lib.bg_destroy(self.handle)
+            self.handle = None
+
+    def _type(self, predictor):
+        return _parse_type(self.lib, predictor)
+
+    def reset(self, predictor):
+        _check(self.lib.bg_reset(self.handle, self._type(predictor)))
+
+    def occupancy(self, predictor):
+        pht, btb = u64(), u64()
+        _check(self.lib.bg_occupancy(
+            self.handle, self._type(predictor), ctypes.byref(pht),
+            ctypes.byref(btb)))
+        return pht.value, btb.value
+
+    def btb_level(self, predictor, pcs, domains=None):
+        """first BTB level holding each branch (uint64), the number of
+        levels if none, 0 for a single-level BTB"""
+        pcs = _buffer(pcs, np.uint64)
+        domains = None if domains is None else _buffer(domains, np.uint64)
+        levels = np.zeros(len(pcs), dtype=np.uint64)
+        _check(self.lib.bg_btb_level(
+            self.handle, self._type(predictor), _pointer(pcs, u64),
+            None if domains is None else _pointer(domains, u64), len(pcs),
+            _pointer(levels, u64)))
+        return levels
+
+    def lookup_pht(self, predictor, pcs, taken, domains=None, correct=None):
+        """look up a batch of branches, fill correct (uint8) if given and
+        return the number of correct predictions"""
+        pcs = _buffer(pcs, np.uint64)
+        taken = _buffer(taken, np.uint8)
+        domains = None if domains is None else _buffer(domains, np.uint64)
+        hits = u64()
+        _check(self.lib.bg_lookup_pht(
+            self.handle, self._type(predictor), _pointer(pcs, u64),
+            _pointer(taken, ctypes.c_uint8),
+            None if domains is None else _pointer(domains, u64), len(pcs),
+            None if correct is None else _pointer(correct, ctypes.c_uint8),
+            ctypes.byref(hits)))
+        return hits.value
+
+    def lookup_btb(self, predictor, pcs, targets, domains=None,
+                   outcomes=None):
+        """look up a batch of branches, fill outcomes (int8: 1 hit, 0 wrong
+        target, -1 miss) if given and return the number of hits"""
+        pcs = _buffer(pcs, np.uint64)
+        targets = _buffer(targets, np.uint64)
+        domains = None if domains is None else _buffer(domains, np.uint64)
+        hits = u64()
+        _check(self.lib.bg_lookup_btb(
+            self.handle, self._type(predictor), _pointer(pcs, u64),
+            _pointer(targets, u64),
+            None if domains is None else _pointer(domains, u64), len(pcs),
+            None if outcomes is None else _pointer(outcomes, ctypes.c_int8),
+            ctypes.byref(hits)))
+        return hits.value
+
+    def attack(self, name, predictor, *args):
+        """reuse-based attack (pht_timing, pht_speculative, btb_timing,
+        btb_speculative), return (addr, accesses)"""
+        addr, accesses = u64(), u64()
+        function = getattr(self.lib, 'bg_' + name)
+        _check(function(self.handle, self._type(predictor), *args,
+                        ctypes.byref(addr), ctypes.byref(accesses)))
+        return addr.value, accesses.value
+
+    def attack_set(self, name, predictor, *args):
+        """prune- or occupancy-based attack (btb_prune, pht_occupancy_attack,
+        btb_occupancy_attack), return (addrs, accesses)"""
+        function = getattr(self.lib, 'bg_' + name)
+        size, accesses = u64(), u64()
+        addrs = np.zeros(0, dtype=np.uint64)
+        while True:
+            status = function(self.handle, self._type(predictor), *args,
+                              _pointer(addrs, u64), len(addrs),
+                              ctypes.byref(size), ctypes.byref(accesses))
+            if status != BG_ECAPACITY:
+                break
+            # the attack is rerun with the same random stream
+            addrs = np.zeros(size.value, dtype=np.uint64)
+        _check(status)
+        return addrs[:size.value], accesses.value
+
+
+class BranchGauge:
+    def __init__(self, path):
+        self.lib = ctypes.CDLL(path)
+        self.lib.bg_create.argtypes = [
+            ctypes.POINTER(Config), u64p, u64, ctypes.POINTER(ctypes.c_void_p)]
+        self.lib.bg_destroy.argtypes = [ctypes.c_void_p]
+        self.lib.bg_seed.argtypes = [u64]
+        self.lib.bg_set_max_branches.argtypes = [u64]
+        self.lib.bg_run_spec.argtypes = [
+            ctypes.c_char_p, u64, u64, u64, ctypes.c_char_p,
+            ctypes.POINTER(ctypes.c_void_p)]
+        self.lib.bg_table_shape.argtypes = [ctypes.c_void_p, u64p, u64p]
+        self.lib.bg_table_data.argtypes = [ctypes.c_void_p]
+        self.lib.bg_table_data.restype = u64p
+        self.lib.bg_table_free.argtypes = [ctypes.c_void_p]
+        self.lib.bg_parse_type.argtypes = [ctypes.c_char_p, u64p]
+        self.lib.bg_reset.argtypes = [ctypes.c_void_p, u64]
+        self.lib.bg_occupancy.argtypes = [ctypes.c_void_p, u64, u64p, u64p]
+        self.lib.bg_btb_level.argtypes = [
+            ctypes.c_void_p, u64, u64p, u64p, u64, u64p]
+        self.lib.bg_lookup_pht.argtypes = [
+            ctypes.c_void_p, u64, u64p, ctypes.POINTER(ctypes.c_uint8), u64p,
+            u64, ctypes.POINTER(ctypes.c_uint8), u64p]
+        self.lib.bg_lookup_btb.argtypes = [
+            ctypes.c_void_p, u64, u64p, u64p, u64p, u64,
+            ctypes.POINTER(ctypes.c_int8), u64p]
+        # set, type, the uint64_t arguments of the attack, then the outputs
+        for name, count in (('pht_timing', 3), ('pht_speculative', 3),
+                            ('btb_timing', 3), ('btb_speculative', 4)):
+            getattr(self.lib, 'bg_' + name).argtypes = [
+                ctypes.c_void_p, u64] + [u64] * count + [u64p] * 2
+        for name, count in (('btb_prune', 4), ('pht_occupancy_attack', 4),
+                            ('btb_occupancy_attack', 3)):
+            getattr(self.lib, 'bg_' + name).argtypes = [
+                ctypes.c_void_p, u64] + [u64] * count + [u64p, u64, u64p,
+                                                         u64p]
+        doublep = ctypes.POINTER(ctypes.c_double)
+        self.lib.bg_mutual_information.argtypes = [
+            u64p, u64, u64, ctypes.c_double] + [doublep] * 4
+        self.lib.bg_channel_capacity.argtypes = [u64p, u64, u64, doublep]
+
+    def mutual_information(self, values, secrets, z=1.96):
+        """plug-in and Miller-Madow mutual information in bits and the z
+        confidence interval from the 2^secrets * (secrets + 1) joint counts of
+        a predictor in a row of a mutual-information mode (see
+        include/utils/Leakage.hpp)"""
+        counts = _joint_counts(values, secrets)
+        results = [ctypes.c_double() for _ in range(4)]
+        _check(self.lib.bg_mutual_information(
+            _pointer(counts, u64), 2 ** secrets, secrets + 1, z,
+            *[ctypes.byref(result) for result in results]))
+        plug_in, miller_madow, lower, upper = [r.value for r in results]
+        return plug_in, miller_madow, (lower, upper)
+
+    def channel_capacity(self, values, secrets):
+        """capacity in bits of the channel of the joint counts of a
+        predictor in a row of a mutual-information mode"""
+        counts = _joint_counts(values, secrets)
+        bits = ctypes.c_double()
+        _check(self.lib.bg_channel_capacity(
+            _pointer(counts, u64), 2 ** secrets, secrets + 1,
+            ctypes.byref(bits)))
+        return bits.value
+
+    def config(self, **fields):
+        config = Config()
+        self.lib.bg_default_config(ctypes.byref(config))
+        for name, value in fields.items():
+            if isinstance(value, (list, tuple)):
+                # per-level fields, e.g. btb_sets=[16, 256]
+                value = (u64 * BG_BTB_MAX_LEVELS)(*value)
+            setattr(config, name, value)
+        return config
+
+    def predictors(self, types, **fields):
+        """construct the predictors of types (names or BPUType values) with
+        the config fields (e.g. seed=42, addr_space=48, btb_levels=2,
+        btb_sets=[16, 256], btb_ways=[4, 4])"""
+        values = [_parse_type(self.lib, predictor) for predictor in types]
+        array = (u64 * len(values))(*values)
+        handle = ctypes.c_void_p()
+        _check(self.lib.bg_create(ctypes.byref(self.config(**fields)), array,
+                                  len(values), ctypes.byref(handle)))
+        return Predictors(self.lib, handle)
+
+    def seed(self, seed):
+        self.lib.bg_seed(seed)
+
+    def set_max_branches(self, max_branches):
+        self.lib.bg_set_max_branches(max_branches)
+
+    def run_spec(self, spec, seed=0, shard=(0, 1), output=None):
+        """evaluate the text of a spec, return its (rows, columns) table"""
+        table = ctypes.c_void_p()
+        _check(self.lib.bg_run_spec(
+            spec.encode(), seed, shard[0], shard[1],
+            None if output is None else output.encode(),
+            ctypes.byref(table)))
+        rows, columns = u64(), u64()
+        self.lib.bg_table_shape(table, ctypes.byref(rows),
+                                ctypes.byref(columns))
+        size = rows.value * columns.value
+        data = self.lib.bg_table_data(table)
+        # the table owns the buffer, keep a copy beyond its lifetime
+        values = np.ctypeslib.as_array(data, shape=(size,)).copy() \
+            if size > 0 else np.zeros(0, dtype=np.uint64)
+        self.lib.bg_table_free(table)
+        return values.reshape(rows.value, columns.value)
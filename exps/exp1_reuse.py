@@ -35,7 +35,7 @@ def exp1_reuse_access():
     num_repeats = global_num_repeats
     num_branches = 1e9
     # execute the binary
-    cmd = "{} reuse-access {} {} 2> {}".format(bin_file, num_branches, num_repeats, output_file)
+    cmd = "{} reuse-access {} {} --journal {}.journal --resume 2> {}".format(bin_file, num_branches, num_repeats, output_file, output_file)
     os.system(cmd)
 
 def exp1_reuse_collision_rate():
@@ -49,7 +49,7 @@ def exp1_reuse_collision_rate():
     num_repeats = global_num_repeats
     num_branches = 1e9
     # execute the binary
-    cmd = "{} reuse-collision {} {} 2> {}".format(bin_file, num_branches, num_repeats, output_file)
+    cmd = "{} reuse-collision {} {} --journal {}.journal --resume 2> {}".format(bin_file, num_branches, num_repeats, output_file, output_file)
     os.system(cmd)
 
 # execute the experiment (multi-threading)
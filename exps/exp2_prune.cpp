@@ -19,281 +19,157 @@
 // author: iamywang
 // date: 2024/12/27
 // =============================================================================
+#include "include/exps/exp2_prune.hpp"
+
 #include <cstdint>
 #include <iostream>
+#include <string>
+#include <utility>
 #include <vector>
 
-#include "include/predictors/BSUP.hpp"
-#include "include/predictors/BaseBPU.hpp"
-#include "include/predictors/HyBP.hpp"
-#include "include/predictors/LSBP.hpp"
-#include "include/predictors/NoisyXorBP.hpp"
-#include "include/predictors/STBPU.hpp"
-#include "include/predictors/XorBP.hpp"
+#include "include/predictors/BPUSet.hpp"
+#include "include/utils/Journal.hpp"
+#include "include/utils/Progress.hpp"
+#include "include/utils/ResultCache.hpp"
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Scheduler.hpp"
+#include "include/utils/Spec.hpp"
+#include "include/utils/Sweep.hpp"
 #include "include/utils/Utils.hpp"
 
-class Exp2 {
- private:
-  std::vector<uint64_t> secrets;
-  BaseBPU *base_bpu;
-  BSUP *bsup;
-  XorBP *xorbp;
-  NoisyXorBP *noisyxorbp;
-  LSBP *lsbp;
-  STBPU *stbpu;
-  HyBP *hybp;
-
-  uint64_t attacker_pid;
-  uint64_t victim_pid;
-
- public:
-  Exp2(uint64_t counter_bits, uint64_t counter_nums, uint64_t buffer_ways,
-       uint64_t buffer_sets, uint64_t addr_space = 32) {
-    srand(time(NULL));
-    // init branch predictors
-    base_bpu = new BaseBPU(addr_space);
-    base_bpu->initPHT(counter_bits, counter_nums);
-    base_bpu->initBTB(buffer_ways, buffer_sets);
-
-    bsup = new BSUP(addr_space);
-    bsup->initPHT(3, counter_nums);
-    bsup->initBTB(buffer_ways, buffer_sets);
-
-    xorbp = new XorBP(addr_space);
-    xorbp->initPHT(counter_bits, counter_nums);
-    xorbp->initBTB(buffer_ways, buffer_sets);
-
-    noisyxorbp = new NoisyXorBP(addr_space);
-    noisyxorbp->initPHT(counter_bits, counter_nums);
-    noisyxorbp->initBTB(buffer_ways, buffer_sets);
-
-    lsbp = new LSBP(addr_space);
-    lsbp->initPHT(counter_bits, counter_nums);
-    lsbp->initBTB(buffer_ways, buffer_sets);
-#ifdef RANDOM_PID
-    attacker_pid = rand() & 0xFFFFFFFF;
-    victim_pid = rand() & 0xFFFFFFFF;
-#else
-    attacker_pid = ProcessorPID::PID_ATTACKER;
-    victim_pid = ProcessorPID::PID_VICTIM;
-#endif
-
-    stbpu = new STBPU(addr_space);
-    stbpu->initPHT(counter_bits, counter_nums);
-    stbpu->initBTB(buffer_ways, buffer_sets);
-
-    hybp = new HyBP(addr_space);
-    hybp->initPHT(counter_bits, counter_nums);
-    hybp->initBTB(buffer_ways, buffer_sets);
-
-    // init secrets
-    for (int i = 0; i < 16; i++) {
-      secrets.push_back(rand() & 0xFFFFFFFF);
-    }
-  }
-
-  // experiment: BTB access under different pruning set size
-  std::vector<uint64_t> BTBPruningAccess(uint64_t prune_size,
-                                         uint64_t repeats) {
-    srand(time(NULL));
-    // statistics
-    std::vector<uint64_t> access_stat(7, 0);
-    uint64_t num_loops = 1e9;
-    // simulate the attack
-    for (int i = 0; i < repeats; i++) {
-      uint64_t victim_addr = secrets[0];
-      uint64_t target_addr = secrets[1];
-      std::pair<std::vector<uint64_t>, uint64_t> res_base =
-          base_bpu->BTBPrune(num_loops, victim_addr, prune_size, 1);
-      std::pair<std::vector<uint64_t>, uint64_t> res_bsup =
-          bsup->BTBPrune(num_loops, victim_addr, prune_size, 1);
-      std::pair<std::vector<uint64_t>, uint64_t> res_xorbp =
-          xorbp->BTBPrune(num_loops, victim_addr, prune_size, 1);
-      std::pair<std::vector<uint64_t>, uint64_t> res_noisyxorbp =
-          noisyxorbp->BTBPrune(num_loops, victim_addr, prune_size, 1);
-      std::pair<std::vector<uint64_t>, uint64_t> res_lsbp = lsbp->BTBPrune(
-          num_loops, victim_addr, prune_size, 1, attacker_pid, victim_pid);
-      std::pair<std::vector<uint64_t>, uint64_t> res_stbpu =
-          stbpu->BTBPrune(num_loops, victim_addr, prune_size, 1);
-      std::pair<std::vector<uint64_t>, uint64_t> res_hybp =
-          hybp->BTBPrune(num_loops, victim_addr, prune_size, 1);
-      // save the statistics
-      access_stat[0] += res_base.second;
-      access_stat[1] += res_bsup.second;
-      access_stat[2] += res_xorbp.second;
-      access_stat[3] += res_noisyxorbp.second;
-      access_stat[4] += res_lsbp.second;
-      access_stat[5] += res_stbpu.second;
-      access_stat[6] += res_hybp.second;
-    }
-    for (int j = 0; j < access_stat.size(); j++) {
-      std::cerr << access_stat[j] / repeats << " ";
-    }
-    std::cerr << std::endl;
-    return access_stat;
+Exp2::Exp2(const std::vector<uint64_t> &types, uint64_t counter_bits,
+           uint64_t counter_nums, uint64_t buffer_ways, uint64_t buffer_sets,
+           uint64_t addr_space, ReplacementPolicy policy, const PHTConfig &pht,
+           const RekeyConfig &rekey, const CipherConfig &cipher,
+           const BTBConfig &btb, uint64_t offset_pht, uint64_t offset_btb,
+           const AttackSchedule &schedule)
+    : schedule(schedule) {
+  // init the selected branch predictors only, with a domain per noise tenant
+  bpus = new BPUSet(types, counter_bits, counter_nums, buffer_ways,
+                    buffer_sets, addr_space, policy, pht, rekey, cipher, btb,
+                    NUM_ATTACK_DOMAINS + schedule.noise, offset_pht,
+                    offset_btb);
+  bpus->setSchedule(schedule);
+  // result header
+  header.predictors = bpus->getNames();
+  header.counter_bits = counter_bits;
+  header.counter_nums = counter_nums;
+  header.buffer_ways = buffer_ways;
+  header.buffer_sets = buffer_sets;
+  header.addr_space = addr_space;
+  header.offset_pht = offset_pht;
+  header.offset_btb = offset_btb;
+  header.policy = policyName(policy);
+  header.pht = phtName(pht);
+  header.rekey = rekeyName(rekey);
+  header.cipher = cipherName(cipher);
+  header.btb = btbName(btb);
+  btb_levels = btb.levels.size() + 1;
+  header.seed = RANDOM_SEED;
+  header.common_random = COMMON_RANDOM;
+  header.baseline = BASELINE;
+  header.shard_index = SHARD_INDEX;
+  header.shard_count = SHARD_COUNT;
+
+  // init secrets
+  srand(RANDOM_SEED);
+  for (int i = 0; i < 16; i++) {
+    secrets.push_back(randomAddr(addrMask(addr_space)));
   }
+}
 
-  std::vector<std::vector<uint64_t>> BTBPruningAccessIterate(
-      uint64_t max_pruning_sizes, uint64_t max_repeats) {
-    srand(time(NULL));
+// experiment: BTB access under different pruning set size
+std::vector<std::vector<uint64_t>> Exp2::BTBPruningAccessIterate(
+    const std::vector<uint64_t> &prune_sizes, uint64_t max_repeats) {
 #ifdef EVALUATION
-    std::cout << "== exp2: BTBPruningAccessIterate ==" << std::endl;
+  std::cout << "== exp2: BTBPruningAccessIterate ==" << std::endl;
 #endif
-    std::vector<std::vector<uint64_t>> access_stats;
-    for (uint64_t prune_size = 100; prune_size <= max_pruning_sizes;
-         prune_size += 100) {
+  ResultHeader table = header.table("exp2/BTBPruningAccess", "prune_size");
+  addScheduleParams(table.params, schedule);
+  Sweep sweep(writer, journal, cache, progress, table, prune_sizes,
+              max_repeats,
+              bpus->lookupCounter());
+  // simulate the attack, dump the average branch accesses
+  return sweep.run(
+      [&](const SweepCell &cell) {
+        uint64_t type = bpus->getType(cell.predictor);
+        uint64_t num_loops = 1e9;
+        uint64_t victim_addr = secrets[0];
+        if (cell.fresh) {
+          bpus->reset(type);
+        }
+        std::pair<std::vector<uint64_t>, uint64_t> res =
+            bpus->BTBPrune(type, num_loops, victim_addr, cell.key, 1);
+        return std::vector<uint64_t>{res.second};
+      },
+      true);
+}
+
+// experiment: BTB collison under different eviction set size
+std::vector<std::vector<uint64_t>> Exp2::BTBCollisionRate(
+    uint64_t prune_size, const std::vector<uint64_t> &branch_accesses_num,
+    uint64_t max_repeats) {
 #ifdef EVALUATION
-      std::cout << "BTBPruningAccessIterate: " << prune_size << std::endl;
+  std::cout << "== exp2: BTBCollisionRate ==" << std::endl;
 #endif
-      std::vector<uint64_t> access_stat =
-          BTBPruningAccess(prune_size, max_repeats);
-      access_stats.push_back(access_stat);
+  // with a BTB hierarchy, value 1 + k of a trial is whether the victim
+  // evicted an address of the eviction set from the levels L0 to Lk
+  ResultHeader table =
+      header.table("exp2/BTBCollisionRate", "num_accesses",
+                   btb_levels > 1 ? btb_levels + 1 : 1);
+  table.params = "prune_size=" + std::to_string(prune_size);
+  addScheduleParams(table.params, schedule);
+  Sweep sweep(writer, journal, cache, progress, table, branch_accesses_num,
+              max_repeats,
+              bpus->lookupCounter());
+  // simulate the attack
+  return sweep.run([&](const SweepCell &cell) {
+    uint64_t type = bpus->getType(cell.predictor);
+    uint64_t num_accesses = cell.key;
+    NUMBER_MAX_BRANCHES = num_accesses;
+    uint64_t victim_addr = secrets[0];
+    // the baseline and xor-bp are attacked with a pruning set of 100
+    uint64_t size = (type == BPUType::BPU_BaseBPU ||
+                     type == BPUType::BPU_XorBP)
+                        ? 100
+                        : prune_size;
+    if (cell.fresh) {
+      bpus->reset(type);
     }
-    return access_stats;
-  }
-
-  // experiment: BTB collison under different eviction set size
-  std::vector<std::vector<uint64_t>> BTBCollisionRate(
-      uint64_t prune_size, uint64_t max_branch_accesses, uint64_t max_repeats) {
-    srand(time(NULL));
-#ifdef EVALUATION
-    std::cout << "== exp2: BTBCollisionRate ==" << std::endl;
-#endif
-    std::vector<std::vector<uint64_t>> collision_stats;
-    for (uint64_t num_accesses = 1000; num_accesses <= max_branch_accesses;
-         num_accesses += 1000) {
-      NUMBER_MAX_BRANCHES = num_accesses;
-#ifdef EVALUATION
-      std::cout << "BTBPruneCollisionRate: " << num_accesses << std::endl;
-#endif
-      uint64_t victim_addr = secrets[0];
-      // statistics
-      std::vector<uint64_t> collision_stat(7, 0);
-      // simulate the attack
-      for (int i = 0; i < max_repeats; i++) {
-        std::pair<std::vector<uint64_t>, uint64_t> res_base =
-            base_bpu->BTBPrune(1e9, victim_addr, 100, 4);
-        std::pair<std::vector<uint64_t>, uint64_t> res_bsup =
-            bsup->BTBPrune(1e9, victim_addr, prune_size, 4);
-        std::pair<std::vector<uint64_t>, uint64_t> res_xorbp =
-            xorbp->BTBPrune(1e9, victim_addr, 100, 4);
-        std::pair<std::vector<uint64_t>, uint64_t> res_noisyxorbp =
-            noisyxorbp->BTBPrune(1e9, victim_addr, prune_size, 4);
-        std::pair<std::vector<uint64_t>, uint64_t> res_lsbp = lsbp->BTBPrune(
-            1e9, victim_addr, prune_size, 4, attacker_pid, victim_pid);
-        std::pair<std::vector<uint64_t>, uint64_t> res_stbpu =
-            stbpu->BTBPrune(1e9, victim_addr, prune_size, 4);
-        std::pair<std::vector<uint64_t>, uint64_t> res_hybp =
-            hybp->BTBPrune(1e9, victim_addr, prune_size, 4);
-        // check collision probability: base
-        if (res_base.second <= num_accesses) {
-          for (auto &addr : res_base.first) {
-            base_bpu->lookupBTB(addr, addr);
-          }
-          base_bpu->lookupBTB(victim_addr, victim_addr);
-          for (auto &addr : res_base.first) {
-            if (base_bpu->lookupBTB(addr, addr) == -1) {
-              collision_stat[0]++;
-              break;
-            }
-          }
-        }
-        // check collision probability: bsup
-        if (res_bsup.second <= num_accesses) {
-          for (auto &addr : res_bsup.first) {
-            bsup->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER);
-          }
-          bsup->lookupBTB(victim_addr, victim_addr, SecurityDomain::DOM_VICTIM);
-          for (auto &addr : res_bsup.first) {
-            if (bsup->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER) ==
-                -1) {
-              collision_stat[1]++;
-              break;
-            }
-          }
-        }
-        // check collision probability: xorbp
-        if (res_xorbp.second <= num_accesses) {
-          for (auto &addr : res_xorbp.first) {
-            xorbp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER);
-          }
-          xorbp->lookupBTB(victim_addr, victim_addr,
-                           SecurityDomain::DOM_VICTIM);
-          for (auto &addr : res_xorbp.first) {
-            if (xorbp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER) ==
-                -1) {
-              collision_stat[2]++;
-              break;
-            }
-          }
-        }
-        // check collision probability: noisyxorbp
-        if (res_noisyxorbp.second <= num_accesses) {
-          for (auto &addr : res_noisyxorbp.first) {
-            noisyxorbp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER);
-          }
-          noisyxorbp->lookupBTB(victim_addr, victim_addr,
-                                SecurityDomain::DOM_VICTIM);
-          for (auto &addr : res_noisyxorbp.first) {
-            if (noisyxorbp->lookupBTB(addr, addr,
-                                      SecurityDomain::DOM_ATTACKER) == -1) {
-              collision_stat[3]++;
-              break;
-            }
-          }
-        }
-        // check collision probability: lsbp
-        if (res_lsbp.second <= num_accesses) {
-          for (auto &addr : res_lsbp.first) {
-            lsbp->lookupBTB(addr, addr, attacker_pid,
-                            SecurityDomain::DOM_ATTACKER);
-          }
-          lsbp->lookupBTB(victim_addr, victim_addr, victim_pid,
-                          SecurityDomain::DOM_VICTIM);
-          for (auto &addr : res_lsbp.first) {
-            if (lsbp->lookupBTB(addr, addr, attacker_pid,
-                                SecurityDomain::DOM_ATTACKER) == -1) {
-              collision_stat[4]++;
-              break;
-            }
-          }
-        }
-        // check collision probability: stbpu
-        if (res_stbpu.second <= num_accesses) {
-          for (auto &addr : res_stbpu.first) {
-            stbpu->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER);
-          }
-          stbpu->lookupBTB(victim_addr, victim_addr,
-                           SecurityDomain::DOM_VICTIM);
-          for (auto &addr : res_stbpu.first) {
-            if (stbpu->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER) ==
-                -1) {
-              collision_stat[5]++;
-              break;
-            }
-          }
-        }
-        // check collision probability: hybp
-        if (res_hybp.second <= num_accesses) {
-          for (auto &addr : res_hybp.first) {
-            hybp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER);
-          }
-          hybp->lookupBTB(victim_addr, victim_addr, SecurityDomain::DOM_VICTIM);
-          for (auto &addr : res_hybp.first) {
-            if (hybp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER) ==
-                -1) {
-              collision_stat[6]++;
-              break;
-            }
-          }
+    std::pair<std::vector<uint64_t>, uint64_t> res =
+        bpus->BTBPrune(type, 1e9, victim_addr, size, 4);
+    std::vector<uint64_t> values(table.values_per_predictor, 0);
+    // check collision probability
+    if (res.second > num_accesses) {
+      return values;
+    }
+    for (auto &addr : res.first) {
+      bpus->lookupBTB(type, addr, addr, SecurityDomain::DOM_ATTACKER);
+    }
+    // residence levels of the set around the victim access
+    std::vector<uint64_t> before, after;
+    if (btb_levels > 1) {
+      bpus->getBTBLevels(type, res.first, SecurityDomain::DOM_ATTACKER,
+                         before);
+    }
+    bpus->lookupBTB(type, victim_addr, victim_addr,
+                    SecurityDomain::DOM_VICTIM);
+    if (btb_levels > 1) {
+      bpus->getBTBLevels(type, res.first, SecurityDomain::DOM_ATTACKER,
+                         after);
+      for (uint64_t i = 0; i < before.size(); i++) {
+        for (uint64_t k = before[i]; k < after[i]; k++) {
+          values[1 + k] = 1;
         }
       }
-      collision_stats.push_back(collision_stat);
-      for (int j = 0; j < collision_stat.size(); j++) {
-        std::cerr << collision_stat[j] << " ";
+    }
+    for (auto &addr : res.first) {
+      if (bpus->lookupBTB(type, addr, addr, SecurityDomain::DOM_ATTACKER) ==
+          -1) {
+        values[0] = 1;
+        break;
       }
-      std::cerr << std::endl;
     }
-    return collision_stats;
-  }
-};
\ No newline at end of file
+    return values;
+  });
+}
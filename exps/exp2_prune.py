@@ -35,7 +35,7 @@ def exp2_pruning_access():
     num_repeats = global_num_repeats
     num_pruning_sizes = 4000
     # execute the binary
-    cmd = "{} prune-btb-prune {} {} 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file)
+    cmd = "{} prune-btb-prune {} {} --journal {}.journal --resume 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file, output_file)
     os.system(cmd)
 
 def exp2_pruning_collision():
@@ -49,7 +49,7 @@ def exp2_pruning_collision():
     num_repeats = global_num_repeats
     num_pruning_sizes = 3800
     # execute the binary
-    cmd = "{} prune-btb-collision {} {} 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file)
+    cmd = "{} prune-btb-collision {} {} --journal {}.journal --resume 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file, output_file)
     os.system(cmd)
 
 # execute the experiment (multi-threading)
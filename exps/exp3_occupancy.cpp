@@ -19,433 +19,374 @@
 // author: iamywang
 // date: 2024/12/30
 // =============================================================================
+#include "include/exps/exp3_occupancy.hpp"
+
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <functional>
 #include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
 
-#include "include/predictors/BSUP.hpp"
-#include "include/predictors/BaseBPU.hpp"
-#include "include/predictors/HyBP.hpp"
-#include "include/predictors/LSBP.hpp"
-#include "include/predictors/NoisyXorBP.hpp"
-#include "include/predictors/STBPU.hpp"
-#include "include/predictors/XorBP.hpp"
+#include "include/predictors/BPUSet.hpp"
+#include "include/utils/Journal.hpp"
+#include "include/utils/Progress.hpp"
+#include "include/utils/ResultCache.hpp"
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Scheduler.hpp"
+#include "include/utils/Spec.hpp"
+#include "include/utils/Sweep.hpp"
 #include "include/utils/Utils.hpp"
 
-class Exp3 {
- private:
-  std::vector<uint64_t> secrets;
-  BaseBPU *base_bpu;
-  BSUP *bsup;
-  XorBP *xorbp;
-  NoisyXorBP *noisyxorbp;
-  LSBP *lsbp;
-  STBPU *stbpu;
-  HyBP *hybp;
-
-  uint64_t attacker_pid;
-  uint64_t victim_pid;
-
- public:
-  Exp3(uint64_t counter_bits, uint64_t counter_nums, uint64_t buffer_ways,
-       uint64_t buffer_sets, uint64_t addr_space = 32) {
-    srand(time(NULL));
-    // init branch predictors
-    base_bpu = new BaseBPU(addr_space);
-    base_bpu->initPHT(counter_bits, counter_nums);
-    base_bpu->initBTB(buffer_ways, buffer_sets);
-
-    bsup = new BSUP(addr_space);
-    bsup->initPHT(3, counter_nums);
-    bsup->initBTB(buffer_ways, buffer_sets);
-
-    xorbp = new XorBP(addr_space);
-    xorbp->initPHT(counter_bits, counter_nums);
-    xorbp->initBTB(buffer_ways, buffer_sets);
-
-    noisyxorbp = new NoisyXorBP(addr_space);
-    noisyxorbp->initPHT(counter_bits, counter_nums);
-    noisyxorbp->initBTB(buffer_ways, buffer_sets);
-
-    lsbp = new LSBP(addr_space);
-    lsbp->initPHT(counter_bits, counter_nums);
-    lsbp->initBTB(buffer_ways, buffer_sets);
-#ifdef RANDOM_PID
-    attacker_pid = rand() & 0xFFFFFFFF;
-    victim_pid = rand() & 0xFFFFFFFF;
-#else
-    attacker_pid = ProcessorPID::PID_ATTACKER;
-    victim_pid = ProcessorPID::PID_VICTIM;
-#endif
-
-    stbpu = new STBPU(addr_space);
-    stbpu->initPHT(counter_bits, counter_nums);
-    stbpu->initBTB(buffer_ways, buffer_sets);
-
-    hybp = new HyBP(addr_space);
-    hybp->initPHT(counter_bits, counter_nums);
-    hybp->initBTB(buffer_ways, buffer_sets);
-
-    // init secrets
-    for (int i = 0; i < 16; i++) {
-      secrets.push_back(rand() & 0xFFFFFFFF);
-    }
+// Victim of an importance-sampling trial. The Monte-Carlo trials estimate
+// the collision rate of a victim address; over a uniform victim address
+// (which the attacker, not knowing the keys, cannot tell from the secret),
+// a collision needs the victim to index one of the few sets of the
+// attacker. The victim is drawn from the defensive mixture
+//   q(x) = (1 - bias) p(x) + bias p(x | set_of(x) in sets)
+// of the uniform draw p and the addresses that index a marked set (by
+// rejection from p), and the trial is weighted by the likelihood ratio
+//   p(x) / q(x) = 1 / (1 - bias + bias [set_of(x) in sets] N / |sets|)
+// of its victim, N the sets of the table. This assumes that a uniform
+// address indexes a uniform set, which holds for the power-of-two tables
+// of the XOR-based predictors and up to the cipher for STBPU, HyBP and the
+// index ciphers (see Cipher.hpp).
+// Return the victim address and its weight.
+std::pair<uint64_t, double> Exp3::drawVictim(
+    const std::vector<bool> &sets, uint64_t bias,
+    const std::function<uint64_t(uint64_t)> &set_of) {
+  uint64_t marked = std::count(sets.begin(), sets.end(), true);
+  if (marked == 0) {
+    return {randomAddr(addr_mask), 1.0};
   }
-
-  // experiment: PHT access under different pruning set size
-  std::vector<uint64_t> PHTPruningAccess(uint64_t prune_size,
-                                         uint64_t occupancy_size,
-                                         uint64_t repeats,
-                                         uint64_t counter_bits) {
-    srand(time(NULL));
-    // statistics
-    std::vector<uint64_t> access_stat(7, 0);
-    uint64_t num_loops = 1e9;
-    // simulate the attack
-    for (int i = 0; i < repeats; i++) {
-      std::pair<std::vector<uint64_t>, uint64_t> res_base =
-          base_bpu->PHTOccupancy(num_loops, counter_bits, prune_size,
-                                 occupancy_size);
-      std::pair<std::vector<uint64_t>, uint64_t> res_bsup =
-          bsup->PHTOccupancy(num_loops, 3, prune_size, occupancy_size);
-      std::pair<std::vector<uint64_t>, uint64_t> res_xorbp =
-          xorbp->PHTOccupancy(num_loops, counter_bits, prune_size,
-                              occupancy_size);
-      std::pair<std::vector<uint64_t>, uint64_t> res_noisyxorbp =
-          noisyxorbp->PHTOccupancy(num_loops, counter_bits, prune_size,
-                                   occupancy_size);
-      std::pair<std::vector<uint64_t>, uint64_t> res_lsbp = lsbp->PHTOccupancy(
-          num_loops, counter_bits, prune_size, occupancy_size, attacker_pid);
-      std::pair<std::vector<uint64_t>, uint64_t> res_stbpu =
-          stbpu->PHTOccupancy(num_loops, counter_bits, prune_size,
-                              occupancy_size);
-      std::pair<std::vector<uint64_t>, uint64_t> res_hybp = hybp->PHTOccupancy(
-          num_loops, counter_bits, prune_size, occupancy_size);
-      // save the statistics
-      access_stat[0] += res_base.second;
-      access_stat[1] += res_bsup.second;
-      access_stat[2] += res_xorbp.second;
-      access_stat[3] += res_noisyxorbp.second;
-      access_stat[4] += res_lsbp.second;
-      access_stat[5] += res_stbpu.second;
-      access_stat[6] += res_hybp.second;
+  uint64_t victim_addr = randomAddr(addr_mask);
+  if ((uint64_t)rand() % 100 < bias) {
+    while (!sets[set_of(victim_addr)]) {
+      victim_addr = randomAddr(addr_mask);
     }
-    for (int j = 0; j < access_stat.size(); j++) {
-      std::cerr << access_stat[j] / repeats << " ";
-    }
-    std::cerr << std::endl;
-    return access_stat;
   }
+  double share = bias / 100.0;
+  double ratio = 1 - share;
+  if (sets[set_of(victim_addr)]) {
+    ratio += share * sets.size() / marked;
+  }
+  return {victim_addr, 1 / ratio};
+}
 
-  std::vector<std::vector<uint64_t>> PHTPruningAccessIterate(
-      uint64_t max_pruning_sizes, uint64_t occupancy_size, uint64_t max_repeats,
-      uint64_t counter_bits) {
-    srand(time(NULL));
-#ifdef EVALUATION
-    std::cout << "== exp3: PHTPruningAccessIterate ==" << std::endl;
-#endif
-    std::vector<std::vector<uint64_t>> access_stats;
-    for (uint64_t prune_size = 1; prune_size <= max_pruning_sizes;
-         prune_size++) {
-#ifdef EVALUATION
-      std::cout << "PHTOccupancyPruningAccessIterate: " << prune_size
-                << std::endl;
-#endif
-      std::vector<uint64_t> access_stat = PHTPruningAccess(
-          prune_size, occupancy_size, max_repeats, counter_bits);
-      access_stats.push_back(access_stat);
-    }
-    return access_stats;
+// values of an importance-sampling trial: the collision and its weight
+// and squared weight in units of 1 / RARE_SCALE
+std::vector<uint64_t> Exp3::rareValues(bool collision, double weight) {
+  if (!collision) {
+    return std::vector<uint64_t>{0, 0, 0};
   }
+  uint64_t scaled = std::llround(weight * RARE_SCALE);
+  uint64_t squared = std::llround(weight * weight * RARE_SCALE);
+  return std::vector<uint64_t>{1, scaled, squared};
+}
 
-  // experiment: BTB access under different pruning set size
-  std::vector<uint64_t> BTBPruningAccess(uint64_t prune_size,
-                                         uint64_t occupancy_size,
-                                         uint64_t repeats) {
-    srand(time(NULL));
-    // statistics
-    std::vector<uint64_t> access_stat(7, 0);
-    uint64_t num_loops = 1e9;
-    // simulate the attack
-    for (int i = 0; i < repeats; i++) {
-      std::pair<std::vector<uint64_t>, uint64_t> res_base =
-          base_bpu->BTBOccupancy(num_loops, prune_size, occupancy_size);
-      std::pair<std::vector<uint64_t>, uint64_t> res_bsup =
-          bsup->BTBOccupancy(num_loops, prune_size, occupancy_size);
-      std::pair<std::vector<uint64_t>, uint64_t> res_xorbp =
-          xorbp->BTBOccupancy(num_loops, prune_size, occupancy_size);
-      std::pair<std::vector<uint64_t>, uint64_t> res_noisyxorbp =
-          noisyxorbp->BTBOccupancy(num_loops, prune_size, occupancy_size);
-      std::pair<std::vector<uint64_t>, uint64_t> res_lsbp = lsbp->BTBOccupancy(
-          num_loops, prune_size, occupancy_size, attacker_pid);
-      std::pair<std::vector<uint64_t>, uint64_t> res_stbpu =
-          stbpu->BTBOccupancy(num_loops, prune_size, occupancy_size);
-      std::pair<std::vector<uint64_t>, uint64_t> res_hybp =
-          hybp->BTBOccupancy(num_loops, prune_size, occupancy_size);
-      // save the statistics
-      access_stat[0] += res_base.second;
-      access_stat[1] += res_bsup.second;
-      access_stat[2] += res_xorbp.second;
-      access_stat[3] += res_noisyxorbp.second;
-      access_stat[4] += res_lsbp.second;
-      access_stat[5] += res_stbpu.second;
-      access_stat[6] += res_hybp.second;
-    }
-    for (int j = 0; j < access_stat.size(); j++) {
-      std::cerr << access_stat[j] / repeats << " ";
-    }
-    std::cerr << std::endl;
-    return access_stat;
+Exp3::Exp3(const std::vector<uint64_t> &types, uint64_t counter_bits,
+           uint64_t counter_nums, uint64_t buffer_ways, uint64_t buffer_sets,
+           uint64_t addr_space, ReplacementPolicy policy, const PHTConfig &pht,
+           const RekeyConfig &rekey, const CipherConfig &cipher,
+           const BTBConfig &btb, uint64_t offset_pht, uint64_t offset_btb,
+           const AttackSchedule &schedule)
+    : schedule(schedule) {
+  // init the selected branch predictors only, with a domain per noise tenant
+  bpus = new BPUSet(types, counter_bits, counter_nums, buffer_ways,
+                    buffer_sets, addr_space, policy, pht, rekey, cipher, btb,
+                    NUM_ATTACK_DOMAINS + schedule.noise, offset_pht,
+                    offset_btb);
+  bpus->setSchedule(schedule);
+  // result header
+  header.predictors = bpus->getNames();
+  header.counter_bits = counter_bits;
+  header.counter_nums = counter_nums;
+  header.buffer_ways = buffer_ways;
+  header.buffer_sets = buffer_sets;
+  header.addr_space = addr_space;
+  header.offset_pht = offset_pht;
+  header.offset_btb = offset_btb;
+  header.policy = policyName(policy);
+  header.pht = phtName(pht);
+  header.rekey = rekeyName(rekey);
+  header.cipher = cipherName(cipher);
+  header.btb = btbName(btb);
+  btb_levels = btb.levels.size() + 1;
+  header.seed = RANDOM_SEED;
+  header.common_random = COMMON_RANDOM;
+  header.baseline = BASELINE;
+  header.shard_index = SHARD_INDEX;
+  header.shard_count = SHARD_COUNT;
+  this->counter_nums = counter_nums;
+  this->buffer_sets = buffer_sets;
+  addr_mask = addrMask(addr_space);
+
+  // init secrets
+  srand(RANDOM_SEED);
+  for (int i = 0; i < 16; i++) {
+    secrets.push_back(randomAddr(addrMask(addr_space)));
   }
+}
 
-  std::vector<std::vector<uint64_t>> BTBPruningAccessIterate(
-      uint64_t max_pruning_sizes, uint64_t occupancy_size,
-      uint64_t max_repeats) {
-    srand(time(NULL));
+// experiment: PHT access under different pruning set size
+std::vector<std::vector<uint64_t>> Exp3::PHTPruningAccessIterate(
+    const std::vector<uint64_t> &prune_sizes, uint64_t occupancy_size,
+    uint64_t max_repeats, uint64_t counter_bits) {
 #ifdef EVALUATION
-    std::cout << "== exp3: BTBPruningAccessIterate ==" << std::endl;
+  std::cout << "== exp3: PHTPruningAccessIterate ==" << std::endl;
 #endif
-    std::vector<std::vector<uint64_t>> access_stats;
-    for (uint64_t prune_size = 100; prune_size <= max_pruning_sizes;
-         prune_size += 100) {
+  ResultHeader table = header.table("exp3/PHTPruningAccess", "prune_size");
+  table.params = "occupancy_size=" + std::to_string(occupancy_size) +
+                 ",counter_bits=" + std::to_string(counter_bits);
+  addScheduleParams(table.params, schedule);
+  Sweep sweep(writer, journal, cache, progress, table, prune_sizes,
+              max_repeats,
+              bpus->lookupCounter());
+  // simulate the attack, dump the average branch accesses
+  return sweep.run(
+      [&](const SweepCell &cell) {
+        uint64_t type = bpus->getType(cell.predictor);
+        uint64_t num_loops = 1e9;
+        if (cell.fresh) {
+          bpus->reset(type);
+        }
+        std::pair<std::vector<uint64_t>, uint64_t> res = bpus->PHTOccupancy(
+            type, num_loops, counter_bits, cell.key, occupancy_size);
+        return std::vector<uint64_t>{res.second};
+      },
+      true);
+}
+
+// experiment: BTB access under different pruning set size
+std::vector<std::vector<uint64_t>> Exp3::BTBPruningAccessIterate(
+    const std::vector<uint64_t> &prune_sizes, uint64_t occupancy_size,
+    uint64_t max_repeats) {
 #ifdef EVALUATION
-      std::cout << "BTBOccupancyPruningAccessIterate: " << prune_size
-                << std::endl;
+  std::cout << "== exp3: BTBPruningAccessIterate ==" << std::endl;
 #endif
-      std::vector<uint64_t> access_stat =
-          BTBPruningAccess(prune_size, occupancy_size, max_repeats);
-      access_stats.push_back(access_stat);
-    }
-    return access_stats;
-  }
+  ResultHeader table = header.table("exp3/BTBPruningAccess", "prune_size");
+  table.params = "occupancy_size=" + std::to_string(occupancy_size);
+  addScheduleParams(table.params, schedule);
+  Sweep sweep(writer, journal, cache, progress, table, prune_sizes,
+              max_repeats,
+              bpus->lookupCounter());
+  // simulate the attack, dump the average branch accesses
+  return sweep.run(
+      [&](const SweepCell &cell) {
+        uint64_t type = bpus->getType(cell.predictor);
+        uint64_t num_loops = 1e9;
+        if (cell.fresh) {
+          bpus->reset(type);
+        }
+        std::pair<std::vector<uint64_t>, uint64_t> res = bpus->BTBOccupancy(
+            type, num_loops, cell.key, occupancy_size);
+        return std::vector<uint64_t>{res.second};
+      },
+      true);
+}
 
-  // experiment: PHT collision rate under different occupancy size
-  std::vector<std::vector<uint64_t>> PHTCollisionRate(
-      uint64_t prune_size, uint64_t max_branch_accesses, uint64_t max_repeats,
-      uint64_t counter_bits) {
-    srand(time(NULL));
+// experiment: PHT collision rate under different occupancy size
+std::vector<std::vector<uint64_t>> Exp3::PHTCollisionRate(
+    uint64_t prune_size, uint64_t occupancy_size,
+    const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats,
+    uint64_t counter_bits) {
 #ifdef EVALUATION
-    std::cout << "== exp3: PHTCollisionRate ==" << std::endl;
+  std::cout << "== exp3: PHTCollisionRate ==" << std::endl;
 #endif
-    std::vector<std::vector<uint64_t>> collision_stats;
-    uint64_t occupancy_size = 1024;
-    for (uint64_t num_accesses = 1000; num_accesses <= max_branch_accesses;
-         num_accesses += 1000) {
-      NUMBER_MAX_BRANCHES = num_accesses;
+  ResultHeader table = header.table("exp3/PHTCollisionRate", "num_accesses");
+  table.params = "prune_size=" + std::to_string(prune_size) +
+                 ",occupancy_size=" + std::to_string(occupancy_size) +
+                 ",counter_bits=" + std::to_string(counter_bits);
+  addScheduleParams(table.params, schedule);
+  Sweep sweep(writer, journal, cache, progress, table, branch_accesses_num,
+              max_repeats,
+              bpus->lookupCounter());
+  // simulate the attack
+  return sweep.run([&](const SweepCell &cell) {
+    uint64_t type = bpus->getType(cell.predictor);
+    NUMBER_MAX_BRANCHES = cell.key;
+    uint64_t victim_addr = secrets[0];
+    if (cell.fresh) {
+      bpus->reset(type);
+    }
+    std::pair<std::vector<uint64_t>, uint64_t> res = bpus->PHTOccupancy(
+        type, 1e9, counter_bits, prune_size, occupancy_size);
+    // check collision probability
+    for (auto &addr : res.first) {
+      if (bpus->checkPHTSetCollision(type, addr, SecurityDomain::DOM_ATTACKER,
+                                     victim_addr,
+                                     SecurityDomain::DOM_VICTIM)) {
+        return std::vector<uint64_t>{1};
+      }
+    }
+    return std::vector<uint64_t>{0};
+  });
+}
+
+// experiment: BTB collision rate under different occupancy size
+std::vector<std::vector<uint64_t>> Exp3::BTBCollisionRate(
+    uint64_t prune_size, uint64_t occupancy_size,
+    const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats) {
 #ifdef EVALUATION
-      std::cout << "PHTCollisionRate: " << num_accesses << std::endl;
+  std::cout << "== exp3: BTBCollisionRate ==" << std::endl;
 #endif
-      uint64_t victim_addr = secrets[0];
-      // statistics
-      std::vector<uint64_t> collision_stat(7, 0);
-      // simulate the attack
-      for (int i = 0; i < max_repeats; i++) {
-        std::pair<std::vector<uint64_t>, uint64_t> res_base =
-            base_bpu->PHTOccupancy(1e9, counter_bits, prune_size,
-                                   occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_bsup =
-            bsup->PHTOccupancy(1e9, 3, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_xorbp =
-            xorbp->PHTOccupancy(1e9, counter_bits, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_noisyxorbp =
-            noisyxorbp->PHTOccupancy(1e9, counter_bits, prune_size,
-                                     occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_lsbp =
-            lsbp->PHTOccupancy(1e9, counter_bits, prune_size, occupancy_size,
-                               attacker_pid);
-        std::pair<std::vector<uint64_t>, uint64_t> res_stbpu =
-            stbpu->PHTOccupancy(1e9, counter_bits, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_hybp =
-            hybp->PHTOccupancy(1e9, counter_bits, prune_size, occupancy_size);
-        // check collision probability
-        for (auto &addr : res_base.first) {
-          if (base_bpu->checkPHTSetCollision(addr, victim_addr)) {
-            collision_stat[0]++;
-            break;
-          }
-        }
-        for (auto &addr : res_bsup.first) {
-          if (bsup->checkPHTSetCollision(addr, SecurityDomain::DOM_ATTACKER,
-                                         victim_addr,
-                                         SecurityDomain::DOM_VICTIM)) {
-            collision_stat[1]++;
-            break;
-          }
-        }
-        for (auto &addr : res_xorbp.first) {
-          if (xorbp->checkPHTSetCollision(addr, SecurityDomain::DOM_ATTACKER,
-                                          victim_addr,
-                                          SecurityDomain::DOM_VICTIM)) {
-            collision_stat[2]++;
-            break;
-          }
-        }
-        for (auto &addr : res_noisyxorbp.first) {
-          if (noisyxorbp->checkPHTSetCollision(
-                  addr, SecurityDomain::DOM_ATTACKER, victim_addr,
-                  SecurityDomain::DOM_VICTIM)) {
-            collision_stat[3]++;
-            break;
-          }
-        }
-        for (auto &addr : res_lsbp.first) {
-          if (lsbp->checkPHTSetCollision(
-                  addr, attacker_pid, SecurityDomain::DOM_ATTACKER, victim_addr,
-                  victim_pid, SecurityDomain::DOM_VICTIM)) {
-            collision_stat[4]++;
-            break;
-          }
-        }
-        for (auto &addr : res_stbpu.first) {
-          if (stbpu->checkPHTSetCollision(addr, SecurityDomain::DOM_ATTACKER,
-                                          victim_addr,
-                                          SecurityDomain::DOM_VICTIM)) {
-            collision_stat[5]++;
-            break;
-          }
-        }
-        for (auto &addr : res_hybp.first) {
-          if (hybp->checkPHTSetCollision(addr, SecurityDomain::DOM_ATTACKER,
-                                         victim_addr,
-                                         SecurityDomain::DOM_VICTIM)) {
-            collision_stat[6]++;
-            break;
-          }
+  // with a BTB hierarchy, value 1 + k of a trial is whether the victim
+  // evicted an address of the occupancy set from the levels L0 to Lk
+  ResultHeader table =
+      header.table("exp3/BTBCollisionRate", "num_accesses",
+                   btb_levels > 1 ? btb_levels + 1 : 1);
+  table.params = "prune_size=" + std::to_string(prune_size) +
+                 ",occupancy_size=" + std::to_string(occupancy_size);
+  addScheduleParams(table.params, schedule);
+  Sweep sweep(writer, journal, cache, progress, table, branch_accesses_num,
+              max_repeats,
+              bpus->lookupCounter());
+  // simulate the attack
+  return sweep.run([&](const SweepCell &cell) {
+    uint64_t type = bpus->getType(cell.predictor);
+    NUMBER_MAX_BRANCHES = cell.key;
+    uint64_t victim_addr = secrets[0];
+    if (cell.fresh) {
+      bpus->reset(type);
+    }
+    std::pair<std::vector<uint64_t>, uint64_t> res =
+        bpus->BTBOccupancy(type, 1e9, prune_size, occupancy_size);
+    std::vector<uint64_t> values(table.values_per_predictor, 0);
+    // check collision probability
+    for (auto &addr : res.first) {
+      bpus->lookupBTB(type, addr, addr, SecurityDomain::DOM_ATTACKER);
+    }
+    // residence levels of the set around the victim access
+    std::vector<uint64_t> before, after;
+    if (btb_levels > 1) {
+      bpus->getBTBLevels(type, res.first, SecurityDomain::DOM_ATTACKER,
+                         before);
+    }
+    bpus->lookupBTB(type, victim_addr, victim_addr,
+                    SecurityDomain::DOM_VICTIM);
+    if (btb_levels > 1) {
+      bpus->getBTBLevels(type, res.first, SecurityDomain::DOM_ATTACKER,
+                         after);
+      for (uint64_t i = 0; i < before.size(); i++) {
+        for (uint64_t k = before[i]; k < after[i]; k++) {
+          values[1 + k] = 1;
         }
       }
-      collision_stats.push_back(collision_stat);
-      for (int j = 0; j < collision_stat.size(); j++) {
-        std::cerr << collision_stat[j] << " ";
+    }
+    for (auto &addr : res.first) {
+      if (bpus->lookupBTB(type, addr, addr, SecurityDomain::DOM_ATTACKER) ==
+          -1) {
+        values[0] = 1;
+        break;
       }
-      std::cerr << std::endl;
     }
-    return collision_stats;
-  }
+    return values;
+  });
+}
 
-  // experiment: BTB collision rate under different occupancy size
-  std::vector<std::vector<uint64_t>> BTBCollisionRate(
-      uint64_t prune_size, uint64_t max_branch_accesses, uint64_t max_repeats) {
-    srand(time(NULL));
+// experiment: PHT collision rate under different occupancy size, estimated
+// by importance sampling over the victim address (see drawVictim)
+std::vector<std::vector<uint64_t>> Exp3::PHTRareCollisionRate(
+    uint64_t prune_size, uint64_t occupancy_size,
+    const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats,
+    uint64_t counter_bits, uint64_t bias) {
 #ifdef EVALUATION
-    std::cout << "== exp3: BTBCollisionRate ==" << std::endl;
+  std::cout << "== exp3: PHTRareCollisionRate ==" << std::endl;
 #endif
-    std::vector<std::vector<uint64_t>> collision_stats;
-    uint64_t occupancy_size = 4096;
-    for (uint64_t num_accesses = 1000; num_accesses <= max_branch_accesses;
-         num_accesses += 1000) {
-      NUMBER_MAX_BRANCHES = num_accesses;
+  ResultHeader table =
+      header.table("exp3/PHTRareCollisionRate", "num_accesses", 3);
+  table.params = "prune_size=" + std::to_string(prune_size) +
+                 ",occupancy_size=" + std::to_string(occupancy_size) +
+                 ",counter_bits=" + std::to_string(counter_bits) +
+                 ",bias=" + std::to_string(bias);
+  addScheduleParams(table.params, schedule);
+  Sweep sweep(writer, journal, cache, progress, table, branch_accesses_num,
+              max_repeats,
+              bpus->lookupCounter());
+  // simulate the attack
+  return sweep.run([&](const SweepCell &cell) {
+    uint64_t type = bpus->getType(cell.predictor);
+    NUMBER_MAX_BRANCHES = cell.key;
+    if (cell.fresh) {
+      bpus->reset(type);
+    }
+    std::pair<std::vector<uint64_t>, uint64_t> res = bpus->PHTOccupancy(
+        type, 1e9, counter_bits, prune_size, occupancy_size);
+    // draw the victim towards the sets of the occupancy set
+    std::vector<bool> sets(counter_nums, false);
+    std::vector<uint64_t> occupied;
+    bpus->getPHTSets(type, res.first, SecurityDomain::DOM_ATTACKER, occupied);
+    for (auto &set : occupied) {
+      sets[set] = true;
+    }
+    std::pair<uint64_t, double> victim =
+        drawVictim(sets, bias, [&](uint64_t addr) {
+          return bpus->getPHTSet(type, addr, SecurityDomain::DOM_VICTIM);
+        });
+    // check collision probability
+    for (auto &addr : res.first) {
+      if (bpus->checkPHTSetCollision(type, addr, SecurityDomain::DOM_ATTACKER,
+                                     victim.first,
+                                     SecurityDomain::DOM_VICTIM)) {
+        return rareValues(true, victim.second);
+      }
+    }
+    return rareValues(false, victim.second);
+  });
+}
+
+// experiment: BTB collision rate under different occupancy size, estimated
+// by importance sampling over the victim address (see drawVictim)
+std::vector<std::vector<uint64_t>> Exp3::BTBRareCollisionRate(
+    uint64_t prune_size, uint64_t occupancy_size,
+    const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats,
+    uint64_t bias) {
 #ifdef EVALUATION
-      std::cout << "BTBCollisionRate: " << num_accesses << std::endl;
+  std::cout << "== exp3: BTBRareCollisionRate ==" << std::endl;
 #endif
-      uint64_t victim_addr = secrets[0];
-      // statistics
-      std::vector<uint64_t> collision_stat(7, 0);
-      // simulate the attack
-      for (int i = 0; i < max_repeats; i++) {
-        std::pair<std::vector<uint64_t>, uint64_t> res_base =
-            base_bpu->BTBOccupancy(1e9, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_bsup =
-            bsup->BTBOccupancy(1e9, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_xorbp =
-            xorbp->BTBOccupancy(1e9, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_noisyxorbp =
-            noisyxorbp->BTBOccupancy(1e9, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_lsbp =
-            lsbp->BTBOccupancy(1e9, prune_size, occupancy_size, attacker_pid);
-        std::pair<std::vector<uint64_t>, uint64_t> res_stbpu =
-            stbpu->BTBOccupancy(1e9, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_hybp =
-            hybp->BTBOccupancy(1e9, prune_size, occupancy_size);
-        // check collision probability: base
-        for (auto &addr : res_base.first) {
-          base_bpu->lookupBTB(addr, addr);
-        }
-        base_bpu->lookupBTB(victim_addr, victim_addr);
-        for (auto &addr : res_base.first) {
-          if (base_bpu->lookupBTB(addr, addr) == -1) {
-            collision_stat[0]++;
-            break;
-          }
-        }
-        // check collision probability: bsup
-        for (auto &addr : res_bsup.first) {
-          bsup->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER);
-        }
-        bsup->lookupBTB(victim_addr, victim_addr, SecurityDomain::DOM_VICTIM);
-        for (auto &addr : res_bsup.first) {
-          if (bsup->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER) == -1) {
-            collision_stat[1]++;
-            break;
-          }
-        }
-        // check collision probability: xorbp
-        for (auto &addr : res_xorbp.first) {
-          xorbp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER);
-        }
-        xorbp->lookupBTB(victim_addr, victim_addr, SecurityDomain::DOM_VICTIM);
-        for (auto &addr : res_xorbp.first) {
-          if (xorbp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER) ==
-              -1) {
-            collision_stat[2]++;
-            break;
-          }
-        }
-        // check collision probability: noisyxorbp
-        for (auto &addr : res_noisyxorbp.first) {
-          noisyxorbp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER);
-        }
-        noisyxorbp->lookupBTB(victim_addr, victim_addr,
-                              SecurityDomain::DOM_VICTIM);
-        for (auto &addr : res_noisyxorbp.first) {
-          if (noisyxorbp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER) ==
-              -1) {
-            collision_stat[3]++;
-            break;
-          }
-        }
-        // check collision probability: lsbp
-        for (auto &addr : res_lsbp.first) {
-          lsbp->lookupBTB(addr, addr, attacker_pid,
-                          SecurityDomain::DOM_ATTACKER);
-        }
-        lsbp->lookupBTB(victim_addr, victim_addr, victim_pid,
-                        SecurityDomain::DOM_VICTIM);
-        for (auto &addr : res_lsbp.first) {
-          if (lsbp->lookupBTB(addr, addr, attacker_pid,
-                              SecurityDomain::DOM_ATTACKER) == -1) {
-            collision_stat[4]++;
-            break;
-          }
-        }
-        // check collision probability: stbpu
-        for (auto &addr : res_stbpu.first) {
-          stbpu->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER);
-        }
-        stbpu->lookupBTB(victim_addr, victim_addr, SecurityDomain::DOM_VICTIM);
-        for (auto &addr : res_stbpu.first) {
-          if (stbpu->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER) ==
-              -1) {
-            collision_stat[5]++;
-            break;
-          }
-        }
-        // check collision probability: hybp
-        for (auto &addr : res_hybp.first) {
-          hybp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER);
-        }
-        hybp->lookupBTB(victim_addr, victim_addr, SecurityDomain::DOM_VICTIM);
-        for (auto &addr : res_hybp.first) {
-          if (hybp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER) == -1) {
-            collision_stat[6]++;
-            break;
-          }
-        }
-      }
-      collision_stats.push_back(collision_stat);
-      for (int j = 0; j < collision_stat.size(); j++) {
-        std::cerr << collision_stat[j] << " ";
+  ResultHeader table =
+      header.table("exp3/BTBRareCollisionRate", "num_accesses", 3);
+  table.params = "prune_size=" + std::to_string(prune_size) +
+                 ",occupancy_size=" + std::to_string(occupancy_size) +
+                 ",bias=" + std::to_string(bias);
+  addScheduleParams(table.params, schedule);
+  Sweep sweep(writer, journal, cache, progress, table, branch_accesses_num,
+              max_repeats,
+              bpus->lookupCounter());
+  // simulate the attack
+  return sweep.run([&](const SweepCell &cell) {
+    uint64_t type = bpus->getType(cell.predictor);
+    NUMBER_MAX_BRANCHES = cell.key;
+    if (cell.fresh) {
+      bpus->reset(type);
+    }
+    std::pair<std::vector<uint64_t>, uint64_t> res =
+        bpus->BTBOccupancy(type, 1e9, prune_size, occupancy_size);
+    // draw the victim towards the sets of the occupancy set
+    std::vector<bool> sets(buffer_sets, false);
+    std::vector<uint64_t> occupied;
+    bpus->getBTBSets(type, res.first, SecurityDomain::DOM_ATTACKER, occupied);
+    for (auto &set : occupied) {
+      sets[set] = true;
+    }
+    std::pair<uint64_t, double> victim =
+        drawVictim(sets, bias, [&](uint64_t addr) {
+          return bpus->getBTBSet(type, addr, SecurityDomain::DOM_VICTIM);
+        });
+    // check collision probability
+    for (auto &addr : res.first) {
+      bpus->lookupBTB(type, addr, addr, SecurityDomain::DOM_ATTACKER);
+    }
+    bpus->lookupBTB(type, victim.first, victim.first,
+                    SecurityDomain::DOM_VICTIM);
+    for (auto &addr : res.first) {
+      if (bpus->lookupBTB(type, addr, addr, SecurityDomain::DOM_ATTACKER) ==
+          -1) {
+        return rareValues(true, victim.second);
       }
-      std::cerr << std::endl;
     }
-    return collision_stats;
-  }
-};
\ No newline at end of file
+    return rareValues(false, victim.second);
+  });
+}
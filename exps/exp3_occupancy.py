@@ -35,7 +35,7 @@ def exp3_pht_pruning_access():
     num_repeats = global_num_repeats
     num_pruning_sizes = 100
     # execute the binary
-    cmd = "{} occupancy-pht-prune {} {} 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file)
+    cmd = "{} occupancy-pht-prune {} {} --journal {}.journal --resume 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file, output_file)
     os.system(cmd)
 
 def exp3_btb_pruning_access():
@@ -49,7 +49,7 @@ def exp3_btb_pruning_access():
     num_repeats = global_num_repeats
     num_pruning_sizes = 4000
     # execute the binary
-    cmd = "{} occupancy-btb-prune {} {} 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file)
+    cmd = "{} occupancy-btb-prune {} {} --journal {}.journal --resume 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file, output_file)
     os.system(cmd)
 
 def exp3_pht_collision_rate():
@@ -63,7 +63,7 @@ def exp3_pht_collision_rate():
     num_repeats = global_num_repeats
     num_pruning_sizes = 20
     # execute the binary
-    cmd = "{} occupancy-pht-collision {} {} 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file)
+    cmd = "{} occupancy-pht-collision {} {} --journal {}.journal --resume 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file, output_file)
     os.system(cmd)
 
 def exp3_btb_collision_rate():
@@ -77,7 +77,7 @@ def exp3_btb_collision_rate():
     num_repeats = global_num_repeats
     num_pruning_sizes = 600
     # execute the binary
-    cmd = "{} occupancy-btb-collision {} {} 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file)
+    cmd = "{} occupancy-btb-collision {} {} --journal {}.journal --resume 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file, output_file)
     os.system(cmd)
 
 # execute the experiment (multi-threading)
@@ -19,355 +19,362 @@
 // author: iamywang
 // date: 2024/12/31
 // =============================================================================
+#include "include/exps/exp4_leakage.hpp"
+
 #include <cstdint>
+#include <functional>
 #include <iostream>
+#include <string>
+#include <utility>
 #include <vector>
 
-#include "include/predictors/BSUP.hpp"
-#include "include/predictors/BaseBPU.hpp"
-#include "include/predictors/HyBP.hpp"
-#include "include/predictors/LSBP.hpp"
-#include "include/predictors/NoisyXorBP.hpp"
-#include "include/predictors/STBPU.hpp"
-#include "include/predictors/XorBP.hpp"
+#include "include/predictors/BPUSet.hpp"
+#include "include/utils/Journal.hpp"
+#include "include/utils/Leakage.hpp"
+#include "include/utils/Progress.hpp"
+#include "include/utils/ResultCache.hpp"
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Scheduler.hpp"
+#include "include/utils/Spec.hpp"
+#include "include/utils/Sweep.hpp"
 #include "include/utils/Utils.hpp"
 
-class Exp4 {
- private:
-  std::vector<uint64_t> secrets;
-  BaseBPU *base_bpu;
-  BSUP *bsup;
-  XorBP *xorbp;
-  NoisyXorBP *noisyxorbp;
-  LSBP *lsbp;
-  STBPU *stbpu;
-  HyBP *hybp;
+// number of bins of a leakage histogram
+#define LEAKAGE_BINS 9
 
-  uint64_t attacker_pid;
-  uint64_t victim_pid;
+// trials of a row before its leakage may count as converged
+#define LEAKAGE_MIN_TRIALS 100
 
- public:
-  Exp4(uint64_t counter_bits, uint64_t counter_nums, uint64_t buffer_ways,
-       uint64_t buffer_sets, uint64_t secret_size, uint64_t addr_space = 32) {
-    srand(time(NULL));
-    // init branch predictors
-    base_bpu = new BaseBPU(addr_space);
-    base_bpu->initPHT(counter_bits, counter_nums);
-    base_bpu->initBTB(buffer_ways, buffer_sets);
+// one-hot histogram row of a trial, an index past the last bin counts in
+// the last bin (the original loops wrote it into the bins of the next
+// predictor, which no row of exps/output_ref does)
+std::vector<uint64_t> Exp4::histogram(uint64_t idx) {
+  std::vector<uint64_t> leakage_stat(LEAKAGE_BINS, 0);
+  if (idx >= LEAKAGE_BINS) {
+    idx = LEAKAGE_BINS - 1;
+  }
+  leakage_stat[idx]++;
+  return leakage_stat;
+}
 
-    bsup = new BSUP(addr_space);
-    bsup->initPHT(3, counter_nums);
-    bsup->initBTB(buffer_ways, buffer_sets);
+// joint counts of a predictor
+uint64_t Exp4::jointSize() {
+  return (1ULL << secrets.size()) * (secrets.size() + 1);
+}
 
-    xorbp = new XorBP(addr_space);
-    xorbp->initPHT(counter_bits, counter_nums);
-    xorbp->initBTB(buffer_ways, buffer_sets);
+// one-hot joint row of a trial, 2^secrets * (secrets + 1) cells of the
+// executed subset (a bit mask of the secrets) and the observation, from 0
+// to secrets
+std::vector<uint64_t> Exp4::joint(uint64_t executed, uint64_t observation) {
+  uint64_t observations = secrets.size() + 1;
+  std::vector<uint64_t> joint_stat(jointSize(), 0);
+  if (observation >= observations) {
+    observation = observations - 1;
+  }
+  joint_stat[executed * observations + observation]++;
+  return joint_stat;
+}
 
-    noisyxorbp = new NoisyXorBP(addr_space);
-    noisyxorbp->initPHT(counter_bits, counter_nums);
-    noisyxorbp->initBTB(buffer_ways, buffer_sets);
+// estimators of the predictors from the joint counts of a row
+std::vector<LeakageEstimator> Exp4::estimators(
+    const std::vector<uint64_t> &stat) {
+  std::vector<LeakageEstimator> estimates;
+  for (uint64_t i = 0; i < header.predictors.size(); i++) {
+    estimates.emplace_back(1ULL << secrets.size(), secrets.size() + 1);
+    estimates.back().add(&stat[i * jointSize()]);
+  }
+  return estimates;
+}
 
-    lsbp = new LSBP(addr_space);
-    lsbp->initPHT(counter_bits, counter_nums);
-    lsbp->initBTB(buffer_ways, buffer_sets);
-#ifdef RANDOM_PID
-    attacker_pid = rand() & 0xFFFFFFFF;
-    victim_pid = rand() & 0xFFFFFFFF;
-#else
-    attacker_pid = ProcessorPID::PID_ATTACKER;
-    victim_pid = ProcessorPID::PID_VICTIM;
-#endif
+// convergence test of a row: the confidence intervals of all predictors
+// are at most twice the tolerance (in thousandths of a bit), none if the
+// tolerance is 0
+std::function<bool(const std::vector<uint64_t> &)> Exp4::stopRule(
+    uint64_t tolerance) {
+  if (tolerance == 0) {
+    return nullptr;
+  }
+  return [this, tolerance](const std::vector<uint64_t> &stat) {
+    for (const LeakageEstimator &estimate : estimators(stat)) {
+      std::pair<double, double> bounds = estimate.bounds();
+      if (estimate.getTrials() < LEAKAGE_MIN_TRIALS ||
+          (bounds.second - bounds.first) * 1000 > 2 * tolerance) {
+        return false;
+      }
+    }
+    return true;
+  };
+}
 
-    stbpu = new STBPU(addr_space);
-    stbpu->initPHT(counter_bits, counter_nums);
-    stbpu->initBTB(buffer_ways, buffer_sets);
+// leakage of every predictor in every row, in bits and bits per access, and
+// the capacity of its channel
+void Exp4::report(const std::string &experiment,
+                  const std::vector<uint64_t> &branch_accesses_num,
+                  const std::vector<std::vector<uint64_t>> &stats) {
+  for (uint64_t row = 0; row < stats.size(); row++) {
+    std::vector<LeakageEstimator> estimates = estimators(stats[row]);
+    for (uint64_t i = 0; i < estimates.size(); i++) {
+      const LeakageEstimator &estimate = estimates[i];
+      std::pair<double, double> bounds = estimate.bounds();
+      std::cout << experiment << ": " << branch_accesses_num[row] << " "
+                << header.predictors[i]
+                << " trials=" << estimate.getTrials()
+                << " plug_in=" << estimate.plugIn()
+                << " miller_madow=" << estimate.millerMadow() << " ["
+                << bounds.first << ", " << bounds.second << "] bits, "
+                << estimate.millerMadow() / branch_accesses_num[row]
+                << " bits/access, capacity=" << estimate.capacity()
+                << " bits" << std::endl;
+    }
+  }
+}
 
-    hybp = new HyBP(addr_space);
-    hybp->initPHT(counter_bits, counter_nums);
-    hybp->initBTB(buffer_ways, buffer_sets);
+Exp4::Exp4(const std::vector<uint64_t> &types, uint64_t counter_bits,
+           uint64_t counter_nums, uint64_t buffer_ways, uint64_t buffer_sets,
+           uint64_t secret_size, uint64_t addr_space, ReplacementPolicy policy,
+           const PHTConfig &pht, const RekeyConfig &rekey,
+           const CipherConfig &cipher, const BTBConfig &btb,
+           uint64_t offset_pht, uint64_t offset_btb,
+           const AttackSchedule &schedule)
+    : schedule(schedule) {
+  // init the selected branch predictors only, with a domain per noise tenant
+  bpus = new BPUSet(types, counter_bits, counter_nums, buffer_ways,
+                    buffer_sets, addr_space, policy, pht, rekey, cipher, btb,
+                    NUM_ATTACK_DOMAINS + schedule.noise, offset_pht,
+                    offset_btb);
+  bpus->setSchedule(schedule);
+  // result header
+  header.predictors = bpus->getNames();
+  header.counter_bits = counter_bits;
+  header.counter_nums = counter_nums;
+  header.buffer_ways = buffer_ways;
+  header.buffer_sets = buffer_sets;
+  header.addr_space = addr_space;
+  header.offset_pht = offset_pht;
+  header.offset_btb = offset_btb;
+  header.policy = policyName(policy);
+  header.pht = phtName(pht);
+  header.rekey = rekeyName(rekey);
+  header.cipher = cipherName(cipher);
+  header.btb = btbName(btb);
+  header.seed = RANDOM_SEED;
+  header.common_random = COMMON_RANDOM;
+  header.baseline = BASELINE;
+  header.shard_index = SHARD_INDEX;
+  header.shard_count = SHARD_COUNT;
 
-    // init secrets
-    for (int i = 0; i < secret_size; i++) {
-      secrets.push_back(rand() & 0xFFFFFFFF);
-    }
+  // init secrets
+  srand(RANDOM_SEED);
+  for (int i = 0; i < secret_size; i++) {
+    secrets.push_back(randomAddr(addrMask(addr_space)));
   }
+}
 
-  // experiment: PHT leakage under different branch access
-  std::vector<std::vector<uint64_t>> PHTLeakage(uint64_t prune_size,
-                                                uint64_t max_branch_accesses,
-                                                uint64_t max_repeats,
-                                                uint64_t counter_bits) {
-    srand(time(NULL));
+// experiment: PHT leakage under different branch access
+std::vector<std::vector<uint64_t>> Exp4::PHTLeakage(
+    uint64_t prune_size, uint64_t occupancy_size,
+    const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats,
+    uint64_t counter_bits) {
 #ifdef EVALUATION
-    std::cout << "== exp4: PHTLeakageAccess ==" << std::endl;
+  std::cout << "== exp4: PHTLeakageAccess ==" << std::endl;
 #endif
-    std::vector<std::vector<uint64_t>> leakage_stats;
-    uint64_t occupancy_size = 1024;
-    for (uint64_t num_accesses = 1000; num_accesses <= max_branch_accesses;
-         num_accesses += 1000) {
-      NUMBER_MAX_BRANCHES = num_accesses;
+  ResultHeader table =
+      header.table("exp4/PHTLeakage", "num_accesses", LEAKAGE_BINS);
+  table.params = "prune_size=" + std::to_string(prune_size) +
+                 ",occupancy_size=" + std::to_string(occupancy_size) +
+                 ",counter_bits=" + std::to_string(counter_bits) +
+                 ",secrets=" + std::to_string(secrets.size());
+  addScheduleParams(table.params, schedule);
+  Sweep sweep(writer, journal, cache, progress, table, branch_accesses_num,
+              max_repeats,
+              bpus->lookupCounter());
+  // simulate the attack
+  return sweep.run([&](const SweepCell &cell) {
+    uint64_t type = bpus->getType(cell.predictor);
+    NUMBER_MAX_BRANCHES = cell.key;
+    if (cell.fresh) {
+      bpus->reset(type);
+    }
+    std::pair<std::vector<uint64_t>, uint64_t> res = bpus->PHTOccupancy(
+        type, 1e9, counter_bits, prune_size, occupancy_size);
+    // check collision probability
+    uint64_t collision_misses = 0;
+    for (auto &addr : res.first) {
+      for (uint64_t secret_idx = 0; secret_idx < secrets.size();
+           secret_idx++) {
+        if (bpus->checkPHTSetCollision(type, addr,
+                                       SecurityDomain::DOM_ATTACKER,
+                                       secrets[secret_idx],
+                                       SecurityDomain::DOM_VICTIM)) {
+          collision_misses++;
+          break;
+        }
+      }
+    }
+    return histogram(collision_misses);
+  });
+}
+
+// experiment: BTB leakage under different branch access
+std::vector<std::vector<uint64_t>> Exp4::BTBLeakage(
+    uint64_t prune_size, uint64_t occupancy_size,
+    const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats) {
 #ifdef EVALUATION
-      std::cout << "PHTLeakageAccess: " << num_accesses << std::endl;
+  std::cout << "== exp4: BTBLeakageAccess ==" << std::endl;
 #endif
-      // statistics
-      std::vector<uint64_t> leakage_stat(7 * 9, 0);
-      // simulate the attack
-      for (int i = 0; i < max_repeats; i++) {
-        std::pair<std::vector<uint64_t>, uint64_t> res_base =
-            base_bpu->PHTOccupancy(1e9, counter_bits, prune_size,
-                                   occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_bsup =
-            bsup->PHTOccupancy(1e9, 3, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_xorbp =
-            xorbp->PHTOccupancy(1e9, counter_bits, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_noisyxorbp =
-            noisyxorbp->PHTOccupancy(1e9, counter_bits, prune_size,
-                                     occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_lsbp =
-            lsbp->PHTOccupancy(1e9, counter_bits, prune_size, occupancy_size,
-                               attacker_pid);
-        std::pair<std::vector<uint64_t>, uint64_t> res_stbpu =
-            stbpu->PHTOccupancy(1e9, counter_bits, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_hybp =
-            hybp->PHTOccupancy(1e9, counter_bits, prune_size, occupancy_size);
+  ResultHeader table =
+      header.table("exp4/BTBLeakage", "num_accesses", LEAKAGE_BINS);
+  table.params = "prune_size=" + std::to_string(prune_size) +
+                 ",occupancy_size=" + std::to_string(occupancy_size) +
+                 ",secrets=" + std::to_string(secrets.size());
+  addScheduleParams(table.params, schedule);
+  Sweep sweep(writer, journal, cache, progress, table, branch_accesses_num,
+              max_repeats,
+              bpus->lookupCounter());
+  // simulate the attack
+  return sweep.run([&](const SweepCell &cell) {
+    uint64_t type = bpus->getType(cell.predictor);
+    NUMBER_MAX_BRANCHES = cell.key;
+    if (cell.fresh) {
+      bpus->reset(type);
+    }
+    std::pair<std::vector<uint64_t>, uint64_t> res =
+        bpus->BTBOccupancy(type, 1e9, prune_size, occupancy_size);
+    // check collision probability
+    uint64_t collision_misses = 0;
+    for (auto &addr : res.first) {
+      bpus->lookupBTB(type, addr, addr, SecurityDomain::DOM_ATTACKER);
+    }
+    for (auto &secret : secrets) {
+      bpus->lookupBTB(type, secret, secret, SecurityDomain::DOM_VICTIM);
+    }
+    for (auto &addr : res.first) {
+      if (bpus->lookupBTB(type, addr, addr, SecurityDomain::DOM_ATTACKER) ==
+          -1) {
+        collision_misses++;
+      }
+    }
+    uint64_t idx = collision_misses / 4;
+    if (idx >= secrets.size()) {
+      idx = secrets.size();
+    }
+    return histogram(idx);
+  });
+}
 
-        std::vector<uint64_t> collision_misses(7, 0);
-        // check collision probability: base
-        for (auto &addr : res_base.first) {
-          for (uint64_t secret_idx = 0; secret_idx < secrets.size();
-               secret_idx++) {
-            if (base_bpu->checkPHTSetCollision(addr, secrets[secret_idx])) {
-              collision_misses[0]++;
-              break;
-            }
-          }
-        }
-        // check collision probability: bsup
-        for (auto &addr : res_bsup.first) {
-          for (uint64_t secret_idx = 0; secret_idx < secrets.size();
-               secret_idx++) {
-            if (bsup->checkPHTSetCollision(addr, SecurityDomain::DOM_ATTACKER,
-                                           secrets[secret_idx],
-                                           SecurityDomain::DOM_VICTIM)) {
-              collision_misses[1]++;
-              break;
-            }
-          }
-        }
-        // check collision probability: xorbp
-        for (auto &addr : res_xorbp.first) {
-          for (uint64_t secret_idx = 0; secret_idx < secrets.size();
-               secret_idx++) {
-            if (xorbp->checkPHTSetCollision(addr, SecurityDomain::DOM_ATTACKER,
-                                            secrets[secret_idx],
-                                            SecurityDomain::DOM_VICTIM)) {
-              collision_misses[2]++;
-              break;
-            }
-          }
-        }
-        // check collision probability: noisyxorbp
-        for (auto &addr : res_noisyxorbp.first) {
-          for (uint64_t secret_idx = 0; secret_idx < secrets.size();
-               secret_idx++) {
-            if (noisyxorbp->checkPHTSetCollision(
-                    addr, SecurityDomain::DOM_ATTACKER, secrets[secret_idx],
-                    SecurityDomain::DOM_VICTIM)) {
-              collision_misses[3]++;
-              break;
-            }
-          }
+// experiment: mutual information between the secrets executed by the
+// victim and the PHT collisions observed by the attacker. Every trial the
+// victim executes a uniform random subset of the secrets, which is the
+// secret of the joint counts (see joint): the keys are fixed, so subsets
+// of the same size are not interchangeable. A row ends early once the
+// leakage of every predictor is known to -/+ tolerance thousandths of a
+// bit (0: all repeats).
+std::vector<std::vector<uint64_t>> Exp4::PHTMutualInfo(
+    uint64_t prune_size, uint64_t occupancy_size,
+    const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats,
+    uint64_t counter_bits, uint64_t tolerance) {
+#ifdef EVALUATION
+  std::cout << "== exp4: PHTMutualInfo ==" << std::endl;
+#endif
+  ResultHeader table =
+      header.table("exp4/PHTMutualInfo", "num_accesses", jointSize());
+  table.params = "prune_size=" + std::to_string(prune_size) +
+                 ",occupancy_size=" + std::to_string(occupancy_size) +
+                 ",counter_bits=" + std::to_string(counter_bits) +
+                 ",secrets=" + std::to_string(secrets.size());
+  addScheduleParams(table.params, schedule);
+  Sweep sweep(writer, journal, cache, progress, table, branch_accesses_num,
+              max_repeats,
+              bpus->lookupCounter());
+  // simulate the attack
+  std::vector<std::vector<uint64_t>> stats = sweep.run(
+      [&](const SweepCell &cell) {
+        uint64_t type = bpus->getType(cell.predictor);
+        NUMBER_MAX_BRANCHES = cell.key;
+        if (cell.fresh) {
+          bpus->reset(type);
         }
-        // check collision probability: lsbp
-        for (auto &addr : res_lsbp.first) {
+        // draw the executed secrets before the attack draws
+        uint64_t executed = rand() & ((1ULL << secrets.size()) - 1);
+        std::pair<std::vector<uint64_t>, uint64_t> res = bpus->PHTOccupancy(
+            type, 1e9, counter_bits, prune_size, occupancy_size);
+        // check collisions with the executed secrets
+        uint64_t collision_misses = 0;
+        for (auto &addr : res.first) {
           for (uint64_t secret_idx = 0; secret_idx < secrets.size();
                secret_idx++) {
-            if (lsbp->checkPHTSetCollision(addr, attacker_pid,
+            if ((executed >> secret_idx & 1) &&
+                bpus->checkPHTSetCollision(type, addr,
                                            SecurityDomain::DOM_ATTACKER,
-                                           secrets[secret_idx], victim_pid,
-                                           SecurityDomain::DOM_VICTIM)) {
-              collision_misses[4]++;
-              break;
-            }
-          }
-        }
-        // check collision probability: stbpu
-        for (auto &addr : res_stbpu.first) {
-          for (uint64_t secret_idx = 0; secret_idx < secrets.size();
-               secret_idx++) {
-            if (stbpu->checkPHTSetCollision(addr, SecurityDomain::DOM_ATTACKER,
-                                            secrets[secret_idx],
-                                            SecurityDomain::DOM_VICTIM)) {
-              collision_misses[5]++;
-              break;
-            }
-          }
-        }
-        // check collision probability: hybp
-        for (auto &addr : res_hybp.first) {
-          for (uint64_t secret_idx = 0; secret_idx < secrets.size();
-               secret_idx++) {
-            if (hybp->checkPHTSetCollision(addr, SecurityDomain::DOM_ATTACKER,
                                            secrets[secret_idx],
                                            SecurityDomain::DOM_VICTIM)) {
-              collision_misses[6]++;
+              collision_misses++;
               break;
             }
           }
         }
-        for (int j = 0; j < 7; j++) {
-          leakage_stat[j * 9 + collision_misses[j]]++;
-        }
-      }
-      leakage_stats.push_back(leakage_stat);
-      for (int j = 0; j < leakage_stat.size(); j++) {
-        std::cerr << leakage_stat[j] << " ";
-      }
-      std::cerr << std::endl;
-    }
-    return leakage_stats;
-  }
-
-  // experiment: BTB leakage under different branch access
-  std::vector<std::vector<uint64_t>> BTBLeakage(uint64_t prune_size,
-                                                uint64_t max_branch_accesses,
-                                                uint64_t max_repeats) {
-    srand(time(NULL));
+        return joint(executed, collision_misses);
+      },
+      false, stopRule(tolerance));
 #ifdef EVALUATION
-    std::cout << "== exp4: BTBLeakageAccess ==" << std::endl;
+  report(table.experiment, branch_accesses_num, stats);
 #endif
-    std::vector<std::vector<uint64_t>> leakage_stats;
-    uint64_t occupancy_size = 4096;
-    for (uint64_t num_accesses = 1000; num_accesses <= max_branch_accesses;
-         num_accesses += 1000) {
-      NUMBER_MAX_BRANCHES = num_accesses;
+  return stats;
+}
+
+// experiment: mutual information between the secrets executed by the
+// victim and the BTB misses of the attacker (see PHTMutualInfo)
+std::vector<std::vector<uint64_t>> Exp4::BTBMutualInfo(
+    uint64_t prune_size, uint64_t occupancy_size,
+    const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats,
+    uint64_t tolerance) {
 #ifdef EVALUATION
-      std::cout << "BTBLeakageAccess: " << num_accesses << std::endl;
+  std::cout << "== exp4: BTBMutualInfo ==" << std::endl;
 #endif
-      // statistics
-      std::vector<uint64_t> leakage_stat(7 * 9, 0);
-      // simulate the attack
-      for (int i = 0; i < max_repeats; i++) {
-        std::pair<std::vector<uint64_t>, uint64_t> res_base =
-            base_bpu->BTBOccupancy(1e9, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_bsup =
-            bsup->BTBOccupancy(1e9, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_xorbp =
-            xorbp->BTBOccupancy(1e9, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_noisyxorbp =
-            noisyxorbp->BTBOccupancy(1e9, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_lsbp =
-            lsbp->BTBOccupancy(1e9, prune_size, occupancy_size, attacker_pid);
-        std::pair<std::vector<uint64_t>, uint64_t> res_stbpu =
-            stbpu->BTBOccupancy(1e9, prune_size, occupancy_size);
-        std::pair<std::vector<uint64_t>, uint64_t> res_hybp =
-            hybp->BTBOccupancy(1e9, prune_size, occupancy_size);
-
-        std::vector<uint64_t> collision_misses(7, 0);
-        // check collision probability: base
-        for (auto &addr : res_base.first) {
-          base_bpu->lookupBTB(addr, addr);
-        }
-        for (auto &secret : secrets) {
-          base_bpu->lookupBTB(secret, secret);
-        }
-        for (auto &addr : res_base.first) {
-          if (base_bpu->lookupBTB(addr, addr) == -1) {
-            collision_misses[0]++;
-          }
-        }
-        // check collision probability: bsup
-        for (auto &addr : res_bsup.first) {
-          bsup->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER);
-        }
-        for (auto &secret : secrets) {
-          bsup->lookupBTB(secret, secret, SecurityDomain::DOM_VICTIM);
+  ResultHeader table =
+      header.table("exp4/BTBMutualInfo", "num_accesses", jointSize());
+  table.params = "prune_size=" + std::to_string(prune_size) +
+                 ",occupancy_size=" + std::to_string(occupancy_size) +
+                 ",secrets=" + std::to_string(secrets.size());
+  addScheduleParams(table.params, schedule);
+  Sweep sweep(writer, journal, cache, progress, table, branch_accesses_num,
+              max_repeats,
+              bpus->lookupCounter());
+  // simulate the attack
+  std::vector<std::vector<uint64_t>> stats = sweep.run(
+      [&](const SweepCell &cell) {
+        uint64_t type = bpus->getType(cell.predictor);
+        NUMBER_MAX_BRANCHES = cell.key;
+        if (cell.fresh) {
+          bpus->reset(type);
         }
-        for (auto &addr : res_bsup.first) {
-          if (bsup->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER) == -1) {
-            collision_misses[1]++;
-          }
-        }
-        // check collision probability: xorbp
-        for (auto &addr : res_xorbp.first) {
-          xorbp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER);
-        }
-        for (auto &secret : secrets) {
-          xorbp->lookupBTB(secret, secret, SecurityDomain::DOM_VICTIM);
-        }
-        for (auto &addr : res_xorbp.first) {
-          if (xorbp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER) ==
-              -1) {
-            collision_misses[2]++;
-          }
-        }
-        // check collision probability: noisyxorbp
-        for (auto &addr : res_noisyxorbp.first) {
-          noisyxorbp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER);
-        }
-        for (auto &secret : secrets) {
-          noisyxorbp->lookupBTB(secret, secret, SecurityDomain::DOM_VICTIM);
+        // draw the executed secrets before the attack draws
+        uint64_t executed = rand() & ((1ULL << secrets.size()) - 1);
+        std::pair<std::vector<uint64_t>, uint64_t> res =
+            bpus->BTBOccupancy(type, 1e9, prune_size, occupancy_size);
+        // the victim executes its secrets between prime and probe
+        uint64_t collision_misses = 0;
+        for (auto &addr : res.first) {
+          bpus->lookupBTB(type, addr, addr, SecurityDomain::DOM_ATTACKER);
         }
-        for (auto &addr : res_noisyxorbp.first) {
-          if (noisyxorbp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER) ==
-              -1) {
-            collision_misses[3]++;
+        for (uint64_t secret_idx = 0; secret_idx < secrets.size();
+             secret_idx++) {
+          if (executed >> secret_idx & 1) {
+            bpus->lookupBTB(type, secrets[secret_idx], secrets[secret_idx],
+                            SecurityDomain::DOM_VICTIM);
           }
         }
-        // check collision probability: lsbp
-        for (auto &addr : res_lsbp.first) {
-          lsbp->lookupBTB(addr, addr, attacker_pid,
-                          SecurityDomain::DOM_ATTACKER);
-        }
-        for (auto &secret : secrets) {
-          lsbp->lookupBTB(secret, secret, victim_pid,
-                          SecurityDomain::DOM_VICTIM);
-        }
-        for (auto &addr : res_lsbp.first) {
-          if (lsbp->lookupBTB(addr, addr, attacker_pid,
+        for (auto &addr : res.first) {
+          if (bpus->lookupBTB(type, addr, addr,
                               SecurityDomain::DOM_ATTACKER) == -1) {
-            collision_misses[4]++;
-          }
-        }
-        // check collision probability: stbpu
-        for (auto &addr : res_stbpu.first) {
-          stbpu->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER);
-        }
-        for (auto &secret : secrets) {
-          stbpu->lookupBTB(secret, secret, SecurityDomain::DOM_VICTIM);
-        }
-        for (auto &addr : res_stbpu.first) {
-          if (stbpu->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER) ==
-              -1) {
-            collision_misses[5]++;
+            collision_misses++;
           }
         }
-        // check collision probability: hybp
-        for (auto &addr : res_hybp.first) {
-          hybp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER);
-        }
-        for (auto &secret : secrets) {
-          hybp->lookupBTB(secret, secret, SecurityDomain::DOM_VICTIM);
-        }
-        for (auto &addr : res_hybp.first) {
-          if (hybp->lookupBTB(addr, addr, SecurityDomain::DOM_ATTACKER) == -1) {
-            collision_misses[6]++;
-          }
-        }
-        for (int j = 0; j < 7; j++) {
-          uint64_t idx = collision_misses[j] / 4;
-          if (idx >= secrets.size()) {
-            idx = secrets.size();
-          }
-          leakage_stat[j * 9 + idx]++;
-        }
-      }
-      leakage_stats.push_back(leakage_stat);
-      for (int j = 0; j < leakage_stat.size(); j++) {
-        std::cerr << leakage_stat[j] << " ";
-      }
-      std::cerr << std::endl;
-    }
-    return leakage_stats;
-  }
-};
\ No newline at end of file
+        return joint(executed, collision_misses / 4);
+      },
+      false, stopRule(tolerance));
+#ifdef EVALUATION
+  report(table.experiment, branch_accesses_num, stats);
+#endif
+  return stats;
+}
@@ -35,7 +35,7 @@ def exp4_pht_access(secret_size):
     num_repeats = global_num_repeats
     num_pruning_sizes = secret_size
     # execute the binary
-    cmd = "{} leakage-pht {} {} 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file)
+    cmd = "{} leakage-pht {} {} --journal {}.journal --resume 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file, output_file)
     os.system(cmd)
 
 def exp4_btb_access(secret_size):
@@ -49,7 +49,7 @@ def exp4_btb_access(secret_size):
     num_repeats = global_num_repeats
     num_pruning_sizes = secret_size
     # execute the binary
-    cmd = "{} leakage-btb {} {} 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file)
+    cmd = "{} leakage-btb {} {} --journal {}.journal --resume 2> {}".format(bin_file, num_pruning_sizes, num_repeats, output_file, output_file)
     os.system(cmd)
 
 # execute the experiment (multi-threading)
@@ -0,0 +1,394 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/exps/exp5_trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "include/predictors/BPUSet.hpp"
+#include "include/utils/Counters.hpp"
+#include "include/utils/PerfEvents.hpp"
+#include "include/utils/Progress.hpp"
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Spec.hpp"
+#include "include/utils/Trace.hpp"
+#include "include/utils/Utils.hpp"
+
+// values of a predictor in every window of the trace:
+// pht_lookups, pht_correct, btb_lookups, btb_hits, btb_mispredicts,
+// btb_misses, pht_valid, btb_valid, pht_interference, btb_interference
+#define TRACE_COLUMNS 10
+
+// branches decoded at once
+#define TRACE_CHUNK 4096
+
+// outcome of a table that was not looked up
+#define NO_LOOKUP -2
+
+// replay a branch, conditional branches look up the PHT and, if taken, the
+// BTB; jumps, calls and returns look up the BTB. Every record of a lookup
+// stream is a single PHT or BTB lookup.
+void Exp5::replay(BPUSet *set, uint64_t type, const TraceRecord &record,
+                  int &pht, int &btb) {
+  pht = NO_LOOKUP;
+  btb = NO_LOOKUP;
+  if (record.kind == BranchKind::BR_COND) {
+    pht = set->lookupPHT(type, record.pc, record.taken, record.domain);
+    if (!record.taken || lookup_stream) {
+      return;
+    }
+  }
+  btb = set->lookupBTB(type, record.pc, record.target, record.domain);
+}
+
+// answer of a lookup as seen by an attack: a PHT lookup hits or
+// mispredicts (also if its counter is invalid), a BTB lookup hits,
+// mispredicts or misses
+uint64_t Exp5::answer(int pht, int btb) {
+  if (pht != NO_LOOKUP) {
+    return pht ? LookupOutcome::OUT_HIT : LookupOutcome::OUT_MISPREDICT;
+  }
+  if (btb == 1) {
+    return LookupOutcome::OUT_HIT;
+  }
+  return btb == 0 ? LookupOutcome::OUT_MISPREDICT
+                  : LookupOutcome::OUT_INVALID;
+}
+
+// answer of a recorded lookup
+uint64_t Exp5::answer(const TraceRecord &record) {
+  if (record.kind == BranchKind::BR_COND &&
+      record.outcome == LookupOutcome::OUT_INVALID) {
+    return LookupOutcome::OUT_MISPREDICT;
+  }
+  return record.outcome;
+}
+
+// predictors of the configured geometry with the given security domains
+BPUSet *Exp5::createSet(uint64_t domains) {
+  return new BPUSet(types, header.counter_bits, header.counter_nums,
+                    header.buffer_ways, header.buffer_sets, header.addr_space,
+                    policy, pht_config, rekey_config, cipher_config,
+                    btb_config, domains, header.offset_pht,
+                    header.offset_btb);
+}
+
+// give the predictors the security domains of a trace, the attacker and
+// victim keys do not depend on their number (see Domains.hpp)
+void Exp5::setDomains(uint64_t domains) {
+  if (domains <= bpus->getDomains()) {
+    return;
+  }
+  delete bpus;
+  bpus = createSet(domains);
+  for (BPUSet *set : isolated) {
+    delete set;
+  }
+  isolated.clear();
+}
+
+// clear the state of all predictors before a replay
+void Exp5::resetAll() {
+  for (uint64_t p = 0; p < bpus->size(); p++) {
+    bpus->reset(bpus->getType(p));
+    for (BPUSet *set : isolated) {
+      if (set != nullptr) {
+        set->reset(bpus->getType(p));
+      }
+    }
+  }
+}
+
+// lookups of a predictor, its private predictors included
+uint64_t Exp5::countLookups(uint64_t type) {
+  uint64_t total = bpus->getLookups(type);
+  for (BPUSet *set : isolated) {
+    if (set != nullptr) {
+      total += set->getLookups(type);
+    }
+  }
+  return total;
+}
+
+// replay a chunk of branches through a predictor, add to its window values
+void Exp5::replayChunk(uint64_t type, const TraceRecord *chunk, uint64_t count,
+                       uint64_t *values, bool interference) {
+  for (uint64_t i = 0; i < count; i++) {
+    const TraceRecord &record = chunk[i];
+    int pht, btb;
+    replay(bpus, type, record, pht, btb);
+    if (pht != NO_LOOKUP) {
+      values[0]++;
+      values[1] += pht;
+    }
+    if (btb != NO_LOOKUP) {
+      values[2]++;
+      values[3] += btb == 1;
+      values[4] += btb == 0;
+      values[5] += btb == -1;
+    }
+    // outcomes that differ from a predictor private to the domain
+    if (interference) {
+      BPUSet *&set = isolated[record.domain];
+      if (set == nullptr) {
+        set = createSet(bpus->getDomains());
+      }
+      int private_pht, private_btb;
+      replay(set, type, record, private_pht, private_btb);
+      values[8] += pht != private_pht;
+      values[9] += btb != private_btb;
+    }
+  }
+}
+
+Exp5::Exp5(const std::vector<uint64_t> &types, uint64_t counter_bits,
+           uint64_t counter_nums, uint64_t buffer_ways, uint64_t buffer_sets,
+           uint64_t addr_space, ReplacementPolicy policy, const PHTConfig &pht,
+           const RekeyConfig &rekey, const CipherConfig &cipher,
+           const BTBConfig &btb, uint64_t offset_pht, uint64_t offset_btb)
+    : types(types),
+      policy(policy),
+      pht_config(pht),
+      rekey_config(rekey),
+      cipher_config(cipher),
+      btb_config(btb) {
+  // result header
+  header.counter_bits = counter_bits;
+  header.counter_nums = counter_nums;
+  header.buffer_ways = buffer_ways;
+  header.buffer_sets = buffer_sets;
+  header.addr_space = addr_space;
+  header.offset_pht = offset_pht;
+  header.offset_btb = offset_btb;
+  header.policy = policyName(policy);
+  header.pht = phtName(pht);
+  header.rekey = rekeyName(rekey);
+  header.cipher = cipherName(cipher);
+  header.btb = btbName(btb);
+  header.seed = RANDOM_SEED;
+  header.repeats = 1;
+  // init the selected branch predictors only, with the domains of the
+  // attacks until a trace has more
+  bpus = createSet(NUM_ATTACK_DOMAINS);
+  header.predictors = bpus->getNames();
+}
+
+Exp5::~Exp5() {
+  delete bpus;
+  for (BPUSet *set : isolated) {
+    delete set;
+  }
+}
+
+// experiment: hit rate, occupancy and interference of every window of
+// branches of a trace
+bool Exp5::TraceReplay(const std::string &path, uint64_t window,
+                       bool interference,
+                       std::vector<std::vector<uint64_t>> &stats) {
+#ifdef EVALUATION
+  std::cout << "== exp5: TraceReplay ==" << std::endl;
+#endif
+  TraceReader reader(path);
+  if (!reader.open()) {
+    return false;
+  }
+  ResultHeader table =
+      header.table("exp5/TraceReplay", "branches", TRACE_COLUMNS);
+  table.params = "trace=" + path.substr(path.find_last_of('/') + 1) +
+                 ",window=" + std::to_string(window) +
+                 ",interference=" + std::to_string(interference);
+  setDomains(reader.getDomains());
+  uint64_t num_predictors = bpus->size();
+  srand(RANDOM_SEED);
+  if (interference) {
+    isolated.resize(bpus->getDomains(), nullptr);
+  }
+  lookup_stream = reader.isLookupStream();
+  resetAll();
+  if (writer != nullptr) {
+    writer->begin(table);
+  }
+  if (progress != nullptr) {
+    progress->begin(table.experiment, table.predictors,
+                    (reader.size() + window - 1) / window * num_predictors);
+  }
+  std::vector<TraceRecord> chunk(TRACE_CHUNK);
+  uint64_t replayed = 0;
+  while (replayed < reader.size() && !reader.isCorrupt()) {
+#ifdef EVALUATION
+    std::cout << table.experiment << ": " << replayed << std::endl;
+#endif
+    std::vector<uint64_t> stat(table.columns(), 0);
+    std::vector<uint64_t> lookups(num_predictors, 0);
+    std::vector<uint64_t> trial_ns(num_predictors, 0);
+    uint64_t end = std::min(replayed + window, reader.size());
+    // every chunk is decoded once and replayed through all predictors
+    while (replayed < end) {
+      uint64_t count =
+          reader.next(chunk.data(), std::min<uint64_t>(TRACE_CHUNK,
+                                                       end - replayed));
+      if (count == 0) {
+        break;
+      }
+      for (uint64_t p = 0; p < num_predictors; p++) {
+        uint64_t before = countLookups(bpus->getType(p));
+#ifdef PERF_EVENTS
+        perfBegin(table.predictors[p]);
+#endif
+        auto start = std::chrono::steady_clock::now();
+        replayChunk(bpus->getType(p), chunk.data(), count,
+                    &stat[p * TRACE_COLUMNS], interference);
+        trial_ns[p] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+#ifdef PERF_EVENTS
+        perfEnd();
+#endif
+        lookups[p] += countLookups(bpus->getType(p)) - before;
+      }
+      replayed += count;
+    }
+    // a window cut short by a malformed record is incomplete
+    if (reader.isCorrupt()) {
+      break;
+    }
+    for (uint64_t p = 0; p < num_predictors; p++) {
+      uint64_t type = bpus->getType(p);
+      stat[p * TRACE_COLUMNS + 6] = bpus->getPHTOccupancy(type);
+      stat[p * TRACE_COLUMNS + 7] = bpus->getBTBOccupancy(type);
+#ifdef COUNTERS
+      collectCounters(table.predictors[p], trial_ns[p]);
+#endif
+      if (progress != nullptr) {
+        progress->cell(p, lookups[p], trial_ns[p]);
+      }
+    }
+    if (writer != nullptr) {
+      writer->write(replayed, stat);
+    }
+    stats.push_back(stat);
+  }
+  if (writer != nullptr) {
+    writer->end();
+  }
+  if (progress != nullptr) {
+    progress->end();
+  }
+#ifdef COUNTERS
+  reportCounters(table.experiment);
+#endif
+#ifdef PERF_EVENTS
+  reportPerf(table.experiment);
+#endif
+  return !reader.isCorrupt();
+}
+
+// experiment: answer of every predictor to every lookup of a recorded
+// attack stream, and whether it differs from the recorded answer; return
+// the number of differences of every predictor in differences
+bool Exp5::StreamReplay(const std::string &path,
+                        std::vector<uint64_t> &differences) {
+#ifdef EVALUATION
+  std::cout << "== exp5: StreamReplay ==" << std::endl;
+#endif
+  TraceReader reader(path);
+  if (!reader.open()) {
+    return false;
+  }
+  if (!reader.isLookupStream()) {
+    std::cerr << "Trace: " << path << ": not a lookup stream" << std::endl;
+    return false;
+  }
+  ResultHeader table = header.table("exp5/StreamReplay", "step", 2);
+  table.params = "stream=" + path.substr(path.find_last_of('/') + 1);
+  setDomains(reader.getDomains());
+  uint64_t num_predictors = bpus->size();
+  srand(RANDOM_SEED);
+  lookup_stream = true;
+  resetAll();
+  if (writer != nullptr) {
+    writer->begin(table);
+  }
+  uint64_t num_chunks = (reader.size() + TRACE_CHUNK - 1) / TRACE_CHUNK;
+  if (progress != nullptr) {
+    progress->begin(table.experiment, table.predictors,
+                    num_chunks * num_predictors);
+  }
+  differences.assign(num_predictors, 0);
+  std::vector<uint64_t> first_difference(num_predictors, reader.size());
+  std::vector<TraceRecord> chunk(TRACE_CHUNK);
+  std::vector<std::vector<uint64_t>> rows(
+      TRACE_CHUNK, std::vector<uint64_t>(table.columns(), 0));
+  uint64_t step = 0;
+  uint64_t count;
+  while ((count = reader.next(chunk.data(), TRACE_CHUNK)) > 0) {
+    for (uint64_t p = 0; p < num_predictors; p++) {
+      uint64_t type = bpus->getType(p);
+      uint64_t before = countLookups(type);
+      auto start = std::chrono::steady_clock::now();
+      for (uint64_t i = 0; i < count; i++) {
+        int pht, btb;
+        replay(bpus, type, chunk[i], pht, btb);
+        uint64_t outcome = answer(pht, btb);
+        bool differs = outcome != answer(chunk[i]);
+        rows[i][p * 2] = outcome;
+        rows[i][p * 2 + 1] = differs;
+        if (differs && differences[p]++ == 0) {
+          first_difference[p] = step + i;
+        }
+      }
+      uint64_t trial_ns =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count();
+      if (progress != nullptr) {
+        progress->cell(p, countLookups(type) - before, trial_ns);
+      }
+    }
+    for (uint64_t i = 0; i < count && writer != nullptr; i++) {
+      writer->write(step + i, rows[i]);
+    }
+    step += count;
+  }
+  if (writer != nullptr) {
+    writer->end();
+  }
+  if (progress != nullptr) {
+    progress->end();
+  }
+  // differential summary of every predictor
+  for (uint64_t p = 0; p < num_predictors; p++) {
+    std::cout << "stream experiment=" << table.experiment
+              << " predictor=" << table.predictors[p] << " steps=" << step
+              << " differences=" << differences[p] << " first_difference=";
+    if (differences[p] > 0) {
+      std::cout << first_difference[p] << std::endl;
+    } else {
+      std::cout << "none" << std::endl;
+    }
+  }
+  return !reader.isCorrupt();
+}
@@ -0,0 +1,136 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/exps/exp6_tenants.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "include/predictors/BPUSet.hpp"
+#include "include/utils/Journal.hpp"
+#include "include/utils/Progress.hpp"
+#include "include/utils/ResultCache.hpp"
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Scheduler.hpp"
+#include "include/utils/Spec.hpp"
+#include "include/utils/Sweep.hpp"
+#include "include/utils/Utils.hpp"
+
+Exp6::Exp6(const std::vector<uint64_t> &types, uint64_t counter_bits,
+           uint64_t counter_nums, uint64_t buffer_ways, uint64_t buffer_sets,
+           uint64_t max_tenants, uint64_t addr_space, ReplacementPolicy policy,
+           const PHTConfig &pht, const RekeyConfig &rekey,
+           const CipherConfig &cipher, const BTBConfig &btb,
+           uint64_t offset_pht, uint64_t offset_btb)
+    : addr_space(addr_space) {
+  // init the selected branch predictors with a domain per tenant
+  bpus = new BPUSet(types, counter_bits, counter_nums, buffer_ways,
+                    buffer_sets, addr_space, policy, pht, rekey,
+                    cipher, btb, max_tenants, offset_pht, offset_btb);
+  // result header
+  header.predictors = bpus->getNames();
+  header.counter_bits = counter_bits;
+  header.counter_nums = counter_nums;
+  header.buffer_ways = buffer_ways;
+  header.buffer_sets = buffer_sets;
+  header.addr_space = addr_space;
+  header.offset_pht = offset_pht;
+  header.offset_btb = offset_btb;
+  header.policy = policyName(policy);
+  header.pht = phtName(pht);
+  header.rekey = rekeyName(rekey);
+  header.cipher = cipherName(cipher);
+  header.btb = btbName(btb);
+  header.seed = RANDOM_SEED;
+  header.common_random = COMMON_RANDOM;
+  header.baseline = BASELINE;
+  header.shard_index = SHARD_INDEX;
+  header.shard_count = SHARD_COUNT;
+}
+
+// a tenant looping over its working set, its lookups count in stat (and
+// in the victim columns if it is the victim)
+Process Exp6::tenant(Scheduler &scheduler, const uint64_t *working_set,
+                     uint64_t num_branches, bool victim,
+                     std::vector<uint64_t> &stat) {
+  for (uint64_t cursor = 0;; cursor++) {
+    uint64_t pc = working_set[cursor % num_branches];
+    // loop branch of 2 to 5 iterations
+    uint64_t trips = (pc >> 2) % 4 + 2;
+    bool taken = (cursor / num_branches) % trips != 0;
+    uint64_t pht = scheduler.lookupPHT(pc, taken);
+    uint64_t btb = scheduler.lookupBTB(pc, pc + 64) == 1;
+    stat[0] += pht;
+    stat[1] += btb;
+    stat[2] += victim ? pht : 0;
+    stat[3] += victim ? btb : 0;
+    co_await scheduler.tick();
+  }
+}
+
+// experiment: PHT and BTB interference under different tenant counts
+std::vector<std::vector<uint64_t>> Exp6::TenantInterference(
+    const std::vector<uint64_t> &tenant_counts, uint64_t repeats,
+    uint64_t num_branches, const ScheduleConfig &schedule, uint64_t rounds) {
+#ifdef EVALUATION
+  std::cout << "== exp6: TenantInterference ==" << std::endl;
+#endif
+  ResultHeader table = header.table("exp6/TenantInterference", "tenants", 4);
+  table.params = "domains=" + std::to_string(bpus->getDomains()) +
+                 ",branches=" + std::to_string(num_branches) +
+                 ",quantum=" + std::to_string(schedule.quantum) +
+                 ",rounds=" + std::to_string(rounds);
+  // the default schedule keeps the parameters of earlier results
+  if (schedule.model != SwitchModel::SWITCH_ROUND_ROBIN) {
+    table.params += ",switch=" + std::string(switchName(schedule.model));
+  }
+  if (schedule.flush) {
+    table.params += ",flush=1";
+  }
+  Sweep sweep(writer, journal, cache, progress, table, tenant_counts,
+              repeats,
+              bpus->lookupCounter());
+  // simulate the tenants
+  return sweep.run([&](const SweepCell &cell) {
+    uint64_t type = bpus->getType(cell.predictor);
+    uint64_t tenants = cell.key;
+    if (cell.fresh) {
+      bpus->reset(type);
+    }
+    // working sets of the tenants, tenant t at [t * num_branches]
+    std::vector<uint64_t> branches(tenants * num_branches);
+    for (uint64_t &branch : branches) {
+      branch = randomAddr(addrMask(addr_space));
+    }
+    std::vector<uint64_t> stat(4, 0);
+    Scheduler scheduler(bpus, type, schedule);
+    for (uint64_t t = 0; t < tenants; t++) {
+      scheduler.spawn(tenant(scheduler, &branches[t * num_branches],
+                             num_branches, t == SecurityDomain::DOM_VICTIM,
+                             stat),
+                      t);
+    }
+    scheduler.run(rounds * tenants);
+    return stat;
+  });
+}
@@ -0,0 +1,394 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/exps/exp7_explore.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Spec.hpp"
+#include "include/utils/Utils.hpp"
+#include "include/utils/Workers.hpp"
+
+std::string Exp7::geometryName(const ExploreGeometry &geometry) {
+  return "counter_bits=" + std::to_string(geometry.counter_bits) +
+         " counter_nums=" + std::to_string(geometry.counter_nums) +
+         " buffer_ways=" + std::to_string(geometry.buffer_ways) +
+         " buffer_sets=" + std::to_string(geometry.buffer_sets) +
+         " offset_pht=" + std::to_string(geometry.offset_pht) +
+         " offset_btb=" + std::to_string(geometry.offset_btb) +
+         " policy=" + policyName(geometry.policy);
+}
+
+// "a/b/c" of the values of a swept parameter
+std::string Exp7::valueList(const std::vector<uint64_t> &values) {
+  std::string list;
+  for (uint64_t i = 0; i < values.size(); i++) {
+    list += (i == 0 ? "" : "/") + std::to_string(values[i]);
+  }
+  return list;
+}
+
+// storage of the PHT counters and of the BTB entries (valid bit, tag and
+// target)
+uint64_t Exp7::sizeBits(const ExploreGeometry &geometry) {
+  uint64_t set_bits = (uint64_t)std::log2(geometry.buffer_sets);
+  uint64_t index_bits = geometry.offset_btb + set_bits;
+  uint64_t tag_bits =
+      spec.addr_space > index_bits ? spec.addr_space - index_bits : 0;
+  return geometry.counter_nums * geometry.counter_bits +
+         geometry.buffer_sets * geometry.buffer_ways *
+             (1 + tag_bits + spec.addr_space);
+}
+
+// spec of an experiment at its largest budget, the arguments of another
+// mode than the one of the spec are the defaults of that mode
+ExperimentSpec Exp7::experimentSpec(const std::string &mode) {
+  ExperimentSpec experiment = spec;
+  if (mode != spec.mode) {
+    ExperimentSpec defaults;
+    defaultSpec(mode, spec.secrets, spec.repeats, defaults);
+    experiment.mode = mode;
+    experiment.budgets = defaults.budgets;
+    experiment.prune_size = defaults.prune_size;
+    experiment.occupancy_size = defaults.occupancy_size;
+  }
+  const std::vector<uint64_t> &budgets = experiment.budgets;
+  experiment.budgets = {*std::max_element(budgets.begin(), budgets.end())};
+  return experiment;
+}
+
+// mean and standard error of the trials of a cell from its summed row
+ExploreScore Exp7::score(const std::string &mode,
+                         const std::vector<uint64_t> &row, uint64_t repeats) {
+  ExploreScore score;
+  score.repeats = repeats;
+  double mean = 0, square = 0;
+  if (mode == "leakage-pht" || mode == "leakage-btb") {
+    // histogram of the leaked bins
+    for (uint64_t bin = 0; bin < row.size(); bin++) {
+      mean += (double)bin * row[bin] / repeats;
+      square += (double)bin * bin * row[bin] / repeats;
+    }
+  } else if (mode == "prune-btb-collision" ||
+             mode == "occupancy-btb-collision") {
+    // successful trials, the evicted levels of a BTB hierarchy follow
+    mean = (double)row[0] / repeats;
+    square = mean;
+  } else {
+    // successful trials of every attack, the strongest one counts
+    mean = (double)*std::max_element(row.begin(), row.end()) / repeats;
+    square = mean;
+  }
+  score.leakage = mean;
+  score.std_error =
+      std::sqrt(std::max(square - mean * mean, 0.0) / repeats);
+  return score;
+}
+
+// prune the configurations of an experiment and predictor that another
+// one of no larger size beats by margin standard errors of both
+void Exp7::prune(std::vector<ExploreScore *> &scores,
+                 const std::vector<uint64_t> &sizes) {
+  double margin = spec.explore.margin;
+  std::vector<bool> dominated(scores.size(), false);
+  for (uint64_t a = 0; a < scores.size(); a++) {
+    for (uint64_t b = 0; b < scores.size() && !dominated[a]; b++) {
+      if (b == a || scores[a]->pruned || scores[b]->pruned) {
+        continue;
+      }
+      double upper = scores[b]->leakage + margin * scores[b]->std_error;
+      double lower = scores[a]->leakage - margin * scores[a]->std_error;
+      dominated[a] = sizes[b] <= sizes[a] && upper < lower;
+    }
+  }
+  for (uint64_t a = 0; a < scores.size(); a++) {
+    scores[a]->pruned = scores[a]->pruned || dominated[a];
+  }
+}
+
+// Pareto front of the remaining configurations
+void Exp7::rank(std::vector<ExploreScore *> &scores,
+                const std::vector<uint64_t> &sizes) {
+  for (uint64_t a = 0; a < scores.size(); a++) {
+    if (scores[a]->pruned) {
+      continue;
+    }
+    bool dominated = false;
+    for (uint64_t b = 0; b < scores.size() && !dominated; b++) {
+      if (b == a || scores[b]->pruned) {
+        continue;
+      }
+      dominated = sizes[b] <= sizes[a] &&
+                  scores[b]->leakage <= scores[a]->leakage &&
+                  (sizes[b] < sizes[a] ||
+                   scores[b]->leakage < scores[a]->leakage);
+    }
+    scores[a]->pareto = !dominated;
+  }
+}
+
+Exp7::Exp7(const ExperimentSpec &spec, uint64_t jobs)
+    : spec(spec), jobs(workerJobs(jobs)) {
+  const ExploreSpace &space = spec.explore;
+  modes = space.modes.empty() ? std::vector<std::string>{spec.mode}
+                              : space.modes;
+  // the grid, decoded from the index with the last parameter fastest
+  axes = {space.counter_bits, space.counter_nums, space.buffer_ways,
+          space.buffer_sets,  space.offset_pht,   space.offset_btb};
+  std::vector<uint64_t> fixed = {spec.counter_bits, spec.counter_nums,
+                                 spec.buffer_ways,  spec.buffer_sets,
+                                 spec.offset_pht,   spec.offset_btb};
+  policies = space.policies;
+  uint64_t count = 1;
+  for (uint64_t axis = 0; axis < axes.size(); axis++) {
+    if (axes[axis].empty()) {
+      axes[axis] = {fixed[axis]};
+    }
+    count *= axes[axis].size();
+  }
+  if (policies.empty()) {
+    policies = {spec.policy};
+  }
+  count *= policies.size();
+  for (uint64_t index = 0; index < count; index++) {
+    uint64_t rest = index;
+    ExploreGeometry geometry;
+    geometry.policy = policies[rest % policies.size()];
+    rest /= policies.size();
+    std::vector<uint64_t> point(axes.size());
+    for (uint64_t axis = axes.size(); axis-- > 0;) {
+      point[axis] = axes[axis][rest % axes[axis].size()];
+      rest /= axes[axis].size();
+    }
+    geometry.counter_bits = point[0];
+    geometry.counter_nums = point[1];
+    geometry.buffer_ways = point[2];
+    geometry.buffer_sets = point[3];
+    geometry.offset_pht = point[4];
+    geometry.offset_btb = point[5];
+    geometries.push_back(geometry);
+  }
+  // result header
+  for (uint64_t type : spec.predictors) {
+    header.predictors.push_back(BPU_NAMES[type]);
+  }
+  header.counter_bits = spec.counter_bits;
+  header.counter_nums = spec.counter_nums;
+  header.buffer_ways = spec.buffer_ways;
+  header.buffer_sets = spec.buffer_sets;
+  header.addr_space = spec.addr_space;
+  header.offset_pht = spec.offset_pht;
+  header.offset_btb = spec.offset_btb;
+  header.policy = policyName(spec.policy);
+  header.pht = phtName(spec.pht);
+  header.rekey = rekeyName(spec.rekey);
+  header.cipher = cipherName(spec.cipher);
+  header.btb = btbName(spec.btb);
+  header.seed = RANDOM_SEED;
+  header.common_random = spec.common_random;
+  header.baseline = spec.baseline;
+  header.repeats = spec.repeats;
+}
+
+// whether the leakage of a mode is defined
+bool Exp7::scored(const std::string &mode) {
+  return mode == "reuse-collision" || mode == "prune-btb-collision" ||
+         mode == "occupancy-pht-collision" ||
+         mode == "occupancy-btb-collision" || mode == "leakage-pht" ||
+         mode == "leakage-btb";
+}
+
+// the experiments without a leakage score, none if all can be explored
+std::vector<std::string> Exp7::unscored() {
+  std::vector<std::string> names;
+  for (const std::string &mode : modes) {
+    if (!scored(mode)) {
+      names.push_back(mode);
+    }
+  }
+  return names;
+}
+
+// experiment: leakage vs table size over the design space, evaluate runs
+// the spec of a cell and returns its rows. Return false if a cell failed.
+bool Exp7::Explore(
+    const std::function<std::vector<std::vector<uint64_t>>(
+        const ExperimentSpec &)> &evaluate,
+    std::vector<std::vector<uint64_t>> &stats) {
+#ifdef EVALUATION
+  std::cout << "== exp7: Explore ==" << std::endl;
+#endif
+  uint64_t num_predictors = spec.predictors.size();
+  uint64_t num_configs = geometries.size() * num_predictors;
+  std::vector<ExperimentSpec> experiments;
+  for (const std::string &mode : modes) {
+    experiments.push_back(experimentSpec(mode));
+  }
+  std::vector<uint64_t> sizes;
+  for (const ExploreGeometry &geometry : geometries) {
+    sizes.push_back(sizeBits(geometry));
+  }
+  // scores[(experiment * geometries + geometry) * predictors + predictor]
+  std::vector<ExploreScore> scores(modes.size() * num_configs);
+  std::vector<uint64_t> passes = spec.explore.passes;
+  passes.push_back(spec.repeats);
+  for (uint64_t pass = 0; pass < passes.size(); pass++) {
+    uint64_t repeats = passes[pass];
+    std::vector<uint64_t> cells;
+    for (uint64_t cell = 0; cell < scores.size(); cell++) {
+      if (!scores[cell].pruned) {
+        cells.push_back(cell);
+      }
+    }
+    std::vector<std::vector<uint64_t>> rows;
+    bool completed = runWorkers(
+        cells.size(), jobs,
+        [&](uint64_t task) {
+          uint64_t cell = cells[task];
+          uint64_t config = cell % num_configs;
+          const ExploreGeometry &geometry =
+              geometries[config / num_predictors];
+          ExperimentSpec experiment = experiments[cell / num_configs];
+          experiment.predictors = {
+              spec.predictors[config % num_predictors]};
+          experiment.repeats = repeats;
+          experiment.counter_bits = geometry.counter_bits;
+          experiment.counter_nums = geometry.counter_nums;
+          experiment.buffer_ways = geometry.buffer_ways;
+          experiment.buffer_sets = geometry.buffer_sets;
+          experiment.offset_pht = geometry.offset_pht;
+          experiment.offset_btb = geometry.offset_btb;
+          experiment.policy = geometry.policy;
+          std::vector<std::vector<uint64_t>> cell_rows =
+              evaluate(experiment);
+          return cell_rows.empty() ? std::vector<uint64_t>()
+                                   : cell_rows.back();
+        },
+        rows);
+    if (!completed) {
+      return false;
+    }
+    for (uint64_t task = 0; task < cells.size(); task++) {
+      if (rows[task].empty()) {
+        return false;
+      }
+      uint64_t cell = cells[task];
+      scores[cell] = score(modes[cell / num_configs], rows[task], repeats);
+    }
+    // prune (screening passes) or rank (final pass) the configurations of
+    // every experiment and predictor
+    uint64_t pruned = 0;
+    for (uint64_t m = 0; m < modes.size(); m++) {
+      for (uint64_t predictor = 0; predictor < num_predictors; predictor++) {
+        std::vector<ExploreScore *> configs;
+        for (uint64_t g = 0; g < geometries.size(); g++) {
+          configs.push_back(
+              &scores[m * num_configs + g * num_predictors + predictor]);
+        }
+        if (pass + 1 < passes.size()) {
+          prune(configs, sizes);
+        } else {
+          rank(configs, sizes);
+        }
+        for (ExploreScore *config : configs) {
+          pruned += config->pruned;
+        }
+      }
+    }
+#ifdef EVALUATION
+    std::cout << "exp7/Explore: " << repeats << " repeats, " << cells.size()
+              << " cells, " << pruned << " pruned" << std::endl;
+#endif
+  }
+  // one table per experiment, and the Pareto front of every predictor
+  stats.clear();
+  for (uint64_t m = 0; m < modes.size(); m++) {
+    ResultHeader table = header.table("exp7/Explore", "geometry", 5);
+    table.params =
+        "mode=" + modes[m] +
+        ",budget=" + std::to_string(experiments[m].budgets[0]) +
+        ",passes=" + valueList(passes) +
+        ",margin=" + std::to_string(spec.explore.margin) + ",grid=";
+    const char *names[] = {"counter_bits", "counter_nums", "buffer_ways",
+                           "buffer_sets",  "offset_pht",   "offset_btb"};
+    for (uint64_t axis = 0; axis < axes.size(); axis++) {
+      table.params += std::string(names[axis]) + ":" +
+                      valueList(axes[axis]) + "/";
+    }
+    table.params += "policy:";
+    for (uint64_t i = 0; i < policies.size(); i++) {
+      table.params += (i == 0 ? "" : "/");
+      table.params += policyName(policies[i]);
+    }
+    if (writer != nullptr) {
+      writer->begin(table);
+    }
+    for (uint64_t g = 0; g < geometries.size(); g++) {
+      std::vector<uint64_t> stat;
+      for (uint64_t predictor = 0; predictor < num_predictors; predictor++) {
+        const ExploreScore &config =
+            scores[m * num_configs + g * num_predictors + predictor];
+        stat.push_back(sizes[g]);
+        stat.push_back(std::llround(config.leakage * 1000));
+        stat.push_back(std::llround(config.std_error * 1000));
+        stat.push_back(config.repeats);
+        stat.push_back(config.pareto);
+      }
+      if (writer != nullptr) {
+        writer->write(g, stat);
+      }
+      stats.push_back(stat);
+    }
+    if (writer != nullptr) {
+      writer->end();
+    }
+    for (uint64_t predictor = 0; predictor < num_predictors; predictor++) {
+      std::vector<uint64_t> front;
+      for (uint64_t g = 0; g < geometries.size(); g++) {
+        if (scores[m * num_configs + g * num_predictors + predictor]
+                .pareto) {
+          front.push_back(g);
+        }
+      }
+      std::sort(front.begin(), front.end(), [&](uint64_t a, uint64_t b) {
+        return sizes[a] < sizes[b];
+      });
+      for (uint64_t g : front) {
+        const ExploreScore &config =
+            scores[m * num_configs + g * num_predictors + predictor];
+        std::cout << "pareto mode=" << modes[m]
+                  << " predictor=" << header.predictors[predictor]
+                  << " geometry=" << g << " " << geometryName(geometries[g])
+                  << " size_bits=" << sizes[g]
+                  << " leakage=" << config.leakage
+                  << " stderr=" << config.std_error << std::endl;
+      }
+    }
+  }
+  return true;
+}
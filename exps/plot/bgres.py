@@ -0,0 +1,115 @@
+# Copyright 2025 iamywang
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# =============================================================================
+# BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+# Branch Predictors
+
+# author: iamywang
+# date: 2026/10/18
+# =============================================================================
+# Loader for the result formats of branch-gauge (--format text|binary|npy).
+# load_all() returns one (meta, keys, data) per table of a file, where data
+# is a (rows, columns) matrix, and load() the first of them. For text written
+# to stderr, meta is empty; keys are the line numbers of the text format.
+# =============================================================================
+import os
+import struct
+
+import numpy as np
+
+
+def parse_meta(text):
+    meta = {}
+    for line in text.splitlines():
+        if '=' in line:
+            name, value = line.split('=', 1)
+            meta[name] = value
+    if 'predictors' in meta:
+        meta['predictors'] = meta['predictors'].split(',')
+    return meta
+
+
+def _table(meta, body):
+    return meta, body[:, 0], body[:, 1:]
+
+
+def _load_binary(path):
+    tables = []
+    with open(path, 'rb') as f:
+        magic = f.read(8)
+        while magic in (b'BGRES001', b'BGRES002'):
+            length = struct.unpack('<I', f.read(4))[0]
+            meta = parse_meta(f.read(length).decode())
+            width = int(meta['columns']) + 1
+            # the single table of a BGRES001 file ends with the file
+            if magic == b'BGRES001':
+                body = np.frombuffer(f.read(), dtype='<u8')
+                rows = len(body) // width
+            else:
+                rows = struct.unpack('<Q', f.read(8))[0]
+                body = np.frombuffer(f.read(rows * width * 8), dtype='<u8')
+                rows = min(rows, len(body) // width)
+            tables.append(_table(meta, body[:rows * width].reshape(-1, width)))
+            magic = f.read(8)
+    return tables
+
+
+def _load_npy(path):
+    metas = []
+    if os.path.exists(path + '.meta'):
+        with open(path + '.meta', 'r') as f:
+            metas = [parse_meta(text) for text in f.read().split('\n\n')
+                     if text.strip()]
+    tables = []
+    with open(path, 'rb') as f:
+        size = os.fstat(f.fileno()).st_size
+        while f.tell() < size:
+            body = np.load(f)
+            meta = metas[len(tables)] if len(tables) < len(metas) else {}
+            tables.append(_table(meta, body))
+    return tables
+
+
+def _load_text(path):
+    # (header lines, rows) of every table, a table starts with "# experiment="
+    parts = [([], [])]
+    with open(path, 'r') as f:
+        for line in f:
+            if line.startswith('# '):
+                if line.startswith('# experiment=') and (parts[-1][0] or
+                                                         parts[-1][1]):
+                    parts.append(([], []))
+                parts[-1][0].append(line[2:])
+            elif line.strip():
+                parts[-1][1].append([int(v) for v in line.split()])
+    return [(parse_meta(''.join(lines)), np.arange(len(rows)),
+             np.array(rows, dtype=np.uint64)) for lines, rows in parts]
+
+
+def load_all(path):
+    with open(path, 'rb') as f:
+        magic = f.read(8)
+    # binary format
+    if magic in (b'BGRES001', b'BGRES002'):
+        return _load_binary(path)
+    # npy format with the headers in a sidecar file
+    if magic.startswith(b'\x93NUMPY'):
+        return _load_npy(path)
+    # text format, with "# " header lines in a file
+    return _load_text(path)
+
+
+def load(path):
+    return load_all(path)[0]
@@ -0,0 +1,227 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// The experiments of all modes, the evaluation of a spec and the exploration
+// of its design space, shared by the command line (main.cpp) and the library
+// (api/BranchGauge.cpp).
+// =============================================================================
+#include "include/exps/run.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "include/exps/exp1_reuse.hpp"
+#include "include/exps/exp2_prune.hpp"
+#include "include/exps/exp3_occupancy.hpp"
+#include "include/exps/exp4_leakage.hpp"
+#include "include/exps/exp5_trace.hpp"
+#include "include/exps/exp6_tenants.hpp"
+#include "include/exps/exp7_explore.hpp"
+#include "include/utils/Journal.hpp"
+#include "include/utils/Progress.hpp"
+#include "include/utils/ResultCache.hpp"
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Spec.hpp"
+
+bool runSpec(const ExperimentSpec &spec, ResultWriter *writer,
+             Journal *journal, ResultCache *cache, Progress *progress,
+             std::vector<std::vector<uint64_t>> *rows) {
+  const std::string &mode = spec.mode;
+  std::vector<std::vector<uint64_t>> stats;
+  COMMON_RANDOM = spec.common_random;
+  BASELINE = spec.baseline;
+  // construct the experiment of the mode only
+  if (mode == "reuse-access" || mode == "reuse-collision") {
+    Exp1 *exp1 = new Exp1(spec.predictors, spec.counter_bits,
+                          spec.counter_nums, spec.buffer_ways,
+                          spec.buffer_sets, spec.addr_space, spec.policy,
+                          spec.pht, spec.rekey, spec.cipher,
+                          spec.btb, spec.offset_pht, spec.offset_btb);
+    exp1->setWriter(writer);
+    exp1->setJournal(journal);
+    exp1->setCache(cache);
+    exp1->setProgress(progress);
+    if (mode == "reuse-access") {
+      stats = exp1->ReuseBranchAccess(spec.repeats, spec.counter_bits);
+    } else {
+      stats = exp1->ReuseCollisionRate(spec.budgets, spec.repeats,
+                                       spec.counter_bits);
+    }
+    delete exp1;
+  } else if (mode == "prune-btb-prune" || mode == "prune-btb-collision") {
+    Exp2 *exp2 = new Exp2(spec.predictors, spec.counter_bits,
+                          spec.counter_nums, spec.buffer_ways,
+                          spec.buffer_sets, spec.addr_space, spec.policy,
+                          spec.pht, spec.rekey, spec.cipher,
+                          spec.btb, spec.offset_pht, spec.offset_btb,
+                          spec.attack_schedule);
+    exp2->setWriter(writer);
+    exp2->setJournal(journal);
+    exp2->setCache(cache);
+    exp2->setProgress(progress);
+    if (mode == "prune-btb-prune") {
+      stats = exp2->BTBPruningAccessIterate(spec.budgets, spec.repeats);
+    } else {
+      stats = exp2->BTBCollisionRate(spec.prune_size, spec.budgets,
+                                     spec.repeats);
+    }
+    delete exp2;
+  } else if (mode == "occupancy-pht-prune" ||
+             mode == "occupancy-pht-collision" ||
+             mode == "occupancy-btb-prune" ||
+             mode == "occupancy-btb-collision" ||
+             mode == "occupancy-pht-rare" || mode == "occupancy-btb-rare") {
+    Exp3 *exp3 = new Exp3(spec.predictors, spec.counter_bits,
+                          spec.counter_nums, spec.buffer_ways,
+                          spec.buffer_sets, spec.addr_space, spec.policy,
+                          spec.pht, spec.rekey, spec.cipher,
+                          spec.btb, spec.offset_pht, spec.offset_btb,
+                          spec.attack_schedule);
+    exp3->setWriter(writer);
+    exp3->setJournal(journal);
+    exp3->setCache(cache);
+    exp3->setProgress(progress);
+    if (mode == "occupancy-pht-prune") {
+      stats = exp3->PHTPruningAccessIterate(
+          spec.budgets, spec.occupancy_size, spec.repeats, spec.counter_bits);
+    } else if (mode == "occupancy-pht-collision") {
+      stats = exp3->PHTCollisionRate(spec.prune_size, spec.occupancy_size,
+                                     spec.budgets, spec.repeats,
+                                     spec.counter_bits);
+    } else if (mode == "occupancy-btb-prune") {
+      stats = exp3->BTBPruningAccessIterate(spec.budgets, spec.occupancy_size,
+                                            spec.repeats);
+    } else if (mode == "occupancy-btb-collision") {
+      stats = exp3->BTBCollisionRate(spec.prune_size, spec.occupancy_size,
+                                     spec.budgets, spec.repeats);
+    } else if (mode == "occupancy-pht-rare") {
+      stats = exp3->PHTRareCollisionRate(
+          spec.prune_size, spec.occupancy_size, spec.budgets, spec.repeats,
+          spec.counter_bits, spec.rare_bias);
+    } else {
+      stats = exp3->BTBRareCollisionRate(spec.prune_size, spec.occupancy_size,
+                                         spec.budgets, spec.repeats,
+                                         spec.rare_bias);
+    }
+    delete exp3;
+  } else if (mode == "leakage-pht" || mode == "leakage-btb" ||
+             mutualInfoMode(mode)) {
+    Exp4 *exp4 = new Exp4(spec.predictors, spec.counter_bits,
+                          spec.counter_nums, spec.buffer_ways,
+                          spec.buffer_sets, spec.secrets, spec.addr_space,
+                          spec.policy, spec.pht, spec.rekey, spec.cipher,
+                          spec.btb, spec.offset_pht, spec.offset_btb,
+                          spec.attack_schedule);
+    exp4->setWriter(writer);
+    exp4->setJournal(journal);
+    exp4->setCache(cache);
+    exp4->setProgress(progress);
+    if (mode == "leakage-pht") {
+      stats = exp4->PHTLeakage(spec.prune_size, spec.occupancy_size,
+                               spec.budgets, spec.repeats, spec.counter_bits);
+    } else if (mode == "leakage-btb") {
+      stats = exp4->BTBLeakage(spec.prune_size, spec.occupancy_size,
+                               spec.budgets, spec.repeats);
+    } else if (mode == "leakage-pht-mi") {
+      stats = exp4->PHTMutualInfo(spec.prune_size, spec.occupancy_size,
+                                  spec.budgets, spec.repeats,
+                                  spec.counter_bits, spec.leakage_tolerance);
+    } else {
+      stats = exp4->BTBMutualInfo(spec.prune_size, spec.occupancy_size,
+                                  spec.budgets, spec.repeats,
+                                  spec.leakage_tolerance);
+    }
+    delete exp4;
+  } else if (mode == "trace-replay" || mode == "stream-replay") {
+    Exp5 *exp5 = new Exp5(spec.predictors, spec.counter_bits,
+                          spec.counter_nums, spec.buffer_ways,
+                          spec.buffer_sets, spec.addr_space, spec.policy,
+                          spec.pht, spec.rekey, spec.cipher,
+                          spec.btb, spec.offset_pht, spec.offset_btb);
+    exp5->setWriter(writer);
+    exp5->setProgress(progress);
+    bool replayed;
+    if (mode == "trace-replay") {
+      replayed = exp5->TraceReplay(spec.trace, spec.window,
+                                   spec.interference, stats);
+    } else {
+      std::vector<uint64_t> differences;
+      replayed = exp5->StreamReplay(spec.trace, differences);
+    }
+    delete exp5;
+    if (!replayed) {
+      return false;
+    }
+  } else if (mode == "tenants-interference") {
+    uint64_t max_tenants =
+        *std::max_element(spec.budgets.begin(), spec.budgets.end());
+    Exp6 *exp6 = new Exp6(spec.predictors, spec.counter_bits,
+                          spec.counter_nums, spec.buffer_ways,
+                          spec.buffer_sets, max_tenants, spec.addr_space,
+                          spec.policy, spec.pht, spec.rekey, spec.cipher,
+                          spec.btb, spec.offset_pht, spec.offset_btb);
+    exp6->setWriter(writer);
+    exp6->setJournal(journal);
+    exp6->setCache(cache);
+    exp6->setProgress(progress);
+    stats = exp6->TenantInterference(spec.budgets, spec.repeats,
+                                     spec.tenant_branches,
+                                     spec.tenant_schedule, spec.tenant_rounds);
+    delete exp6;
+  } else {
+    return false;
+  }
+  if (rows != nullptr) {
+    *rows = stats;
+  }
+  return true;
+}
+
+bool runExplore(const ExperimentSpec &spec, ResultWriter *writer,
+                ResultCache *cache, uint64_t jobs,
+                std::vector<std::vector<uint64_t>> *rows) {
+  Exp7 *exp7 = new Exp7(spec, jobs);
+  for (const std::string &mode : exp7->unscored()) {
+    std::cerr << "Explore: mode " << mode << " has no leakage score"
+              << std::endl;
+  }
+  bool explored = false;
+  if (exp7->unscored().empty()) {
+    std::vector<std::vector<uint64_t>> stats;
+    exp7->setWriter(writer);
+    // the cells run in worker processes, which share the cache files only
+    explored = exp7->Explore(
+        [&](const ExperimentSpec &cell) {
+          std::vector<std::vector<uint64_t>> cell_rows;
+          runSpec(cell, nullptr, nullptr, cache, nullptr, &cell_rows);
+          return cell_rows;
+        },
+        stats);
+    if (rows != nullptr) {
+      *rows = stats;
+    }
+  }
+  delete exp7;
+  return explored;
+}
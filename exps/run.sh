@@ -20,6 +20,6 @@
 # date: 2024/12/30
 # =============================================================================
 #!/bin/bash
-rm -rf res
-mkdir res
+# interrupted experiments resume from their journals in res
+mkdir -p res
 python3 exp1_reuse.py & python3 exp2_prune.py & python3 exp3_occupancy.py & python3 exp4_leakage.py
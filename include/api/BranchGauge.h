@@ -0,0 +1,242 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// C API of libbranchgauge, for drivers that run the predictors in-process
+// (e.g., Python through ctypes, see exps/branchgauge.py):
+//   predictors   construct a set of predictors (BPUSet) from a geometry,
+//                look up batches of branches from caller buffers, run the
+//                attacks and read the occupancy
+//   experiments  evaluate a spec (the text of a spec file) and read the rows
+//                of its table from a buffer owned by the table
+//   leakage      estimate the mutual information and the channel capacity
+//                from the joint counts of a mutual-information mode
+//
+// Predictor types are the BPUType values (0 BaseBPU ... 6 HyBP) and domains
+// the SecurityDomain values (0 attacker, 1 victim, then the tenants). Every
+// function returns BG_OK or an error code, results are written to the
+// pointers of the caller. The simulator keeps process-wide state (rand(), the
+// branch budget and the seed), so calls must not run concurrently.
+// =============================================================================
+#ifndef BRANCH_GAUGE_H
+#define BRANCH_GAUGE_H
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define BG_API __declspec(dllexport)
+#else
+#define BG_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// version of the API, changed on incompatible changes
+#define BG_API_VERSION 3
+
+// error codes
+#define BG_OK 0
+#define BG_EINVAL -1     // invalid argument or predictor not in the set
+#define BG_ESPEC -2      // invalid spec or unknown mode
+#define BG_ECAPACITY -3  // output buffer too small, the size is reported
+
+// most BTB levels in front of the BTB of the geometry
+#define BG_BTB_MAX_LEVELS 3
+
+typedef struct bg_predictors bg_predictors;
+typedef struct bg_table bg_table;
+
+// geometry, direction model, rekey policy, index cipher, BTB levels and
+// domains of a predictor set, the defaults are those of a spec (see
+// include/utils/Spec.hpp)
+typedef struct bg_config {
+  uint64_t counter_bits;
+  uint64_t counter_nums;
+  uint64_t buffer_ways;
+  uint64_t buffer_sets;
+  uint64_t addr_space;
+  uint64_t policy;  // 0: LRU, 1: random
+  // direction model of the PHT (PHTModel, see HistoryPHT.hpp)
+  uint64_t pht_model;
+  uint64_t pht_history;
+  uint64_t tage_tables;
+  uint64_t tage_min_history;
+  uint64_t tage_max_history;
+  uint64_t tage_tag_bits;
+  // rekey every N lookups or mispredicts (0: never), on domain switches
+  uint64_t rekey_accesses;
+  uint64_t rekey_mispredicts;
+  uint64_t rekey_domain_switch;
+  // index cipher (CipherType, see Cipher.hpp) and its rounds (0: full)
+  uint64_t cipher;
+  uint64_t cipher_rounds;
+  // BTB levels L0 to L[btb_levels - 1] in front of the BTB (0: a single
+  // level, see BTBHierarchy.hpp): sets, ways, policy (0: LRU, 1: random)
+  // and keyed index of each, and the inclusion (BTBInclusion)
+  uint64_t btb_levels;
+  uint64_t btb_sets[BG_BTB_MAX_LEVELS];
+  uint64_t btb_ways[BG_BTB_MAX_LEVELS];
+  uint64_t btb_policy[BG_BTB_MAX_LEVELS];
+  uint64_t btb_keyed[BG_BTB_MAX_LEVELS];
+  uint64_t btb_inclusion;
+  // security domains, 2 (attacker and victim) to 1024
+  uint64_t domains;
+  // seed of the keys and pids of the predictors
+  uint64_t seed;
+} bg_config;
+
+// BG_API_VERSION of the library
+BG_API int bg_api_version(void);
+
+// ---------------------------------------------------------------- predictors
+
+// defaults of a predictor set
+BG_API void bg_default_config(bg_config *config);
+
+// BPUType of a predictor name (case-insensitive)
+BG_API int bg_parse_type(const char *name, uint64_t *type);
+
+// construct the predictors of types[0 .. count - 1], set *set to NULL on
+// an invalid config
+BG_API int bg_create(const bg_config *config, const uint64_t *types,
+                     uint64_t count, bg_predictors **set);
+
+BG_API void bg_destroy(bg_predictors *set);
+
+// reseed rand(), which draws the random addresses of the attacks
+BG_API void bg_seed(uint64_t seed);
+
+// branch budget of the attacks (NUMBER_MAX_BRANCHES)
+BG_API void bg_set_max_branches(uint64_t max_branches);
+
+// clear the PHT and BTB state (and restore the keys) of a predictor
+BG_API int bg_reset(bg_predictors *set, uint64_t type);
+
+// valid PHT counters and BTB entries of a predictor
+BG_API int bg_occupancy(bg_predictors *set, uint64_t type, uint64_t *pht,
+                        uint64_t *btb);
+
+// first BTB level holding count branches of domains (or NULL for the
+// attacker): 0 for a single-level BTB, the number of levels if none
+BG_API int bg_btb_level(bg_predictors *set, uint64_t type,
+                        const uint64_t *pcs, const uint64_t *domains,
+                        uint64_t count, uint64_t *levels);
+
+// look up count conditional branches: pcs, taken (0 or 1) and domains (or
+// NULL for the attacker), correct[i] is 1 if the direction was predicted
+// (correct may be NULL), *hits counts them
+BG_API int bg_lookup_pht(bg_predictors *set, uint64_t type,
+                         const uint64_t *pcs, const uint8_t *taken,
+                         const uint64_t *domains, uint64_t count,
+                         uint8_t *correct, uint64_t *hits);
+
+// look up count branches in the BTB: outcomes[i] is 1 on a hit, 0 on a wrong
+// target and -1 on a miss (outcomes may be NULL), *hits counts the hits
+BG_API int bg_lookup_btb(bg_predictors *set, uint64_t type,
+                         const uint64_t *pcs, const uint64_t *targets,
+                         const uint64_t *domains, uint64_t count,
+                         int8_t *outcomes, uint64_t *hits);
+
+// reuse-based attacks: *addr is the colliding address of the attacker (or
+// -1 if none was found), *accesses the branches it took
+BG_API int bg_pht_timing(bg_predictors *set, uint64_t type,
+                         uint64_t num_loops, uint64_t counter_bits,
+                         uint64_t victim_addr, uint64_t *addr,
+                         uint64_t *accesses);
+
+BG_API int bg_pht_speculative(bg_predictors *set, uint64_t type,
+                              uint64_t num_loops, uint64_t counter_bits,
+                              uint64_t victim_addr, uint64_t *addr,
+                              uint64_t *accesses);
+
+BG_API int bg_btb_timing(bg_predictors *set, uint64_t type,
+                         uint64_t num_loops, uint64_t victim_addr,
+                         uint64_t target_addr, uint64_t *addr,
+                         uint64_t *accesses);
+
+BG_API int bg_btb_speculative(bg_predictors *set, uint64_t type,
+                              uint64_t num_loops, uint64_t victim_addr,
+                              uint64_t target_addr, uint64_t covert_channel,
+                              uint64_t *addr, uint64_t *accesses);
+
+// prune- and occupancy-based attacks: the eviction (or occupancy) set is
+// copied to addrs, *size is its size; on BG_ECAPACITY only *size and
+// *accesses are written
+BG_API int bg_btb_prune(bg_predictors *set, uint64_t type,
+                        uint64_t num_loops, uint64_t victim_addr,
+                        uint64_t prune_size, uint64_t eviction_size,
+                        uint64_t *addrs, uint64_t capacity, uint64_t *size,
+                        uint64_t *accesses);
+
+BG_API int bg_pht_occupancy_attack(bg_predictors *set, uint64_t type,
+                                   uint64_t num_loops, uint64_t counter_bits,
+                                   uint64_t prune_size,
+                                   uint64_t occupancy_size, uint64_t *addrs,
+                                   uint64_t capacity, uint64_t *size,
+                                   uint64_t *accesses);
+
+BG_API int bg_btb_occupancy_attack(bg_predictors *set, uint64_t type,
+                                   uint64_t num_loops, uint64_t prune_size,
+                                   uint64_t occupancy_size, uint64_t *addrs,
+                                   uint64_t capacity, uint64_t *size,
+                                   uint64_t *accesses);
+
+// --------------------------------------------------------------- experiments
+
+// evaluate a spec (the text of a spec file) with the seed of the spec or
+// else seed. Shard i of N evaluates the (row, repeat) cells with
+// (row * repeats + repeat) % N == i and keeps the sums of the rows, so with N
+// = rows * repeats every call is a single cell of every predictor. output
+// (or NULL) also writes the table in the text format. A baseline spec runs
+// as a single shard (BG_EINVAL otherwise), and a trace that cannot be
+// replayed is BG_ESPEC. Errors are printed to stderr.
+BG_API int bg_run_spec(const char *spec, uint64_t seed, uint64_t shard_index,
+                       uint64_t shard_count, const char *output,
+                       bg_table **table);
+
+// rows and columns of a table (stream-replay has no rows)
+BG_API int bg_table_shape(const bg_table *table, uint64_t *rows,
+                          uint64_t *columns);
+
+// row-major values of a table, valid until the table is freed
+BG_API const uint64_t *bg_table_data(const bg_table *table);
+
+BG_API void bg_table_free(bg_table *table);
+
+// ------------------------------------------------------------------- leakage
+
+// mutual information of the secrets * observations joint counts (row-major,
+// e.g. the counts of a predictor in a row of leakage-pht-mi) in bits: the
+// plug-in and Miller-Madow estimates and the z confidence interval of the
+// latter (see include/utils/Leakage.hpp)
+BG_API int bg_mutual_information(const uint64_t *counts, uint64_t secrets,
+                                 uint64_t observations, double z,
+                                 double *plug_in, double *miller_madow,
+                                 double *lower, double *upper);
+
+// capacity of the channel of the joint counts in bits (Blahut-Arimoto)
+BG_API int bg_channel_capacity(const uint64_t *counts, uint64_t secrets,
+                               uint64_t observations, double *bits);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
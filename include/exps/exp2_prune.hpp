@@ -0,0 +1,84 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/19
+// =============================================================================
+#ifndef EXP2_PRUNE_HPP
+#define EXP2_PRUNE_HPP
+#include <cstdint>
+#include <vector>
+
+#include "include/predictors/BPUSet.hpp"
+#include "include/utils/Journal.hpp"
+#include "include/utils/Progress.hpp"
+#include "include/utils/ResultCache.hpp"
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Scheduler.hpp"
+#include "include/utils/Utils.hpp"
+
+class Exp2 {
+ private:
+  std::vector<uint64_t> secrets;
+  BPUSet *bpus;
+
+  // levels of the BTB of the predictors, 1 if single-level
+  uint64_t btb_levels;
+
+  // result output
+  ResultWriter *writer = nullptr;
+  Journal *journal = nullptr;
+  ResultCache *cache = nullptr;
+  Progress *progress = nullptr;
+  ResultHeader header;
+
+  // schedule of the attacks, recorded in the params of every table
+  AttackSchedule schedule;
+
+ public:
+  Exp2(const std::vector<uint64_t> &types, uint64_t counter_bits,
+       uint64_t counter_nums, uint64_t buffer_ways, uint64_t buffer_sets,
+       uint64_t addr_space = 32,
+       ReplacementPolicy policy = ReplacementPolicy::REPL_LRU,
+       const PHTConfig &pht = PHTConfig(),
+       const RekeyConfig &rekey = RekeyConfig(),
+       const CipherConfig &cipher = CipherConfig(),
+       const BTBConfig &btb = BTBConfig(), uint64_t offset_pht = 5,
+       uint64_t offset_btb = 5,
+       const AttackSchedule &schedule = AttackSchedule());
+
+  ~Exp2() { delete bpus; }
+
+  void setWriter(ResultWriter *writer) { this->writer = writer; }
+
+  void setJournal(Journal *journal) { this->journal = journal; }
+
+  void setCache(ResultCache *cache) { this->cache = cache; }
+
+  void setProgress(Progress *progress) { this->progress = progress; }
+
+  // experiment: BTB access under different pruning set size
+  std::vector<std::vector<uint64_t>> BTBPruningAccessIterate(
+      const std::vector<uint64_t> &prune_sizes, uint64_t max_repeats);
+
+  // experiment: BTB collison under different eviction set size
+  std::vector<std::vector<uint64_t>> BTBCollisionRate(
+      uint64_t prune_size, const std::vector<uint64_t> &branch_accesses_num,
+      uint64_t max_repeats);
+};
+#endif
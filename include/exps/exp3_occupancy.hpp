@@ -0,0 +1,137 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/19
+// =============================================================================
+#ifndef EXP3_OCCUPANCY_HPP
+#define EXP3_OCCUPANCY_HPP
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "include/predictors/BPUSet.hpp"
+#include "include/utils/Journal.hpp"
+#include "include/utils/Progress.hpp"
+#include "include/utils/ResultCache.hpp"
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Scheduler.hpp"
+#include "include/utils/Utils.hpp"
+
+class Exp3 {
+ private:
+  std::vector<uint64_t> secrets;
+  BPUSet *bpus;
+
+  // levels of the BTB of the predictors, 1 if single-level
+  uint64_t btb_levels;
+  uint64_t counter_nums;
+  uint64_t buffer_sets;
+  uint64_t addr_mask;
+
+  // result output
+  ResultWriter *writer = nullptr;
+  Journal *journal = nullptr;
+  ResultCache *cache = nullptr;
+  Progress *progress = nullptr;
+  ResultHeader header;
+
+  // schedule of the attacks, recorded in the params of every table
+  AttackSchedule schedule;
+
+  // Victim of an importance-sampling trial. The Monte-Carlo trials estimate
+  // the collision rate of a victim address; over a uniform victim address
+  // (which the attacker, not knowing the keys, cannot tell from the secret),
+  // a collision needs the victim to index one of the few sets of the
+  // attacker. The victim is drawn from the defensive mixture
+  //   q(x) = (1 - bias) p(x) + bias p(x | set_of(x) in sets)
+  // of the uniform draw p and the addresses that index a marked set (by
+  // rejection from p), and the trial is weighted by the likelihood ratio
+  //   p(x) / q(x) = 1 / (1 - bias + bias [set_of(x) in sets] N / |sets|)
+  // of its victim, N the sets of the table. This assumes that a uniform
+  // address indexes a uniform set, which holds for the power-of-two tables
+  // of the XOR-based predictors and up to the cipher for STBPU, HyBP and the
+  // index ciphers (see Cipher.hpp).
+  // Return the victim address and its weight.
+  std::pair<uint64_t, double> drawVictim(
+      const std::vector<bool> &sets, uint64_t bias,
+      const std::function<uint64_t(uint64_t)> &set_of);
+
+  // values of an importance-sampling trial: the collision and its weight
+  // and squared weight in units of 1 / RARE_SCALE
+  static std::vector<uint64_t> rareValues(bool collision, double weight);
+
+ public:
+  Exp3(const std::vector<uint64_t> &types, uint64_t counter_bits,
+       uint64_t counter_nums, uint64_t buffer_ways, uint64_t buffer_sets,
+       uint64_t addr_space = 32,
+       ReplacementPolicy policy = ReplacementPolicy::REPL_LRU,
+       const PHTConfig &pht = PHTConfig(),
+       const RekeyConfig &rekey = RekeyConfig(),
+       const CipherConfig &cipher = CipherConfig(),
+       const BTBConfig &btb = BTBConfig(), uint64_t offset_pht = 5,
+       uint64_t offset_btb = 5,
+       const AttackSchedule &schedule = AttackSchedule());
+
+  ~Exp3() { delete bpus; }
+
+  void setWriter(ResultWriter *writer) { this->writer = writer; }
+
+  void setJournal(Journal *journal) { this->journal = journal; }
+
+  void setCache(ResultCache *cache) { this->cache = cache; }
+
+  void setProgress(Progress *progress) { this->progress = progress; }
+
+  // experiment: PHT access under different pruning set size
+  std::vector<std::vector<uint64_t>> PHTPruningAccessIterate(
+      const std::vector<uint64_t> &prune_sizes, uint64_t occupancy_size,
+      uint64_t max_repeats, uint64_t counter_bits);
+
+  // experiment: BTB access under different pruning set size
+  std::vector<std::vector<uint64_t>> BTBPruningAccessIterate(
+      const std::vector<uint64_t> &prune_sizes, uint64_t occupancy_size,
+      uint64_t max_repeats);
+
+  // experiment: PHT collision rate under different occupancy size
+  std::vector<std::vector<uint64_t>> PHTCollisionRate(
+      uint64_t prune_size, uint64_t occupancy_size,
+      const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats,
+      uint64_t counter_bits);
+
+  // experiment: BTB collision rate under different occupancy size
+  std::vector<std::vector<uint64_t>> BTBCollisionRate(
+      uint64_t prune_size, uint64_t occupancy_size,
+      const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats);
+
+  // experiment: PHT collision rate under different occupancy size, estimated
+  // by importance sampling over the victim address (see drawVictim)
+  std::vector<std::vector<uint64_t>> PHTRareCollisionRate(
+      uint64_t prune_size, uint64_t occupancy_size,
+      const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats,
+      uint64_t counter_bits, uint64_t bias);
+
+  // experiment: BTB collision rate under different occupancy size, estimated
+  // by importance sampling over the victim address (see drawVictim)
+  std::vector<std::vector<uint64_t>> BTBRareCollisionRate(
+      uint64_t prune_size, uint64_t occupancy_size,
+      const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats,
+      uint64_t bias);
+};
+#endif
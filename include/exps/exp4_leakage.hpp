@@ -0,0 +1,132 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/19
+// =============================================================================
+#ifndef EXP4_LEAKAGE_HPP
+#define EXP4_LEAKAGE_HPP
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "include/predictors/BPUSet.hpp"
+#include "include/utils/Journal.hpp"
+#include "include/utils/Leakage.hpp"
+#include "include/utils/Progress.hpp"
+#include "include/utils/ResultCache.hpp"
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Scheduler.hpp"
+#include "include/utils/Utils.hpp"
+
+class Exp4 {
+ private:
+  std::vector<uint64_t> secrets;
+  BPUSet *bpus;
+
+  // result output
+  ResultWriter *writer = nullptr;
+  Journal *journal = nullptr;
+  ResultCache *cache = nullptr;
+  Progress *progress = nullptr;
+  ResultHeader header;
+
+  // schedule of the attacks, recorded in the params of every table
+  AttackSchedule schedule;
+
+  // one-hot histogram row of a trial, an index past the last bin counts in
+  // the last bin (the original loops wrote it into the bins of the next
+  // predictor, which no row of exps/output_ref does)
+  std::vector<uint64_t> histogram(uint64_t idx);
+
+  // joint counts of a predictor
+  uint64_t jointSize();
+
+  // one-hot joint row of a trial, 2^secrets * (secrets + 1) cells of the
+  // executed subset (a bit mask of the secrets) and the observation, from 0
+  // to secrets
+  std::vector<uint64_t> joint(uint64_t executed, uint64_t observation);
+
+  // estimators of the predictors from the joint counts of a row
+  std::vector<LeakageEstimator> estimators(const std::vector<uint64_t> &stat);
+
+  // convergence test of a row: the confidence intervals of all predictors
+  // are at most twice the tolerance (in thousandths of a bit), none if the
+  // tolerance is 0
+  std::function<bool(const std::vector<uint64_t> &)> stopRule(
+      uint64_t tolerance);
+
+  // leakage of every predictor in every row, in bits and bits per access
+  void report(const std::string &experiment,
+              const std::vector<uint64_t> &branch_accesses_num,
+              const std::vector<std::vector<uint64_t>> &stats);
+
+ public:
+  Exp4(const std::vector<uint64_t> &types, uint64_t counter_bits,
+       uint64_t counter_nums, uint64_t buffer_ways, uint64_t buffer_sets,
+       uint64_t secret_size, uint64_t addr_space = 32,
+       ReplacementPolicy policy = ReplacementPolicy::REPL_LRU,
+       const PHTConfig &pht = PHTConfig(),
+       const RekeyConfig &rekey = RekeyConfig(),
+       const CipherConfig &cipher = CipherConfig(),
+       const BTBConfig &btb = BTBConfig(), uint64_t offset_pht = 5,
+       uint64_t offset_btb = 5,
+       const AttackSchedule &schedule = AttackSchedule());
+
+  ~Exp4() { delete bpus; }
+
+  void setWriter(ResultWriter *writer) { this->writer = writer; }
+
+  void setJournal(Journal *journal) { this->journal = journal; }
+
+  void setCache(ResultCache *cache) { this->cache = cache; }
+
+  void setProgress(Progress *progress) { this->progress = progress; }
+
+  // experiment: PHT leakage under different branch access
+  std::vector<std::vector<uint64_t>> PHTLeakage(
+      uint64_t prune_size, uint64_t occupancy_size,
+      const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats,
+      uint64_t counter_bits);
+
+  // experiment: BTB leakage under different branch access
+  std::vector<std::vector<uint64_t>> BTBLeakage(
+      uint64_t prune_size, uint64_t occupancy_size,
+      const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats);
+
+  // experiment: mutual information between the secrets executed by the
+  // victim and the PHT collisions observed by the attacker. Every trial the
+  // victim executes a uniform random subset of the secrets, which is the
+  // secret of the joint counts (see joint): the keys are fixed, so subsets
+  // of the same size are not interchangeable. A row ends early once the
+  // leakage of every predictor is known to -/+ tolerance thousandths of a
+  // bit (0: all repeats).
+  std::vector<std::vector<uint64_t>> PHTMutualInfo(
+      uint64_t prune_size, uint64_t occupancy_size,
+      const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats,
+      uint64_t counter_bits, uint64_t tolerance);
+
+  // experiment: mutual information between the secrets executed by the
+  // victim and the BTB misses of the attacker (see PHTMutualInfo)
+  std::vector<std::vector<uint64_t>> BTBMutualInfo(
+      uint64_t prune_size, uint64_t occupancy_size,
+      const std::vector<uint64_t> &branch_accesses_num, uint64_t max_repeats,
+      uint64_t tolerance);
+};
+#endif
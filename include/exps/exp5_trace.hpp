@@ -0,0 +1,116 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/19
+// =============================================================================
+#ifndef EXP5_TRACE_HPP
+#define EXP5_TRACE_HPP
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "include/predictors/BPUSet.hpp"
+#include "include/utils/Progress.hpp"
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Trace.hpp"
+#include "include/utils/Utils.hpp"
+
+class Exp5 {
+ private:
+  std::vector<uint64_t> types;
+  ReplacementPolicy policy;
+  PHTConfig pht_config;
+  RekeyConfig rekey_config;
+  CipherConfig cipher_config;
+  BTBConfig btb_config;
+  BPUSet *bpus;
+  // private predictors of every domain, created at its first branch
+  std::vector<BPUSet *> isolated;
+
+  // whether the replayed trace is a lookup stream of an attack
+  bool lookup_stream = false;
+
+  // result output
+  ResultWriter *writer = nullptr;
+  Progress *progress = nullptr;
+  ResultHeader header;
+
+  // replay a branch, conditional branches look up the PHT and, if taken, the
+  // BTB; jumps, calls and returns look up the BTB. Every record of a lookup
+  // stream is a single PHT or BTB lookup.
+  void replay(BPUSet *set, uint64_t type, const TraceRecord &record, int &pht,
+              int &btb);
+
+  // answer of a lookup as seen by an attack: a PHT lookup hits or
+  // mispredicts (also if its counter is invalid), a BTB lookup hits,
+  // mispredicts or misses
+  uint64_t answer(int pht, int btb);
+
+  // answer of a recorded lookup
+  uint64_t answer(const TraceRecord &record);
+
+  // predictors of the configured geometry with the given security domains
+  BPUSet *createSet(uint64_t domains);
+
+  // give the predictors the security domains of a trace
+  void setDomains(uint64_t domains);
+
+  // clear the state of all predictors before a replay
+  void resetAll();
+
+  // lookups of a predictor, its private predictors included
+  uint64_t countLookups(uint64_t type);
+
+  // replay a chunk of branches through a predictor, add to its window values
+  void replayChunk(uint64_t type, const TraceRecord *chunk, uint64_t count,
+                   uint64_t *values, bool interference);
+
+ public:
+  Exp5(const std::vector<uint64_t> &types, uint64_t counter_bits,
+       uint64_t counter_nums, uint64_t buffer_ways, uint64_t buffer_sets,
+       uint64_t addr_space = 32,
+       ReplacementPolicy policy = ReplacementPolicy::REPL_LRU,
+       const PHTConfig &pht = PHTConfig(),
+       const RekeyConfig &rekey = RekeyConfig(),
+       const CipherConfig &cipher = CipherConfig(),
+       const BTBConfig &btb = BTBConfig(), uint64_t offset_pht = 5,
+       uint64_t offset_btb = 5);
+
+  ~Exp5();
+
+  void setWriter(ResultWriter *writer) { this->writer = writer; }
+
+  void setProgress(Progress *progress) { this->progress = progress; }
+
+  // experiment: hit rate, occupancy and interference of every window of
+  // branches of a trace. Return false if the trace cannot be opened or has a
+  // malformed record, the window of which is left out of stats.
+  bool TraceReplay(const std::string &path, uint64_t window,
+                   bool interference,
+                   std::vector<std::vector<uint64_t>> &stats);
+
+  // experiment: answer of every predictor to every lookup of a recorded
+  // attack stream, and whether it differs from the recorded answer; return
+  // the number of differences of every predictor in differences. Return
+  // false if the trace cannot be opened, is not a lookup stream or has a
+  // malformed record.
+  bool StreamReplay(const std::string &path,
+                    std::vector<uint64_t> &differences);
+};
+#endif
@@ -0,0 +1,90 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/19
+// =============================================================================
+// Multi-tenant interference: the tenants (security domains 0 .. T-1, the
+// victim is domain 1) share a predictor, each looping over its own working
+// set of random branches as a process of a Scheduler. Every branch looks up
+// the PHT (with a per-branch loop pattern) and the BTB. The tenants run
+// round-robin, quantum branches at a time, or in random slices of quantum
+// branches on average, and the predictor can be flushed on every switch.
+// Per predictor the values of a row are
+//   pht_correct btb_hits victim_pht_correct victim_btb_hits
+// out of the branches of rounds * T slices (rounds * T * quantum with
+// round-robin, of which rounds * quantum are victim branches).
+// =============================================================================
+#ifndef EXP6_TENANTS_HPP
+#define EXP6_TENANTS_HPP
+#include <cstdint>
+#include <vector>
+
+#include "include/predictors/BPUSet.hpp"
+#include "include/utils/Journal.hpp"
+#include "include/utils/Progress.hpp"
+#include "include/utils/ResultCache.hpp"
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Scheduler.hpp"
+#include "include/utils/Utils.hpp"
+
+class Exp6 {
+ private:
+  BPUSet *bpus;
+  uint64_t addr_space;
+
+  // result output
+  ResultWriter *writer = nullptr;
+  Journal *journal = nullptr;
+  ResultCache *cache = nullptr;
+  Progress *progress = nullptr;
+  ResultHeader header;
+
+ public:
+  Exp6(const std::vector<uint64_t> &types, uint64_t counter_bits,
+       uint64_t counter_nums, uint64_t buffer_ways, uint64_t buffer_sets,
+       uint64_t max_tenants, uint64_t addr_space = 32,
+       ReplacementPolicy policy = ReplacementPolicy::REPL_LRU,
+       const PHTConfig &pht = PHTConfig(),
+       const RekeyConfig &rekey = RekeyConfig(),
+       const CipherConfig &cipher = CipherConfig(),
+       const BTBConfig &btb = BTBConfig(), uint64_t offset_pht = 5,
+       uint64_t offset_btb = 5);
+
+  ~Exp6() { delete bpus; }
+
+  void setWriter(ResultWriter *writer) { this->writer = writer; }
+
+  void setJournal(Journal *journal) { this->journal = journal; }
+
+  void setCache(ResultCache *cache) { this->cache = cache; }
+
+  void setProgress(Progress *progress) { this->progress = progress; }
+
+  // a tenant looping over its working set, its lookups count in stat (and
+  // in the victim columns if it is the victim)
+  static Process tenant(Scheduler &scheduler, const uint64_t *working_set,
+                        uint64_t num_branches, bool victim,
+                        std::vector<uint64_t> &stat);
+
+  // experiment: PHT and BTB interference under different tenant counts
+  std::vector<std::vector<uint64_t>> TenantInterference(
+      const std::vector<uint64_t> &tenant_counts, uint64_t repeats,
+      uint64_t num_branches, const ScheduleConfig &schedule, uint64_t rounds);
+};
+#endif
@@ -0,0 +1,134 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/19
+// =============================================================================
+// Design-space exploration: the leakage of every predictor over a grid of
+// geometries (counter bits, PHT counters, BTB ways and sets, index offsets
+// and replacement policy) for one or more experiments. A cell is an
+// (experiment, geometry, predictor) triple, evaluated at the largest budget
+// of the experiment in a worker process (see Workers.hpp).
+//
+// The leakage of a cell is the mean outcome of its trials: the leaked secret
+// bin of the leakage experiments, and the success of the strongest attack of
+// the collision experiments. Cells are evaluated in passes of increasing
+// repeats (the screening passes, then all repeats of the spec). After a
+// screening pass, a configuration is pruned if another one with a table of
+// no larger size leaks less by margin standard errors of both. The final
+// pass puts the remaining configurations on a Pareto front of leakage vs
+// table size. A pass repeats the trials of the smaller passes (cell seeds do
+// not depend on the pass), so with a result cache only the additional
+// repeats are simulated.
+//
+// Per experiment, the rows of the result table are the geometries (key: the
+// index in the grid, the policy varies fastest) with, per predictor,
+//   size_bits leakage stderr repeats pareto
+// where leakage and stderr are in thousandths, repeats are those of the last
+// pass of the configuration and pareto is 1 on the front.
+// =============================================================================
+#ifndef EXP7_EXPLORE_HPP
+#define EXP7_EXPLORE_HPP
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Spec.hpp"
+#include "include/utils/Utils.hpp"
+
+// a point of the design space
+struct ExploreGeometry {
+  uint64_t counter_bits;
+  uint64_t counter_nums;
+  uint64_t buffer_ways;
+  uint64_t buffer_sets;
+  uint64_t offset_pht;
+  uint64_t offset_btb;
+  ReplacementPolicy policy;
+};
+
+// leakage of a configuration after its last pass
+struct ExploreScore {
+  double leakage = 0;
+  double std_error = 0;
+  uint64_t repeats = 0;
+  bool pruned = false;
+  bool pareto = false;
+};
+
+class Exp7 {
+ private:
+  ExperimentSpec spec;
+  uint64_t jobs;
+  std::vector<std::string> modes;
+  // values of the swept parameters in the order of ExploreGeometry
+  std::vector<std::vector<uint64_t>> axes;
+  std::vector<ReplacementPolicy> policies;
+  std::vector<ExploreGeometry> geometries;
+
+  // result output
+  ResultWriter *writer = nullptr;
+  ResultHeader header;
+
+  std::string geometryName(const ExploreGeometry &geometry);
+
+  // "a/b/c" of the values of a swept parameter
+  static std::string valueList(const std::vector<uint64_t> &values);
+
+  // storage of the PHT counters and of the BTB entries (valid bit, tag and
+  // target)
+  uint64_t sizeBits(const ExploreGeometry &geometry);
+
+  // spec of an experiment at its largest budget, the arguments of another
+  // mode than the one of the spec are the defaults of that mode
+  ExperimentSpec experimentSpec(const std::string &mode);
+
+  // mean and standard error of the trials of a cell from its summed row
+  ExploreScore score(const std::string &mode, const std::vector<uint64_t> &row,
+                     uint64_t repeats);
+
+  // prune the configurations of an experiment and predictor that another
+  // one of no larger size beats by margin standard errors of both
+  void prune(std::vector<ExploreScore *> &scores,
+             const std::vector<uint64_t> &sizes);
+
+  // Pareto front of the remaining configurations
+  void rank(std::vector<ExploreScore *> &scores,
+            const std::vector<uint64_t> &sizes);
+
+ public:
+  Exp7(const ExperimentSpec &spec, uint64_t jobs = 0);
+
+  void setWriter(ResultWriter *writer) { this->writer = writer; }
+
+  // whether the leakage of a mode is defined
+  static bool scored(const std::string &mode);
+
+  // the experiments without a leakage score, none if all can be explored
+  std::vector<std::string> unscored();
+
+  // experiment: leakage vs table size over the design space, evaluate runs
+  // the spec of a cell and returns its rows. Return false if a cell failed.
+  bool Explore(
+      const std::function<std::vector<std::vector<uint64_t>>(
+          const ExperimentSpec &)> &evaluate,
+      std::vector<std::vector<uint64_t>> &stats);
+};
+#endif
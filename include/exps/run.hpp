@@ -0,0 +1,49 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/19
+// =============================================================================
+// The evaluation of a spec and the exploration of its design space, shared by
+// the command line (main.cpp) and the library (api/BranchGauge.cpp).
+// =============================================================================
+#ifndef RUN_HPP
+#define RUN_HPP
+#include <cstdint>
+#include <vector>
+
+#include "include/utils/Journal.hpp"
+#include "include/utils/Progress.hpp"
+#include "include/utils/ResultCache.hpp"
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Spec.hpp"
+
+// evaluate an experiment spec and return its rows (none for stream-replay)
+// in rows if not nullptr, return false if the mode is unknown or its trace
+// cannot be replayed
+bool runSpec(const ExperimentSpec &spec, ResultWriter *writer,
+             Journal *journal, ResultCache *cache, Progress *progress,
+             std::vector<std::vector<uint64_t>> *rows = nullptr);
+
+// explore the design space of a spec (see exps/exp7_explore.cpp) with up to
+// jobs worker processes (0: the hardware threads) and return its rows in rows
+// if not nullptr, return false if a mode has no leakage or a cell failed
+bool runExplore(const ExperimentSpec &spec, ResultWriter *writer,
+                ResultCache *cache, uint64_t jobs,
+                std::vector<std::vector<uint64_t>> *rows = nullptr);
+#endif
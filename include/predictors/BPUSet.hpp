@@ -0,0 +1,232 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// The set of evaluated branch predictors with a common interface: every call
+// takes the BPUType of the predictor and a SecurityDomain, and is dispatched
+// to the predictor-specific API (e.g., LS-BP additionally takes the pid of the
+// domain, the baseline takes no domain at all).
+//
+// Only the selected predictors are constructed. The keys of every predictor
+// are drawn from a seed derived from the run seed and the predictor, so a
+// predictor behaves the same whichever other predictors are selected. The
+// keyed predictors (Noisy-XOR-BP, STBPU, HyBP) rotate their keys under the
+// rekey policy of the set (see Rekey.hpp), and the predictors with an index
+// key (all but the baseline and XOR-BP) take the index cipher of the set (see
+// Cipher.hpp). The BTB of every predictor is the BTB hierarchy of the set, a
+// single level by default (see BTBHierarchy.hpp). Besides the attacker and
+// victim, a set can hold further security domains (tenants), each with its
+// own keys and pid. The prune and occupancy attacks run either as the
+// scripts of the predictors (attacks/*.cpp) or, under an attack schedule, as
+// interleaved processes of the attacker, the victim and noise tenants of the
+// further domains (attacks/BPUSet.cpp).
+// =============================================================================
+#ifndef BPU_SET_HPP
+#define BPU_SET_HPP
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "include/predictors/BSUP.hpp"
+#include "include/predictors/BTBHierarchy.hpp"
+#include "include/predictors/BaseBPU.hpp"
+#include "include/predictors/Domains.hpp"
+#include "include/predictors/HistoryPHT.hpp"
+#include "include/predictors/HyBP.hpp"
+#include "include/predictors/LSBP.hpp"
+#include "include/predictors/NoisyXorBP.hpp"
+#include "include/predictors/Rekey.hpp"
+#include "include/predictors/STBPU.hpp"
+#include "include/predictors/XorBP.hpp"
+#include "include/utils/Cipher.hpp"
+#include "include/utils/Utils.hpp"
+
+struct AttackSchedule;
+
+class BPUSet {
+ private:
+  BaseBPU *base_bpu = nullptr;
+  BSUP *bsup = nullptr;
+  XorBP *xorbp = nullptr;
+  NoisyXorBP *noisyxorbp = nullptr;
+  LSBP *lsbp = nullptr;
+  STBPU *stbpu = nullptr;
+  HyBP *hybp = nullptr;
+
+  uint64_t attacker_pid;
+  uint64_t victim_pid;
+
+  // pid of every security domain, the attacker and victim first
+  std::vector<uint64_t> pids;
+
+  // selected predictors (BPUType)
+  std::vector<uint64_t> types;
+
+  // geometry of the attacker's address draws
+  uint64_t addr_mask;
+  uint64_t offset_pht;
+  uint64_t offset_btb;
+  uint64_t buffer_ways;
+  uint64_t btb_set_bits;
+
+  // schedule of the prune and occupancy attacks, none for the scripts
+  AttackSchedule *schedule = nullptr;
+
+  // prune and occupancy attacks as scheduled processes
+  std::pair<std::vector<uint64_t>, uint64_t> scheduledBTBPrune(
+      uint64_t type, uint64_t num_loops, uint64_t victim_addr,
+      uint64_t prune_size, uint64_t eviction_size);
+
+  std::pair<std::vector<uint64_t>, uint64_t> scheduledPHTOccupancy(
+      uint64_t type, uint64_t num_loops, uint64_t counter_bits,
+      uint64_t prune_size, uint64_t occupancy_size);
+
+  std::pair<std::vector<uint64_t>, uint64_t> scheduledBTBOccupancy(
+      uint64_t type, uint64_t num_loops, uint64_t prune_size,
+      uint64_t occupancy_size);
+
+ public:
+  BPUSet(const std::vector<uint64_t> &types, uint64_t counter_bits,
+         uint64_t counter_nums, uint64_t buffer_ways, uint64_t buffer_sets,
+         uint64_t addr_space = 32,
+         ReplacementPolicy policy = ReplacementPolicy::REPL_LRU,
+         const PHTConfig &pht = PHTConfig(),
+         const RekeyConfig &rekey = RekeyConfig(),
+         const CipherConfig &cipher = CipherConfig(),
+         const BTBConfig &btb = BTBConfig(),
+         uint64_t domains = NUM_ATTACK_DOMAINS, uint64_t offset_pht = 5,
+         uint64_t offset_btb = 5);
+
+  ~BPUSet();
+
+  // all predictors in the order of BPUType
+  static std::vector<uint64_t> allTypes();
+
+  // parse a predictor name (case-insensitive), return false if unknown
+  static bool parseType(const std::string &name, uint64_t &type);
+
+  uint64_t size() { return types.size(); }
+
+  // BPUType of the i-th selected predictor
+  uint64_t getType(uint64_t index) { return types[index]; }
+
+  std::vector<std::string> getNames();
+
+  // security domains of the predictors (see Domains.hpp)
+  uint64_t getDomains() { return pids.size(); }
+
+  // run the prune and occupancy attacks as scheduled processes, with a noise
+  // tenant in each domain after the attacker and victim
+  void setSchedule(const AttackSchedule &schedule);
+
+  // clear the PHT and BTB state of a predictor
+  void reset(uint64_t type);
+
+  // clear the PHT and BTB entries of a predictor but keep its keys
+  void flush(uint64_t type);
+
+  // valid PHT counters and BTB entries of a predictor
+  uint64_t getPHTOccupancy(uint64_t type);
+
+  uint64_t getBTBOccupancy(uint64_t type);
+
+  // PHT and BTB lookups of a predictor
+  uint64_t getLookups(uint64_t type);
+
+  // lookups of the i-th selected predictor, the lookup counter of a Sweep
+  std::function<uint64_t(uint64_t)> lookupCounter();
+
+  // pid of a security domain (LS-BP)
+  uint64_t getPID(uint64_t domain);
+
+  uint64_t getBufferWays() { return buffer_ways; }
+
+  // address of an attack (AttackKind) on a predictor, drawn as by its script,
+  // any address for ATK_NONE
+  uint64_t attackAddr(uint64_t type, uint64_t attack, uint64_t victim_addr);
+
+  // counter bits of a predictor (BSUP uses 3-bit counters)
+  uint64_t getCounterBits(uint64_t type, uint64_t counter_bits);
+
+  bool lookupPHT(uint64_t type, uint64_t pc, bool taken, uint64_t domain);
+
+  int lookupBTB(uint64_t type, uint64_t pc, uint64_t target, uint64_t domain);
+
+  int checkPHTSetCollision(uint64_t type, uint64_t addr1, uint64_t domain1,
+                           uint64_t addr2, uint64_t domain2);
+
+  // PHT and BTB set of an address in a domain
+  uint64_t getPHTSet(uint64_t type, uint64_t addr, uint64_t domain);
+
+  uint64_t getBTBSet(uint64_t type, uint64_t addr, uint64_t domain);
+
+  // first BTB level holding an address in a domain, 0 for a single-level BTB
+  // and the number of levels if none (see BTBHierarchy.hpp)
+  uint64_t getBTBLevel(uint64_t type, uint64_t addr, uint64_t domain);
+
+  void getBTBLevels(uint64_t type, const std::vector<uint64_t> &addrs,
+                    uint64_t domain, std::vector<uint64_t> &levels);
+
+  // sets of a batch of addresses, vectorized for STBPU
+  void getPHTSets(uint64_t type, const std::vector<uint64_t> &addrs,
+                  uint64_t domain, std::vector<uint64_t> &sets);
+
+  void getBTBSets(uint64_t type, const std::vector<uint64_t> &addrs,
+                  uint64_t domain, std::vector<uint64_t> &sets);
+
+  // reuse-based attack
+  std::pair<uint64_t, uint64_t> PHTTiming(uint64_t type, uint64_t num_loops,
+                                          uint64_t counter_bits,
+                                          uint64_t victim_addr);
+
+  std::pair<uint64_t, uint64_t> PHTSpeculative(uint64_t type,
+                                               uint64_t num_loops,
+                                               uint64_t counter_bits,
+                                               uint64_t victim_addr);
+
+  std::pair<uint64_t, uint64_t> BTBTiming(uint64_t type, uint64_t num_loops,
+                                          uint64_t victim_addr,
+                                          uint64_t target_addr);
+
+  std::pair<uint64_t, uint64_t> BTBSpeculative(uint64_t type,
+                                               uint64_t num_loops,
+                                               uint64_t victim_addr,
+                                               uint64_t target_addr,
+                                               uint64_t covert_channel);
+
+  // prune-based attack
+  std::pair<std::vector<uint64_t>, uint64_t> BTBPrune(uint64_t type,
+                                                      uint64_t num_loops,
+                                                      uint64_t victim_addr,
+                                                      uint64_t prune_size,
+                                                      uint64_t eviction_size);
+
+  // occupancy-based attack
+  std::pair<std::vector<uint64_t>, uint64_t> PHTOccupancy(
+      uint64_t type, uint64_t num_loops, uint64_t counter_bits,
+      uint64_t prune_size, uint64_t occupancy_size);
+
+  std::pair<std::vector<uint64_t>, uint64_t> BTBOccupancy(
+      uint64_t type, uint64_t num_loops, uint64_t prune_size,
+      uint64_t occupancy_size);
+};
+#endif
@@ -30,48 +30,104 @@
 #include <cstdlib>
 #include <vector>
 
+#include "include/predictors/BTBHierarchy.hpp"
+#include "include/predictors/Domains.hpp"
+#include "include/predictors/HistoryPHT.hpp"
+#include "include/utils/Cipher.hpp"
+#include "include/utils/Llbc.hpp"
 #include "include/utils/Utils.hpp"
 
 class BSUP {
  private:
-  // address space
+  // address space and its mask
   uint64_t addr_space;
+  uint64_t addr_mask;
 
   // parameters for PHT
   uint64_t counter_bits;
   uint64_t counter_nums;
   uint64_t offset_pht;
+  uint64_t pht_set_bits;  // log2(counter_nums)
 
   // parameters for BTB
   uint64_t buffer_ways;
   uint64_t buffer_sets;
   uint64_t offset_btb;
+  uint64_t btb_set_bits;                 // log2(buffer_sets)
   ReplacementPolicy buffer_replacement;  // 0: LRU, 1: Random
 
   // data structures for PHT
   std::vector<uint64_t> PHT_valid;
   std::vector<uint64_t> PHT_counter;
 
+  // global-history model replacing the bimodal PHT, nullptr if bimodal
+  HistoryPHT *history = nullptr;
+
+  // multi-level BTB replacing the BTB, nullptr if single-level
+  BTBHierarchy *btb_levels = nullptr;
+
+  // PHT and BTB lookups, read by the progress reporter
+  uint64_t lookups = 0;
+
   // data structures for BTB
   std::vector<std::vector<uint64_t>> BTB_valid;
   std::vector<std::vector<uint64_t>> BTB_src;
   std::vector<std::vector<uint64_t>> BTB_dest;
   std::vector<std::vector<uint64_t>> BTB_lru;
 
-  // encryption keys
-  std::vector<uint64_t> index_keys;
-  std::vector<uint64_t> content_keys;
+  // encryption keys of a security domain
+  struct DomainKeys {
+    uint64_t index_key;
+    uint64_t content_key;
+  };
+
+  // key table, one row per domain (see Domains.hpp)
+  std::vector<DomainKeys> keys;
+
+  // block cipher replacing the XOR of the index key, nullptr for the XOR
+  BlockCipher *index_cipher = nullptr;
+
+  // index of an address under the index key of a domain
+  uint64_t indexEncrypt(uint64_t plain, uint64_t domain);
+
+  // LLBC of the content key of every domain on targets and on PHT counters
+  std::vector<LLBC> dest_ciphers;
+  std::vector<LLBC> counter_ciphers;
+
+  // build the ciphers of the content keys on blocks of the given width
+  void initCiphers(std::vector<LLBC> &ciphers, uint64_t width);
+
+  // encryption of a PHT counter
+  uint64_t encryptCounter(uint64_t counter, uint64_t domain);
+
+  uint64_t decryptCounter(uint64_t counter, uint64_t domain);
+
+  // write an encrypted target to a way of a BTB set and make it the MRU
+  void writeBTB(uint64_t index, uint64_t way, uint64_t dest);
 
  public:
-  BSUP(uint64_t addr_space = 32) : addr_space(addr_space) {
+  BSUP(uint64_t addr_space = 32, uint64_t domains = NUM_ATTACK_DOMAINS)
+      : addr_space(addr_space),
+        addr_mask(addrMask(addr_space)),
+        keys(domains) {
 #ifdef RANDOM_KEY
-    this->index_keys = {rand() & ((1ULL << addr_space) - 1),
-                        rand() & ((1ULL << addr_space) - 1)};
-    this->content_keys = this->index_keys;
+    drawDomainKeys(keys, {&DomainKeys::index_key}, addr_space);
+    for (DomainKeys &row : keys) {
+      row.content_key = row.index_key;
+    }
 #else
-    this->index_keys = {EncryptionKey::KEY_0, EncryptionKey::KEY_1};
-    this->content_keys = {EncryptionKey::KEY_0, EncryptionKey::KEY_1};
+    fixDomainKeys(keys, &DomainKeys::index_key, EncryptionKey::KEY_0,
+                  EncryptionKey::KEY_1);
+    fixDomainKeys(keys, &DomainKeys::content_key, EncryptionKey::KEY_0,
+                  EncryptionKey::KEY_1);
 #endif
+    initCiphers(dest_ciphers, addr_space);
+  }
+
+  ~BSUP() {
+    delete history;
+    delete btb_levels;
+    delete index_cipher;
   }
 
   // init
@@ -82,6 +138,30 @@ class BSUP {
       uint64_t buffer_ways, uint64_t buffer_sets, uint64_t offset_btb = 5,
       ReplacementPolicy buffer_replacement = ReplacementPolicy::REPL_LRU);
 
+  // direction model of the PHT (see HistoryPHT.hpp), after initPHT
+  void initHistory(const PHTConfig &config);
+
+  // levels of the BTB (see BTBHierarchy.hpp), after initBTB
+  void initLevels(const BTBConfig &config);
+
+  // index cipher (see Cipher.hpp), CIPHER_NATIVE keeps the XOR
+  void initCipher(const CipherConfig &config);
+
+  // clear the PHT and BTB state
+  void reset();
+
+  // clear the PHT and BTB entries but keep the keys (a flush on a context
+  // switch)
+  void flush();
+
+  // valid entries of the PHT and BTB
+  uint64_t getPHTOccupancy();
+
+  uint64_t getBTBOccupancy();
+
+  // PHT and BTB lookups since construction
+  uint64_t getLookups() { return lookups; }
+
   // encryption and decryption
   uint64_t encrypt(uint64_t plain, uint64_t key);
 
@@ -96,6 +176,13 @@ class BSUP {
 
   uint64_t getBTBDest(uint64_t dest, uint64_t domain);
 
+  // first BTB level holding a branch, the number of levels if none
+  uint64_t getBTBLevel(uint64_t pc, uint64_t domain);
+
+  // encrypted targets of a batch of targets
+  void getBTBDests(const uint64_t *dests, uint64_t count, uint64_t domain,
+                   uint64_t *encrypted);
+
   bool lookupPHT(uint64_t pc, bool taken, uint64_t domain);
 
   void updatePHT(uint64_t pc, bool taken, uint64_t domain);
@@ -0,0 +1,181 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Multi-level BTB that replaces the single-level BTB of a predictor: small
+// upper levels (L0, L1, ...) in front of the BTB of the geometry, which is
+// the last level. A branch is identified by its line, the BTB set and tag of
+// the predictor (getBTBSet, getBTBTag), so the keyed index randomization of
+// the predictor applies to every level. The last level is indexed by the set
+// of the line; an upper level either by its low bits (as a smaller table
+// indexed by the same bits) or, if keyed, by a hash of the line under a key
+// of its own, so that the sets of one level say nothing about the others.
+// The level keys are drawn anew (predictorRand) with every reset of the
+// predictor and every rekey epoch, which also invalidate all levels.
+//
+// Lookups go from L0 down to the first level holding the line. Inclusion:
+//   nine       non-inclusive non-exclusive: a line is filled into every
+//              level above the one that hit (all levels on a miss), and
+//              every level evicts on its own
+//   inclusive  as nine, and a line evicted from a level is invalidated in
+//              the levels above it (back-invalidation)
+//   exclusive  a line lives in one level: it is moved to L0 on a hit below,
+//              and the victims move one level down, out of the last level
+//
+// The levels are one flat array of entries, level by level and set by set;
+// entries are valid in the current epoch only, so a flush is O(1). Every
+// level has its own replacement policy, LRU by the time of the last access
+// that reached the level: a hit in L0 does not refresh the copies below it.
+// A corrected target (a mispredict) is written to every level holding the
+// line, so a copy below never answers with a stale target.
+// =============================================================================
+#ifndef BTB_HIERARCHY_HPP
+#define BTB_HIERARCHY_HPP
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "include/utils/Utils.hpp"
+
+enum BTBInclusion {
+  BTB_NINE = 0,
+  BTB_INCLUSIVE = 1,
+  BTB_EXCLUSIVE = 2,
+  NUM_BTB_INCLUSIONS = 3
+};
+
+// inclusion names in the order of BTBInclusion
+static const char *const BTB_INCLUSION_NAMES[] = {"nine", "inclusive",
+                                                  "exclusive"};
+
+// most levels of a hierarchy, the last one included
+#define BTB_MAX_LEVELS 4
+
+struct BTBLevelConfig {
+  uint64_t sets = 16;
+  uint64_t ways = 4;
+  ReplacementPolicy policy = ReplacementPolicy::REPL_LRU;
+  // indexed by a keyed hash of the line instead of the low bits of its set
+  bool keyed = false;
+};
+
+struct BTBConfig {
+  // levels in front of the BTB of the geometry, L0 first, none for a
+  // single-level BTB
+  std::vector<BTBLevelConfig> levels;
+  uint64_t inclusion = BTBInclusion::BTB_NINE;
+};
+
+// "single" or the inclusion and the upper levels, e.g.
+// "inclusive/16x4-lru-keyed/256x4-random"
+std::string btbName(const BTBConfig &config);
+
+// parse an inclusion name, return false if unknown
+bool parseBTBInclusion(const std::string &name, uint64_t &inclusion);
+
+// whether a hierarchy can be built: at most BTB_MAX_LEVELS levels of some
+// sets and ways
+bool checkBTBConfig(const BTBConfig &config);
+
+class BTBHierarchy {
+ private:
+  struct Entry {
+    uint64_t epoch;  // valid if the current epoch
+    uint64_t set;    // line: BTB set and tag of the predictor
+    uint64_t tag;
+    uint64_t dest;
+    uint64_t stamp;  // time of the last access
+  };
+
+  struct Level {
+    uint64_t sets;
+    uint64_t ways;
+    ReplacementPolicy policy;
+    bool keyed;
+    uint64_t key;
+    uint64_t base;  // first entry in entries
+  };
+
+  uint64_t inclusion;
+  std::vector<Level> levels;
+  std::vector<Entry> entries;
+  uint64_t epoch = 1;
+  uint64_t stamp = 0;
+
+  // level of the line of the last lookup, and the last-level set of the line
+  // it evicted from the hierarchy (-1 if none)
+  uint64_t hit_level = 0;
+  uint64_t evicted_set = -1;
+
+  // first entry of the set of a line in a level
+  uint64_t setBase(uint64_t level, uint64_t set, uint64_t tag) const;
+
+  // key of a keyed level
+  static uint64_t drawKey();
+
+  // valid entry of a line in the set at base of a level, nullptr if none
+  Entry *find(uint64_t level, uint64_t base, uint64_t set, uint64_t tag);
+
+  // write a line into the set at base of a level, return true and the
+  // replaced line in victim if a valid line was replaced
+  bool insert(uint64_t level, uint64_t base, const Entry &line,
+              Entry &victim);
+
+  // fill a line into the set at base of a level (nine, inclusive)
+  void fill(uint64_t level, uint64_t base, const Entry &line);
+
+ public:
+  // upper levels of a config in front of a last level of buffer_sets sets
+  // and buffer_ways ways, the keys of the keyed levels from predictorRand()
+  BTBHierarchy(const BTBConfig &config, uint64_t buffer_ways,
+               uint64_t buffer_sets, ReplacementPolicy policy);
+
+  // hierarchy of a config, nullptr for a single-level BTB
+  static BTBHierarchy *create(const BTBConfig &config, uint64_t buffer_ways,
+                              uint64_t buffer_sets, ReplacementPolicy policy);
+
+  // look up and update the line of a branch with its (encoded) target,
+  // return 1 if the target is correct, 0 on a mispredict and -1 on a miss
+  int lookup(uint64_t set, uint64_t tag, uint64_t dest);
+
+  // whether the last lookup evicted a line out of the last level, and its set
+  bool evicted(uint64_t &set) const {
+    set = evicted_set;
+    return evicted_set != (uint64_t)-1;
+  }
+
+  // level that served the last lookup, getLevels() on a miss
+  uint64_t getHitLevel() const { return hit_level; }
+
+  // first level holding a line, getLevels() if none (without side effects)
+  uint64_t getLevel(uint64_t set, uint64_t tag);
+
+  uint64_t getLevels() const { return levels.size(); }
+
+  // invalidate all entries
+  void flush() { epoch++; }
+
+  // draw new keys for the keyed levels and invalidate all entries
+  void rekey();
+
+  // valid entries of all levels
+  uint64_t getOccupancy();
+};
+#endif
@@ -25,36 +25,56 @@
 #include <cstdint>
 #include <vector>
 
+#include "include/predictors/BTBHierarchy.hpp"
+#include "include/predictors/HistoryPHT.hpp"
 #include "include/utils/Utils.hpp"
 
 class BaseBPU {
  private:
-  // address space
+  // address space and its mask
   uint64_t addr_space;
+  uint64_t addr_mask;
 
   // parameters for PHT
   uint64_t counter_bits;
   uint64_t counter_nums;
   uint64_t offset_pht;
+  uint64_t pht_set_bits;  // log2(counter_nums)
 
   // parameters for BTB
   uint64_t buffer_ways;
   uint64_t buffer_sets;
   uint64_t offset_btb;
+  uint64_t btb_set_bits;                 // log2(buffer_sets)
   ReplacementPolicy buffer_replacement;  // 0: LRU, 1: Random
 
   // data structures for PHT
   std::vector<uint64_t> PHT_valid;
   std::vector<uint64_t> PHT_counter;
 
+  // global-history model replacing the bimodal PHT, nullptr if bimodal
+  HistoryPHT *history = nullptr;
+
   // data structures for BTB
   std::vector<std::vector<uint64_t>> BTB_valid;
   std::vector<std::vector<uint64_t>> BTB_src;
   std::vector<std::vector<uint64_t>> BTB_dest;
   std::vector<std::vector<uint64_t>> BTB_lru;
 
+  // multi-level BTB replacing the BTB, nullptr if single-level
+  BTBHierarchy *btb_levels = nullptr;
+
+  // PHT and BTB lookups, read by the progress reporter
+  uint64_t lookups = 0;
+
  public:
-  BaseBPU(uint64_t addr_space = 32) : addr_space(addr_space) {}
+  BaseBPU(uint64_t addr_space = 32)
+      : addr_space(addr_space), addr_mask(addrMask(addr_space)) {}
+
+  ~BaseBPU() {
+    delete history;
+    delete btb_levels;
+  }
 
   // init
   void initPHT(uint64_t counter_bits, uint64_t counter_nums,
@@ -64,6 +84,26 @@ class BaseBPU {
       uint64_t buffer_ways, uint64_t buffer_sets, uint64_t offset_btb = 5,
       ReplacementPolicy buffer_replacement = ReplacementPolicy::REPL_LRU);
 
+  // direction model of the PHT (see HistoryPHT.hpp), after initPHT
+  void initHistory(const PHTConfig &config);
+
+  // levels of the BTB (see BTBHierarchy.hpp), after initBTB
+  void initLevels(const BTBConfig &config);
+
+  // clear the PHT and BTB state
+  void reset();
+
+  // clear the PHT and BTB entries (a flush on a context switch)
+  void flush();
+
+  // valid entries of the PHT and BTB
+  uint64_t getPHTOccupancy();
+
+  uint64_t getBTBOccupancy();
+
+  // PHT and BTB lookups since construction
+  uint64_t getLookups() { return lookups; }
+
   // get set and tag in PHT and BTB
   uint64_t getPHTSet(uint64_t pc);
 
@@ -73,6 +113,9 @@ class BaseBPU {
 
   uint64_t getBTBDest(uint64_t dest);
 
+  // first BTB level holding a branch, the number of levels if none
+  uint64_t getBTBLevel(uint64_t pc);
+
   bool lookupPHT(uint64_t pc, bool taken);
 
   void updatePHT(uint64_t pc, bool taken);
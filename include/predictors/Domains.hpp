@@ -0,0 +1,87 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Security domains of the predictors. Domain 0 is the attacker and domain 1
+// the victim of the attacks (SecurityDomain); the domains above them are the
+// other tenants (SMT threads, processes, VMs) of the multi-tenant experiments.
+//
+// A keyed predictor keeps the keys of a domain in one row of a key table (a
+// struct of its keys per domain, stored contiguously), so a lookup reads a
+// single row and switching the domain only changes the row. The attacker and
+// victim keys are drawn first and in the order of the two-domain predictors,
+// so they do not depend on the number of domains.
+// =============================================================================
+#ifndef DOMAINS_HPP
+#define DOMAINS_HPP
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <vector>
+
+#include "include/utils/Utils.hpp"
+
+// most security domains of a predictor
+#define MAX_DOMAINS 1024
+
+// the attacker and the victim
+#define NUM_ATTACK_DOMAINS 2
+
+// draw the keys of every domain from rand(), as wide as the address space
+template <typename Keys>
+void drawDomainKeys(std::vector<Keys> &keys,
+                    std::initializer_list<uint64_t Keys::*> slots,
+                    uint64_t addr_space) {
+  uint64_t mask = addrMask(addr_space);
+  // attacker and victim first, key by key
+  for (uint64_t Keys::*slot : slots) {
+    for (uint64_t domain = 0;
+         domain < keys.size() && domain < NUM_ATTACK_DOMAINS; domain++) {
+      keys[domain].*slot = randomAddr(mask);
+    }
+  }
+  for (uint64_t domain = NUM_ATTACK_DOMAINS; domain < keys.size(); domain++) {
+    for (uint64_t Keys::*slot : slots) {
+      keys[domain].*slot = randomAddr(mask);
+    }
+  }
+}
+
+// fixed key of every domain: the given keys of the attacker and victim, and
+// keys derived from both for the other tenants
+template <typename Keys>
+void fixDomainKeys(std::vector<Keys> &keys, uint64_t Keys::*slot,
+                   uint64_t attacker_key, uint64_t victim_key) {
+  for (uint64_t domain = 0; domain < keys.size(); domain++) {
+    if (domain == SecurityDomain::DOM_ATTACKER) {
+      keys[domain].*slot = attacker_key;
+    } else if (domain == SecurityDomain::DOM_VICTIM) {
+      keys[domain].*slot = victim_key;
+    } else {
+      // splitmix64 finalizer, truncated to the width of the fixed keys
+      uint64_t z = attacker_key ^ (victim_key << 32) ^
+                   (domain * 0x9E3779B97F4A7C15ULL);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      keys[domain].*slot = (z ^ (z >> 31)) & 0xFFFFFFFF;
+    }
+  }
+}
+#endif
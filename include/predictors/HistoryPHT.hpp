@@ -0,0 +1,168 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Global-history direction predictors that replace the bimodal PHT of a
+// predictor:
+//   gshare      one table indexed by the set XOR the folded global history
+//   tournament  bimodal and gshare tables with a per-set 2-bit chooser
+//   tage        a bimodal base and tagged tables with geometric histories,
+//               the longest matching table provides the prediction
+//
+// Every model is indexed by the PHT set of the predictor (getPHTSet), so the
+// keyed index randomization (XOR, QARMA, ...) applies before the history is
+// mixed in. One global history is shared by all security domains, as in a
+// core. Histories are kept folded to the width of every index and tag and
+// updated in O(1) per branch; table entries are packed into bytes (bit 7
+// valid, the counter below). Every table has the size of the PHT, which must
+// be a power of two.
+// =============================================================================
+#ifndef HISTORY_PHT_HPP
+#define HISTORY_PHT_HPP
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// direction predictor of the PHT
+enum PHTModel {
+  PHT_BIMODAL = 0,
+  PHT_GSHARE = 1,
+  PHT_TOURNAMENT = 2,
+  PHT_TAGE = 3,
+  NUM_PHT_MODELS = 4
+};
+
+// model names in the order of PHTModel
+static const char *const PHT_MODEL_NAMES[] = {"bimodal", "gshare",
+                                              "tournament", "tage"};
+
+// longest global history of any model
+#define PHT_MAX_HISTORY 1024
+
+// longest TAGE tag and most TAGE tables
+#define PHT_MAX_TAG_BITS 16
+#define PHT_MAX_TABLES 16
+
+struct PHTConfig {
+  uint64_t model = PHTModel::PHT_BIMODAL;
+  // global history of gshare and the tournament
+  uint64_t history = 16;
+  // tagged tables of TAGE, histories grow geometrically from min to max
+  uint64_t tage_tables = 4;
+  uint64_t tage_min_history = 4;
+  uint64_t tage_max_history = 64;
+  uint64_t tage_tag_bits = 9;
+};
+
+// "bimodal", "gshare/h16", "tournament/h16" or "tage/t4/h4-64/tag9"
+std::string phtName(const PHTConfig &config);
+
+// parse a model name, return false if unknown
+bool parsePHTModel(const std::string &name, uint64_t &model);
+
+// whether a model can be built for a PHT of counter_nums counter_bits-bit
+// counters (the bimodal PHT of the predictor always can)
+bool checkPHTConfig(const PHTConfig &config, uint64_t counter_bits,
+                    uint64_t counter_nums);
+
+// a history of length bits folded by XOR into width bits
+struct FoldedHistory {
+  uint64_t value = 0;
+  uint64_t length = 0;
+  uint64_t width = 1;
+  // position of the bit leaving the history
+  uint64_t outpoint = 0;
+
+  void init(uint64_t length, uint64_t width);
+
+  // shift in the newest outcome, shift out the one length branches ago
+  void update(uint64_t newest, uint64_t oldest) {
+    value = (value << 1) | newest;
+    value ^= oldest << outpoint;
+    value ^= value >> width;
+    value &= (1ULL << width) - 1;
+  }
+};
+
+class HistoryPHT {
+ private:
+  // tagged entry of TAGE
+  struct TageEntry {
+    uint16_t tag;
+    uint8_t counter;  // bit 7 valid, 3-bit counter
+    uint8_t useful;   // 2-bit
+  };
+
+  PHTConfig config;
+  uint64_t counter_bits;
+  uint64_t counter_nums;
+  uint64_t index_bits;
+  uint64_t index_mask;
+
+  // global history, bit d of the history is buffer[(head + d) & mask]
+  std::vector<uint8_t> buffer;
+  uint64_t head = 0;
+  uint64_t mask;
+
+  // bimodal base (tournament, TAGE), gshare table and chooser (tournament)
+  std::vector<uint8_t> base;
+  std::vector<uint8_t> gshare;
+  std::vector<uint8_t> chooser;
+  FoldedHistory gshare_fold;
+
+  // tagged tables of TAGE, table t at [t * counter_nums]
+  std::vector<TageEntry> tage;
+  std::vector<FoldedHistory> index_folds;
+  std::vector<FoldedHistory> tag_folds;
+  uint64_t tag_mask;
+  uint64_t updates = 0;
+
+  // entries and tags of the current branch
+  uint64_t indices[PHT_MAX_TABLES];
+  uint64_t tags[PHT_MAX_TABLES];
+
+  // packed counter of counter_bits, initialized to taken like the bimodal PHT
+  int lookupCounter(uint8_t &entry, bool taken);
+
+  int lookupTournament(uint64_t set, bool taken);
+
+  int lookupTAGE(uint64_t set, bool taken);
+
+  void pushHistory(bool taken);
+
+ public:
+  HistoryPHT(const PHTConfig &config, uint64_t counter_bits,
+             uint64_t counter_nums);
+
+  // model of a config, nullptr for the bimodal PHT of the predictor
+  static HistoryPHT *create(const PHTConfig &config, uint64_t counter_bits,
+                            uint64_t counter_nums);
+
+  // predict and update the branch of a PHT set, return 1 if the prediction
+  // is correct, 0 on a mispredict and -1 if the entry was invalid
+  int lookup(uint64_t set, bool taken);
+
+  // clear the tables and the history
+  void reset();
+
+  // valid entries of all tables
+  uint64_t getOccupancy();
+};
+#endif
@@ -31,61 +31,101 @@
 #include <cstdlib>
 #include <vector>
 
-#include "include/utils/Qarma64.hpp"
+#include "include/predictors/BTBHierarchy.hpp"
+#include "include/predictors/Domains.hpp"
+#include "include/predictors/HistoryPHT.hpp"
+#include "include/predictors/Rekey.hpp"
+#include "include/utils/Cipher.hpp"
 #include "include/utils/Utils.hpp"
 
 class HyBP {
  private:
-  // address space
+  // address space and its mask
   uint64_t addr_space;
+  uint64_t addr_mask;
 
   // parameters for PHT
   uint64_t counter_bits;
   uint64_t counter_nums;
   uint64_t offset_pht;
+  uint64_t pht_set_bits;  // log2(counter_nums)
 
   // parameters for BTB
   uint64_t buffer_ways;
   uint64_t buffer_sets;
   uint64_t offset_btb;
+  uint64_t btb_set_bits;                 // log2(buffer_sets)
   ReplacementPolicy buffer_replacement;  // 0: LRU, 1: Random
 
   // data structures for PHT
   std::vector<uint64_t> PHT_valid;
   std::vector<uint64_t> PHT_counter;
 
+  // global-history model replacing the bimodal PHT, nullptr if bimodal
+  HistoryPHT *history = nullptr;
+
+  // multi-level BTB replacing the BTB, nullptr if single-level
+  BTBHierarchy *btb_levels = nullptr;
+
+  // PHT and BTB lookups, read by the progress reporter
+  uint64_t lookups = 0;
+
   // data structures for BTB
   std::vector<std::vector<uint64_t>> BTB_valid;
   std::vector<std::vector<uint64_t>> BTB_src;
   std::vector<std::vector<uint64_t>> BTB_dest;
   std::vector<std::vector<uint64_t>> BTB_lru;
 
-  // encryption keys
-  std::vector<uint64_t> index_tweaks;
-  std::vector<uint64_t> index_w0s;
-  std::vector<uint64_t> index_k0s;
-  std::vector<uint64_t> content_keys;
-  QARMA *qarma = new QARMA();
+  // encryption keys of a security domain
+  struct DomainKeys {
+    uint64_t index_tweak;
+    uint64_t index_w0;
+    uint64_t index_k0;
+    uint64_t content_key;
+  };
+
+  // key table, one row per domain (see Domains.hpp)
+  std::vector<DomainKeys> keys;
+
+  // index cipher, one round of QARMA-64 unless a cipher config replaces it
+  BlockCipher *index_cipher =
+      BlockCipher::create({CipherType::CIPHER_QARMA64, 1});
+
+  // key rotation (see Rekey.hpp) and the keys of the first epoch
+  RekeyEpochs rekey;
+  std::vector<DomainKeys> initial_keys;
+
+  // draw new keys for all domains
+  void redrawKeys();
 
  public:
-  HyBP(uint64_t addr_space = 32) : addr_space(addr_space) {
+  HyBP(uint64_t addr_space = 32, uint64_t domains = NUM_ATTACK_DOMAINS)
+      : addr_space(addr_space),
+        addr_mask(addrMask(addr_space)),
+        keys(domains) {
 #ifdef RANDOM_KEY
-    this->index_tweaks = {rand() & ((1ULL << addr_space) - 1),
-                          rand() & ((1ULL << addr_space) - 1)};
-    this->index_w0s = {rand() & ((1ULL << addr_space) - 1),
-                       rand() & ((1ULL << addr_space) - 1)};
-    this->index_k0s = {rand() & ((1ULL << addr_space) - 1),
-                       rand() & ((1ULL << addr_space) - 1)};
-    this->content_keys = {rand() & ((1ULL << addr_space) - 1),
-                          rand() & ((1ULL << addr_space) - 1)};
+    drawDomainKeys(keys,
+                   {&DomainKeys::index_tweak, &DomainKeys::index_w0,
+                    &DomainKeys::index_k0, &DomainKeys::content_key},
+                   addr_space);
 #else
-    this->index_tweaks = {EncryptionKey::KEY_0, EncryptionKey::KEY_1};
-    this->index_w0s = {EncryptionKey::KEY_2, EncryptionKey::KEY_3};
-    this->index_k0s = {EncryptionKey::KEY_4, EncryptionKey::KEY_5};
-    this->content_keys = {EncryptionKey::KEY_6, EncryptionKey::KEY_7};
+    fixDomainKeys(keys, &DomainKeys::index_tweak, EncryptionKey::KEY_0,
+                  EncryptionKey::KEY_1);
+    fixDomainKeys(keys, &DomainKeys::index_w0, EncryptionKey::KEY_2,
+                  EncryptionKey::KEY_3);
+    fixDomainKeys(keys, &DomainKeys::index_k0, EncryptionKey::KEY_4,
+                  EncryptionKey::KEY_5);
+    fixDomainKeys(keys, &DomainKeys::content_key, EncryptionKey::KEY_6,
+                  EncryptionKey::KEY_7);
 #endif
   }
 
+  ~HyBP() {
+    delete history;
+    delete btb_levels;
+    delete index_cipher;
+  }
+
   // init
   void initPHT(uint64_t counter_bits, uint64_t counter_nums,
                uint64_t offset_pht = 5);
@@ -94,14 +134,42 @@ class HyBP {
       uint64_t buffer_ways, uint64_t buffer_sets, uint64_t offset_btb = 5,
       ReplacementPolicy buffer_replacement = ReplacementPolicy::REPL_LRU);
 
+  // direction model of the PHT (see HistoryPHT.hpp), after initPHT
+  void initHistory(const PHTConfig &config);
+
+  // levels of the BTB (see BTBHierarchy.hpp), after initBTB
+  void initLevels(const BTBConfig &config);
+
+  // key rotation policy (see Rekey.hpp)
+  void initRekey(const RekeyConfig &config);
+
+  // index cipher (see Cipher.hpp), CIPHER_NATIVE keeps one round of QARMA-64
+  void initCipher(const CipherConfig &config);
+
+  // clear the PHT and BTB state
+  void reset();
+
+  // clear the PHT and BTB entries but keep the keys (a flush on a context
+  // switch)
+  void flush();
+
+  // valid entries of the PHT and BTB
+  uint64_t getPHTOccupancy();
+
+  uint64_t getBTBOccupancy();
+
+  // PHT and BTB lookups since construction
+  uint64_t getLookups() { return lookups; }
+
   // encryption and decryption
   uint64_t encrypt(uint64_t plain, uint64_t key);
 
   uint64_t decrypt(uint64_t cipher, uint64_t key);
 
-  uint64_t qarma_encrypt(uint64_t plain, uint64_t domain);
+  // index cipher under the index keys of a domain
+  uint64_t indexEncrypt(uint64_t plain, uint64_t domain);
 
-  uint64_t qarma_decrypt(uint64_t cipher, uint64_t domain);
+  uint64_t indexDecrypt(uint64_t cipher, uint64_t domain);
 
   // get set and tag in PHT and BTB
   uint64_t getPHTSet(uint64_t pc, uint64_t domain);
@@ -112,6 +180,9 @@ class HyBP {
 
   uint64_t getBTBDest(uint64_t dest, uint64_t domain);
 
+  // first BTB level holding a branch, the number of levels if none
+  uint64_t getBTBLevel(uint64_t pc, uint64_t domain);
+
   bool lookupPHT(uint64_t pc, bool taken, uint64_t domain);
 
   void updatePHT(uint64_t pc, bool taken, uint64_t domain);
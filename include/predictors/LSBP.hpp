@@ -29,47 +29,83 @@
 #include <cstdlib>
 #include <vector>
 
+#include "include/predictors/BTBHierarchy.hpp"
+#include "include/predictors/Domains.hpp"
+#include "include/predictors/HistoryPHT.hpp"
+#include "include/utils/Cipher.hpp"
 #include "include/utils/Utils.hpp"
 
 class LSBP {
  private:
-  // address space
+  // address space and its mask
   uint64_t addr_space;
+  uint64_t addr_mask;
 
   // parameters for PHT
   uint64_t counter_bits;
   uint64_t counter_nums;
   uint64_t offset_pht;
+  uint64_t pht_set_bits;  // log2(counter_nums)
 
   // parameters for BTB
   uint64_t buffer_ways;
   uint64_t buffer_sets;
   uint64_t offset_btb;
+  uint64_t btb_set_bits;                 // log2(buffer_sets)
   ReplacementPolicy buffer_replacement;  // 0: LRU, 1: Random
 
   // data structures for PHT
   std::vector<uint64_t> PHT_valid;
   std::vector<uint64_t> PHT_counter;
 
+  // global-history model replacing the bimodal PHT, nullptr if bimodal
+  HistoryPHT *history = nullptr;
+
+  // multi-level BTB replacing the BTB, nullptr if single-level
+  BTBHierarchy *btb_levels = nullptr;
+
+  // PHT and BTB lookups, read by the progress reporter
+  uint64_t lookups = 0;
+
   // data structures for BTB
   std::vector<std::vector<uint64_t>> BTB_valid;
   std::vector<std::vector<uint64_t>> BTB_src;
   std::vector<std::vector<uint64_t>> BTB_dest;
   std::vector<std::vector<uint64_t>> BTB_lru;
 
-  // encryption keys
-  std::vector<uint64_t> index_keys;
+  // encryption keys of a security domain
+  struct DomainKeys {
+    uint64_t index_key;
+  };
+
+  // key table, one row per domain (see Domains.hpp)
+  std::vector<DomainKeys> keys;
+
+  // block cipher replacing the XOR of the index key, nullptr for the XOR
+  BlockCipher *index_cipher = nullptr;
+
+  // index of an address under the index key of a domain
+  uint64_t indexEncrypt(uint64_t plain, uint64_t domain);
 
  public:
-  LSBP(uint64_t addr_space = 32) : addr_space(addr_space) {
+  LSBP(uint64_t addr_space = 32, uint64_t domains = NUM_ATTACK_DOMAINS)
+      : addr_space(addr_space),
+        addr_mask(addrMask(addr_space)),
+        keys(domains) {
 #ifdef RANDOM_KEY
-    this->index_keys = {rand() & ((1ULL << addr_space) - 1),
-                        rand() & ((1ULL << addr_space) - 1)};
+    drawDomainKeys(keys, {&DomainKeys::index_key}, addr_space);
 #else
-    this->index_keys = {EncryptionKey::KEY_0, EncryptionKey::KEY_1};
+    fixDomainKeys(keys, &DomainKeys::index_key, EncryptionKey::KEY_0,
+                  EncryptionKey::KEY_1);
 #endif
   }
 
+  ~LSBP() {
+    delete history;
+    delete btb_levels;
+    delete index_cipher;
+  }
+
   // init
   void initPHT(uint64_t counter_bits, uint64_t counter_nums,
                uint64_t offset_pht = 5);
@@ -78,6 +114,30 @@ class LSBP {
       uint64_t buffer_ways, uint64_t buffer_sets, uint64_t offset_btb = 5,
       ReplacementPolicy buffer_replacement = ReplacementPolicy::REPL_LRU);
 
+  // direction model of the PHT (see HistoryPHT.hpp), after initPHT
+  void initHistory(const PHTConfig &config);
+
+  // levels of the BTB (see BTBHierarchy.hpp), after initBTB
+  void initLevels(const BTBConfig &config);
+
+  // index cipher (see Cipher.hpp), CIPHER_NATIVE keeps the XOR
+  void initCipher(const CipherConfig &config);
+
+  // clear the PHT and BTB state
+  void reset();
+
+  // clear the PHT and BTB entries but keep the keys (a flush on a context
+  // switch)
+  void flush();
+
+  // valid entries of the PHT and BTB
+  uint64_t getPHTOccupancy();
+
+  uint64_t getBTBOccupancy();
+
+  // PHT and BTB lookups since construction
+  uint64_t getLookups() { return lookups; }
+
   // encryption and decryption
   uint64_t encrypt(uint64_t plain, uint64_t key);
 
@@ -92,6 +152,9 @@ class LSBP {
 
   uint64_t getBTBDest(uint64_t dest, uint64_t domain);
 
+  // first BTB level holding a branch, the number of levels if none
+  uint64_t getBTBLevel(uint64_t pc, uint64_t pid, uint64_t domain);
+
   bool lookupPHT(uint64_t pc, bool taken, uint64_t pid, uint64_t domain);
 
   void updatePHT(uint64_t pc, bool taken, uint64_t pid, uint64_t domain);
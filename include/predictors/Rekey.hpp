@@ -0,0 +1,104 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Key rotation of the keyed predictors (Noisy-XOR-BP, STBPU, HyBP). The keys
+// are redrawn at the next lookup after:
+//   accesses     N lookups (PHT and BTB) since the last rekey
+//   mispredicts  N PHT mispredicts, BTB mispredicts and BTB evictions since
+//                the last rekey (the re-randomization threshold of STBPU)
+//   domain       a lookup of another security domain than the previous one
+//
+// A rekey does not walk the tables. Every entry is tagged with the epoch it
+// was written in (the PHT_valid/BTB_valid arrays hold the epoch instead of
+// 1), and an entry is valid only if its tag is the current epoch, so a rekey
+// invalidates all entries in O(1) by starting a new epoch. The tables of a
+// global-history PHT model are kept and reinterpreted under the new keys.
+//
+// The new keys come from a private stream seeded at every reset from the
+// random generator of the trial, so a trial is reproducible and rotating the
+// keys does not change the random addresses drawn by the attacks.
+// =============================================================================
+#ifndef REKEY_HPP
+#define REKEY_HPP
+#include <cstdint>
+#include <string>
+
+struct RekeyConfig {
+  // rekey every N lookups and every N mispredicts (0: never)
+  uint64_t accesses = 0;
+  uint64_t mispredicts = 0;
+  // rekey when the lookups switch to another security domain
+  bool domain_switch = false;
+};
+
+// "none" or the enabled triggers, e.g. "a1000/m100/switch"
+std::string rekeyName(const RekeyConfig &config);
+
+class RekeyEpochs {
+ private:
+  RekeyConfig config;
+  bool enabled = false;
+
+  // key stream
+  uint64_t state = 0;
+
+  // events since the last rekey and domain of the previous lookup
+  uint64_t accesses = 0;
+  uint64_t mispredicts = 0;
+  uint64_t last_domain = -1;
+
+ public:
+  // epoch of the valid entries, 0 marks an entry that was never written
+  uint64_t epoch = 1;
+
+  void init(const RekeyConfig &config);
+
+  // count a lookup of a domain, return true if the keys must be redrawn
+  // before it (the epoch has then already moved on)
+  bool lookup(uint64_t domain) {
+    if (!enabled) {
+      return false;
+    }
+    accesses++;
+    bool due = (config.accesses != 0 && accesses > config.accesses) ||
+               (config.mispredicts != 0 && mispredicts >= config.mispredicts) ||
+               (config.domain_switch && last_domain != (uint64_t)-1 &&
+                domain != last_domain);
+    last_domain = domain;
+    if (due) {
+      epoch++;
+      accesses = 1;
+      mispredicts = 0;
+    }
+    return due;
+  }
+
+  // count a mispredict or eviction of a lookup
+  void mispredict() { mispredicts++; }
+
+  // next key of the stream, masked to the address space
+  uint64_t nextKey(uint64_t addr_space);
+
+  // restart the triggers and draw the seed of the key stream (predictorRand),
+  // the epoch keeps growing so stale entries never become valid again
+  void reset();
+};
+#endif
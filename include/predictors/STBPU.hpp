@@ -20,9 +20,9 @@
 // date: 2024/12/03
 // =============================================================================
 // STBPU is proposed in DSN 2022
-// Index  Encryption: PHT/pc+k0/hash, BTB/pc+k0/hash
-// Src    Encryption: PHT/pc+k0/hash, BTB/pc+k0/hash
-// Dest   Encryption: PHT/XOR/k1,     BTB/XOR/k1
+// Index  Encryption: PHT/pc+k0/remap, BTB/pc+k0/remap
+// Src    Encryption: PHT/pc+k0/remap, BTB/pc+k0/remap
+// Dest   Encryption: PHT/XOR/k1,      BTB/XOR/k1
 // =============================================================================
 #ifndef STBPU_HPP
 #define STBPU_HPP
@@ -31,55 +31,107 @@
 #include <cstdlib>
 #include <vector>
 
+#include "include/predictors/BTBHierarchy.hpp"
+#include "include/predictors/Domains.hpp"
+#include "include/predictors/HistoryPHT.hpp"
+#include "include/predictors/Rekey.hpp"
+#include "include/utils/Cipher.hpp"
 #include "include/utils/Utils.hpp"
 
 class STBPU {
  private:
-  // address space
+  // address space and its mask
   uint64_t addr_space;
+  uint64_t addr_mask;
 
   // parameters for PHT
   uint64_t counter_bits;
   uint64_t counter_nums;
   uint64_t offset_pht;
+  uint64_t pht_set_bits;  // log2(counter_nums)
 
   // parameters for BTB
   uint64_t buffer_ways;
   uint64_t buffer_sets;
   uint64_t offset_btb;
+  uint64_t btb_set_bits;                 // log2(buffer_sets)
   ReplacementPolicy buffer_replacement;  // 0: LRU, 1: Random
 
   // data structures for PHT
   std::vector<uint64_t> PHT_valid;
   std::vector<uint64_t> PHT_counter;
 
+  // global-history model replacing the bimodal PHT, nullptr if bimodal
+  HistoryPHT *history = nullptr;
+
+  // multi-level BTB replacing the BTB, nullptr if single-level
+  BTBHierarchy *btb_levels = nullptr;
+
+  // PHT and BTB lookups, read by the progress reporter
+  uint64_t lookups = 0;
+
   // data structures for BTB
   std::vector<std::vector<uint64_t>> BTB_valid;
   std::vector<std::vector<uint64_t>> BTB_src;
   std::vector<std::vector<uint64_t>> BTB_dest;
   std::vector<std::vector<uint64_t>> BTB_lru;
 
-  // encryption keys
-  std::vector<uint64_t> index_keys;
-  std::vector<uint64_t> index_hashes;
-  std::vector<uint64_t> content_keys;
+  // encryption keys of a security domain
+  struct DomainKeys {
+    uint64_t index_key;
+    uint64_t index_hash;
+    uint64_t content_key;
+  };
+
+  // key table, one row per domain (see Domains.hpp)
+  std::vector<DomainKeys> keys;
+
+  // key rotation (see Rekey.hpp) and the keys of the first epoch
+  RekeyEpochs rekey;
+  std::vector<DomainKeys> initial_keys;
+
+  // block cipher replacing the remapping, nullptr for the native one
+  BlockCipher *index_cipher = nullptr;
+
+  // draw new keys for all domains
+  void redrawKeys();
+
+  // address keyed with the index key of the domain, before the remapping
+  uint64_t keyedAddr(uint64_t addr, uint64_t domain);
+
+  // keyed remapping of an address to its index and tag (see STBPU.cpp), of
+  // one address or of a batch (vectorized with AVX2 or AVX-512)
+  uint64_t remap(uint64_t addr, uint64_t domain);
+
+  void remapBatch(const uint64_t *addrs, uint64_t count, uint64_t domain,
+                  uint64_t *remapped);
 
  public:
-  STBPU(uint64_t addr_space = 32) : addr_space(addr_space) {
+  STBPU(uint64_t addr_space = 32, uint64_t domains = NUM_ATTACK_DOMAINS)
+      : addr_space(addr_space),
+        addr_mask(addrMask(addr_space)),
+        keys(domains) {
 #ifdef RANDOM_KEY
-    this->index_keys = {rand() & ((1ULL << addr_space) - 1),
-                        rand() & ((1ULL << addr_space) - 1)};
-    this->index_hashes = {rand() & ((1ULL << addr_space) - 1),
-                          rand() & ((1ULL << addr_space) - 1)};
-    this->content_keys = {rand() & ((1ULL << addr_space) - 1),
-                          rand() & ((1ULL << addr_space) - 1)};
+    drawDomainKeys(keys,
+                   {&DomainKeys::index_key, &DomainKeys::index_hash,
+                    &DomainKeys::content_key},
+                   addr_space);
 #else
-    this->index_keys = {EncryptionKey::KEY_0, EncryptionKey::KEY_1};
-    this->index_hashes = {EncryptionKey::KEY_2, EncryptionKey::KEY_3};
-    this->content_keys = {EncryptionKey::KEY_4, EncryptionKey::KEY_5};
+    fixDomainKeys(keys, &DomainKeys::index_key, EncryptionKey::KEY_0,
+                  EncryptionKey::KEY_1);
+    fixDomainKeys(keys, &DomainKeys::index_hash, EncryptionKey::KEY_2,
+                  EncryptionKey::KEY_3);
+    fixDomainKeys(keys, &DomainKeys::content_key, EncryptionKey::KEY_4,
+                  EncryptionKey::KEY_5);
 #endif
   }
 
+  ~STBPU() {
+    delete history;
+    delete btb_levels;
+    delete index_cipher;
+  }
+
   // init
   void initPHT(uint64_t counter_bits, uint64_t counter_nums,
                uint64_t offset_pht = 5);
@@ -88,6 +140,33 @@ class STBPU {
       uint64_t buffer_ways, uint64_t buffer_sets, uint64_t offset_btb = 5,
       ReplacementPolicy buffer_replacement = ReplacementPolicy::REPL_LRU);
 
+  // direction model of the PHT (see HistoryPHT.hpp), after initPHT
+  void initHistory(const PHTConfig &config);
+
+  // levels of the BTB (see BTBHierarchy.hpp), after initBTB
+  void initLevels(const BTBConfig &config);
+
+  // key rotation policy (see Rekey.hpp)
+  void initRekey(const RekeyConfig &config);
+
+  // index cipher (see Cipher.hpp), CIPHER_NATIVE keeps the keyed remapping
+  void initCipher(const CipherConfig &config);
+
+  // clear the PHT and BTB state
+  void reset();
+
+  // clear the PHT and BTB entries but keep the keys (a flush on a context
+  // switch)
+  void flush();
+
+  // valid entries of the PHT and BTB
+  uint64_t getPHTOccupancy();
+
+  uint64_t getBTBOccupancy();
+
+  // PHT and BTB lookups since construction
+  uint64_t getLookups() { return lookups; }
+
   // encryption and decryption
   uint64_t encrypt(uint64_t plain, uint64_t key);
 
@@ -100,8 +179,18 @@ class STBPU {
 
   uint64_t getBTBTag(uint64_t src, uint64_t domain);
 
+  // sets of a batch of addresses
+  void getPHTSets(const uint64_t *pcs, uint64_t count, uint64_t domain,
+                  uint64_t *sets);
+
+  void getBTBSets(const uint64_t *pcs, uint64_t count, uint64_t domain,
+                  uint64_t *sets);
+
   uint64_t getBTBDest(uint64_t dest, uint64_t domain);
 
+  // first BTB level holding a branch, the number of levels if none
+  uint64_t getBTBLevel(uint64_t pc, uint64_t domain);
+
   bool lookupPHT(uint64_t pc, bool taken, uint64_t domain);
 
   void updatePHT(uint64_t pc, bool taken, uint64_t domain);
@@ -0,0 +1,378 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/utils/Cipher.hpp"
+
+#include <cstdint>
+#include <string>
+
+// ---------------------------------------------------------------- 64-bit state
+
+// cells are nibbles, cell 0 is the most significant
+static constexpr uint64_t getCell(uint64_t x, int cell) {
+  return (x >> (4 * (15 - cell))) & 0xF;
+}
+
+static constexpr uint64_t putCell(uint64_t value, int cell) {
+  return value << (4 * (15 - cell));
+}
+
+// out cell i is in cell perm[i]
+static constexpr uint64_t permuteCells(uint64_t x, const int *perm) {
+  uint64_t y = 0;
+  for (int i = 0; i < 16; i++) {
+    y |= putCell(getCell(x, perm[i]), i);
+  }
+  return y;
+}
+
+// linear map of the state as the XOR of one table entry per byte
+struct LinearMap {
+  uint64_t table[8][256];
+
+  template <typename Map>
+  constexpr explicit LinearMap(Map map) : table() {
+    for (int byte = 0; byte < 8; byte++) {
+      for (uint64_t value = 0; value < 256; value++) {
+        table[byte][value] = map(value << (8 * byte));
+      }
+    }
+  }
+
+  uint64_t apply(uint64_t x) const {
+    return table[0][x & 0xFF] ^ table[1][(x >> 8) & 0xFF] ^
+           table[2][(x >> 16) & 0xFF] ^ table[3][(x >> 24) & 0xFF] ^
+           table[4][(x >> 32) & 0xFF] ^ table[5][(x >> 40) & 0xFF] ^
+           table[6][(x >> 48) & 0xFF] ^ table[7][x >> 56];
+  }
+};
+
+// 4-bit S-box applied to every cell, one lookup per byte
+struct SubCells {
+  uint8_t table[256];
+
+  constexpr explicit SubCells(const uint8_t *sbox) : table() {
+    for (int value = 0; value < 256; value++) {
+      table[value] = sbox[value >> 4] << 4 | sbox[value & 0xF];
+    }
+  }
+
+  uint64_t apply(uint64_t x) const {
+    uint64_t y = 0;
+    for (int byte = 0; byte < 8; byte++) {
+      y |= (uint64_t)table[(x >> (8 * byte)) & 0xFF] << (8 * byte);
+    }
+    return y;
+  }
+};
+
+// ------------------------------------------------------------------- QARMA-64
+
+// sigma_2 and the constants of Qarma64.hpp
+static constexpr uint8_t QARMA_SBOX[16] = {11, 6, 8,  15, 12, 0, 9, 14,
+                                           3,  7, 4, 5,  13, 2, 1, 10};
+static constexpr uint8_t QARMA_SBOX_INV[16] = {5, 14, 13, 8,  10, 11, 1, 9,
+                                               2, 6,  15, 0,  4,  12, 7, 3};
+static constexpr int QARMA_T[16] = {0, 11, 6, 13, 10, 1, 12, 7,
+                                    5, 14, 3, 8,  15, 4, 9,  2};
+static constexpr int QARMA_T_INV[16] = {0,  5, 15, 10, 13, 8, 2, 7,
+                                        11, 14, 4, 1,  6,  3, 9, 12};
+static constexpr int QARMA_H[16] = {6, 5, 14, 15, 0, 1, 2,  3,
+                                    7, 12, 13, 4, 8, 9, 10, 11};
+static constexpr int QARMA_M[16] = {0, 1, 2, 1, 1, 0, 1, 2,
+                                    2, 1, 0, 1, 1, 2, 1, 0};
+static constexpr uint64_t QARMA_ALPHA = 0xC0AC29B7C97C50DDULL;
+static constexpr uint64_t QARMA_C[8] = {
+    0x0000000000000000ULL, 0x13198A2E03707344ULL, 0xA4093822299F31D0ULL,
+    0x082EFA98EC4E6C89ULL, 0x452821E638D01377ULL, 0xBE5466CF34E90C6CULL,
+    0x3F84D5B5B5470917ULL, 0x9216D5D98979FB1BULL};
+// tweak cells updated by the LFSR omega
+static constexpr bool QARMA_LFSR_CELLS[16] = {1, 1, 0, 1, 1, 0, 0, 0,
+                                              1, 0, 0, 1, 0, 1, 0, 0};
+
+static constexpr uint64_t qarmaMix(uint64_t x) {
+  uint64_t y = 0;
+  for (int row = 0; row < 4; row++) {
+    for (int column = 0; column < 4; column++) {
+      uint64_t cell = 0;
+      for (int j = 0; j < 4; j++) {
+        int rotation = QARMA_M[4 * row + j];
+        if (rotation != 0) {
+          uint64_t a = getCell(x, 4 * j + column);
+          cell ^= ((a << rotation) & 0xF) | (a >> (4 - rotation));
+        }
+      }
+      y |= putCell(cell, 4 * row + column);
+    }
+  }
+  return y;
+}
+
+static constexpr uint64_t qarmaLFSR(uint64_t x) {
+  return (((x ^ x >> 1) & 1) << 3) | x >> 1;
+}
+
+static constexpr uint64_t qarmaUpdateTweak(uint64_t tweak) {
+  uint64_t y = permuteCells(tweak, QARMA_H);
+  for (int i = 0; i < 16; i++) {
+    if (QARMA_LFSR_CELLS[i]) {
+      y = (y & ~putCell(0xF, i)) | putCell(qarmaLFSR(getCell(y, i)), i);
+    }
+  }
+  return y;
+}
+
+struct QarmaTables {
+  // ShuffleCells then MixColumns, MixColumns then the inverse ShuffleCells,
+  // the inverse ShuffleCells, MixColumns and the tweak update
+  LinearMap shuffle_mix{
+      [](uint64_t x) { return qarmaMix(permuteCells(x, QARMA_T)); }};
+  LinearMap mix_unshuffle{
+      [](uint64_t x) { return permuteCells(qarmaMix(x), QARMA_T_INV); }};
+  LinearMap unshuffle{[](uint64_t x) { return permuteCells(x, QARMA_T_INV); }};
+  LinearMap mix{[](uint64_t x) { return qarmaMix(x); }};
+  LinearMap tweak{[](uint64_t x) { return qarmaUpdateTweak(x); }};
+  SubCells sub{QARMA_SBOX};
+  SubCells sub_inv{QARMA_SBOX_INV};
+};
+
+static const QarmaTables QARMA_TABLES;
+
+class Qarma64Cipher : public BlockCipher {
+ private:
+  uint64_t rounds;
+
+  uint64_t forward(uint64_t x, uint64_t tweakey, bool linear) const {
+    x ^= tweakey;
+    if (linear) {
+      x = QARMA_TABLES.shuffle_mix.apply(x);
+    }
+    return QARMA_TABLES.sub.apply(x);
+  }
+
+  uint64_t backward(uint64_t x, uint64_t tweakey, bool linear) const {
+    x = QARMA_TABLES.sub_inv.apply(x);
+    if (linear) {
+      x = QARMA_TABLES.mix_unshuffle.apply(x);
+    }
+    return x ^ tweakey;
+  }
+
+  // the reflector-based structure of qarma64_enc/qarma64_dec
+  uint64_t run(uint64_t x, uint64_t tweak, uint64_t w0, uint64_t w1,
+               uint64_t k0, uint64_t k1) const {
+    uint64_t tweaks[8];
+    x ^= w0;
+    for (uint64_t i = 0; i < rounds; i++) {
+      tweaks[i] = tweak;
+      x = forward(x, k0 ^ tweak ^ QARMA_C[i], i != 0);
+      tweak = QARMA_TABLES.tweak.apply(tweak);
+    }
+    x = forward(x, w1 ^ tweak, true);
+    x = QARMA_TABLES.unshuffle.apply(QARMA_TABLES.shuffle_mix.apply(x) ^ k1);
+    x = backward(x, w0 ^ tweak, true);
+    for (uint64_t i = rounds; i-- > 0;) {
+      x = backward(x, k0 ^ tweaks[i] ^ QARMA_C[i] ^ QARMA_ALPHA, i != 0);
+    }
+    return x ^ w1;
+  }
+
+  static uint64_t orthomorphism(uint64_t w0) {
+    return (w0 >> 1 | w0 << 63) ^ (w0 >> 63);
+  }
+
+  uint64_t encryptBlock(uint64_t plain, const CipherKey &key) const {
+    return run(plain, key.tweak, key.w0, orthomorphism(key.w0), key.k0,
+               key.k0);
+  }
+
+ public:
+  explicit Qarma64Cipher(uint64_t rounds) : rounds(rounds) {}
+
+  uint64_t encrypt(uint64_t plain, const CipherKey &key) const override {
+    return encryptBlock(plain, key);
+  }
+
+  uint64_t decrypt(uint64_t cipher, const CipherKey &key) const override {
+    return run(cipher, key.tweak, orthomorphism(key.w0), key.w0,
+               key.k0 ^ QARMA_ALPHA, QARMA_TABLES.mix.apply(key.k0));
+  }
+
+  void encryptBatch(const uint64_t *plain, uint64_t count,
+                    const CipherKey &key, uint64_t *cipher) const override {
+    for (uint64_t i = 0; i < count; i++) {
+      cipher[i] = encryptBlock(plain[i], key);
+    }
+  }
+};
+
+// --------------------------------------------------------------------- PRINCE
+
+static constexpr uint8_t PRINCE_SBOX[16] = {0xB, 0xF, 0x3, 0x2, 0xA, 0xC,
+                                            0x9, 0x1, 0x6, 0x7, 0x8, 0x0,
+                                            0xE, 0x5, 0xD, 0x4};
+static constexpr uint8_t PRINCE_SBOX_INV[16] = {0xB, 0x7, 0x3, 0x2, 0xF, 0xD,
+                                                0x8, 0x9, 0xA, 0x6, 0x4, 0x0,
+                                                0x5, 0xE, 0xC, 0x1};
+static constexpr uint64_t PRINCE_RC[12] = {
+    0x0000000000000000ULL, 0x13198A2E03707344ULL, 0xA4093822299F31D0ULL,
+    0x082EFA98EC4E6C89ULL, 0x452821E638D01377ULL, 0xBE5466CF34E90C6CULL,
+    0x7EF84F78FD955CB1ULL, 0x85840851F1AC43AAULL, 0xC882D32F25323C54ULL,
+    0x64A51195E0E3610DULL, 0xD3B5A399CA0C2399ULL, 0xC0AC29B7C97C50DDULL};
+static constexpr int PRINCE_SR[16] = {0, 5,  10, 15, 4,  9, 14, 3,
+                                      8, 13, 2,  7,  12, 1, 6,  11};
+static constexpr int PRINCE_SR_INV[16] = {0, 13, 10, 7, 4,  1, 14, 11,
+                                          8, 5,  2,  15, 12, 9, 6, 3};
+
+// M': the 16-bit chunks (most significant first) are multiplied by M^(0),
+// M^(1), M^(1), M^(0), whose 4x4 blocks m_i mask out bit 3 - i of a cell
+static constexpr uint64_t princeMixPrime(uint64_t x) {
+  uint64_t y = 0;
+  for (int chunk = 0; chunk < 4; chunk++) {
+    int shift = chunk == 0 || chunk == 3 ? 0 : 1;
+    for (int row = 0; row < 4; row++) {
+      uint64_t cell = 0;
+      for (int j = 0; j < 4; j++) {
+        int block = (row + j + shift) % 4;
+        cell ^= getCell(x, 4 * chunk + j) & ~(8ULL >> block) & 0xF;
+      }
+      y |= putCell(cell, 4 * chunk + row);
+    }
+  }
+  return y;
+}
+
+struct PrinceTables {
+  // M = SR o M', M' and M^-1 = M' o SR^-1
+  LinearMap mix{
+      [](uint64_t x) { return permuteCells(princeMixPrime(x), PRINCE_SR); }};
+  LinearMap mix_prime{[](uint64_t x) { return princeMixPrime(x); }};
+  LinearMap mix_inv{[](uint64_t x) {
+    return princeMixPrime(permuteCells(x, PRINCE_SR_INV));
+  }};
+  SubCells sub{PRINCE_SBOX};
+  SubCells sub_inv{PRINCE_SBOX_INV};
+};
+
+static const PrinceTables PRINCE_TABLES;
+
+class PrinceCipher : public BlockCipher {
+ private:
+  uint64_t rounds;
+
+  // PRINCEcore, the rounds before and after the middle layer use the
+  // constants RC_1 .. RC_rounds and RC_(11 - rounds) .. RC_10, so that the
+  // alpha-reflection (decryption with k1 ^ alpha) holds at every round count
+  uint64_t core(uint64_t x, uint64_t k1) const {
+    x ^= k1 ^ PRINCE_RC[0];
+    for (uint64_t i = 1; i <= rounds; i++) {
+      x = PRINCE_TABLES.mix.apply(PRINCE_TABLES.sub.apply(x));
+      x ^= PRINCE_RC[i] ^ k1;
+    }
+    x = PRINCE_TABLES.sub.apply(x);
+    x = PRINCE_TABLES.mix_prime.apply(x);
+    x = PRINCE_TABLES.sub_inv.apply(x);
+    for (uint64_t i = 11 - rounds; i <= 10; i++) {
+      x ^= PRINCE_RC[i] ^ k1;
+      x = PRINCE_TABLES.sub_inv.apply(PRINCE_TABLES.mix_inv.apply(x));
+    }
+    return x ^ PRINCE_RC[11] ^ k1;
+  }
+
+  static uint64_t whitening(uint64_t k0) {
+    return (k0 >> 1 | k0 << 63) ^ (k0 >> 63);
+  }
+
+  uint64_t encryptBlock(uint64_t plain, const CipherKey &key) const {
+    return core(plain ^ key.w0, key.k0 ^ key.tweak) ^ whitening(key.w0);
+  }
+
+ public:
+  explicit PrinceCipher(uint64_t rounds) : rounds(rounds) {}
+
+  uint64_t encrypt(uint64_t plain, const CipherKey &key) const override {
+    return encryptBlock(plain, key);
+  }
+
+  uint64_t decrypt(uint64_t cipher, const CipherKey &key) const override {
+    return core(cipher ^ whitening(key.w0),
+                key.k0 ^ key.tweak ^ PRINCE_RC[11]) ^
+           key.w0;
+  }
+
+  void encryptBatch(const uint64_t *plain, uint64_t count,
+                    const CipherKey &key, uint64_t *cipher) const override {
+    for (uint64_t i = 0; i < count; i++) {
+      cipher[i] = encryptBlock(plain[i], key);
+    }
+  }
+};
+
+// ---------------------------------------------------------------------- config
+
+static const char *const CIPHER_NAMES[] = {"native", "qarma64", "prince"};
+
+std::string cipherName(const CipherConfig &config) {
+  if (config.type == CipherType::CIPHER_NATIVE) {
+    return "native";
+  }
+  uint64_t rounds = config.rounds ? config.rounds : cipherRounds(config.type);
+  return std::string(CIPHER_NAMES[config.type]) + "-r" +
+         std::to_string(rounds);
+}
+
+bool parseCipherType(const std::string &name, CipherType &type) {
+  for (int i = 0; i < CipherType::NUM_CIPHER_TYPES; i++) {
+    if (name == CIPHER_NAMES[i]) {
+      type = (CipherType)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+uint64_t cipherRounds(CipherType type) {
+  switch (type) {
+    case CipherType::CIPHER_QARMA64:
+      return 7;
+    case CipherType::CIPHER_PRINCE:
+      return 5;
+    default:
+      return 0;
+  }
+}
+
+CipherKey cipherKey(uint64_t key) {
+  // the key halves differ, the core key is the key with its halves swapped
+  return CipherKey{0, key, (key << 32 | key >> 32) ^ QARMA_ALPHA};
+}
+
+BlockCipher *BlockCipher::create(const CipherConfig &config) {
+  uint64_t rounds = config.rounds ? config.rounds : cipherRounds(config.type);
+  switch (config.type) {
+    case CipherType::CIPHER_QARMA64:
+      return new Qarma64Cipher(rounds);
+    case CipherType::CIPHER_PRINCE:
+      return new PrinceCipher(rounds);
+    default:
+      return nullptr;
+  }
+}
@@ -0,0 +1,100 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Low-latency 64-bit block ciphers for the index randomization of the keyed
+// predictors (BSUP, Noisy-XOR-BP, LS-BP, STBPU, HyBP). By default every
+// predictor keeps the index function of its design (CIPHER_NATIVE: a XOR,
+// the keyed remapping of STBPU, one round of QARMA-64 for HyBP); a cipher
+// config replaces it by one of
+//   qarma64  QARMA-64 (sigma_2 S-box) with 1 to 7 rounds, default 7
+//   prince   PRINCE with 1 to 5 forward rounds (2 * rounds + 2 S-box
+//            layers), default 5
+// so that the cipher and its rounds are compared on the same predictors.
+//
+// The implementations work on the 64-bit state: the linear layers are
+// lookups of byte-indexed tables (as the T-tables of AES) and the S-box
+// layers lookups of byte tables, built once from the reference definitions.
+// QARMA-64 is bit-exact with the reference implementation in Qarma64.hpp and
+// PRINCE with its published test vectors.
+//
+// Follow-up work, not implemented yet: SCARF (a 10-bit block under a 48-bit
+// tweak, built for cache set indices) and QARMA-128 (a 128-bit block). Both
+// need their reference test vectors, which are not in this tree, and a state
+// or tweak wider than the 64-bit block of BlockCipher. Their names are
+// rejected as unknown ciphers until then.
+// =============================================================================
+#ifndef CIPHER_HPP
+#define CIPHER_HPP
+#include <cstdint>
+#include <string>
+
+enum CipherType {
+  // the index function of the predictor's design
+  CIPHER_NATIVE = 0,
+  CIPHER_QARMA64 = 1,
+  CIPHER_PRINCE = 2,
+  NUM_CIPHER_TYPES = 3
+};
+
+struct CipherConfig {
+  CipherType type = CipherType::CIPHER_NATIVE;
+  // rounds of the cipher, 0 for its full rounds
+  uint64_t rounds = 0;
+};
+
+// "native" or the cipher and its rounds, e.g. "prince-r3"
+std::string cipherName(const CipherConfig &config);
+
+// parse a cipher name ("native", "qarma64" or "prince"), return false if it
+// is unknown
+bool parseCipherType(const std::string &name, CipherType &type);
+
+// rounds of a cipher, the full rounds are also the maximum
+uint64_t cipherRounds(CipherType type);
+
+// key of a block cipher: a tweak and two key halves, the whitening key w0
+// and the core key k0 (the 128-bit key k0 || k1 of PRINCE, which folds the
+// tweak into k1)
+struct CipherKey {
+  uint64_t tweak;
+  uint64_t w0;
+  uint64_t k0;
+};
+
+// cipher key of a predictor with a single 64-bit index key
+CipherKey cipherKey(uint64_t key);
+
+class BlockCipher {
+ public:
+  virtual ~BlockCipher() = default;
+
+  virtual uint64_t encrypt(uint64_t plain, const CipherKey &key) const = 0;
+
+  virtual uint64_t decrypt(uint64_t cipher, const CipherKey &key) const = 0;
+
+  // a batch of blocks under one key, without a virtual call per block
+  virtual void encryptBatch(const uint64_t *plain, uint64_t count,
+                            const CipherKey &key, uint64_t *cipher) const = 0;
+
+  // cipher of a config, nullptr for CIPHER_NATIVE
+  static BlockCipher *create(const CipherConfig &config);
+};
+#endif
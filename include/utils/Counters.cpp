@@ -0,0 +1,132 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/utils/Counters.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "include/utils/Utils.hpp"
+
+static const char *const EVENT_NAMES[] = {
+    "pht_lookups", "pht_hits",        "pht_mispredicts", "pht_invalid",
+    "btb_lookups", "btb_hits",        "btb_mispredicts", "btb_invalid",
+    "btb_evictions", "cipher_calls"};
+
+thread_local HotCounters hot_counters;
+
+// total of the trials of all threads
+static HotCounters total_counters;
+static std::mutex total_mutex;
+
+void HotCounters::clear() {
+  memset(events, 0, sizeof(events));
+  memset(phases, 0, sizeof(phases));
+  memset(trials, 0, sizeof(trials));
+  memset(trial_ns, 0, sizeof(trial_ns));
+  for (uint64_t type = 0; type < NUM_BPU_TYPES; type++) {
+    evictions[type].clear();
+  }
+  attack = AttackKind::ATK_NONE;
+  phase = AttackPhase::PHASE_NONE;
+}
+
+void HotCounters::add(const HotCounters &other) {
+  for (uint64_t type = 0; type < NUM_BPU_TYPES; type++) {
+    for (uint64_t event = 0; event < NUM_COUNTER_EVENTS; event++) {
+      events[type][event] += other.events[type][event];
+    }
+    for (uint64_t kind = 0; kind < NUM_ATTACK_KINDS; kind++) {
+      for (uint64_t phase = 0; phase < NUM_ATTACK_PHASES; phase++) {
+        phases[type][kind][phase] += other.phases[type][kind][phase];
+      }
+    }
+    if (evictions[type].size() < other.evictions[type].size()) {
+      evictions[type].resize(other.evictions[type].size(), 0);
+    }
+    for (uint64_t set = 0; set < other.evictions[type].size(); set++) {
+      evictions[type][set] += other.evictions[type][set];
+    }
+    trials[type] += other.trials[type];
+    trial_ns[type] += other.trial_ns[type];
+  }
+}
+
+void collectCounters(const std::string &predictor, uint64_t trial_ns) {
+  for (uint64_t type = 0; type < NUM_BPU_TYPES; type++) {
+    if (predictor == BPU_NAMES[type]) {
+      hot_counters.trials[type]++;
+      hot_counters.trial_ns[type] += trial_ns;
+    }
+  }
+  std::lock_guard<std::mutex> lock(total_mutex);
+  total_counters.add(hot_counters);
+  hot_counters.clear();
+}
+
+void reportCounters(const std::string &experiment) {
+  std::lock_guard<std::mutex> lock(total_mutex);
+  for (uint64_t type = 0; type < NUM_BPU_TYPES; type++) {
+    if (total_counters.trials[type] == 0) {
+      continue;
+    }
+    std::string prefix = "counters experiment=" + experiment +
+                         " predictor=" + BPU_NAMES[type];
+    // lookups and their outcomes
+    std::cout << prefix << " trials=" << total_counters.trials[type]
+              << " trial_ns=" << total_counters.trial_ns[type];
+    for (uint64_t event = 0; event < NUM_COUNTER_EVENTS; event++) {
+      std::cout << " " << EVENT_NAMES[event] << "="
+                << total_counters.events[type][event];
+    }
+    std::cout << std::endl;
+    // lookups in every phase of the attacks
+    for (uint64_t kind = 0; kind < NUM_ATTACK_KINDS; kind++) {
+      uint64_t lookups = 0;
+      for (uint64_t phase = 0; phase < NUM_ATTACK_PHASES; phase++) {
+        lookups += total_counters.phases[type][kind][phase];
+      }
+      if (lookups == 0) {
+        continue;
+      }
+      std::cout << prefix << " attack=" << ATTACK_NAMES[kind];
+      for (uint64_t phase = 0; phase < NUM_ATTACK_PHASES; phase++) {
+        std::cout << " " << PHASE_NAMES[phase] << "="
+                  << total_counters.phases[type][kind][phase];
+      }
+      std::cout << std::endl;
+    }
+    // evictions of every BTB set
+    if (!total_counters.evictions[type].empty()) {
+      std::cout << prefix << " evictions_per_set=";
+      for (uint64_t set = 0; set < total_counters.evictions[type].size();
+           set++) {
+        std::cout << (set ? "," : "") << total_counters.evictions[type][set];
+      }
+      std::cout << std::endl;
+    }
+  }
+  total_counters.clear();
+}
@@ -0,0 +1,252 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Hot-path counters of the predictors and attacks, enabled by the COUNTERS
+// definition in CMakeLists.txt. Without it (and without PERF_EVENTS and
+// RECORDER, which share the attack markers) the COUNT_* macros compile to
+// nothing. The progress reporter reads the lookup count of every predictor
+// instead (getLookups), a plain member increment.
+//
+// Per predictor the counters track the PHT/BTB lookups and their outcomes,
+// the BTB evictions of every set, the cipher invocations and the CPU time of
+// the trials. Every lookup is also attributed to the phase of the running
+// attack (prune set initialization, self-conflict removal, victim access,
+// probe). The counters are thread-local and added to a process-wide total at
+// the end of every trial; a sweep prints and clears the total when it ends.
+// Trials served by the result cache are not simulated and not counted.
+// =============================================================================
+#ifndef COUNTERS_HPP
+#define COUNTERS_HPP
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "include/utils/PerfEvents.hpp"
+#include "include/utils/Recorder.hpp"
+#include "include/utils/Utils.hpp"
+
+// predictor events
+enum CounterEvent {
+  EVT_PHT_LOOKUP = 0,
+  EVT_PHT_HIT = 1,
+  EVT_PHT_MISPREDICT = 2,
+  EVT_PHT_INVALID = 3,
+  EVT_BTB_LOOKUP = 4,
+  EVT_BTB_HIT = 5,
+  EVT_BTB_MISPREDICT = 6,
+  EVT_BTB_INVALID = 7,
+  EVT_BTB_EVICTION = 8,
+  EVT_CIPHER = 9,
+  NUM_COUNTER_EVENTS = 10
+};
+
+// attacks in the order of the BPUSet API
+enum AttackKind {
+  ATK_NONE = 0,
+  ATK_PHTTiming = 1,
+  ATK_PHTSpeculative = 2,
+  ATK_BTBTiming = 3,
+  ATK_BTBSpeculative = 4,
+  ATK_BTBPrune = 5,
+  ATK_PHTOccupancy = 6,
+  ATK_BTBOccupancy = 7,
+  NUM_ATTACK_KINDS = 8
+};
+
+// attack phases, lookups outside of an attack count as PHASE_NONE
+enum AttackPhase {
+  PHASE_NONE = 0,
+  PHASE_INIT = 1,
+  PHASE_REMOVE = 2,
+  PHASE_VICTIM = 3,
+  PHASE_PROBE = 4,
+  NUM_ATTACK_PHASES = 5
+};
+
+// attack and phase names in the order of AttackKind and AttackPhase
+static const char *const ATTACK_NAMES[] = {
+    "none",           "PHTTiming", "PHTSpeculative", "BTBTiming",
+    "BTBSpeculative", "BTBPrune",  "PHTOccupancy",   "BTBOccupancy"};
+
+static const char *const PHASE_NAMES[] = {"none", "init", "remove", "victim",
+                                          "probe"};
+
+struct HotCounters {
+  uint64_t events[NUM_BPU_TYPES][NUM_COUNTER_EVENTS];
+  uint64_t phases[NUM_BPU_TYPES][NUM_ATTACK_KINDS][NUM_ATTACK_PHASES];
+  std::vector<uint64_t> evictions[NUM_BPU_TYPES];
+  uint64_t trials[NUM_BPU_TYPES];
+  uint64_t trial_ns[NUM_BPU_TYPES];
+
+  // running attack and phase of the thread
+  uint64_t attack;
+  uint64_t phase;
+
+  HotCounters() { clear(); }
+
+  void clear();
+
+  void add(const HotCounters &other);
+};
+
+extern thread_local HotCounters hot_counters;
+
+#ifdef COUNTERS
+// count a lookup with its event and the running attack phase
+inline void countLookup(uint64_t type, uint64_t event) {
+  hot_counters.events[type][event]++;
+  hot_counters.phases[type][hot_counters.attack][hot_counters.phase]++;
+}
+#endif
+
+#if defined(COUNTERS) || defined(RECORDER)
+// count an event, the outcome events also complete a recorded lookup
+inline void countEvent(uint64_t type, uint64_t event) {
+#ifdef COUNTERS
+  hot_counters.events[type][event]++;
+#endif
+#ifdef RECORDER
+  switch (event) {
+    case CounterEvent::EVT_PHT_HIT:
+    case CounterEvent::EVT_BTB_HIT:
+      recordOutcome(LookupOutcome::OUT_HIT);
+      break;
+    case CounterEvent::EVT_PHT_MISPREDICT:
+    case CounterEvent::EVT_BTB_MISPREDICT:
+      recordOutcome(LookupOutcome::OUT_MISPREDICT);
+      break;
+    case CounterEvent::EVT_PHT_INVALID:
+    case CounterEvent::EVT_BTB_INVALID:
+      recordOutcome(LookupOutcome::OUT_INVALID);
+      break;
+  }
+#endif
+#ifndef COUNTERS
+  (void)type;
+#endif
+}
+#endif
+
+// PHT event of a lookup outcome (1 hit, 0 mispredict, -1 invalid)
+inline uint64_t phtEvent(int outcome) {
+  return outcome == 1   ? CounterEvent::EVT_PHT_HIT
+         : outcome == 0 ? CounterEvent::EVT_PHT_MISPREDICT
+                        : CounterEvent::EVT_PHT_INVALID;
+}
+
+// BTB event of a lookup outcome (1 hit, 0 mispredict, -1 invalid)
+inline uint64_t btbEvent(int outcome) {
+  return outcome == 1   ? CounterEvent::EVT_BTB_HIT
+         : outcome == 0 ? CounterEvent::EVT_BTB_MISPREDICT
+                        : CounterEvent::EVT_BTB_INVALID;
+}
+
+#if defined(COUNTERS) || defined(RECORDER)
+// count an eviction from a BTB set, the lookup missed
+inline void countEviction(uint64_t type, uint64_t set) {
+#ifdef COUNTERS
+  std::vector<uint64_t> &evictions = hot_counters.evictions[type];
+  if (set >= evictions.size()) {
+    evictions.resize(set + 1, 0);
+  }
+  evictions[set]++;
+  hot_counters.events[type][EVT_BTB_EVICTION]++;
+#endif
+#ifdef RECORDER
+  recordOutcome(LookupOutcome::OUT_INVALID);
+#endif
+#ifndef COUNTERS
+  (void)type;
+  (void)set;
+#endif
+}
+#endif
+
+#if defined(COUNTERS) || defined(PERF_EVENTS) || defined(RECORDER)
+// running attack of the thread for the lifetime of the scope
+class AttackScope {
+ public:
+  AttackScope(uint64_t attack) {
+#ifdef PERF_EVENTS
+    perfSwitch();
+#endif
+    hot_counters.attack = attack;
+    hot_counters.phase = AttackPhase::PHASE_NONE;
+  }
+
+  ~AttackScope() {
+#ifdef PERF_EVENTS
+    perfSwitch();
+#endif
+    hot_counters.attack = AttackKind::ATK_NONE;
+    hot_counters.phase = AttackPhase::PHASE_NONE;
+  }
+};
+
+// running phase of the attack of the thread
+inline void enterPhase(uint64_t phase) {
+#ifdef PERF_EVENTS
+  if (hot_counters.phase != phase) {
+    perfSwitch();
+  }
+#endif
+  hot_counters.phase = phase;
+}
+#endif
+
+// security domain of a lookup without domains (BaseBPU), from the phase
+inline uint64_t phaseDomain() {
+  return hot_counters.phase == AttackPhase::PHASE_VICTIM
+             ? SecurityDomain::DOM_VICTIM
+             : SecurityDomain::DOM_ATTACKER;
+}
+
+// add the counters of the thread to the total at the end of a trial
+void collectCounters(const std::string &predictor, uint64_t trial_ns);
+
+// print the total of an experiment to stdout and clear it
+void reportCounters(const std::string &experiment);
+
+#ifdef COUNTERS
+#define COUNT_LOOKUP(type, event) countLookup(type, event)
+#else
+#define COUNT_LOOKUP(type, event)
+#endif
+
+// the outcome events also complete the lookups of RECORDER
+#if defined(COUNTERS) || defined(RECORDER)
+#define COUNT_EVENT(type, event) countEvent(type, event)
+#define COUNT_EVICTION(type, set) countEviction(type, set)
+#else
+#define COUNT_EVENT(type, event)
+#define COUNT_EVICTION(type, set)
+#endif
+
+// the attack markers also delimit the hardware counters of PERF_EVENTS and
+// the domains of the BaseBPU lookups of RECORDER
+#if defined(COUNTERS) || defined(PERF_EVENTS) || defined(RECORDER)
+#define COUNT_ATTACK(attack) AttackScope attack_scope(attack)
+#define COUNT_PHASE(next) enterPhase(next)
+#else
+#define COUNT_ATTACK(attack)
+#define COUNT_PHASE(next)
+#endif
+#endif
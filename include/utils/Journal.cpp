@@ -0,0 +1,166 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/utils/Journal.hpp"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+Journal::Journal(std::string path, bool resume, uint64_t interval)
+    : path(path), resume(resume), interval(interval) {}
+
+Journal::~Journal() { close(); }
+
+void Journal::load(const std::string &fingerprint) {
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    return;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string tag;
+    fields >> tag;
+    if (tag == "sweep") {
+      std::string recorded;
+      fields >> recorded;
+      if (recorded != fingerprint) {
+        std::cerr << "Journal: " << path
+                  << " belongs to a different sweep configuration" << std::endl;
+        exit(1);
+      }
+    } else if (tag == "row") {
+      uint64_t row, count;
+      JournalRow state;
+      fields >> row >> state.key >> state.cells_done >> count;
+      state.values.resize(count);
+      for (uint64_t i = 0; i < count; i++) {
+        fields >> state.values[i];
+      }
+      // a torn last line (killed while writing) misses its end marker
+      std::string end;
+      fields >> end;
+      if (fields.fail() || end != ".") {
+        continue;
+      }
+      rows[row] = state;
+    }
+  }
+}
+
+bool Journal::readSeed(const std::string &path, uint64_t &seed) {
+  std::ifstream in(path);
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string tag, fingerprint, experiment;
+    uint64_t recorded;
+    fields >> tag >> fingerprint >> experiment >> recorded;
+    if (tag == "sweep" && !fields.fail()) {
+      seed = recorded;
+      return true;
+    }
+  }
+  return false;
+}
+
+void Journal::open(const std::string &fingerprint,
+                   const std::string &experiment, uint64_t seed) {
+  rows.clear();
+  if (resume) {
+    load(fingerprint);
+  }
+  // rewrite the journal compactly with the restored rows only, through a
+  // temporary file so that a crash here does not lose the old journal
+  std::string temp_path = path + ".tmp";
+  file = fopen(temp_path.c_str(), "w");
+  if (file == nullptr) {
+    std::cerr << "Journal: cannot open " << temp_path << std::endl;
+    exit(1);
+  }
+  fprintf(file, "BGJOURNAL 1\nsweep %s %s %llu\n", fingerprint.c_str(),
+          experiment.c_str(), (unsigned long long)seed);
+  for (auto &entry : rows) {
+    writeRow(entry.first, entry.second.key, entry.second.cells_done,
+             entry.second.values);
+  }
+  fflush(file);
+  fsync(fileno(file));
+  fclose(file);
+  rename(temp_path.c_str(), path.c_str());
+  file = fopen(path.c_str(), "a");
+  last_checkpoint = std::chrono::steady_clock::now();
+}
+
+bool Journal::restore(uint64_t row, uint64_t &cells_done,
+                      std::vector<uint64_t> &values) {
+  auto entry = rows.find(row);
+  if (entry == rows.end()) {
+    return false;
+  }
+  cells_done = entry->second.cells_done;
+  values = entry->second.values;
+  return true;
+}
+
+bool Journal::due() {
+  return std::chrono::steady_clock::now() - last_checkpoint >=
+         std::chrono::seconds(interval);
+}
+
+void Journal::writeRow(uint64_t row, uint64_t key, uint64_t cells_done,
+                       const std::vector<uint64_t> &values) {
+  std::string line = "row " + std::to_string(row) + " " +
+                     std::to_string(key) + " " + std::to_string(cells_done) +
+                     " " + std::to_string(values.size());
+  for (uint64_t value : values) {
+    line += " " + std::to_string(value);
+  }
+  line += " .\n";
+  fwrite(line.data(), 1, line.size(), file);
+}
+
+void Journal::checkpoint(uint64_t row, uint64_t key, uint64_t cells_done,
+                         const std::vector<uint64_t> &values) {
+  if (file == nullptr) {
+    return;
+  }
+  writeRow(row, key, cells_done, values);
+  fflush(file);
+  fsync(fileno(file));
+  last_checkpoint = std::chrono::steady_clock::now();
+}
+
+void Journal::close() {
+  if (file != nullptr) {
+    fclose(file);
+    file = nullptr;
+  }
+}
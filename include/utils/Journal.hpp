@@ -0,0 +1,89 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Checkpoint journal of a sweep. The journal is an append-only text file:
+//
+//   BGJOURNAL 1
+//   sweep <fingerprint> <experiment> <seed>
+//   row <row> <key> <cells_done> <count> <values...> .
+//
+// Cells of a row are evaluated in a fixed order and every cell reseeds the
+// random generator from its coordinates, so <cells_done> is the stream
+// position of the row and <values> are the partial sums up to it. The last
+// record of a row wins.
+// =============================================================================
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+class Journal {
+ private:
+  struct JournalRow {
+    uint64_t key = 0;
+    uint64_t cells_done = 0;
+    std::vector<uint64_t> values;
+  };
+
+  std::string path;
+  bool resume;
+  uint64_t interval;
+
+  FILE *file = nullptr;
+  std::map<uint64_t, JournalRow> rows;
+  std::chrono::steady_clock::time_point last_checkpoint;
+
+  void load(const std::string &fingerprint);
+
+  void writeRow(uint64_t row, uint64_t key, uint64_t cells_done,
+                const std::vector<uint64_t> &values);
+
+ public:
+  // interval: seconds between two checkpoints of an unfinished row
+  Journal(std::string path, bool resume = false, uint64_t interval = 60);
+
+  ~Journal();
+
+  // start journaling a sweep, restoring its progress when resuming
+  void open(const std::string &fingerprint, const std::string &experiment,
+            uint64_t seed);
+
+  // random seed recorded in a journal, return false if there is none
+  static bool readSeed(const std::string &path, uint64_t &seed);
+
+  // restored progress of a row, return false if nothing is recorded
+  bool restore(uint64_t row, uint64_t &cells_done,
+               std::vector<uint64_t> &values);
+
+  // whether the checkpoint interval has elapsed
+  bool due();
+
+  // append the progress of a row and flush it to disk
+  void checkpoint(uint64_t row, uint64_t key, uint64_t cells_done,
+                  const std::vector<uint64_t> &values);
+
+  void close();
+};
+#endif
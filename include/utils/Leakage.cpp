@@ -0,0 +1,194 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/utils/Leakage.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+LeakageEstimator::LeakageEstimator(uint64_t secrets, uint64_t observations)
+    : secrets(secrets),
+      observations(observations),
+      counts(secrets * observations, 0) {}
+
+void LeakageEstimator::add(uint64_t secret, uint64_t observation,
+                           uint64_t count) {
+  counts[secret * observations + observation] += count;
+  trials += count;
+}
+
+void LeakageEstimator::add(const uint64_t *table) {
+  for (uint64_t i = 0; i < counts.size(); i++) {
+    counts[i] += table[i];
+    trials += table[i];
+  }
+}
+
+void LeakageEstimator::merge(const LeakageEstimator &other) {
+  add(other.counts.data());
+}
+
+void LeakageEstimator::entropy(const std::vector<uint64_t> &cells,
+                               double &bits, uint64_t &nonempty) const {
+  bits = 0;
+  nonempty = 0;
+  for (uint64_t count : cells) {
+    if (count > 0) {
+      double p = (double)count / trials;
+      bits -= p * std::log2(p);
+      nonempty++;
+    }
+  }
+}
+
+void LeakageEstimator::marginals(
+    std::vector<uint64_t> &secret_counts,
+    std::vector<uint64_t> &observation_counts) const {
+  secret_counts.assign(secrets, 0);
+  observation_counts.assign(observations, 0);
+  for (uint64_t x = 0; x < secrets; x++) {
+    for (uint64_t y = 0; y < observations; y++) {
+      secret_counts[x] += counts[x * observations + y];
+      observation_counts[y] += counts[x * observations + y];
+    }
+  }
+}
+
+void LeakageEstimator::estimate(double &bits, double &cells) const {
+  std::vector<uint64_t> secret_counts, observation_counts;
+  marginals(secret_counts, observation_counts);
+  double h_x, h_y, h_xy;
+  uint64_t m_x, m_y, m_xy;
+  entropy(secret_counts, h_x, m_x);
+  entropy(observation_counts, h_y, m_y);
+  entropy(counts, h_xy, m_xy);
+  bits = h_x + h_y - h_xy;
+  // (m_x - 1) + (m_y - 1) - (m_xy - 1)
+  cells = (double)m_x + m_y - m_xy - 1;
+}
+
+double LeakageEstimator::plugIn() const {
+  if (trials == 0) {
+    return 0;
+  }
+  double bits, cells;
+  estimate(bits, cells);
+  return bits;
+}
+
+double LeakageEstimator::millerMadow() const {
+  if (trials == 0) {
+    return 0;
+  }
+  double bits, cells;
+  estimate(bits, cells);
+  return bits + cells / (2 * trials * std::log(2.0));
+}
+
+double LeakageEstimator::standardError() const {
+  if (trials == 0) {
+    return 0;
+  }
+  std::vector<uint64_t> secret_counts, observation_counts;
+  marginals(secret_counts, observation_counts);
+  double mean = 0, square = 0;
+  for (uint64_t x = 0; x < secrets; x++) {
+    for (uint64_t y = 0; y < observations; y++) {
+      uint64_t count = counts[x * observations + y];
+      if (count == 0) {
+        continue;
+      }
+      double p = (double)count / trials;
+      double density = std::log2((double)count * trials /
+                                 secret_counts[x] / observation_counts[y]);
+      mean += p * density;
+      square += p * density * density;
+    }
+  }
+  return std::sqrt(std::max(square - mean * mean, 0.0) / trials);
+}
+
+std::pair<double, double> LeakageEstimator::bounds(double z) const {
+  double bits = millerMadow();
+  double error = z * standardError();
+  // no estimate exceeds the entropy of the secrets or the observations
+  double bound = std::log2((double)std::min(secrets, observations));
+  return std::make_pair(std::clamp(bits - error, 0.0, bound),
+                        std::clamp(bits + error, 0.0, bound));
+}
+
+double LeakageEstimator::capacity(double tolerance,
+                                  uint64_t max_iterations) const {
+  // the channel: p(y | x) of every secret with a count
+  std::vector<uint64_t> secret_counts, observation_counts;
+  marginals(secret_counts, observation_counts);
+  std::vector<uint64_t> rows;
+  for (uint64_t x = 0; x < secrets; x++) {
+    if (secret_counts[x] > 0) {
+      rows.push_back(x);
+    }
+  }
+  if (rows.size() < 2) {
+    return 0;
+  }
+  // start from uniform secrets, and weight every secret by 2^D(x) of the
+  // divergence D(x) of its row from the observations under the weights, until
+  // log2 sum r(x) 2^D(x) <= C <= max D(x) are within the tolerance
+  std::vector<double> weights(rows.size(), 1.0 / rows.size());
+  std::vector<double> divergences(rows.size());
+  std::vector<double> q(observations);
+  double lower = 0;
+  for (uint64_t iteration = 0; iteration < max_iterations; iteration++) {
+    std::fill(q.begin(), q.end(), 0.0);
+    for (uint64_t i = 0; i < rows.size(); i++) {
+      uint64_t x = rows[i];
+      for (uint64_t y = 0; y < observations; y++) {
+        q[y] += weights[i] * counts[x * observations + y] / secret_counts[x];
+      }
+    }
+    double upper = 0, sum = 0;
+    for (uint64_t i = 0; i < rows.size(); i++) {
+      uint64_t x = rows[i];
+      double divergence = 0;
+      for (uint64_t y = 0; y < observations; y++) {
+        uint64_t count = counts[x * observations + y];
+        if (count > 0) {
+          double p = (double)count / secret_counts[x];
+          divergence += p * std::log2(p / q[y]);
+        }
+      }
+      divergences[i] = divergence;
+      upper = std::max(upper, divergence);
+      sum += weights[i] * std::exp2(divergence);
+    }
+    lower = std::log2(sum);
+    if (upper - lower <= tolerance) {
+      break;
+    }
+    for (uint64_t i = 0; i < rows.size(); i++) {
+      weights[i] *= std::exp2(divergences[i]) / sum;
+    }
+  }
+  return std::max(lower, 0.0);
+}
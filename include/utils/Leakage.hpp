@@ -0,0 +1,89 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Streaming estimate of the mutual information I(X; Y) between the secret X
+// of a victim and the observation Y of an attacker, in bits. The state is the
+// table of joint counts of (x, y) over the trials: a trial adds one count,
+// and the estimates of threads, shards or sweep rows merge by adding their
+// counts. From the N counts:
+//   plug-in       H(X) + H(Y) - H(X, Y) of the empirical distribution, biased
+//                 upwards by about (|X| - 1)(|Y| - 1) / (2 N ln 2)
+//   Miller-Madow  the plug-in with every entropy corrected by
+//                 (m - 1) / (2 N ln 2), m its non-empty cells
+//   bounds        Miller-Madow -/+ z standard errors of the asymptotic
+//                 variance (E[i(X; Y)^2] - I^2) / N, i(x; y) the information
+//                 density log2 p(x, y) / (p(x) p(y)), clamped to
+//                 [0, log2 min(|X|, |Y|)]
+//   capacity      max of I(X; Y) over the distributions of the secrets for
+//                 the channel p(y | x) of the counts (Blahut-Arimoto), the
+//                 leakage if the victim's secrets were chosen to leak most
+// =============================================================================
+#ifndef LEAKAGE_HPP
+#define LEAKAGE_HPP
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class LeakageEstimator {
+ private:
+  uint64_t secrets;
+  uint64_t observations;
+  // counts of (secret, observation), row-major
+  std::vector<uint64_t> counts;
+  uint64_t trials = 0;
+
+  // sum over the non-empty cells of -p log2 p and their number
+  void entropy(const std::vector<uint64_t> &cells, double &bits,
+               uint64_t &nonempty) const;
+
+  void marginals(std::vector<uint64_t> &secret_counts,
+                 std::vector<uint64_t> &observation_counts) const;
+
+  // plug-in estimate and the non-empty cells of its Miller-Madow correction
+  void estimate(double &bits, double &cells) const;
+
+ public:
+  LeakageEstimator(uint64_t secrets, uint64_t observations);
+
+  void add(uint64_t secret, uint64_t observation, uint64_t count = 1);
+
+  // add a table of secrets * observations counts, row-major
+  void add(const uint64_t *table);
+
+  void merge(const LeakageEstimator &other);
+
+  uint64_t getTrials() const { return trials; }
+
+  double plugIn() const;
+
+  double millerMadow() const;
+
+  double standardError() const;
+
+  // z-confidence interval around the Miller-Madow estimate
+  std::pair<double, double> bounds(double z = 1.96) const;
+
+  // capacity of the channel of the secrets with a non-zero count, to within
+  // tolerance bits or after max_iterations updates
+  double capacity(double tolerance = 1e-6,
+                  uint64_t max_iterations = 10000) const;
+};
+#endif
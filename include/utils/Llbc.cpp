@@ -0,0 +1,199 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/utils/Llbc.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// 4-bit S-box (sigma_2 of QARMA)
+static constexpr uint8_t LLBC_SBOX[16] = {11, 6, 8,  15, 12, 0, 9, 14,
+                                          3,  7, 4, 5,  13, 2, 1, 10};
+
+// round constants, the fraction digits of pi
+static constexpr uint32_t LLBC_CONSTANTS[LLBC_ROUNDS] = {
+    0x243F6A88, 0x85A308D3, 0x13198A2E, 0x03707344,
+    0xA4093822, 0x299F31D0, 0x082EFA98, 0xEC4E6C89};
+
+typedef std::array<std::array<uint32_t, 256>, 4> LLBCTables;
+
+static constexpr uint32_t rotl32(uint32_t x, int shift) {
+  return x << shift | x >> (32 - shift);
+}
+
+// round function tables: table j maps byte j of the input through the S-box
+// and the linear mix of the round
+static constexpr LLBCTables makeTables() {
+  LLBCTables tables{};
+  for (int j = 0; j < 4; j++) {
+    for (uint32_t byte = 0; byte < 256; byte++) {
+      uint32_t sub = LLBC_SBOX[byte >> 4] << 4 | LLBC_SBOX[byte & 0xF];
+      uint32_t x = sub << (8 * j);
+      tables[j][byte] = x ^ rotl32(x, 7) ^ rotl32(x, 18);
+    }
+  }
+  return tables;
+}
+
+static constexpr LLBCTables LLBC_TABLES = makeTables();
+
+static inline uint64_t blockMask(uint64_t bits) {
+  return bits >= 64 ? ~0ULL : (1ULL << bits) - 1;
+}
+
+static inline uint64_t roundFunction(uint64_t half, uint32_t key) {
+  uint32_t x = (uint32_t)half ^ key;
+  return LLBC_TABLES[0][x & 0xFF] ^ LLBC_TABLES[1][(x >> 8) & 0xFF] ^
+         LLBC_TABLES[2][(x >> 16) & 0xFF] ^ LLBC_TABLES[3][x >> 24];
+}
+
+LLBC::LLBC(uint64_t key, uint64_t width)
+    : width(width), mask(blockMask(width)) {
+  for (int i = 0; i < LLBC_ROUNDS; i++) {
+    // key rotated left by 17 bits per round
+    uint64_t r = (17 * i) % 64;
+    uint64_t rotated = r == 0 ? key : key << r | key >> (64 - r);
+    round_keys[i] = (uint32_t)(rotated ^ rotated >> 32) ^ LLBC_CONSTANTS[i];
+  }
+  if (width > LLBC_TABLE_BITS) {
+    return;
+  }
+  // rank of every block among the 64-bit encryptions of all blocks
+  uint64_t blocks = 1ULL << width;
+  std::vector<std::pair<uint64_t, uint64_t>> order(blocks);
+  for (uint64_t block = 0; block < blocks; block++) {
+    uint64_t cipher = block;
+    feistelEnc<1>(&cipher, 64);
+    order[block] = std::make_pair(cipher, block);
+  }
+  std::sort(order.begin(), order.end());
+  encrypt_table.resize(blocks);
+  decrypt_table.resize(blocks);
+  for (uint64_t rank = 0; rank < blocks; rank++) {
+    encrypt_table[order[rank].second] = rank;
+    decrypt_table[rank] = order[rank].second;
+  }
+}
+
+// every round moves the low half (low bits) above the high half XORed with
+// the round function of the low half, the halves of an odd width alternate
+template <int lanes>
+void LLBC::feistelEnc(uint64_t *blocks, uint64_t bits) const {
+  uint64_t low = bits / 2;
+  uint64_t high = bits - low;
+  uint64_t low_mask = blockMask(low);
+  uint64_t high_mask = blockMask(high);
+  for (int i = 0; i < LLBC_ROUNDS; i += 2) {
+    for (int lane = 0; lane < lanes; lane++) {
+      uint64_t right = blocks[lane] & low_mask;
+      uint64_t left =
+          (blocks[lane] >> low) ^ roundFunction(right, round_keys[i]);
+      blocks[lane] = right << high | (left & high_mask);
+    }
+    for (int lane = 0; lane < lanes; lane++) {
+      uint64_t right = blocks[lane] & high_mask;
+      uint64_t left =
+          (blocks[lane] >> high) ^ roundFunction(right, round_keys[i + 1]);
+      blocks[lane] = right << low | (left & low_mask);
+    }
+  }
+}
+
+template <int lanes>
+void LLBC::feistelDec(uint64_t *blocks, uint64_t bits) const {
+  uint64_t low = bits / 2;
+  uint64_t high = bits - low;
+  uint64_t low_mask = blockMask(low);
+  uint64_t high_mask = blockMask(high);
+  for (int i = LLBC_ROUNDS - 2; i >= 0; i -= 2) {
+    for (int lane = 0; lane < lanes; lane++) {
+      uint64_t right = blocks[lane] >> low;
+      uint64_t left = blocks[lane] ^ roundFunction(right, round_keys[i + 1]);
+      blocks[lane] = (left & low_mask) << high | right;
+    }
+    for (int lane = 0; lane < lanes; lane++) {
+      uint64_t right = blocks[lane] >> high;
+      uint64_t left = blocks[lane] ^ roundFunction(right, round_keys[i]);
+      blocks[lane] = (left & high_mask) << low | right;
+    }
+  }
+}
+
+uint64_t LLBC::encrypt(uint64_t plain) const {
+  uint64_t block = plain & mask;
+  if (!encrypt_table.empty()) {
+    return (plain & ~mask) | encrypt_table[block];
+  }
+  feistelEnc<1>(&block, width);
+  return (plain & ~mask) | block;
+}
+
+uint64_t LLBC::decrypt(uint64_t cipher) const {
+  uint64_t block = cipher & mask;
+  if (!decrypt_table.empty()) {
+    return (cipher & ~mask) | decrypt_table[block];
+  }
+  feistelDec<1>(&block, width);
+  return (cipher & ~mask) | block;
+}
+
+void LLBC::encryptBatch(const uint64_t *plain, uint64_t count,
+                        uint64_t *cipher) const {
+  uint64_t i = 0;
+  if (encrypt_table.empty()) {
+    for (; i + LLBC_LANES <= count; i += LLBC_LANES) {
+      uint64_t blocks[LLBC_LANES];
+      for (int lane = 0; lane < LLBC_LANES; lane++) {
+        blocks[lane] = plain[i + lane] & mask;
+      }
+      feistelEnc<LLBC_LANES>(blocks, width);
+      for (int lane = 0; lane < LLBC_LANES; lane++) {
+        cipher[i + lane] = (plain[i + lane] & ~mask) | blocks[lane];
+      }
+    }
+  }
+  for (; i < count; i++) {
+    cipher[i] = encrypt(plain[i]);
+  }
+}
+
+void LLBC::decryptBatch(const uint64_t *cipher, uint64_t count,
+                        uint64_t *plain) const {
+  uint64_t i = 0;
+  if (decrypt_table.empty()) {
+    for (; i + LLBC_LANES <= count; i += LLBC_LANES) {
+      uint64_t blocks[LLBC_LANES];
+      for (int lane = 0; lane < LLBC_LANES; lane++) {
+        blocks[lane] = cipher[i + lane] & mask;
+      }
+      feistelDec<LLBC_LANES>(blocks, width);
+      for (int lane = 0; lane < LLBC_LANES; lane++) {
+        plain[i + lane] = (cipher[i + lane] & ~mask) | blocks[lane];
+      }
+    }
+  }
+  for (; i < count; i++) {
+    plain[i] = decrypt(cipher[i]);
+  }
+}
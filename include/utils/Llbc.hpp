@@ -0,0 +1,79 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Low-latency block cipher (LLBC) of BSUP on a block of 1 to 64 bits, the
+// width of the stored field (a target address or a PHT counter):
+// - blocks of more than LLBC_TABLE_BITS bits are encrypted by an unbalanced
+//   Feistel network of LLBC_ROUNDS rounds, whose round function is a keyed
+//   lookup of four byte-indexed tables (4-bit S-boxes and a linear mix, as
+//   the T-tables of AES)
+// - smaller blocks (the counters) are encrypted by a lookup in a keyed
+//   permutation of all 2^width blocks, drawn by sorting the blocks by their
+//   64-bit encryption
+// Both take a fixed number of operations without data-dependent branches.
+// Bits above the block width pass through unchanged.
+// =============================================================================
+#ifndef LLBC_HPP
+#define LLBC_HPP
+#include <cstdint>
+#include <vector>
+
+#define LLBC_ROUNDS 8
+#define LLBC_TABLE_BITS 8
+#define LLBC_LANES 4
+
+class LLBC {
+ private:
+  uint64_t width = 0;
+  uint64_t mask = 0;
+
+  // 32-bit key of every Feistel round
+  uint32_t round_keys[LLBC_ROUNDS];
+
+  // permutation of the blocks and its inverse, if width <= LLBC_TABLE_BITS
+  std::vector<uint8_t> encrypt_table;
+  std::vector<uint8_t> decrypt_table;
+
+  // Feistel network on lanes independent blocks of bits bits
+  template <int lanes>
+  void feistelEnc(uint64_t *blocks, uint64_t bits) const;
+
+  template <int lanes>
+  void feistelDec(uint64_t *blocks, uint64_t bits) const;
+
+ public:
+  LLBC() = default;
+
+  // cipher of a 64-bit key on blocks of width bits
+  LLBC(uint64_t key, uint64_t width);
+
+  uint64_t encrypt(uint64_t plain) const;
+
+  uint64_t decrypt(uint64_t cipher) const;
+
+  // a batch of blocks, the rounds of LLBC_LANES blocks overlap
+  void encryptBatch(const uint64_t *plain, uint64_t count,
+                    uint64_t *cipher) const;
+
+  void decryptBatch(const uint64_t *cipher, uint64_t count,
+                    uint64_t *plain) const;
+};
+#endif
@@ -0,0 +1,276 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/utils/PerfEvents.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "include/utils/Counters.hpp"
+#include "include/utils/Utils.hpp"
+
+static const char *const PERF_NAMES[] = {"cycles", "instructions",
+                                         "l1d_misses", "llc_misses",
+                                         "branch_misses"};
+
+// counts of every predictor, attack and phase
+struct PerfCounts {
+  uint64_t counts[NUM_BPU_TYPES][NUM_ATTACK_KINDS][NUM_ATTACK_PHASES]
+                 [NUM_PERF_EVENTS];
+
+  PerfCounts() { clear(); }
+
+  void clear() { memset(counts, 0, sizeof(counts)); }
+};
+
+// counter group of a thread
+struct PerfGroup {
+  bool opened = false;
+  int fds[NUM_PERF_EVENTS];
+  // position of every event in the group read, -1 if not provided
+  int64_t slots[NUM_PERF_EVENTS];
+  uint64_t num_slots = 0;
+
+  // predictor of the running trial, -1 outside of trials
+  int64_t type = -1;
+
+  // values and times of the last read
+  uint64_t last[NUM_PERF_EVENTS];
+  uint64_t last_enabled = 0;
+  uint64_t last_running = 0;
+
+  PerfCounts trial;
+
+  ~PerfGroup() {
+    for (uint64_t event = 0; event < NUM_PERF_EVENTS; event++) {
+      if (slots[event] >= 0) {
+        close(fds[event]);
+      }
+    }
+  }
+
+  void open();
+
+  // read the group and attribute the deltas to the running attack and phase
+  void sample();
+};
+
+static thread_local PerfGroup perf_group;
+
+// total of the trials of all threads
+static PerfCounts total_perf;
+static bool total_provided[NUM_PERF_EVENTS];
+static std::mutex total_mutex;
+
+#ifdef __linux__
+static int openEvent(uint32_t type, uint64_t config, int group) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = group < 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // the calling thread on any cpu
+  return syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+#endif
+
+void PerfGroup::open() {
+  opened = true;
+  for (uint64_t event = 0; event < NUM_PERF_EVENTS; event++) {
+    slots[event] = -1;
+  }
+#ifdef __linux__
+  const uint32_t types[NUM_PERF_EVENTS] = {
+      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE};
+  const uint64_t configs[NUM_PERF_EVENTS] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+  // the cycles lead the group, the other events are optional
+  fds[PERF_CYCLES] = openEvent(types[PERF_CYCLES], configs[PERF_CYCLES], -1);
+  if (fds[PERF_CYCLES] < 0) {
+    std::cerr << "perf: perf_event_open failed (" << strerror(errno)
+              << "), hardware counters are disabled" << std::endl;
+    return;
+  }
+  slots[PERF_CYCLES] = num_slots++;
+  for (uint64_t event = 1; event < NUM_PERF_EVENTS; event++) {
+    fds[event] = openEvent(types[event], configs[event], fds[PERF_CYCLES]);
+    if (fds[event] >= 0) {
+      slots[event] = num_slots++;
+    }
+  }
+  ioctl(fds[PERF_CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  sample();
+#else
+  std::cerr << "perf: hardware counters require Linux" << std::endl;
+#endif
+}
+
+void PerfGroup::sample() {
+#ifdef __linux__
+  if (num_slots == 0) {
+    return;
+  }
+  // nr, time_enabled, time_running, values
+  uint64_t buffer[3 + NUM_PERF_EVENTS];
+  if (read(fds[PERF_CYCLES], buffer, sizeof(buffer)) < 0) {
+    return;
+  }
+  uint64_t enabled = buffer[1] - last_enabled;
+  uint64_t running = buffer[2] - last_running;
+  last_enabled = buffer[1];
+  last_running = buffer[2];
+  for (uint64_t event = 0; event < NUM_PERF_EVENTS; event++) {
+    if (slots[event] < 0) {
+      continue;
+    }
+    uint64_t value = buffer[3 + slots[event]];
+    uint64_t delta = value - last[event];
+    last[event] = value;
+    if (type < 0) {
+      continue;
+    }
+    // scale the counts of a multiplexed group to its enabled time
+    if (running > 0 && running < enabled) {
+      delta = delta * ((double)enabled / running);
+    }
+    trial.counts[type][hot_counters.attack][hot_counters.phase][event] +=
+        delta;
+  }
+#endif
+}
+
+void perfBegin(const std::string &predictor) {
+  if (!perf_group.opened) {
+    perf_group.open();
+  }
+  // the counts since the last trial belong to no predictor
+  perf_group.type = -1;
+  perf_group.sample();
+  for (uint64_t type = 0; type < NUM_BPU_TYPES; type++) {
+    if (predictor == BPU_NAMES[type]) {
+      perf_group.type = type;
+    }
+  }
+}
+
+void perfSwitch() {
+  if (perf_group.type >= 0) {
+    perf_group.sample();
+  }
+}
+
+void perfEnd() {
+  if (perf_group.type < 0) {
+    return;
+  }
+  perf_group.sample();
+  perf_group.type = -1;
+  std::lock_guard<std::mutex> lock(total_mutex);
+  for (uint64_t type = 0; type < NUM_BPU_TYPES; type++) {
+    for (uint64_t kind = 0; kind < NUM_ATTACK_KINDS; kind++) {
+      for (uint64_t phase = 0; phase < NUM_ATTACK_PHASES; phase++) {
+        for (uint64_t event = 0; event < NUM_PERF_EVENTS; event++) {
+          total_perf.counts[type][kind][phase][event] +=
+              perf_group.trial.counts[type][kind][phase][event];
+        }
+      }
+    }
+  }
+  for (uint64_t event = 0; event < NUM_PERF_EVENTS; event++) {
+    total_provided[event] |= perf_group.slots[event] >= 0;
+  }
+  perf_group.trial.clear();
+}
+
+// print the events of a line with the derived ipc and misses per kilo
+// instructions
+static void printPerf(const uint64_t (&sum)[NUM_PERF_EVENTS]) {
+  for (uint64_t event = 0; event < NUM_PERF_EVENTS; event++) {
+    if (total_provided[event]) {
+      std::cout << " " << PERF_NAMES[event] << "=" << sum[event];
+    }
+  }
+  double instructions = sum[PERF_INSTRUCTIONS];
+  char buffer[64];
+  if (total_provided[PERF_INSTRUCTIONS] && sum[PERF_CYCLES] > 0) {
+    snprintf(buffer, sizeof(buffer), " ipc=%.3f",
+             instructions / sum[PERF_CYCLES]);
+    std::cout << buffer;
+  }
+  for (uint64_t event = PERF_L1D_MISSES; event < NUM_PERF_EVENTS; event++) {
+    if (total_provided[PERF_INSTRUCTIONS] && total_provided[event] &&
+        instructions > 0) {
+      snprintf(buffer, sizeof(buffer), " %s_pki=%.3f", PERF_NAMES[event],
+               sum[event] * 1000 / instructions);
+      std::cout << buffer;
+    }
+  }
+  std::cout << std::endl;
+}
+
+void reportPerf(const std::string &experiment) {
+  std::lock_guard<std::mutex> lock(total_mutex);
+  for (uint64_t type = 0; type < NUM_BPU_TYPES; type++) {
+    std::string prefix =
+        "perf experiment=" + experiment + " predictor=" + BPU_NAMES[type];
+    uint64_t total[NUM_PERF_EVENTS] = {};
+    for (uint64_t kind = 0; kind < NUM_ATTACK_KINDS; kind++) {
+      for (uint64_t phase = 0; phase < NUM_ATTACK_PHASES; phase++) {
+        const uint64_t(&sum)[NUM_PERF_EVENTS] =
+            total_perf.counts[type][kind][phase];
+        if (sum[PERF_CYCLES] == 0) {
+          continue;
+        }
+        std::cout << prefix << " attack=" << ATTACK_NAMES[kind]
+                  << " phase=" << PHASE_NAMES[phase];
+        printPerf(sum);
+        for (uint64_t event = 0; event < NUM_PERF_EVENTS; event++) {
+          total[event] += sum[event];
+        }
+      }
+    }
+    if (total[PERF_CYCLES] > 0) {
+      std::cout << prefix << " attack=all phase=all";
+      printPerf(total);
+    }
+  }
+  total_perf.clear();
+}
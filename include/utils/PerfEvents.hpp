@@ -0,0 +1,65 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Hardware counters of the simulation itself, enabled by the PERF_EVENTS
+// definition in CMakeLists.txt (Linux only, through perf_event_open).
+//
+// Every thread opens one group of user-space counters (cycles, instructions,
+// L1D read misses, last level cache misses, branch misses) and reads it at
+// every attack call and attack phase switch of a trial (the COUNT_ATTACK and
+// COUNT_PHASE markers). The counts in between are attributed to the predictor
+// of the trial and to the running attack and phase; the code of the
+// experiment outside of the attacks (resets, collision checks) counts as
+// attack=none. A sweep prints and clears the process-wide total when it ends.
+//
+// Every switch costs a read() of the group, which pollutes the caches and the
+// branch predictor of the host; compare the predictors against each other
+// rather than against unmonitored runs. Events that the CPU or the kernel
+// does not provide are left out of the report.
+// =============================================================================
+#ifndef PERF_EVENTS_HPP
+#define PERF_EVENTS_HPP
+#include <cstdint>
+#include <string>
+
+// hardware events of a group
+enum PerfEvent {
+  PERF_CYCLES = 0,
+  PERF_INSTRUCTIONS = 1,
+  PERF_L1D_MISSES = 2,
+  PERF_LLC_MISSES = 3,
+  PERF_BRANCH_MISSES = 4,
+  NUM_PERF_EVENTS = 5
+};
+
+// start counting a trial of the predictor on the calling thread
+void perfBegin(const std::string &predictor);
+
+// attribute the counts since the last switch to the running attack and phase
+void perfSwitch();
+
+// end the trial and add its counts to the process-wide total
+void perfEnd();
+
+// print the total of an experiment to stdout and clear it
+void reportPerf(const std::string &experiment);
+
+#endif
@@ -0,0 +1,140 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/utils/Progress.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+Progress::Progress(const std::string &path, uint64_t interval)
+    : path(path), interval(interval) {
+  start = std::chrono::steady_clock::now();
+  running = true;
+  reporter = std::thread(&Progress::run, this);
+}
+
+Progress::~Progress() { close(); }
+
+void Progress::begin(const std::string &experiment,
+                     const std::vector<std::string> &predictors,
+                     uint64_t total_cells) {
+  std::lock_guard<std::mutex> lock(mutex);
+  this->experiment = experiment;
+  this->predictors = predictors;
+  this->total_cells = total_cells;
+  done_cells = 0;
+  restored_cells = 0;
+  lookups.assign(predictors.size(), 0);
+  trial_ns.assign(predictors.size(), 0);
+  start = std::chrono::steady_clock::now();
+}
+
+void Progress::restore(uint64_t cells) {
+  std::lock_guard<std::mutex> lock(mutex);
+  done_cells += cells;
+  restored_cells += cells;
+}
+
+void Progress::cell(uint64_t predictor, uint64_t lookups, uint64_t trial_ns) {
+  std::lock_guard<std::mutex> lock(mutex);
+  done_cells++;
+  this->lookups[predictor] += lookups;
+  this->trial_ns[predictor] += trial_ns;
+}
+
+void Progress::end() {
+  std::lock_guard<std::mutex> lock(mutex);
+  report();
+  experiment = "";
+}
+
+void Progress::close() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) {
+      return;
+    }
+    running = false;
+  }
+  wakeup.notify_all();
+  reporter.join();
+}
+
+void Progress::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (running) {
+    wakeup.wait_for(lock, std::chrono::seconds(interval));
+    if (running && !experiment.empty()) {
+      report();
+    }
+  }
+}
+
+void Progress::report() {
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  uint64_t busy_ns = 0;
+  for (uint64_t ns : trial_ns) {
+    busy_ns += ns;
+  }
+  // extrapolate the cells completed in this run
+  uint64_t run_cells = done_cells - restored_cells;
+  double eta = -1;
+  if (run_cells > 0) {
+    eta = elapsed * (total_cells - done_cells) / run_cells;
+  }
+  char buffer[256];
+  snprintf(buffer, sizeof(buffer),
+           "progress experiment=%s cells=%llu/%llu percent=%.2f "
+           "elapsed=%.0f eta=%.0f busy=%.3f",
+           experiment.c_str(), (unsigned long long)done_cells,
+           (unsigned long long)total_cells,
+           total_cells ? 100.0 * done_cells / total_cells : 100.0, elapsed,
+           eta, elapsed > 0 ? busy_ns / 1e9 / elapsed : 0.0);
+  std::string line = buffer;
+  for (uint64_t i = 0; i < predictors.size(); i++) {
+    snprintf(buffer, sizeof(buffer), " %s.lookups_per_sec=%.0f",
+             predictors[i].c_str(),
+             trial_ns[i] ? lookups[i] * 1e9 / trial_ns[i] : 0.0);
+    line += buffer;
+  }
+  line += "\n";
+  if (path == "-") {
+    // a single write keeps the line whole next to the other output
+    fputs(line.c_str(), stdout);
+    fflush(stdout);
+    return;
+  }
+  std::string temporary = path + ".tmp";
+  FILE *file = fopen(temporary.c_str(), "w");
+  if (file == nullptr) {
+    return;
+  }
+  fputs(line.c_str(), file);
+  fclose(file);
+  rename(temporary.c_str(), path.c_str());
+}
@@ -0,0 +1,94 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Progress of a running sweep, reported by a dedicated thread every interval
+// as one line of space-separated key=value pairs:
+//   progress experiment=<name> cells=<done>/<total> percent=<x>
+//   elapsed=<s> eta=<s> busy=<x> <predictor>.lookups_per_sec=<x> ...
+// where busy is the fraction of the wall time spent in completed trials and
+// the lookups/sec of a predictor are taken over its simulated trials. The
+// ETA extrapolates the cells completed in this run (cells restored from a
+// journal are done but excluded from the rate).
+//
+// The line is appended to stdout ("-") or replaces the content of a status
+// file, which is written to a temporary file and renamed so that readers
+// always see a complete snapshot.
+// =============================================================================
+#ifndef PROGRESS_HPP
+#define PROGRESS_HPP
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Progress {
+ private:
+  std::string path;
+  uint64_t interval;
+
+  // reporter thread state
+  std::thread reporter;
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  bool running = false;
+
+  // state of the current sweep (guarded by mutex)
+  std::string experiment = "";
+  std::vector<std::string> predictors;
+  uint64_t total_cells = 0;
+  uint64_t done_cells = 0;
+  uint64_t restored_cells = 0;
+  std::vector<uint64_t> lookups;
+  std::vector<uint64_t> trial_ns;
+  std::chrono::steady_clock::time_point start;
+
+  void run();
+
+  // write the status line of the current sweep, with the mutex held
+  void report();
+
+ public:
+  // "-" reports to stdout, interval in seconds
+  Progress(const std::string &path, uint64_t interval = 10);
+
+  ~Progress();
+
+  // start reporting a sweep of the given number of cells
+  void begin(const std::string &experiment,
+             const std::vector<std::string> &predictors, uint64_t total_cells);
+
+  // cells completed by an interrupted run
+  void restore(uint64_t cells);
+
+  // a completed cell, with the lookups and the time of its trial if it was
+  // simulated (zero if it was served by the result cache)
+  void cell(uint64_t predictor, uint64_t lookups, uint64_t trial_ns);
+
+  // report the final state of the sweep
+  void end();
+
+  // stop the reporter thread
+  void close();
+};
+#endif
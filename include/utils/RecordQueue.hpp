@@ -0,0 +1,98 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Bounded lock-free queue (sequence-numbered ring buffer) used to hand result
+// records from the simulation threads to the writer thread. Any number of
+// producers may push; a single consumer pops.
+// =============================================================================
+#ifndef RECORD_QUEUE_HPP
+#define RECORD_QUEUE_HPP
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class RecordQueue {
+ private:
+  struct Slot {
+    std::atomic<uint64_t> sequence;
+    T data;
+  };
+
+  // capacity is rounded up to a power of two
+  uint64_t mask;
+  std::vector<Slot> slots;
+
+  // keep producer and consumer cursors on separate cache lines
+  alignas(64) std::atomic<uint64_t> head{0};
+  alignas(64) std::atomic<uint64_t> tail{0};
+
+ public:
+  RecordQueue(uint64_t capacity = 4096) {
+    uint64_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    mask = size - 1;
+    slots = std::vector<Slot>(size);
+    for (uint64_t i = 0; i < size; i++) {
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // return false if the queue is full
+  bool push(T &&item) {
+    uint64_t pos = head.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = slots[pos & mask];
+      uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+      int64_t diff = (int64_t)seq - (int64_t)pos;
+      if (diff == 0) {
+        if (head.compare_exchange_weak(pos, pos + 1,
+                                       std::memory_order_relaxed)) {
+          slot.data = std::move(item);
+          slot.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // return false if the queue is empty (single consumer only)
+  bool pop(T &item) {
+    uint64_t pos = tail.load(std::memory_order_relaxed);
+    Slot &slot = slots[pos & mask];
+    uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+    if ((int64_t)seq - (int64_t)(pos + 1) < 0) {
+      return false;
+    }
+    item = std::move(slot.data);
+    slot.sequence.store(pos + mask + 1, std::memory_order_release);
+    tail.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+};
+#endif
@@ -0,0 +1,71 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/utils/Recorder.hpp"
+
+#include <cstdint>
+#include <string>
+
+#include "include/utils/Trace.hpp"
+
+thread_local StreamRecorder *stream_recorder = nullptr;
+
+StreamRecorder::StreamRecorder(const std::string &path)
+    : writer(path, true) {}
+
+bool StreamRecorder::open() { return writer.open(); }
+
+void StreamRecorder::flush() {
+  if (has_pending) {
+    writer.write(pending);
+    has_pending = false;
+  }
+}
+
+void StreamRecorder::lookupPHT(uint64_t pc, bool taken, uint64_t domain) {
+  flush();
+  pending.pc = pc;
+  pending.target = 0;
+  pending.taken = taken;
+  pending.kind = BranchKind::BR_COND;
+  pending.domain = domain;
+  pending.outcome = LookupOutcome::OUT_NONE;
+  has_pending = true;
+  lookups++;
+}
+
+void StreamRecorder::lookupBTB(uint64_t pc, uint64_t target,
+                               uint64_t domain) {
+  flush();
+  pending.pc = pc;
+  pending.target = target;
+  pending.taken = true;
+  pending.kind = BranchKind::BR_JUMP;
+  pending.domain = domain;
+  pending.outcome = LookupOutcome::OUT_NONE;
+  has_pending = true;
+  lookups++;
+}
+
+bool StreamRecorder::close() {
+  flush();
+  return writer.close();
+}
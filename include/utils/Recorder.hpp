@@ -0,0 +1,95 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Recorder of the PHT and BTB lookups of an attack, enabled by the RECORDER
+// definition in CMakeLists.txt. While a recorder is attached to a thread, the
+// RECORD_* markers at the top of the lookups of every predictor and the
+// outcome events (COUNT_EVENT, COUNT_EVICTION) write a lookup stream in the
+// trace format (see Trace.hpp), which the stream-replay mode drives through
+// other predictors. BaseBPU has no security domains; its lookups take the
+// domain of the running attack phase (victim access or attacker).
+// =============================================================================
+#ifndef RECORDER_HPP
+#define RECORDER_HPP
+#include <cstdint>
+#include <string>
+
+#include "include/utils/Trace.hpp"
+
+class StreamRecorder {
+ private:
+  TraceWriter writer;
+  uint64_t lookups = 0;
+
+  // the last lookup, written when its outcome is known
+  TraceRecord pending;
+  bool has_pending = false;
+
+  void flush();
+
+ public:
+  StreamRecorder(const std::string &path);
+
+  // create the log, return false if it cannot be written
+  bool open();
+
+  void lookupPHT(uint64_t pc, bool taken, uint64_t domain);
+
+  void lookupBTB(uint64_t pc, uint64_t target, uint64_t domain);
+
+  // outcome of the last lookup (LookupOutcome)
+  void outcome(uint64_t outcome) { pending.outcome = outcome; }
+
+  uint64_t size() { return lookups; }
+
+  // write the last lookup and the header, return false on i/o errors
+  bool close();
+};
+
+// recorder of the thread, nullptr if its lookups are not recorded
+extern thread_local StreamRecorder *stream_recorder;
+
+inline void recordPHT(uint64_t pc, bool taken, uint64_t domain) {
+  if (stream_recorder != nullptr) {
+    stream_recorder->lookupPHT(pc, taken, domain);
+  }
+}
+
+inline void recordBTB(uint64_t pc, uint64_t target, uint64_t domain) {
+  if (stream_recorder != nullptr) {
+    stream_recorder->lookupBTB(pc, target, domain);
+  }
+}
+
+inline void recordOutcome(uint64_t outcome) {
+  if (stream_recorder != nullptr) {
+    stream_recorder->outcome(outcome);
+  }
+}
+
+#ifdef RECORDER
+#define RECORD_PHT(pc, taken, domain) recordPHT(pc, taken, domain)
+#define RECORD_BTB(pc, target, domain) recordBTB(pc, target, domain)
+#else
+#define RECORD_PHT(pc, taken, domain)
+#define RECORD_BTB(pc, target, domain)
+#endif
+#endif
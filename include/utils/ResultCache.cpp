@@ -0,0 +1,170 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/utils/ResultCache.hpp"
+
+#include <sys/stat.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "include/utils/CodeVersion.hpp"
+#include "include/utils/Utils.hpp"
+
+#define CACHE_BUCKETS 256
+
+// compile-time switches that change the result of a trial
+static const char *const BUILD_FLAGS = ""
+#ifdef RANDOM_KEY
+                                       "RANDOM_KEY,"
+#endif
+#ifdef RANDOM_PID
+                                       "RANDOM_PID,"
+#endif
+#ifdef LIMITED_BRANCH_ACCESS
+                                       "LIMITED_BRANCH_ACCESS,"
+#endif
+    ;
+
+// 64-bit hash of a string with a given basis (FNV-1a, splitmix64 finalizer)
+static uint64_t hashString(const std::string &text, uint64_t basis) {
+  uint64_t hash = basis;
+  for (unsigned char c : text) {
+    hash = (hash ^ c) * 0x100000001B3ULL;
+  }
+  hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+  return hash ^ (hash >> 31);
+}
+
+const char *codeVersion(const std::string &predictor) {
+  for (uint64_t i = 0; i < sizeof(BPU_NAMES) / sizeof(BPU_NAMES[0]); i++) {
+    if (predictor == BPU_NAMES[i]) {
+      return CODE_VERSIONS[i];
+    }
+  }
+  return "unknown";
+}
+
+ResultCache::ResultCache(std::string dir)
+    : dir(dir), loaded(CACHE_BUCKETS, false) {
+  mkdir(dir.c_str(), 0755);
+}
+
+std::string ResultCache::address(const ResultHeader &header,
+                                 const std::string &predictor, uint64_t key,
+                                 uint64_t repeat, uint64_t cell_seed) {
+  std::string config;
+  config += "experiment=" + header.experiment + "\n";
+  config += "params=" + header.params + "\n";
+  config += "predictor=" + predictor + "\n";
+  config += "version=" + std::string(codeVersion(predictor)) + "\n";
+  config += "flags=" + std::string(BUILD_FLAGS) + "\n";
+  config += "geometry=" + std::to_string(header.counter_bits) + "," +
+            std::to_string(header.counter_nums) + "," +
+            std::to_string(header.buffer_ways) + "," +
+            std::to_string(header.buffer_sets) + "," +
+            std::to_string(header.addr_space) + "\n";
+  config += "offsets=" + std::to_string(header.offset_pht) + "," +
+            std::to_string(header.offset_btb) + "\n";
+  config += "policy=" + header.policy + "\n";
+  config += "pht=" + header.pht + "\n";
+  config += "rekey=" + header.rekey + "\n";
+  config += "cipher=" + header.cipher + "\n";
+  config += "btb=" + header.btb + "\n";
+  config += "budget=" + std::to_string(key) + "\n";
+  config += "seed=" + std::to_string(header.seed) + "\n";
+  config += "repeat=" + std::to_string(repeat) + "\n";
+  config += "cell_seed=" + std::to_string(cell_seed) + "\n";
+  char buffer[33];
+  snprintf(buffer, sizeof(buffer), "%016llx%016llx",
+           (unsigned long long)hashString(config, 0xCBF29CE484222325ULL),
+           (unsigned long long)hashString(config, 0x84222325CBF29CE4ULL));
+  return buffer;
+}
+
+std::string ResultCache::bucketPath(const std::string &address) {
+  return dir + "/" + address.substr(0, 2) + ".cells";
+}
+
+void ResultCache::load(const std::string &address) {
+  uint64_t bucket = std::stoull(address.substr(0, 2), nullptr, 16);
+  if (loaded[bucket]) {
+    return;
+  }
+  loaded[bucket] = true;
+  std::ifstream in(bucketPath(address));
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string cell;
+    uint64_t count;
+    fields >> cell >> count;
+    std::vector<uint64_t> values(count);
+    for (uint64_t i = 0; i < count; i++) {
+      fields >> values[i];
+    }
+    // skip torn lines of an interrupted writer
+    std::string end;
+    fields >> end;
+    if (fields.fail() || end != ".") {
+      continue;
+    }
+    cells[cell] = values;
+  }
+}
+
+bool ResultCache::lookup(const std::string &address,
+                         std::vector<uint64_t> &values) {
+  load(address);
+  auto entry = cells.find(address);
+  if (entry == cells.end()) {
+    misses++;
+    return false;
+  }
+  hits++;
+  values = entry->second;
+  return true;
+}
+
+void ResultCache::store(const std::string &address,
+                        const std::vector<uint64_t> &values) {
+  load(address);
+  cells[address] = values;
+  std::string line = address + " " + std::to_string(values.size());
+  for (uint64_t value : values) {
+    line += " " + std::to_string(value);
+  }
+  line += " .\n";
+  FILE *file = fopen(bucketPath(address).c_str(), "a");
+  if (file == nullptr) {
+    std::cerr << "ResultCache: cannot write " << bucketPath(address)
+              << std::endl;
+    return;
+  }
+  fwrite(line.data(), 1, line.size(), file);
+  fclose(file);
+}
@@ -0,0 +1,80 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Content-addressed cache of sweep cells. The address of a cell is a 128-bit
+// hash of everything its result depends on: experiment and its arguments,
+// predictor and the code version of that predictor, geometry, replacement
+// policy, PHT model, rekey policy, index cipher, compile-time flags, budget
+// and the seeds of the run and the cell.
+// Editing one predictor therefore only invalidates the cells of that
+// predictor.
+//
+// Cells are stored in 256 append-only bucket files "<dir>/<xx>.cells" (xx is
+// the first byte of the address) with one line per cell:
+//
+//   <address> <count> <values...> .
+//
+// Buckets are loaded on first use. Lines are appended with a single write, so
+// several processes (e.g., shards) can share a cache directory.
+// =============================================================================
+#ifndef RESULT_CACHE_HPP
+#define RESULT_CACHE_HPP
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "include/utils/ResultWriter.hpp"
+
+// code version of a predictor, a hash of its sources and the shared sources
+const char *codeVersion(const std::string &predictor);
+
+class ResultCache {
+ private:
+  std::string dir;
+  std::vector<bool> loaded;
+  std::unordered_map<std::string, std::vector<uint64_t>> cells;
+
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+
+  std::string bucketPath(const std::string &address);
+
+  void load(const std::string &address);
+
+ public:
+  explicit ResultCache(std::string dir);
+
+  // address of a cell of a result table
+  static std::string address(const ResultHeader &header,
+                             const std::string &predictor, uint64_t key,
+                             uint64_t repeat, uint64_t cell_seed);
+
+  // return false if the cell is not cached
+  bool lookup(const std::string &address, std::vector<uint64_t> &values);
+
+  void store(const std::string &address, const std::vector<uint64_t> &values);
+
+  uint64_t getHits() { return hits; }
+
+  uint64_t getMisses() { return misses; }
+};
+#endif
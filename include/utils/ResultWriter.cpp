@@ -0,0 +1,471 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/utils/ResultWriter.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// width reserved for the row count in the NPY header, so that the shape can
+// be patched in place when the table is finished
+#define NPY_ROWS_WIDTH 20
+#define NPY_HEADER_ALIGN 64
+
+std::string ResultHeader::serialize() const {
+  std::string out;
+  out += "experiment=" + experiment + "\n";
+  out += "key=" + key_name + "\n";
+  out += "predictors=";
+  for (uint64_t i = 0; i < predictors.size(); i++) {
+    out += (i == 0 ? "" : ",") + predictors[i];
+  }
+  out += "\n";
+  out += "values_per_predictor=" + std::to_string(values_per_predictor) + "\n";
+  out += "layout=" + layout + "\n";
+  out += "columns=" + std::to_string(columns()) + "\n";
+  out += "counter_bits=" + std::to_string(counter_bits) + "\n";
+  out += "counter_nums=" + std::to_string(counter_nums) + "\n";
+  out += "buffer_ways=" + std::to_string(buffer_ways) + "\n";
+  out += "buffer_sets=" + std::to_string(buffer_sets) + "\n";
+  out += "addr_space=" + std::to_string(addr_space) + "\n";
+  out += "offset_pht=" + std::to_string(offset_pht) + "\n";
+  out += "offset_btb=" + std::to_string(offset_btb) + "\n";
+  out += "policy=" + policy + "\n";
+  out += "pht=" + pht + "\n";
+  out += "rekey=" + rekey + "\n";
+  out += "cipher=" + cipher + "\n";
+  out += "btb=" + btb + "\n";
+  out += "params=" + params + "\n";
+  out += "seed=" + std::to_string(seed) + "\n";
+  out += "common_random=" + std::to_string(common_random) + "\n";
+  out += "baseline=" + std::to_string(baseline) + "\n";
+  out += "repeats=" + std::to_string(repeats) + "\n";
+  out += "average=" + std::to_string(average) + "\n";
+  out += "shard=" + std::to_string(shard_index) + "/" +
+         std::to_string(shard_count) + "\n";
+  return out;
+}
+
+bool ResultHeader::parse(const std::string &text) {
+  std::istringstream lines(text);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    uint64_t pos = line.find('=');
+    if (pos == std::string::npos) {
+      return false;
+    }
+    std::string name = line.substr(0, pos);
+    std::string value = line.substr(pos + 1);
+    try {
+      if (name == "experiment") {
+        experiment = value;
+      } else if (name == "key") {
+        key_name = value;
+      } else if (name == "predictors") {
+        predictors.clear();
+        std::istringstream names(value);
+        std::string predictor;
+        while (std::getline(names, predictor, ',')) {
+          predictors.push_back(predictor);
+        }
+      } else if (name == "values_per_predictor") {
+        values_per_predictor = std::stoull(value);
+      } else if (name == "layout") {
+        layout = value;
+      } else if (name == "counter_bits") {
+        counter_bits = std::stoull(value);
+      } else if (name == "counter_nums") {
+        counter_nums = std::stoull(value);
+      } else if (name == "buffer_ways") {
+        buffer_ways = std::stoull(value);
+      } else if (name == "buffer_sets") {
+        buffer_sets = std::stoull(value);
+      } else if (name == "addr_space") {
+        addr_space = std::stoull(value);
+      } else if (name == "offset_pht") {
+        offset_pht = std::stoull(value);
+      } else if (name == "offset_btb") {
+        offset_btb = std::stoull(value);
+      } else if (name == "policy") {
+        policy = value;
+      } else if (name == "pht") {
+        pht = value;
+      } else if (name == "rekey") {
+        rekey = value;
+      } else if (name == "cipher") {
+        cipher = value;
+      } else if (name == "btb") {
+        btb = value;
+      } else if (name == "params") {
+        params = value;
+      } else if (name == "seed") {
+        seed = std::stoull(value);
+      } else if (name == "common_random") {
+        common_random = std::stoull(value) != 0;
+      } else if (name == "baseline") {
+        baseline = std::stoull(value) != 0;
+      } else if (name == "repeats") {
+        repeats = std::stoull(value);
+      } else if (name == "average") {
+        average = std::stoull(value) != 0;
+      } else if (name == "shard") {
+        uint64_t slash = value.find('/');
+        if (slash == std::string::npos) {
+          return false;
+        }
+        shard_index = std::stoull(value.substr(0, slash));
+        shard_count = std::stoull(value.substr(slash + 1));
+      }
+      // "columns" is derived, unknown names are skipped
+    } catch (...) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// read the records of a table, up to num_rows (UINT64_MAX: to the end of
+// the file)
+static void readRecords(std::ifstream &in, uint64_t num_rows,
+                        ResultTable &table) {
+  std::vector<uint64_t> record(table.header.columns() + 1);
+  while (table.keys.size() < num_rows &&
+         in.read(reinterpret_cast<char *>(record.data()),
+                 record.size() * sizeof(uint64_t))) {
+    table.keys.push_back(record[0]);
+    table.rows.emplace_back(record.begin() + 1, record.end());
+  }
+}
+
+// header lines of the npy tables, each followed by an empty line
+static bool readMeta(const std::string &path, std::vector<std::string> &metas) {
+  std::ifstream meta_in(path + ".meta");
+  if (!meta_in.is_open()) {
+    return false;
+  }
+  std::stringstream meta;
+  meta << meta_in.rdbuf();
+  std::string text = meta.str();
+  uint64_t start = 0;
+  while (start < text.size()) {
+    uint64_t end = text.find("\n\n", start);
+    if (end == std::string::npos) {
+      end = text.size();
+    }
+    metas.push_back(text.substr(start, end - start));
+    start = end + 2;
+  }
+  return true;
+}
+
+bool readResults(const std::string &path, std::vector<ResultTable> &tables) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open()) {
+    return false;
+  }
+  tables.clear();
+  std::vector<std::string> metas;
+  char magic[8];
+  while (in.read(magic, sizeof(magic))) {
+    ResultTable table;
+    uint64_t num_rows = UINT64_MAX;
+    if (memcmp(magic, "BGRES001", 8) == 0 ||
+        memcmp(magic, "BGRES002", 8) == 0) {
+      uint32_t length;
+      in.read(reinterpret_cast<char *>(&length), sizeof(length));
+      std::string meta(length, '\0');
+      in.read(&meta[0], length);
+      // the single table of a BGRES001 file ends with the file
+      if (magic[7] == '2') {
+        in.read(reinterpret_cast<char *>(&num_rows), sizeof(num_rows));
+      }
+      if (!in || !table.header.parse(meta)) {
+        return false;
+      }
+    } else if (memcmp(magic, "\x93NUMPY\x01\x00", 8) == 0) {
+      uint16_t length;
+      in.read(reinterpret_cast<char *>(&length), sizeof(length));
+      std::string dict(length, '\0');
+      in.read(&dict[0], length);
+      uint64_t shape = dict.find("'shape': (");
+      if (!in || shape == std::string::npos) {
+        return false;
+      }
+      num_rows = std::stoull(dict.substr(shape + 10));
+      if (metas.empty() && !readMeta(path, metas)) {
+        return false;
+      }
+      if (tables.size() >= metas.size() ||
+          !table.header.parse(metas[tables.size()])) {
+        return false;
+      }
+    } else {
+      // the text format carries no keys
+      return false;
+    }
+    readRecords(in, num_rows, table);
+    tables.push_back(table);
+  }
+  return !tables.empty();
+}
+
+ResultHeader ResultHeader::table(std::string experiment, std::string key_name,
+                                 uint64_t values_per_predictor,
+                                 std::string layout) const {
+  ResultHeader header = *this;
+  header.experiment = experiment;
+  header.key_name = key_name;
+  header.values_per_predictor = values_per_predictor;
+  header.layout = layout;
+  return header;
+}
+
+ResultWriter::ResultWriter(ResultFormat format, std::string path,
+                           uint64_t queue_size)
+    : format(format), path(path), queue(queue_size) {
+  running = true;
+  worker = std::thread(&ResultWriter::run, this);
+}
+
+ResultWriter::~ResultWriter() { close(); }
+
+bool ResultWriter::parseFormat(const std::string &name, ResultFormat &format) {
+  if (name == "text") {
+    format = ResultFormat::FMT_TEXT;
+  } else if (name == "binary") {
+    format = ResultFormat::FMT_BINARY;
+  } else if (name == "npy") {
+    format = ResultFormat::FMT_NPY;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void ResultWriter::begin(const ResultHeader &header) {
+  Record record;
+  record.kind = REC_BEGIN;
+  record.header = header;
+  enqueue(std::move(record));
+}
+
+void ResultWriter::write(uint64_t key, const std::vector<uint64_t> &values) {
+  Record record;
+  record.kind = REC_ROW;
+  record.key = key;
+  record.values = values;
+  enqueue(std::move(record));
+}
+
+void ResultWriter::end() {
+  Record record;
+  record.kind = REC_END;
+  enqueue(std::move(record));
+}
+
+void ResultWriter::close() {
+  if (!running) {
+    return;
+  }
+  Record record;
+  record.kind = REC_STOP;
+  enqueue(std::move(record));
+  worker.join();
+  running = false;
+}
+
+void ResultWriter::enqueue(Record &&record) {
+  // the queue is only full if the disk cannot keep up, back off until the
+  // writer thread has drained some records
+  while (!queue.push(std::move(record))) {
+    std::this_thread::yield();
+  }
+}
+
+void ResultWriter::run() {
+  Record record;
+  uint64_t idle = 0;
+  while (true) {
+    if (!queue.pop(record)) {
+      // spin briefly, then sleep so an idle writer does not burn a core
+      if (++idle < 64) {
+        std::this_thread::yield();
+      } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+      }
+      continue;
+    }
+    idle = 0;
+    if (record.kind == REC_BEGIN) {
+      beginTable(record.header);
+    } else if (record.kind == REC_ROW) {
+      writeRow(record.key, record.values);
+    } else if (record.kind == REC_END) {
+      endTable();
+    } else {
+      closeFile();
+      return;
+    }
+  }
+}
+
+bool ResultWriter::openFile() {
+  if (format == ResultFormat::FMT_TEXT && (path.empty() || path == "-")) {
+    file = stderr;
+    return true;
+  }
+  file = fopen(path.c_str(), format == ResultFormat::FMT_TEXT ? "w" : "wb");
+  if (file == nullptr) {
+    fprintf(stderr, "ResultWriter: cannot open %s\n", path.c_str());
+    return false;
+  }
+  // the metadata does not fit into the NPY dictionary, keep it aside
+  if (format == ResultFormat::FMT_NPY) {
+    meta_file = fopen((path + ".meta").c_str(), "w");
+  }
+  return true;
+}
+
+void ResultWriter::closeFile() {
+  endTable();
+  if (file != nullptr && file != stderr) {
+    fclose(file);
+  }
+  if (meta_file != nullptr) {
+    fclose(meta_file);
+  }
+  file = nullptr;
+  meta_file = nullptr;
+}
+
+void ResultWriter::beginTable(const ResultHeader &header) {
+  endTable();
+  rows = 0;
+  columns = header.columns();
+  if (file == nullptr && !openFile()) {
+    return;
+  }
+  in_table = true;
+  std::string meta = header.serialize();
+  if (format == ResultFormat::FMT_TEXT) {
+    // stderr keeps the headerless layout of the original experiments
+    if (file != stderr) {
+      std::istringstream lines(meta);
+      std::string line;
+      while (std::getline(lines, line)) {
+        fprintf(file, "# %s\n", line.c_str());
+      }
+    }
+  } else if (format == ResultFormat::FMT_BINARY) {
+    uint32_t length = meta.size();
+    fwrite("BGRES002", 1, 8, file);
+    fwrite(&length, sizeof(length), 1, file);
+    fwrite(meta.data(), 1, meta.size(), file);
+    rows_pos = ftell(file);
+    fwrite(&rows, sizeof(rows), 1, file);
+  } else if (format == ResultFormat::FMT_NPY) {
+    if (meta_file != nullptr) {
+      fwrite(meta.data(), 1, meta.size(), meta_file);
+      fputs("\n", meta_file);
+      fflush(meta_file);
+    }
+    std::string dict = "{'descr': '<u8', 'fortran_order': False, 'shape': (";
+    std::string prefix("\x93NUMPY\x01\x00", 8);
+    rows_pos = ftell(file) + prefix.size() + 2 + dict.size();
+    dict += std::string(NPY_ROWS_WIDTH, ' ') + ", " +
+            std::to_string(columns + 1) + "), }";
+    uint64_t total = prefix.size() + 2 + dict.size() + 1;
+    dict += std::string((NPY_HEADER_ALIGN - total % NPY_HEADER_ALIGN) %
+                            NPY_HEADER_ALIGN,
+                        ' ') +
+            "\n";
+    uint16_t length = dict.size();
+    fwrite(prefix.data(), 1, prefix.size(), file);
+    fwrite(&length, sizeof(length), 1, file);
+    fwrite(dict.data(), 1, dict.size(), file);
+    patchRows();
+  }
+  fflush(file);
+}
+
+void ResultWriter::writeRow(uint64_t key, const std::vector<uint64_t> &values) {
+  if (file == nullptr || !in_table) {
+    return;
+  }
+  if (format == ResultFormat::FMT_TEXT) {
+    std::string line;
+    for (uint64_t value : values) {
+      line += std::to_string(value) + " ";
+    }
+    line += "\n";
+    fwrite(line.data(), 1, line.size(), file);
+  } else {
+    // fixed-width record: pad or truncate to the declared column count
+    std::vector<uint64_t> record(columns + 1, 0);
+    record[0] = key;
+    for (uint64_t i = 0; i < values.size() && i < columns; i++) {
+      record[i + 1] = values[i];
+    }
+    fwrite(record.data(), sizeof(uint64_t), record.size(), file);
+  }
+  rows++;
+  // rows are produced slowly, keep the file readable if the run is killed
+  if (format != ResultFormat::FMT_TEXT) {
+    patchRows();
+  }
+  fflush(file);
+}
+
+void ResultWriter::patchRows() {
+  // patch the row count into the space reserved in the table header
+  long end = ftell(file);
+  fseek(file, rows_pos, SEEK_SET);
+  if (format == ResultFormat::FMT_BINARY) {
+    fwrite(&rows, sizeof(rows), 1, file);
+  } else {
+    std::string count = std::to_string(rows);
+    count += std::string(NPY_ROWS_WIDTH - count.size(), ' ');
+    fwrite(count.data(), 1, count.size(), file);
+  }
+  fseek(file, end, SEEK_SET);
+}
+
+void ResultWriter::endTable() {
+  if (file == nullptr || !in_table) {
+    return;
+  }
+  if (format != ResultFormat::FMT_TEXT) {
+    patchRows();
+  }
+  fflush(file);
+  in_table = false;
+}
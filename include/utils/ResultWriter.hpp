@@ -0,0 +1,186 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Result output of the experiments. Every result table is a sequence of
+// fixed-width records (key, values[columns]) where the key is the swept
+// parameter of the row (branch accesses, pruning size or repeat index). A
+// writer opens its file once and appends every table of the run (e.g., one
+// per experiment of an exploration) behind a header of its own.
+//
+// FMT_TEXT:   space-separated decimal values (the original stderr format), in
+//             a file every table starts with its header lines as "# " lines
+// FMT_BINARY: per table "BGRES002", uint32 header length, "name=value\n"
+//             header lines, uint64 row count, then little-endian uint64
+//             records of (columns + 1) fields ("BGRES001" files hold a single
+//             table without the row count)
+// FMT_NPY:    per table an NPY v1.0 uint64 array of shape (rows, columns + 1),
+//             one after the other (numpy.load of an open file reads them in
+//             turn), the header lines of the tables are written to
+//             "<path>.meta", each followed by an empty line
+// =============================================================================
+#ifndef RESULT_WRITER_HPP
+#define RESULT_WRITER_HPP
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/utils/RecordQueue.hpp"
+
+// output format
+enum ResultFormat { FMT_TEXT = 0, FMT_BINARY = 1, FMT_NPY = 2 };
+
+// self-describing header of a result table
+struct ResultHeader {
+  std::string experiment;
+  std::string key_name;
+  std::vector<std::string> predictors;
+  // values of each predictor, "predictor-major" (p0v0 p0v1 .. p1v0 ..) or
+  // "group-major" (g0p0 g0p1 .. g1p0 ..)
+  uint64_t values_per_predictor = 1;
+  std::string layout = "predictor-major";
+  // geometry
+  uint64_t counter_bits = 0;
+  uint64_t counter_nums = 0;
+  uint64_t buffer_ways = 0;
+  uint64_t buffer_sets = 0;
+  uint64_t addr_space = 0;
+  // address bits below the PHT and BTB index
+  uint64_t offset_pht = 5;
+  uint64_t offset_btb = 5;
+  std::string policy = "lru";
+  // direction model of the PHT (phtName)
+  std::string pht = "bimodal";
+  // key rotation of the keyed predictors (rekeyName)
+  std::string rekey = "none";
+  // index cipher of the keyed predictors (cipherName)
+  std::string cipher = "native";
+  // levels of the BTB (btbName)
+  std::string btb = "single";
+  // arguments of the experiment, e.g., "prune_size=20,counter_bits=2"
+  std::string params;
+  // random seed of the run
+  uint64_t seed = 0;
+  // whether the predictors of a trial share its random draws (see Sweep.hpp)
+  bool common_random = false;
+  // whether the trials keep the predictor tables and one random stream, as
+  // in the original experiments (see Sweep.hpp)
+  bool baseline = false;
+  // repeats of every row, and whether a row is their sum or average
+  uint64_t repeats = 0;
+  bool average = false;
+  // shard of the sweep, the rows of a shard (i/N with N > 1) are partial sums
+  // over its cells that are combined by merging all N shards
+  uint64_t shard_index = 0;
+  uint64_t shard_count = 1;
+
+  uint64_t columns() const { return predictors.size() * values_per_predictor; }
+
+  // copy of this header (geometry and seed) for a specific result table
+  ResultHeader table(std::string experiment, std::string key_name,
+                     uint64_t values_per_predictor = 1,
+                     std::string layout = "predictor-major") const;
+
+  std::string serialize() const;
+
+  // inverse of serialize, return false on malformed lines
+  bool parse(const std::string &text);
+};
+
+// result table read back from a file
+struct ResultTable {
+  ResultHeader header;
+  std::vector<uint64_t> keys;
+  std::vector<std::vector<uint64_t>> rows;
+};
+
+// read all tables of a binary or npy result file, return false if the file
+// is malformed or holds no table
+bool readResults(const std::string &path, std::vector<ResultTable> &tables);
+
+class ResultWriter {
+ private:
+  enum RecordKind { REC_BEGIN = 0, REC_ROW = 1, REC_END = 2, REC_STOP = 3 };
+
+  struct Record {
+    RecordKind kind = REC_ROW;
+    uint64_t key = 0;
+    std::vector<uint64_t> values;
+    ResultHeader header;
+  };
+
+  ResultFormat format;
+  std::string path;
+
+  // writer thread state
+  RecordQueue<Record> queue;
+  std::thread worker;
+  std::atomic<bool> running{false};
+
+  // output file and current table (only touched by the writer thread)
+  FILE *file = nullptr;
+  FILE *meta_file = nullptr;
+  bool in_table = false;
+  uint64_t rows = 0;
+  uint64_t columns = 0;
+  // offset of the row count of the current table in the file
+  long rows_pos = 0;
+
+  void enqueue(Record &&record);
+
+  void run();
+
+  bool openFile();
+
+  void closeFile();
+
+  void beginTable(const ResultHeader &header);
+
+  void writeRow(uint64_t key, const std::vector<uint64_t> &values);
+
+  void endTable();
+
+  void patchRows();
+
+ public:
+  // an empty path or "-" writes to stderr (text format only)
+  ResultWriter(ResultFormat format = ResultFormat::FMT_TEXT,
+               std::string path = "", uint64_t queue_size = 4096);
+
+  ~ResultWriter();
+
+  static bool parseFormat(const std::string &name, ResultFormat &format);
+
+  // start a new result table behind the previous ones
+  void begin(const ResultHeader &header);
+
+  // append one record to the current table
+  void write(uint64_t key, const std::vector<uint64_t> &values);
+
+  // finish the current table
+  void end();
+
+  // drain the queue and stop the writer thread
+  void close();
+};
+#endif
@@ -0,0 +1,132 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/utils/Scheduler.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+// frames are pooled in 64-byte size classes up to 4 KB, larger frames (which
+// no process of the experiments has) are allocated directly
+static const std::size_t FRAME_CLASS = 64;
+static const std::size_t FRAME_CLASSES = 64;
+
+// free frames of every size class, kept for the lifetime of the thread
+static thread_local std::vector<void *> free_frames[FRAME_CLASSES];
+
+const char *switchName(SwitchModel model) {
+  return model == SwitchModel::SWITCH_RANDOM ? "random" : "round-robin";
+}
+
+bool parseSwitchModel(const std::string &name, SwitchModel &model) {
+  if (name == "round-robin") {
+    model = SwitchModel::SWITCH_ROUND_ROBIN;
+  } else if (name == "random") {
+    model = SwitchModel::SWITCH_RANDOM;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void addScheduleParams(std::string &params, const AttackSchedule &schedule) {
+  if (!schedule.enabled) {
+    return;
+  }
+  params += params.empty() ? "" : ",";
+  params += "quantum=" + std::to_string(schedule.config.quantum) +
+            ",switch=" + switchName(schedule.config.model) +
+            ",noise=" + std::to_string(schedule.noise) +
+            ",noise_branches=" + std::to_string(schedule.noise_branches);
+  if (schedule.config.flush) {
+    params += ",flush=1";
+  }
+}
+
+void *allocateFrame(std::size_t size) {
+  std::size_t index = (size - 1) / FRAME_CLASS;
+  if (index >= FRAME_CLASSES) {
+    return ::operator new(size);
+  }
+  std::vector<void *> &frames = free_frames[index];
+  if (frames.empty()) {
+    return ::operator new((index + 1) * FRAME_CLASS);
+  }
+  void *frame = frames.back();
+  frames.pop_back();
+  return frame;
+}
+
+void releaseFrame(void *frame, std::size_t size) {
+  std::size_t index = (size - 1) / FRAME_CLASS;
+  if (index >= FRAME_CLASSES) {
+    ::operator delete(frame);
+    return;
+  }
+  free_frames[index].push_back(frame);
+}
+
+void Scheduler::spawn(Process process, uint64_t domain, bool background) {
+  processes.push_back(std::move(process));
+  domains.push_back(domain);
+  this->background.push_back(background);
+}
+
+uint64_t Scheduler::next(bool first) {
+  uint64_t count = processes.size();
+  uint64_t process = first ? 0 : (current + 1) % count;
+  if (config.model == SwitchModel::SWITCH_RANDOM) {
+    process = rand() % count;
+  }
+  // skip the processes that returned, one is left (see run)
+  while (processes[process].done()) {
+    process = (process + 1) % count;
+  }
+  return process;
+}
+
+void Scheduler::run(uint64_t slices) {
+  uint64_t live = 0;
+  for (uint64_t i = 0; i < processes.size(); i++) {
+    live += !background[i] && !processes[i].done();
+  }
+  for (uint64_t i = 0; i < slices && live > 0; i++) {
+    uint64_t process = next(i == 0);
+    if (i > 0 && domains[process] != domains[current]) {
+      switches++;
+      if (config.flush) {
+        bpus->flush(type);
+      }
+    }
+    current = process;
+    slice = config.quantum;
+    if (config.model == SwitchModel::SWITCH_RANDOM) {
+      slice = 1 + rand() % (2 * config.quantum - 1);
+    }
+    processes[current].resume();
+    live -= !background[current] && processes[current].done();
+  }
+}
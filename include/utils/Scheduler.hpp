@@ -0,0 +1,219 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Interleaved execution of simulated processes on one predictor. Every
+// process (the attacker, the victim or a background tenant) is a coroutine
+// that looks up the predictor in its own security domain and ends every
+// branch with
+//   co_await scheduler.tick();
+// which suspends it when its time slice is used up. The scheduler then
+// switches to the next process (see SwitchModel), flushes the predictor if
+// the switch changes the domain and flushing is enabled, and resumes that
+// process where it left off.
+//
+// A tick within the slice does not suspend, so a process runs its slice as
+// a straight-line loop. A process that waits for the others (e.g. the
+// attacker of a prune attack for the victim) ends its slice early with
+//   co_await scheduler.yield();
+// Background processes (the victim and the noise of an attack) run for as
+// long as a foreground process has not returned.
+//
+// Coroutine frames come from free lists per size class that keep the frames
+// of destroyed processes, so the processes of a trial allocate nothing once
+// the first trial has run.
+// =============================================================================
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "include/predictors/BPUSet.hpp"
+
+// next process and length of its time slice
+enum SwitchModel {
+  // every process in turn for quantum branches
+  SWITCH_ROUND_ROBIN = 0,
+  // a random process for 1 to 2 * quantum - 1 branches (quantum on average)
+  SWITCH_RANDOM = 1
+};
+
+struct ScheduleConfig {
+  SwitchModel model = SwitchModel::SWITCH_ROUND_ROBIN;
+  // branches of a time slice
+  uint64_t quantum = 16;
+  // clear the PHT and BTB on every switch to another domain
+  bool flush = false;
+};
+
+// name of a switch model ("round-robin" or "random")
+const char *switchName(SwitchModel model);
+
+// parse the name of a switch model, return false if it is unknown
+bool parseSwitchModel(const std::string &name, SwitchModel &model);
+
+// schedule of the prune and occupancy attacks of a predictor set (see
+// attacks/BPUSet.cpp): the attacker, the victim and noise tenants as
+// processes
+struct AttackSchedule {
+  // run the attacks as processes, else as the scripts of attacks/*.cpp
+  bool enabled = false;
+  ScheduleConfig config;
+  // noise tenants, each in a domain of its own, and the branches of the
+  // working set of every one
+  uint64_t noise = 0;
+  uint64_t noise_branches = 64;
+};
+
+// add a schedule to the params of a result table, if it is enabled
+void addScheduleParams(std::string &params, const AttackSchedule &schedule);
+
+// coroutine frames from the free list of their size class
+void *allocateFrame(std::size_t size);
+
+void releaseFrame(void *frame, std::size_t size);
+
+// a simulated process, owns its coroutine
+class Process {
+ public:
+  struct promise_type {
+    Process get_return_object() {
+      return Process(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    // a process starts when it is first scheduled
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    std::suspend_always final_suspend() noexcept { return {}; }
+
+    void return_void() {}
+
+    void unhandled_exception() { std::terminate(); }
+
+    static void *operator new(std::size_t size) { return allocateFrame(size); }
+
+    static void operator delete(void *frame, std::size_t size) {
+      releaseFrame(frame, size);
+    }
+  };
+
+  explicit Process(std::coroutine_handle<promise_type> handle)
+      : handle(handle) {}
+
+  Process(Process &&other) noexcept : handle(other.handle) {
+    other.handle = nullptr;
+  }
+
+  Process &operator=(Process &&other) noexcept {
+    std::swap(handle, other.handle);
+    return *this;
+  }
+
+  Process(const Process &) = delete;
+
+  Process &operator=(const Process &) = delete;
+
+  ~Process() {
+    if (handle) {
+      handle.destroy();
+    }
+  }
+
+  bool done() const { return handle.done(); }
+
+  void resume() { handle.resume(); }
+
+ private:
+  std::coroutine_handle<promise_type> handle;
+};
+
+class Scheduler {
+ private:
+  BPUSet *bpus;
+  uint64_t type;
+  ScheduleConfig config;
+
+  // processes, their domains and whether they run in the background, in the
+  // order they were spawned
+  std::vector<Process> processes;
+  std::vector<uint64_t> domains;
+  std::vector<bool> background;
+
+  // running process and the branches left in its slice
+  uint64_t current = 0;
+  uint64_t slice = 0;
+
+  // switches to another domain
+  uint64_t switches = 0;
+
+  // next process to run after the current one (which may have returned)
+  uint64_t next(bool first);
+
+ public:
+  // suspends the running process at the end of its slice
+  struct Tick {
+    bool ready;
+
+    bool await_ready() const noexcept { return ready; }
+
+    void await_suspend(std::coroutine_handle<>) const noexcept {}
+
+    void await_resume() const noexcept {}
+  };
+
+  // schedule processes on a predictor (BPUType) of a set
+  Scheduler(BPUSet *bpus, uint64_t type, const ScheduleConfig &config)
+      : bpus(bpus), type(type), config(config) {}
+
+  // add a process of a security domain
+  void spawn(Process process, uint64_t domain, bool background = false);
+
+  // run up to slices time slices, until every foreground process returned
+  void run(uint64_t slices);
+
+  // domain of the running process
+  uint64_t domain() const { return domains[current]; }
+
+  uint64_t getSwitches() const { return switches; }
+
+  // look up the predictor in the domain of the running process
+  bool lookupPHT(uint64_t pc, bool taken) {
+    return bpus->lookupPHT(type, pc, taken, domains[current]);
+  }
+
+  int lookupBTB(uint64_t pc, uint64_t target) {
+    return bpus->lookupBTB(type, pc, target, domains[current]);
+  }
+
+  // end a branch of the running process
+  Tick tick() { return Tick{--slice > 0}; }
+
+  // end the slice of the running process
+  Tick yield() {
+    slice = 0;
+    return Tick{false};
+  }
+};
+#endif
@@ -0,0 +1,653 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/utils/Spec.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "include/predictors/BPUSet.hpp"
+#include "include/utils/Utils.hpp"
+
+// budget grid start, start + step, ..., up to stop
+static std::vector<uint64_t> grid(uint64_t start, uint64_t stop,
+                                  uint64_t step) {
+  std::vector<uint64_t> values;
+  for (uint64_t value = start; value <= stop; value += step) {
+    values.push_back(value);
+  }
+  return values;
+}
+
+static std::string trim(const std::string &text) {
+  uint64_t begin = text.find_first_not_of(" \t\r");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  uint64_t end = text.find_last_not_of(" \t\r");
+  return text.substr(begin, end - begin + 1);
+}
+
+static std::vector<std::string> split(const std::string &text) {
+  std::vector<std::string> items;
+  std::istringstream fields(text);
+  std::string item;
+  while (std::getline(fields, item, ',')) {
+    if (!trim(item).empty()) {
+      items.push_back(trim(item));
+    }
+  }
+  return items;
+}
+
+static std::vector<uint64_t> splitValues(const std::string &text) {
+  std::vector<uint64_t> values;
+  for (const std::string &item : split(text)) {
+    values.push_back(std::stoull(item));
+  }
+  if (values.empty()) {
+    throw std::invalid_argument(text);
+  }
+  return values;
+}
+
+static ReplacementPolicy parsePolicy(const std::string &name) {
+  if (name == "lru") {
+    return ReplacementPolicy::REPL_LRU;
+  } else if (name == "random") {
+    return ReplacementPolicy::REPL_RANDOM;
+  }
+  throw std::invalid_argument(name);
+}
+
+const char *policyName(ReplacementPolicy policy) {
+  return policy == ReplacementPolicy::REPL_RANDOM ? "random" : "lru";
+}
+
+bool rareMode(const std::string &mode) {
+  return mode == "occupancy-pht-rare" || mode == "occupancy-btb-rare";
+}
+
+bool mutualInfoMode(const std::string &mode) {
+  return mode == "leakage-pht-mi" || mode == "leakage-btb-mi";
+}
+
+bool defaultSpec(const std::string &mode, uint64_t max_branches,
+                 uint64_t max_repeats, ExperimentSpec &spec) {
+  spec.mode = mode;
+  spec.predictors = BPUSet::allTypes();
+  spec.repeats = max_repeats;
+  if (mode == "reuse-access") {
+    spec.budgets.clear();
+  } else if (mode == "reuse-collision") {
+    spec.budgets = {10000,   50000,    100000,   200000,
+                    500000,  1000000,  10000000, 100000000};
+  } else if (mode == "prune-btb-prune") {
+    spec.budgets = grid(100, max_branches, 100);
+  } else if (mode == "prune-btb-collision") {
+    spec.prune_size = 3800;
+    spec.budgets = grid(1000, 300000, 1000);
+  } else if (mode == "occupancy-pht-prune") {
+    spec.occupancy_size = 1024;
+    spec.budgets = grid(1, max_branches, 1);
+  } else if (mode == "occupancy-pht-collision") {
+    spec.prune_size = 20;
+    spec.occupancy_size = 1024;
+    spec.budgets = grid(1000, 500000, 1000);
+  } else if (mode == "occupancy-btb-prune") {
+    spec.occupancy_size = 4096;
+    spec.budgets = grid(100, max_branches, 100);
+  } else if (mode == "occupancy-btb-collision") {
+    spec.prune_size = 600;
+    spec.occupancy_size = 4096;
+    spec.budgets = grid(1000, 200000, 1000);
+  } else if (mode == "occupancy-pht-rare") {
+    spec.prune_size = 20;
+    spec.occupancy_size = 1024;
+    spec.budgets = grid(100, 10000, 100);
+  } else if (mode == "occupancy-btb-rare") {
+    spec.prune_size = 600;
+    spec.occupancy_size = 4096;
+    spec.budgets = grid(100, 10000, 100);
+  } else if (mode == "leakage-pht" || mode == "leakage-pht-mi") {
+    spec.prune_size = 20;
+    spec.occupancy_size = 1024;
+    spec.secrets = max_branches;
+    spec.budgets = grid(1000, 500000, 1000);
+  } else if (mode == "leakage-btb" || mode == "leakage-btb-mi") {
+    spec.prune_size = 600;
+    spec.occupancy_size = 4096;
+    spec.secrets = max_branches;
+    spec.budgets = grid(1000, 200000, 1000);
+  } else if (mode == "tenants-interference") {
+    spec.budgets.clear();
+    for (uint64_t tenants = NUM_ATTACK_DOMAINS;
+         tenants <= std::min<uint64_t>(max_branches, MAX_DOMAINS);
+         tenants *= 2) {
+      spec.budgets.push_back(tenants);
+    }
+  } else if (mode == "trace-replay" || mode == "stream-replay") {
+    spec.budgets.clear();
+    if (max_branches > 0) {
+      spec.window = max_branches;
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// the values of a swept parameter, or the value of the spec
+static std::vector<uint64_t> orSpec(const std::vector<uint64_t> &values,
+                                    uint64_t value) {
+  return values.empty() ? std::vector<uint64_t>{value} : values;
+}
+
+// check the design space of an exploration, print the first error
+static bool checkExplore(const std::string &path,
+                         const ExperimentSpec &spec) {
+  const ExploreSpace &space = spec.explore;
+  for (const std::string &mode : space.modes) {
+    ExperimentSpec defaults;
+    if (!defaultSpec(mode, 0, 1, defaults)) {
+      std::cerr << "Spec: " << path << ": unknown mode \"" << mode << "\""
+                << std::endl;
+      return false;
+    }
+  }
+  for (const std::vector<uint64_t> *values :
+       {&space.counter_bits, &space.counter_nums, &space.buffer_ways,
+        &space.buffer_sets}) {
+    if (std::count(values->begin(), values->end(), 0) > 0) {
+      std::cerr << "Spec: " << path << ": empty table in the design space"
+                << std::endl;
+      return false;
+    }
+  }
+  for (uint64_t counter_bits :
+       orSpec(space.counter_bits, spec.counter_bits)) {
+    for (uint64_t counter_nums :
+         orSpec(space.counter_nums, spec.counter_nums)) {
+      if (!checkPHTConfig(spec.pht, counter_bits, counter_nums)) {
+        std::cerr << "Spec: " << path << ": invalid PHT model "
+                  << phtName(spec.pht) << " with " << counter_nums << " "
+                  << counter_bits << "-bit counters" << std::endl;
+        return false;
+      }
+    }
+  }
+  for (const std::vector<uint64_t> *values :
+       {&space.offset_pht, &space.offset_btb}) {
+    for (uint64_t offset : *values) {
+      if (offset >= spec.addr_space) {
+        std::cerr << "Spec: " << path << ": index offset " << offset
+                  << " outside the " << spec.addr_space
+                  << "-bit address space" << std::endl;
+        return false;
+      }
+    }
+  }
+  for (uint64_t pass = 0; pass < space.passes.size(); pass++) {
+    uint64_t repeats = space.passes[pass];
+    if (repeats == 0 || repeats >= spec.repeats ||
+        (pass > 0 && repeats <= space.passes[pass - 1])) {
+      std::cerr << "Spec: " << path << ": screening passes must increase "
+                << "from 1 to below " << spec.repeats << " repeats"
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool loadSpec(const std::string &path, ExperimentSpec &spec) {
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    std::cerr << "Spec: cannot open " << path << std::endl;
+    return false;
+  }
+  return parseSpec(in, path, spec);
+}
+
+bool parseSpec(std::istream &in, const std::string &path,
+               ExperimentSpec &spec) {
+  // "section.name" -> value
+  std::map<std::string, std::string> entries;
+  std::string section, line;
+  uint64_t line_number = 0;
+  while (std::getline(in, line)) {
+    line_number++;
+    line = trim(line.substr(0, line.find_first_of(";#")));
+    if (line.empty()) {
+      continue;
+    }
+    if (line.front() == '[' && line.back() == ']') {
+      section = trim(line.substr(1, line.size() - 2));
+      continue;
+    }
+    uint64_t pos = line.find('=');
+    if (pos == std::string::npos) {
+      std::cerr << "Spec: " << path << ":" << line_number
+                << ": expected name = value" << std::endl;
+      return false;
+    }
+    entries[section + "." + trim(line.substr(0, pos))] =
+        trim(line.substr(pos + 1));
+  }
+  std::string current;
+  try {
+    // start from the defaults of the mode
+    current = "experiment.mode";
+    uint64_t repeats = entries.count("experiment.repeats")
+                           ? std::stoull(entries["experiment.repeats"])
+                           : 1;
+    if (!defaultSpec(entries[current], 0, repeats, spec)) {
+      std::cerr << "Spec: " << path << ": unknown mode \"" << entries[current]
+                << "\"" << std::endl;
+      return false;
+    }
+    entries.erase("experiment.mode");
+    entries.erase("experiment.repeats");
+    // any entry of [schedule] runs the attacks as scheduled processes
+    spec.attack_schedule.enabled = false;
+    for (auto &entry : entries) {
+      if (entry.first.rfind("schedule.", 0) == 0) {
+        spec.attack_schedule.enabled = true;
+      }
+    }
+    for (auto &entry : entries) {
+      current = entry.first;
+      const std::string &value = entry.second;
+      if (current == "experiment.predictors") {
+        spec.predictors.clear();
+        for (const std::string &name : split(value)) {
+          uint64_t type;
+          if (name == "all") {
+            spec.predictors = BPUSet::allTypes();
+          } else if (BPUSet::parseType(name, type)) {
+            spec.predictors.push_back(type);
+          } else {
+            throw std::invalid_argument(name);
+          }
+        }
+      } else if (current == "experiment.seed") {
+        spec.seed = std::stoull(value);
+        spec.seeded = true;
+      } else if (current == "experiment.common_random") {
+        if (value == "true" || value == "1") {
+          spec.common_random = true;
+        } else if (value == "false" || value == "0") {
+          spec.common_random = false;
+        } else {
+          throw std::invalid_argument(value);
+        }
+      } else if (current == "experiment.baseline") {
+        if (value == "true" || value == "1") {
+          spec.baseline = true;
+        } else if (value == "false" || value == "0") {
+          spec.baseline = false;
+        } else {
+          throw std::invalid_argument(value);
+        }
+      } else if (current == "geometry.counter_bits") {
+        spec.counter_bits = std::stoull(value);
+      } else if (current == "geometry.counter_nums") {
+        spec.counter_nums = std::stoull(value);
+      } else if (current == "geometry.buffer_ways") {
+        spec.buffer_ways = std::stoull(value);
+      } else if (current == "geometry.buffer_sets") {
+        spec.buffer_sets = std::stoull(value);
+      } else if (current == "geometry.addr_space") {
+        spec.addr_space = std::stoull(value);
+      } else if (current == "geometry.offset_pht") {
+        spec.offset_pht = std::stoull(value);
+      } else if (current == "geometry.offset_btb") {
+        spec.offset_btb = std::stoull(value);
+      } else if (current == "geometry.policy") {
+        spec.policy = parsePolicy(value);
+      } else if (current == "geometry.pht") {
+        if (!parsePHTModel(value, spec.pht.model)) {
+          throw std::invalid_argument(value);
+        }
+      } else if (current == "geometry.history") {
+        spec.pht.history = std::stoull(value);
+      } else if (current == "geometry.tage_tables") {
+        spec.pht.tage_tables = std::stoull(value);
+      } else if (current == "geometry.tage_history") {
+        std::vector<std::string> lengths = split(value);
+        if (lengths.size() != 2) {
+          throw std::invalid_argument(value);
+        }
+        spec.pht.tage_min_history = std::stoull(lengths[0]);
+        spec.pht.tage_max_history = std::stoull(lengths[1]);
+      } else if (current == "geometry.tage_tag_bits") {
+        spec.pht.tage_tag_bits = std::stoull(value);
+      } else if (current == "budget.values") {
+        spec.budgets.clear();
+        for (const std::string &budget : split(value)) {
+          spec.budgets.push_back(std::stoull(budget));
+        }
+      } else if (current == "budget.start" || current == "budget.stop" ||
+                 current == "budget.step") {
+        // handled below as a whole
+      } else if (current == "attack.prune_size") {
+        spec.prune_size = std::stoull(value);
+      } else if (current == "attack.occupancy_size") {
+        spec.occupancy_size = std::stoull(value);
+      } else if (current == "attack.secrets") {
+        spec.secrets = std::stoull(value);
+      } else if (current == "trace.path") {
+        spec.trace = value;
+      } else if (current == "trace.window") {
+        spec.window = std::stoull(value);
+      } else if (current == "trace.interference") {
+        if (value == "true" || value == "1") {
+          spec.interference = true;
+        } else if (value == "false" || value == "0") {
+          spec.interference = false;
+        } else {
+          throw std::invalid_argument(value);
+        }
+      } else if (current == "tenants.branches") {
+        spec.tenant_branches = std::stoull(value);
+      } else if (current == "tenants.quantum") {
+        spec.tenant_schedule.quantum = std::stoull(value);
+      } else if (current == "tenants.rounds") {
+        spec.tenant_rounds = std::stoull(value);
+      } else if (current == "tenants.switch") {
+        if (!parseSwitchModel(value, spec.tenant_schedule.model)) {
+          throw std::invalid_argument(value);
+        }
+      } else if (current == "tenants.flush") {
+        if (value == "true" || value == "1") {
+          spec.tenant_schedule.flush = true;
+        } else if (value == "false" || value == "0") {
+          spec.tenant_schedule.flush = false;
+        } else {
+          throw std::invalid_argument(value);
+        }
+      } else if (current == "schedule.quantum") {
+        spec.attack_schedule.config.quantum = std::stoull(value);
+      } else if (current == "schedule.switch") {
+        if (!parseSwitchModel(value, spec.attack_schedule.config.model)) {
+          throw std::invalid_argument(value);
+        }
+      } else if (current == "schedule.flush") {
+        if (value == "true" || value == "1") {
+          spec.attack_schedule.config.flush = true;
+        } else if (value == "false" || value == "0") {
+          spec.attack_schedule.config.flush = false;
+        } else {
+          throw std::invalid_argument(value);
+        }
+      } else if (current == "schedule.noise") {
+        spec.attack_schedule.noise = std::stoull(value);
+      } else if (current == "schedule.branches") {
+        spec.attack_schedule.noise_branches = std::stoull(value);
+      } else if (current == "rare.bias") {
+        spec.rare_bias = std::stoull(value);
+      } else if (current == "leakage.tolerance") {
+        spec.leakage_tolerance = std::stoull(value);
+      } else if (current == "rekey.accesses") {
+        spec.rekey.accesses = std::stoull(value);
+      } else if (current == "rekey.mispredicts") {
+        spec.rekey.mispredicts = std::stoull(value);
+      } else if (current == "rekey.domain_switch") {
+        if (value == "true" || value == "1") {
+          spec.rekey.domain_switch = true;
+        } else if (value == "false" || value == "0") {
+          spec.rekey.domain_switch = false;
+        } else {
+          throw std::invalid_argument(value);
+        }
+      } else if (current == "cipher.name") {
+        if (!parseCipherType(value, spec.cipher.type)) {
+          throw std::invalid_argument(value);
+        }
+      } else if (current == "cipher.rounds") {
+        spec.cipher.rounds = std::stoull(value);
+      } else if (current == "btb.levels") {
+        spec.btb.levels.clear();
+        for (const std::string &level : split(value)) {
+          uint64_t pos = level.find('x');
+          if (pos == std::string::npos) {
+            throw std::invalid_argument(level);
+          }
+          BTBLevelConfig config;
+          config.sets = std::stoull(level.substr(0, pos));
+          config.ways = std::stoull(level.substr(pos + 1));
+          spec.btb.levels.push_back(config);
+        }
+      } else if (current == "btb.policy" || current == "btb.keyed") {
+        // handled below, once the levels are known
+      } else if (current == "btb.inclusion") {
+        if (!parseBTBInclusion(value, spec.btb.inclusion)) {
+          throw std::invalid_argument(value);
+        }
+      } else if (current == "explore.modes") {
+        spec.explore.modes = split(value);
+      } else if (current == "explore.counter_bits") {
+        spec.explore.counter_bits = splitValues(value);
+      } else if (current == "explore.counter_nums") {
+        spec.explore.counter_nums = splitValues(value);
+      } else if (current == "explore.buffer_ways") {
+        spec.explore.buffer_ways = splitValues(value);
+      } else if (current == "explore.buffer_sets") {
+        spec.explore.buffer_sets = splitValues(value);
+      } else if (current == "explore.offset_pht") {
+        spec.explore.offset_pht = splitValues(value);
+      } else if (current == "explore.offset_btb") {
+        spec.explore.offset_btb = splitValues(value);
+      } else if (current == "explore.policy") {
+        spec.explore.policies.clear();
+        for (const std::string &name : split(value)) {
+          spec.explore.policies.push_back(parsePolicy(name));
+        }
+      } else if (current == "explore.passes") {
+        spec.explore.passes = splitValues(value);
+      } else if (current == "explore.margin") {
+        spec.explore.margin = std::stoull(value);
+      } else {
+        std::cerr << "Spec: " << path << ": unknown entry " << current
+                  << std::endl;
+        return false;
+      }
+    }
+    if (entries.count("budget.stop")) {
+      current = "budget.start";
+      uint64_t start = std::stoull(entries.count("budget.start")
+                                       ? entries["budget.start"]
+                                       : entries["budget.step"]);
+      current = "budget.step";
+      uint64_t step = std::stoull(entries.count("budget.step")
+                                      ? entries["budget.step"]
+                                      : entries["budget.start"]);
+      current = "budget.stop";
+      if (step == 0) {
+        throw std::invalid_argument("step");
+      }
+      spec.budgets = grid(start, std::stoull(entries["budget.stop"]), step);
+    }
+    // a single value for all levels or one per level
+    std::vector<BTBLevelConfig> &levels = spec.btb.levels;
+    if (entries.count("btb.policy")) {
+      current = "btb.policy";
+      std::vector<std::string> policies = split(entries[current]);
+      if (policies.size() != 1 && policies.size() != levels.size()) {
+        throw std::invalid_argument(entries[current]);
+      }
+      for (uint64_t i = 0; i < levels.size(); i++) {
+        levels[i].policy = parsePolicy(policies[policies.size() > 1 ? i : 0]);
+      }
+    }
+    if (entries.count("btb.keyed")) {
+      current = "btb.keyed";
+      std::vector<std::string> keyed = split(entries[current]);
+      if (keyed.size() != 1 && keyed.size() != levels.size()) {
+        throw std::invalid_argument(entries[current]);
+      }
+      for (uint64_t i = 0; i < levels.size(); i++) {
+        const std::string &value = keyed[keyed.size() > 1 ? i : 0];
+        if (value == "true" || value == "1") {
+          levels[i].keyed = true;
+        } else if (value == "false" || value == "0") {
+          levels[i].keyed = false;
+        } else {
+          throw std::invalid_argument(value);
+        }
+      }
+    }
+  } catch (...) {
+    std::cerr << "Spec: " << path << ": invalid value of " << current
+              << std::endl;
+    return false;
+  }
+  if (spec.predictors.empty()) {
+    std::cerr << "Spec: " << path << ": no predictors selected" << std::endl;
+    return false;
+  }
+  if (spec.addr_space == 0 || spec.addr_space > 64) {
+    std::cerr << "Spec: " << path << ": " << spec.addr_space
+              << "-bit address space, expected 1 to 64 bits" << std::endl;
+    return false;
+  }
+  if (spec.offset_pht >= spec.addr_space ||
+      spec.offset_btb >= spec.addr_space) {
+    std::cerr << "Spec: " << path << ": index offsets " << spec.offset_pht
+              << " and " << spec.offset_btb << " outside the "
+              << spec.addr_space << "-bit address space" << std::endl;
+    return false;
+  }
+  const PHTConfig &pht = spec.pht;
+  if (!checkPHTConfig(pht, spec.counter_bits, spec.counter_nums)) {
+    std::cerr << "Spec: " << path << ": invalid PHT model " << phtName(pht)
+              << " with " << spec.counter_nums << " " << spec.counter_bits
+              << "-bit counters" << std::endl;
+    return false;
+  }
+  const CipherConfig &cipher = spec.cipher;
+  if (cipher.rounds > cipherRounds(cipher.type) ||
+      (cipher.type == CipherType::CIPHER_NATIVE && cipher.rounds > 0)) {
+    std::cerr << "Spec: " << path << ": " << cipher.rounds
+              << " rounds of the index cipher, expected up to "
+              << cipherRounds(cipher.type) << std::endl;
+    return false;
+  }
+  if (!checkBTBConfig(spec.btb)) {
+    std::cerr << "Spec: " << path << ": invalid BTB hierarchy "
+              << btbName(spec.btb) << ", expected up to "
+              << BTB_MAX_LEVELS - 1 << " levels in front of the BTB"
+              << std::endl;
+    return false;
+  }
+  // common random numbers reseed every trial, baseline trials never do
+  if (spec.baseline && spec.common_random) {
+    std::cerr << "Spec: " << path
+              << ": baseline and common_random exclude each other"
+              << std::endl;
+    return false;
+  }
+  if (spec.secrets == 0) {
+    std::cerr << "Spec: " << path << ": no secrets" << std::endl;
+    return false;
+  }
+  bool replay = spec.mode == "trace-replay" || spec.mode == "stream-replay";
+  if (replay && (spec.trace.empty() || spec.window == 0)) {
+    std::cerr << "Spec: " << path << ": no trace or empty window" << std::endl;
+    return false;
+  }
+  if (spec.budgets.empty() && spec.mode != "reuse-access" && !replay) {
+    std::cerr << "Spec: " << path << ": empty budget grid" << std::endl;
+    return false;
+  }
+  if (!checkExplore(path, spec)) {
+    return false;
+  }
+  if (rareMode(spec.mode)) {
+    if (spec.rare_bias == 0 || spec.rare_bias > RARE_MAX_BIAS ||
+        spec.repeats > RARE_MAX_REPEATS) {
+      std::cerr << "Spec: " << path << ": bias " << spec.rare_bias
+                << "% and " << spec.repeats << " repeats, expected 1 to "
+                << RARE_MAX_BIAS << "% and up to " << RARE_MAX_REPEATS
+                << " repeats" << std::endl;
+      return false;
+    }
+    // every set must be reachable by the victim draws
+    if (spec.addr_space < spec.offset_pht + std::log2(spec.counter_nums) ||
+        spec.addr_space < spec.offset_btb + std::log2(spec.buffer_sets)) {
+      std::cerr << "Spec: " << path << ": the " << spec.addr_space
+                << "-bit address space does not index every set"
+                << std::endl;
+      return false;
+    }
+  }
+  if (mutualInfoMode(spec.mode) && spec.secrets > LEAKAGE_MAX_SECRETS) {
+    std::cerr << "Spec: " << path << ": " << spec.secrets
+              << " secrets, expected up to " << LEAKAGE_MAX_SECRETS
+              << std::endl;
+    return false;
+  }
+  if (spec.mode == "tenants-interference") {
+    for (uint64_t tenants : spec.budgets) {
+      if (tenants < NUM_ATTACK_DOMAINS || tenants > MAX_DOMAINS) {
+        std::cerr << "Spec: " << path << ": " << tenants
+                  << " tenants, expected " << NUM_ATTACK_DOMAINS << " to "
+                  << MAX_DOMAINS << std::endl;
+        return false;
+      }
+    }
+    if (spec.tenant_branches == 0 || spec.tenant_schedule.quantum == 0 ||
+        spec.tenant_rounds == 0) {
+      std::cerr << "Spec: " << path << ": empty tenant working set or turn"
+                << std::endl;
+      return false;
+    }
+  }
+  if (spec.attack_schedule.enabled) {
+    const AttackSchedule &schedule = spec.attack_schedule;
+    if (spec.mode.rfind("prune-", 0) != 0 &&
+        spec.mode.rfind("occupancy-", 0) != 0 &&
+        spec.mode.rfind("leakage-", 0) != 0) {
+      std::cerr << "Spec: " << path << ": mode " << spec.mode
+                << " runs no scheduled attack" << std::endl;
+      return false;
+    }
+    if (schedule.config.quantum == 0 ||
+        (schedule.noise > 0 && schedule.noise_branches == 0) ||
+        schedule.noise > MAX_DOMAINS - NUM_ATTACK_DOMAINS) {
+      std::cerr << "Spec: " << path << ": quantum " << schedule.config.quantum
+                << " and " << schedule.noise << " noise tenants of "
+                << schedule.noise_branches << " branches, expected up to "
+                << MAX_DOMAINS - NUM_ATTACK_DOMAINS << " tenants"
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
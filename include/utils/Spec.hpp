@@ -0,0 +1,233 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Declarative experiment specification. A spec names the experiment (attack
+// mode), the predictor subset, the geometry and replacement policy, the budget
+// grid (branch accesses, pruning sizes or tenant counts), the repeats and the
+// attack
+// arguments. Specs are either built from the command line of a mode
+// (defaultSpec) or loaded from an INI file:
+//
+//   [experiment]
+//   mode = leakage-btb
+//   predictors = STBPU, HyBP      ; or "all"
+//   repeats = 1000
+//   seed = 42                     ; optional
+//   common_random = true          ; same draws for every predictor of a
+//                                 ; trial (see Sweep.hpp)
+//   baseline = true               ; trials of the original experiments
+//
+//   [geometry]
+//   counter_bits = 2
+//   counter_nums = 1024
+//   buffer_ways = 4
+//   buffer_sets = 1024
+//   addr_space = 32               ; 1 to 64 bits, e.g. 48
+//   offset_pht = 5                ; address bits below the PHT index
+//   offset_btb = 5                ; and below the BTB index
+//   policy = lru                  ; or "random"
+//   pht = tage                    ; bimodal, gshare, tournament or tage
+//   history = 16                  ; global history of gshare, tournament
+//   tage_tables = 4
+//   tage_history = 4, 64          ; shortest and longest TAGE history
+//   tage_tag_bits = 9
+//
+//   [rekey]                       ; Noisy-XOR-BP, STBPU and HyBP
+//   accesses = 10000              ; redraw the keys every N lookups
+//   mispredicts = 1000            ; and every N mispredicts/evictions
+//   domain_switch = true          ; and on every switch of the domain
+//
+//   [cipher]                      ; index cipher of BSUP, Noisy-XOR-BP,
+//   name = prince                 ; LS-BP, STBPU and HyBP: native, qarma64
+//   rounds = 3                    ; or prince, 0 for its full rounds
+//
+//   [btb]                         ; levels L0, L1, ... in front of the BTB
+//   levels = 16x4, 256x4          ; of the geometry: sets x ways
+//   policy = lru, random          ; one for all levels or one per level
+//   keyed = true, false           ; index by a keyed hash of the line
+//   inclusion = nine              ; inclusive or exclusive
+//
+//   [budget]
+//   values = 1000, 2000, 5000     ; or start, stop and step
+//
+//   [attack]
+//   prune_size = 600
+//   occupancy_size = 4096
+//   secrets = 8
+//
+//   [trace]                       ; mode = trace-replay or stream-replay
+//   path = workload.bgt
+//   window = 1000000              ; branches per result row
+//   interference = true           ; also replay every domain in isolation
+//
+//   [tenants]                     ; mode = tenants-interference, the budget
+//   branches = 64                 ; values are the tenant counts
+//   quantum = 16                  ; branches between domain switches
+//   rounds = 100                  ; turns of every tenant
+//   switch = round-robin          ; or "random" slices of quantum branches
+//   flush = false                 ; flush the predictor on every switch
+//
+//   [schedule]                    ; prune-, occupancy- and leakage- modes:
+//   quantum = 16                  ; the attacker, the victim and the noise
+//   switch = round-robin          ; tenants as scheduled processes (see
+//   flush = false                 ; attacks/BPUSet.cpp), the same keys as
+//   noise = 2                     ; [tenants], and the noise tenants and
+//   branches = 64                 ; their working sets
+//
+//   [rare]                        ; mode = occupancy-pht-rare or
+//   bias = 50                     ; occupancy-btb-rare: percent of the
+//                                 ; victims drawn in the attacker's sets
+//
+//   [leakage]                     ; mode = leakage-pht-mi or leakage-btb-mi
+//   tolerance = 10                ; end a row once the leakage is known to
+//                                 ; -/+ N thousandths of a bit, 0: all
+//                                 ; repeats
+//
+//   [explore]                     ; branch-gauge explore: the swept values,
+//   modes = leakage-pht, leakage-btb
+//   counter_bits = 1, 2, 3        ; missing entries keep the mode and the
+//   counter_nums = 256, 1024      ; geometry of the spec
+//   buffer_ways = 2, 4
+//   buffer_sets = 256, 1024
+//   offset_pht = 0, 5
+//   offset_btb = 0, 5
+//   policy = lru, random
+//   passes = 10, 100              ; repeats of the screening passes
+//   margin = 2                    ; standard errors of a pruning decision
+//
+// Missing entries take the defaults of the mode.
+// =============================================================================
+#ifndef SPEC_HPP
+#define SPEC_HPP
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "include/predictors/BTBHierarchy.hpp"
+#include "include/predictors/HistoryPHT.hpp"
+#include "include/predictors/Rekey.hpp"
+#include "include/utils/Cipher.hpp"
+#include "include/utils/Scheduler.hpp"
+#include "include/utils/Utils.hpp"
+
+// the rare modes (occupancy-pht-rare, occupancy-btb-rare) estimate the
+// collision rate by importance sampling (see exps/exp3_occupancy.cpp): their
+// weighted values are fixed-point in units of 1 / RARE_SCALE, and the bias
+// and the repeats are bounded so that the sums of a row fit 64 bits
+#define RARE_SCALE 100000000000000ULL
+#define RARE_MAX_BIAS 50
+#define RARE_MAX_REPEATS 10000
+
+// the mutual-information modes (leakage-pht-mi, leakage-btb-mi) count every
+// (executed subset, observation) pair of up to LEAKAGE_MAX_SECRETS secrets,
+// 2^secrets * (secrets + 1) values per predictor (see exps/exp4_leakage.cpp)
+#define LEAKAGE_MAX_SECRETS 8
+
+// design space of an exploration (see exps/exp7_explore.cpp), an empty list
+// keeps the mode or parameter of the spec
+struct ExploreSpace {
+  std::vector<std::string> modes;
+  std::vector<uint64_t> counter_bits;
+  std::vector<uint64_t> counter_nums;
+  std::vector<uint64_t> buffer_ways;
+  std::vector<uint64_t> buffer_sets;
+  std::vector<uint64_t> offset_pht;
+  std::vector<uint64_t> offset_btb;
+  std::vector<ReplacementPolicy> policies;
+  // repeats of the screening passes before the final pass of all repeats
+  std::vector<uint64_t> passes;
+  // standard errors by which a configuration must be worse to be pruned
+  uint64_t margin = 2;
+};
+
+struct ExperimentSpec {
+  std::string mode;
+  // selected predictors (BPUType)
+  std::vector<uint64_t> predictors;
+  // geometry
+  uint64_t counter_bits = 2;
+  uint64_t counter_nums = 1024;
+  uint64_t buffer_ways = 4;
+  uint64_t buffer_sets = 1024;
+  uint64_t addr_space = 32;
+  uint64_t offset_pht = 5;
+  uint64_t offset_btb = 5;
+  ReplacementPolicy policy = ReplacementPolicy::REPL_LRU;
+  PHTConfig pht;
+  RekeyConfig rekey;
+  CipherConfig cipher;
+  // levels of the BTB, a single level if none
+  BTBConfig btb;
+  // swept parameter: branch accesses or pruning sizes
+  std::vector<uint64_t> budgets;
+  uint64_t repeats = 1;
+  // attack arguments
+  uint64_t prune_size = 0;
+  uint64_t occupancy_size = 0;
+  uint64_t secrets = 16;
+  // trace replay
+  std::string trace;
+  uint64_t window = 1000000;
+  bool interference = false;
+  // multi-tenant interference: working set of every tenant, its schedule
+  // (branches per turn, switch model and flushes) and turns
+  uint64_t tenant_branches = 64;
+  ScheduleConfig tenant_schedule;
+  uint64_t tenant_rounds = 100;
+  // prune and occupancy attacks as scheduled processes, if enabled
+  AttackSchedule attack_schedule;
+  // rare modes: percent of the victims drawn in the attacker's sets
+  uint64_t rare_bias = RARE_MAX_BIAS;
+  // mutual-information modes: half-width of the confidence interval that
+  // ends a row, in thousandths of a bit (0: all repeats)
+  uint64_t leakage_tolerance = 0;
+  // random seed, if given by the spec
+  bool seeded = false;
+  uint64_t seed = 0;
+  // common random numbers across the predictors of a trial
+  bool common_random = false;
+  // trials that keep the predictor tables and one random stream
+  bool baseline = false;
+  ExploreSpace explore;
+};
+
+// name of a replacement policy ("lru" or "random")
+const char *policyName(ReplacementPolicy policy);
+
+// whether a mode estimates by importance sampling
+bool rareMode(const std::string &mode);
+
+// whether a mode estimates the mutual information of secret and observation
+bool mutualInfoMode(const std::string &mode);
+
+// spec of a mode as run by "branch-gauge <mode> <max_branches> <max_repeats>",
+// return false if the mode is unknown
+bool defaultSpec(const std::string &mode, uint64_t max_branches,
+                 uint64_t max_repeats, ExperimentSpec &spec);
+
+// load a spec file, print the first error and return false if it is invalid
+bool loadSpec(const std::string &path, ExperimentSpec &spec);
+
+// parse a spec from a stream, errors name the spec by path
+bool parseSpec(std::istream &in, const std::string &path,
+               ExperimentSpec &spec);
+#endif
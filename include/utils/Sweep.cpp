@@ -0,0 +1,345 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/utils/Sweep.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "include/utils/Counters.hpp"
+#include "include/utils/Journal.hpp"
+#include "include/utils/PerfEvents.hpp"
+#include "include/utils/Progress.hpp"
+#include "include/utils/ResultCache.hpp"
+#include "include/utils/ResultWriter.hpp"
+
+// splitmix64 finalizer
+static uint64_t mix64(uint64_t x) {
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+// FNV-1a
+static uint64_t hashString(const std::string &text) {
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  for (unsigned char c : text) {
+    hash = (hash ^ c) * 0x100000001B3ULL;
+  }
+  return hash;
+}
+
+uint64_t cellSeed(uint64_t seed, const std::string &experiment, uint64_t key,
+                  uint64_t repeat, const std::string &predictor) {
+  uint64_t hash = mix64(seed ^ hashString(experiment));
+  hash = mix64(hash ^ key);
+  hash = mix64(hash ^ repeat);
+  return mix64(hash ^ hashString(predictor));
+}
+
+uint64_t deriveSeed(uint64_t seed, const std::string &label) {
+  return mix64(seed ^ hashString(label));
+}
+
+// predictor stream of a cell with common random numbers (splitmix64), off
+// outside of such cells
+static bool predictor_stream = false;
+static uint64_t predictor_state = 0;
+
+uint64_t predictorRand() {
+  if (!predictor_stream) {
+    return rand();
+  }
+  predictor_state += 0x9E3779B97F4A7C15ULL;
+  return mix64(predictor_state) >> 33;
+}
+
+Sweep::Sweep(ResultWriter *writer, Journal *journal, ResultCache *cache,
+             Progress *progress, const ResultHeader &header,
+             const std::vector<uint64_t> &keys, uint64_t repeats,
+             const std::function<uint64_t(uint64_t)> &lookups)
+    : writer(writer),
+      journal(journal),
+      cache(cache),
+      progress(progress),
+      header(header),
+      keys(keys),
+      repeats(repeats),
+      lookups(lookups) {
+  this->header.repeats = repeats;
+}
+
+bool Sweep::owns(uint64_t row, uint64_t repeat) {
+  return (row * repeats + repeat) % header.shard_count == header.shard_index;
+}
+
+uint64_t Sweep::ownedCells() {
+  uint64_t cells = 0;
+  for (uint64_t row = 0; row < keys.size(); row++) {
+    for (uint64_t repeat = 0; repeat < repeats; repeat++) {
+      cells += owns(row, repeat);
+    }
+  }
+  return cells;
+}
+
+uint64_t Sweep::column(uint64_t predictor, uint64_t k) {
+  if (header.layout == "group-major") {
+    return k * header.predictors.size() + predictor;
+  }
+  return predictor * header.values_per_predictor + k;
+}
+
+std::string Sweep::fingerprint() {
+  std::string config = header.serialize();
+  config += "repeats=" + std::to_string(repeats) + "\n";
+  config += "keys=";
+  for (uint64_t key : keys) {
+    config += std::to_string(key) + ",";
+  }
+  char buffer[17];
+  snprintf(buffer, sizeof(buffer), "%016llx",
+           (unsigned long long)hashString(config));
+  return buffer;
+}
+
+std::vector<std::vector<uint64_t>> Sweep::run(
+    const std::function<std::vector<uint64_t>(const SweepCell &)> &trial,
+    bool average,
+    const std::function<bool(const std::vector<uint64_t> &)> &converged) {
+  std::vector<std::vector<uint64_t>> stats;
+  uint64_t num_predictors = header.predictors.size();
+  uint64_t num_cells = repeats * num_predictors;
+  header.average = average;
+  if (journal != nullptr) {
+    journal->open(fingerprint(), header.experiment, header.seed);
+  }
+  if (writer != nullptr) {
+    writer->begin(header);
+  }
+  if (progress != nullptr) {
+    progress->begin(header.experiment, header.predictors,
+                    ownedCells() * num_predictors);
+  }
+  // the original experiments draw from a single stream per table
+  if (header.baseline) {
+    srand(header.seed);
+  }
+  for (uint64_t row = 0; row < keys.size(); row++) {
+#ifdef EVALUATION
+    std::cout << header.experiment << ": " << keys[row] << std::endl;
+#endif
+    std::vector<uint64_t> stat(header.columns(), 0);
+    uint64_t cells_done = 0;
+    if (journal != nullptr) {
+      journal->restore(row, cells_done, stat);
+    }
+    if (progress != nullptr) {
+      uint64_t restored = 0;
+      for (uint64_t cell = 0; cell < cells_done; cell++) {
+        restored += owns(row, cell / num_predictors);
+      }
+      progress->restore(restored);
+    }
+    // cells are evaluated repeat by repeat, predictor by predictor
+    for (uint64_t cell = cells_done; cell < num_cells; cell++) {
+      SweepCell coord;
+      coord.row = row;
+      coord.key = keys[row];
+      coord.repeat = cell / num_predictors;
+      coord.predictor = cell % num_predictors;
+      coord.fresh = !header.baseline;
+      if (!owns(coord.row, coord.repeat)) {
+        continue;
+      }
+      // with common random numbers, all predictors share the seed
+      uint64_t seed = cellSeed(
+          header.seed, header.experiment, coord.key, coord.repeat,
+          header.common_random ? "" : header.predictors[coord.predictor]);
+      std::vector<uint64_t> values;
+      std::string address;
+      if (cache != nullptr) {
+        address = ResultCache::address(header,
+                                       header.predictors[coord.predictor],
+                                       coord.key, coord.repeat, seed);
+      }
+      if (cache == nullptr || !cache->lookup(address, values)) {
+        if (!header.baseline) {
+          srand(seed);
+          predictor_stream = header.common_random;
+          predictor_state = deriveSeed(seed, "predictor");
+        }
+        uint64_t before = lookups ? lookups(coord.predictor) : 0;
+#ifdef PERF_EVENTS
+        perfBegin(header.predictors[coord.predictor]);
+#endif
+        auto start = std::chrono::steady_clock::now();
+        values = trial(coord);
+        uint64_t trial_ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+#ifdef PERF_EVENTS
+        perfEnd();
+#endif
+#ifdef COUNTERS
+        collectCounters(header.predictors[coord.predictor], trial_ns);
+#endif
+        if (progress != nullptr) {
+          uint64_t after = lookups ? lookups(coord.predictor) : 0;
+          progress->cell(coord.predictor, after - before, trial_ns);
+        }
+        if (cache != nullptr) {
+          cache->store(address, values);
+        }
+      } else if (progress != nullptr) {
+        progress->cell(coord.predictor, 0, 0);
+      }
+      for (uint64_t k = 0; k < values.size(); k++) {
+        stat[column(coord.predictor, k)] += values[k];
+      }
+      if (journal != nullptr && cell + 1 < num_cells && journal->due()) {
+        journal->checkpoint(row, keys[row], cell + 1, stat);
+      }
+      // early stop, the rest of the row counts as done
+      if (converged && coord.predictor + 1 == num_predictors &&
+          converged(stat)) {
+        break;
+      }
+    }
+    if (journal != nullptr && cells_done < num_cells) {
+      journal->checkpoint(row, keys[row], num_cells, stat);
+    }
+    // shards keep the sums, the average is taken when merging them
+    if (average && repeats > 0 && header.shard_count == 1) {
+      for (uint64_t &value : stat) {
+        value /= repeats;
+      }
+    }
+    if (writer != nullptr) {
+      writer->write(keys[row], stat);
+    }
+    stats.push_back(stat);
+  }
+  predictor_stream = false;
+  if (writer != nullptr) {
+    writer->end();
+  }
+  if (journal != nullptr) {
+    journal->close();
+  }
+  if (progress != nullptr) {
+    progress->end();
+  }
+#ifdef EVALUATION
+  if (cache != nullptr) {
+    std::cout << "cache: " << cache->getHits() << " hits, "
+              << cache->getMisses() << " misses" << std::endl;
+  }
+#endif
+#ifdef COUNTERS
+  reportCounters(header.experiment);
+#endif
+#ifdef PERF_EVENTS
+  reportPerf(header.experiment);
+#endif
+  return stats;
+}
+
+bool mergeShards(const std::vector<std::string> &paths, ResultWriter *writer) {
+  std::vector<ResultTable> merged;
+  std::vector<bool> seen;
+  for (const std::string &path : paths) {
+    std::vector<ResultTable> tables;
+    if (!readResults(path, tables)) {
+      std::cerr << "merge: cannot read " << path << std::endl;
+      return false;
+    }
+    if (seen.empty()) {
+      merged = tables;
+      for (ResultTable &table : merged) {
+        for (std::vector<uint64_t> &row : table.rows) {
+          row.assign(table.header.columns(), 0);
+        }
+      }
+      seen.assign(tables[0].header.shard_count, false);
+    }
+    // all shards must come from the same run, table by table
+    uint64_t shard = tables[0].header.shard_index;
+    bool same = tables.size() == merged.size() && shard < seen.size();
+    for (uint64_t t = 0; same && t < tables.size(); t++) {
+      ResultHeader expected = merged[t].header;
+      expected.shard_index = shard;
+      same = tables[t].header.serialize() == expected.serialize() &&
+             tables[t].keys == merged[t].keys;
+    }
+    if (!same) {
+      std::cerr << "merge: " << path << " is not a shard of "
+                << merged[0].header.experiment << std::endl;
+      return false;
+    }
+    if (seen[shard]) {
+      std::cerr << "merge: shard " << shard << "/" << seen.size()
+                << " is given twice" << std::endl;
+      return false;
+    }
+    seen[shard] = true;
+    for (uint64_t t = 0; t < tables.size(); t++) {
+      for (uint64_t row = 0; row < tables[t].rows.size(); row++) {
+        for (uint64_t i = 0; i < tables[t].rows[row].size(); i++) {
+          merged[t].rows[row][i] += tables[t].rows[row][i];
+        }
+      }
+    }
+  }
+  for (uint64_t shard = 0; shard < seen.size(); shard++) {
+    if (!seen[shard]) {
+      std::cerr << "merge: shard " << shard << "/" << seen.size()
+                << " is missing" << std::endl;
+      return false;
+    }
+  }
+  if (seen.empty()) {
+    return false;
+  }
+  for (ResultTable &table : merged) {
+    table.header.shard_index = 0;
+    table.header.shard_count = 1;
+    writer->begin(table.header);
+    for (uint64_t row = 0; row < table.rows.size(); row++) {
+      if (table.header.average && table.header.repeats > 0) {
+        for (uint64_t &value : table.rows[row]) {
+          value /= table.header.repeats;
+        }
+      }
+      writer->write(table.keys[row], table.rows[row]);
+    }
+    writer->end();
+  }
+  return true;
+}
@@ -0,0 +1,128 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// A sweep evaluates an experiment as a grid of cells (row, repeat, predictor).
+// Each row is one value of the swept parameter (branch accesses, pruning size
+// or repeat index); a cell is a single attack trial on a single predictor and
+// returns the values of that predictor in the row. A row is the sum of its
+// cells (or their average over the repeats).
+//
+// Before every cell the random generator is reseeded from the cell
+// coordinates, so the result of a cell does not depend on the cells that ran
+// before it. This is what makes checkpoint/resume and the result cache exact,
+// and what lets a sweep be split into shards: shard i/N evaluates the
+// (row, repeat) pairs with (row * repeats + repeat) % N == i and writes
+// partial sums, which mergeShards combines into the table of a single run.
+//
+// With common random numbers (ResultHeader::common_random), the seed of a
+// cell leaves out the predictor, so every predictor of a (row, repeat) runs
+// the attack on the same draws of rand(): the same candidate addresses and
+// victims. The draws of the predictors themselves (random replacement, the
+// key streams of a rekey) then come from a stream of their own
+// (predictorRand), which keeps them from shifting the draws of the attack.
+// Paired differences between predictors lose the noise of the draws.
+//
+// Baseline sweeps (ResultHeader::baseline) run the trials as the original
+// experiments did, for comparison with their results (exps/output_ref): the
+// random generator is seeded once per table and every predictor keeps its
+// tables from one trial to the next. A baseline cell depends on all cells
+// before it, so these sweeps are neither journaled, cached nor sharded.
+// =============================================================================
+#ifndef SWEEP_HPP
+#define SWEEP_HPP
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "include/utils/Journal.hpp"
+#include "include/utils/Progress.hpp"
+#include "include/utils/ResultCache.hpp"
+#include "include/utils/ResultWriter.hpp"
+
+// coordinates of a single trial
+struct SweepCell {
+  uint64_t row;        // index of the row in the sweep
+  uint64_t key;        // swept parameter of the row
+  uint64_t repeat;     // repeat index within the row
+  uint64_t predictor;  // index into the predictors of the header
+  bool fresh;          // whether the trial starts from cleared tables
+};
+
+// seed of a cell derived from the run seed and the cell coordinates
+uint64_t cellSeed(uint64_t seed, const std::string &experiment, uint64_t key,
+                  uint64_t repeat, const std::string &predictor);
+
+// seed derived from the run seed for a named purpose (e.g., predictor keys)
+uint64_t deriveSeed(uint64_t seed, const std::string &label);
+
+// random number (31 bits, as rand()) of a draw by a predictor itself: rand(),
+// or the predictor stream of a cell with common random numbers
+uint64_t predictorRand();
+
+class Sweep {
+ private:
+  ResultWriter *writer;
+  Journal *journal;
+  ResultCache *cache;
+  Progress *progress;
+  ResultHeader header;
+  std::vector<uint64_t> keys;
+  uint64_t repeats;
+
+  // lookups of the i-th predictor so far, for the progress reporter
+  std::function<uint64_t(uint64_t)> lookups;
+
+  // column of the k-th value of a predictor in a row
+  uint64_t column(uint64_t predictor, uint64_t k);
+
+  std::string fingerprint();
+
+  // number of (row, repeat) pairs in the shard of this sweep
+  uint64_t ownedCells();
+
+ public:
+  // writer, journal, cache, progress and lookups are optional (nullptr),
+  // without lookups the progress reports no lookups/sec
+  Sweep(ResultWriter *writer, Journal *journal, ResultCache *cache,
+        Progress *progress, const ResultHeader &header,
+        const std::vector<uint64_t> &keys, uint64_t repeats,
+        const std::function<uint64_t(uint64_t)> &lookups = nullptr);
+
+  // whether a cell belongs to the shard of this sweep
+  bool owns(uint64_t row, uint64_t repeat);
+
+  // evaluate all cells, write one record per row and return the rows. If
+  // converged is given, a row ends at the first complete repeat after which
+  // converged holds for its partial sums. The shards of such a sweep would
+  // stop at different repeats and cannot be merged (main rejects them).
+  std::vector<std::vector<uint64_t>> run(
+      const std::function<std::vector<uint64_t>(const SweepCell &)> &trial,
+      bool average = false,
+      const std::function<bool(const std::vector<uint64_t> &)> &converged =
+          nullptr);
+};
+
+// merge the result files of all shards of a run, table by table, into the
+// tables of a single run, return false if the shards do not form a complete
+// run
+bool mergeShards(const std::vector<std::string> &paths, ResultWriter *writer);
+#endif
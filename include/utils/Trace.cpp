@@ -0,0 +1,349 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/utils/Trace.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "include/predictors/Domains.hpp"
+
+static const char TRACE_MAGIC[8] = {'B', 'G', 'T', 'R', 'C', '0', '0', '2'};
+
+// former format, with a victim bit instead of a domain varint
+static const char TRACE_MAGIC_V1[8] = {'B', 'G', 'T', 'R', 'C', '0', '0', '1'};
+static const uint64_t TRACE_DOMAINS_V1 = 0x03;
+
+// magic, records, payload bytes, flags
+static const uint64_t TRACE_HEADER_SIZE = 32;
+
+static const char *const KIND_NAMES[] = {"cond", "jmp", "ind", "call", "ret"};
+
+// flags of a record
+static const uint8_t FLAG_KIND = 0x07;
+static const uint8_t FLAG_TAKEN = 0x08;
+static const uint8_t FLAG_DOMAIN = 0x10;
+static const uint8_t FLAG_TARGET = 0x20;
+static const uint8_t FLAG_OUTCOME_SHIFT = 6;
+
+static uint64_t zigzag(uint64_t delta) {
+  return (delta << 1) ^ (uint64_t)((int64_t)delta >> 63);
+}
+
+static uint64_t unzigzag(uint64_t value) {
+  return (value >> 1) ^ (0 - (value & 1));
+}
+
+static uint8_t *putVarint(uint8_t *out, uint64_t value) {
+  while (value >= 0x80) {
+    *out++ = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  *out++ = (uint8_t)value;
+  return out;
+}
+
+// return nullptr if the varint runs past the end
+static const uint8_t *getVarint(const uint8_t *in, const uint8_t *end,
+                                uint64_t &value) {
+  value = 0;
+  for (uint64_t shift = 0; in < end && shift < 64; shift += 7) {
+    uint8_t byte = *in++;
+    value |= (uint64_t)(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return in;
+    }
+  }
+  return nullptr;
+}
+
+static void putU64(uint8_t *out, uint64_t value) {
+  for (uint64_t i = 0; i < 8; i++) {
+    out[i] = (uint8_t)(value >> (8 * i));
+  }
+}
+
+static uint64_t getU64(const uint8_t *in) {
+  uint64_t value = 0;
+  for (uint64_t i = 0; i < 8; i++) {
+    value |= (uint64_t)in[i] << (8 * i);
+  }
+  return value;
+}
+
+TraceWriter::TraceWriter(const std::string &path, bool lookups)
+    : path(path), lookups(lookups) {}
+
+TraceWriter::~TraceWriter() { close(); }
+
+bool TraceWriter::open() {
+  file = fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    std::cerr << "Trace: cannot write " << path << std::endl;
+    return false;
+  }
+  // the header is written by close
+  uint8_t header[TRACE_HEADER_SIZE] = {};
+  fwrite(header, 1, sizeof(header), file);
+  return true;
+}
+
+void TraceWriter::write(const TraceRecord &record) {
+  uint8_t buffer[1 + 10 + 10 + 10];
+  uint8_t *out = buffer;
+  uint8_t flags = (record.kind & FLAG_KIND) | (record.taken ? FLAG_TAKEN : 0) |
+                  (record.domain ? FLAG_DOMAIN : 0) |
+                  (record.target ? FLAG_TARGET : 0) |
+                  (record.outcome << FLAG_OUTCOME_SHIFT);
+  *out++ = flags;
+  out = putVarint(out, zigzag(record.pc - last_pc));
+  if (record.target) {
+    out = putVarint(out, zigzag(record.target - record.pc));
+  }
+  if (record.domain) {
+    out = putVarint(out, record.domain);
+  }
+  fwrite(buffer, 1, out - buffer, file);
+  last_pc = record.pc;
+  payload += out - buffer;
+  if (record.domain >= domains) {
+    domains = record.domain + 1ULL;
+  }
+  records++;
+}
+
+bool TraceWriter::close() {
+  if (file == nullptr) {
+    return true;
+  }
+  uint8_t header[TRACE_HEADER_SIZE];
+  memcpy(header, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+  putU64(header + 8, records);
+  putU64(header + 16, payload);
+  putU64(header + 24, (domains << TRACE_DOMAINS_SHIFT) |
+                          (lookups ? TRACE_LOOKUPS : 0));
+  bool ok = fseek(file, 0, SEEK_SET) == 0 &&
+            fwrite(header, 1, sizeof(header), file) == sizeof(header);
+  ok = fclose(file) == 0 && ok;
+  file = nullptr;
+  if (!ok) {
+    std::cerr << "Trace: cannot write " << path << std::endl;
+  }
+  return ok;
+}
+
+TraceReader::TraceReader(const std::string &path) : path(path) {}
+
+TraceReader::~TraceReader() {
+  if (base != nullptr) {
+    munmap((void *)base, length);
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+}
+
+bool TraceReader::open() {
+  fd = ::open(path.c_str(), O_RDONLY);
+  struct stat info;
+  if (fd < 0 || fstat(fd, &info) != 0) {
+    std::cerr << "Trace: cannot open " << path << std::endl;
+    return false;
+  }
+  length = info.st_size;
+  if (length < TRACE_HEADER_SIZE) {
+    std::cerr << "Trace: " << path << ": not a trace" << std::endl;
+    return false;
+  }
+  void *data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    std::cerr << "Trace: cannot map " << path << std::endl;
+    return false;
+  }
+  base = (const uint8_t *)data;
+  // the records are decoded once, front to back
+  madvise(data, length, MADV_SEQUENTIAL);
+  domain_varint = memcmp(base, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0;
+  if (!domain_varint &&
+      memcmp(base, TRACE_MAGIC_V1, sizeof(TRACE_MAGIC_V1)) != 0) {
+    std::cerr << "Trace: " << path << ": not a trace" << std::endl;
+    return false;
+  }
+  records = getU64(base + 8);
+  uint64_t payload = getU64(base + 16);
+  flags = getU64(base + 24);
+  if (domain_varint) {
+    domains = (flags >> TRACE_DOMAINS_SHIFT) & TRACE_DOMAINS_MASK;
+  } else {
+    // the highest bit of the domain mask
+    domains = (flags & TRACE_DOMAINS_V1) > 1 ? 2 : flags & TRACE_DOMAINS_V1;
+  }
+  if (domains > MAX_DOMAINS) {
+    std::cerr << "Trace: " << path << ": " << domains
+              << " domains, at most " << MAX_DOMAINS << std::endl;
+    return false;
+  }
+  if (payload > length - TRACE_HEADER_SIZE) {
+    std::cerr << "Trace: " << path << ": truncated" << std::endl;
+    return false;
+  }
+  end = base + TRACE_HEADER_SIZE + payload;
+  rewind();
+  return true;
+}
+
+uint64_t TraceReader::next(TraceRecord *chunk, uint64_t max) {
+  const uint8_t *in = next_byte;
+  uint64_t pc = last_pc;
+  uint64_t count = 0;
+  if (max > records - decoded) {
+    max = records - decoded;
+  }
+  while (count < max && in < end) {
+    uint8_t flags = *in++;
+    uint64_t value;
+    in = getVarint(in, end, value);
+    if (in == nullptr) {
+      break;
+    }
+    pc += unzigzag(value);
+    TraceRecord &record = chunk[count];
+    record.pc = pc;
+    record.target = 0;
+    record.kind = flags & FLAG_KIND;
+    record.taken = (flags & FLAG_TAKEN) != 0;
+    record.domain = (flags & FLAG_DOMAIN) != 0;
+    record.outcome = flags >> FLAG_OUTCOME_SHIFT;
+    if (flags & FLAG_TARGET) {
+      in = getVarint(in, end, value);
+      if (in == nullptr) {
+        break;
+      }
+      record.target = pc + unzigzag(value);
+    }
+    if ((flags & FLAG_DOMAIN) && domain_varint) {
+      in = getVarint(in, end, value);
+      if (in == nullptr) {
+        break;
+      }
+      record.domain = value;
+      // a domain beyond the header could not be replayed
+      if (value >= domains) {
+        in = nullptr;
+        break;
+      }
+    }
+    if (record.kind >= BranchKind::NUM_BRANCH_KINDS) {
+      in = nullptr;
+      break;
+    }
+    count++;
+  }
+  if (in == nullptr || (count < max && in >= end)) {
+    // the header promised more records
+    if (!corrupt) {
+      std::cerr << "Trace: " << path << ": malformed record "
+                << decoded + count << std::endl;
+    }
+    corrupt = true;
+    next_byte = end;
+    decoded = records;
+    return count;
+  }
+  next_byte = in;
+  last_pc = pc;
+  decoded += count;
+  return count;
+}
+
+void TraceReader::rewind() {
+  next_byte = base + TRACE_HEADER_SIZE;
+  last_pc = 0;
+  decoded = 0;
+}
+
+// parse a branch kind by name or number
+static bool parseKind(const char *text, uint8_t &kind) {
+  for (uint64_t i = 0; i < BranchKind::NUM_BRANCH_KINDS; i++) {
+    if (strcmp(text, KIND_NAMES[i]) == 0) {
+      kind = i;
+      return true;
+    }
+  }
+  char *rest;
+  uint64_t value = strtoull(text, &rest, 10);
+  kind = value;
+  return *rest == '\0' && rest != text &&
+         value < BranchKind::NUM_BRANCH_KINDS;
+}
+
+bool convertTrace(const std::string &text_path,
+                  const std::string &trace_path) {
+  std::ifstream in(text_path);
+  if (!in.is_open()) {
+    std::cerr << "Trace: cannot open " << text_path << std::endl;
+    return false;
+  }
+  TraceWriter writer(trace_path);
+  if (!writer.open()) {
+    return false;
+  }
+  std::string line;
+  uint64_t line_number = 0;
+  while (std::getline(in, line)) {
+    line_number++;
+    line = line.substr(0, line.find('#'));
+    char pc[32], target[32], kind[16];
+    unsigned taken, domain;
+    char extra;
+    int fields = sscanf(line.c_str(), "%31s %31s %u %15s %u %c", pc, target,
+                        &taken, kind, &domain, &extra);
+    if (fields <= 0) {
+      continue;
+    }
+    TraceRecord record;
+    char *pc_end, *target_end;
+    record.pc = strtoull(pc, &pc_end, 16);
+    record.target = strtoull(target, &target_end, 16);
+    record.taken = taken;
+    record.domain = domain;
+    record.outcome = LookupOutcome::OUT_NONE;
+    if (fields != 5 || *pc_end != '\0' || *target_end != '\0' || taken > 1 ||
+        domain >= MAX_DOMAINS || !parseKind(kind, record.kind)) {
+      std::cerr << "Trace: " << text_path << ":" << line_number
+                << ": expected \"<pc> <target> <taken> <kind> <domain>\""
+                << std::endl;
+      return false;
+    }
+    writer.write(record);
+  }
+  return writer.close();
+}
@@ -0,0 +1,162 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Branch traces for replaying workloads through the predictors.
+//
+// Binary format (little-endian): "BGTRC002", uint64 records, uint64 payload
+// bytes, uint64 flags (lookup stream in bit 8, number of domains in bits
+// 16-31), then one variable-length record per branch:
+//   uint8 flags     kind (bits 0-2), taken (bit 3), domain present (bit 4),
+//                   target present (bit 5), outcome (bits 6-7)
+//   varint pc       zigzag delta to the pc of the previous record
+//   varint target   zigzag delta to the pc (if present)
+//   varint domain   security domain (if present, else domain 0)
+// so that a branch of a loop or a near call takes 3 to 5 bytes instead of 24,
+// one more for a domain below 128. Traces of the former "BGTRC001" format
+// have no domain varint, their domain bit is the victim (domain 1).
+//
+// A lookup stream is recorded from an attack (see Recorder.hpp): every record
+// is a single lookup, a PHT lookup (BR_COND) or a BTB lookup (BR_JUMP), with
+// the outcome of the recording predictor.
+//
+// Text format: one branch per line, "#" starts a comment:
+//   <pc> <target> <taken> <kind> <domain>
+// with hexadecimal addresses, taken 0/1, kind cond|jmp|ind|call|ret and the
+// security domain, 0 (attacker), 1 (victim) or a further tenant below
+// MAX_DOMAINS (see Domains.hpp).
+//
+// The reader maps the whole file and decodes it in chunks, so multi-GB traces
+// stream from the page cache without copies.
+// =============================================================================
+#ifndef TRACE_HPP
+#define TRACE_HPP
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// kind of a traced branch
+enum BranchKind {
+  BR_COND = 0,
+  BR_JUMP = 1,
+  BR_INDIRECT = 2,
+  BR_CALL = 3,
+  BR_RETURN = 4,
+  NUM_BRANCH_KINDS = 5
+};
+
+// flags of the header
+#define TRACE_LOOKUPS 0x100
+#define TRACE_DOMAINS_SHIFT 16
+#define TRACE_DOMAINS_MASK 0xFFFF
+
+// outcome of a recorded lookup
+enum LookupOutcome {
+  OUT_NONE = 0,
+  OUT_INVALID = 1,
+  OUT_HIT = 2,
+  OUT_MISPREDICT = 3
+};
+
+struct TraceRecord {
+  uint64_t pc;
+  uint64_t target;
+  uint8_t taken;
+  uint8_t kind;
+  uint16_t domain;
+  uint8_t outcome;
+};
+
+class TraceWriter {
+ private:
+  std::string path;
+  FILE *file = nullptr;
+  uint64_t records = 0;
+  uint64_t payload = 0;
+  uint64_t domains = 0;
+  bool lookups;
+  uint64_t last_pc = 0;
+
+ public:
+  TraceWriter(const std::string &path, bool lookups = false);
+
+  ~TraceWriter();
+
+  // create the file, return false if it cannot be written
+  bool open();
+
+  void write(const TraceRecord &record);
+
+  // write the header, return false on i/o errors
+  bool close();
+};
+
+class TraceReader {
+ private:
+  std::string path;
+  int fd = -1;
+  const uint8_t *base = nullptr;
+  uint64_t length = 0;
+
+  // records, flags and domains of the header, and whether the records have
+  // a domain varint ("BGTRC002") or a victim bit ("BGTRC001")
+  uint64_t records = 0;
+  uint64_t flags = 0;
+  uint64_t domains = 0;
+  bool domain_varint = true;
+
+  // decoding position
+  const uint8_t *next_byte = nullptr;
+  const uint8_t *end = nullptr;
+  uint64_t last_pc = 0;
+  uint64_t decoded = 0;
+  bool corrupt = false;
+
+ public:
+  TraceReader(const std::string &path);
+
+  ~TraceReader();
+
+  // map the file, print the first error and return false if it is invalid
+  bool open();
+
+  uint64_t size() { return records; }
+
+  // number of security domains of the trace, one more than its highest
+  // domain
+  uint64_t getDomains() { return domains; }
+
+  // whether the trace is a lookup stream of an attack
+  bool isLookupStream() { return (flags & TRACE_LOOKUPS) != 0; }
+
+  // whether decoding stopped at a malformed record
+  bool isCorrupt() { return corrupt; }
+
+  // decode up to max records, return 0 at the end of the trace
+  uint64_t next(TraceRecord *chunk, uint64_t max);
+
+  // restart from the first record
+  void rewind();
+};
+
+// convert a text trace to the binary format, print the first error and
+// return false if it is malformed
+bool convertTrace(const std::string &text_path, const std::string &trace_path);
+#endif
@@ -25,7 +25,7 @@
 #include <cstdint>
 enum ReplacementPolicy { REPL_LRU = 0, REPL_RANDOM = 1 };
 
-// security domain
+// security domain, the domains above the victim are other tenants
 enum SecurityDomain { DOM_ATTACKER = 0, DOM_VICTIM = 1 };
 
 // BPU type
@@ -39,6 +39,14 @@ enum BPUType {
   BPU_HyBP = 6
 };
 
+// BPU names in the order of BPUType
+static const char *const BPU_NAMES[] = {"BaseBPU",    "BSUP", "XorBP",
+                                        "NoisyXorBP", "LSBP", "STBPU",
+                                        "HyBP"};
+
+// number of evaluated branch predictors
+#define NUM_BPU_TYPES 7
+
 // Encryption Keys
 enum EncryptionKey {
   KEY_0 = 0x06FADE60,
@@ -52,8 +60,46 @@ enum EncryptionKey {
 };
 
 // Processor PIDs
-enum ProcessorPID { PID_ATTACKER = 0x1234, PID_VICTIM = 0x5678 };
+enum ProcessorPID {
+  PID_ATTACKER = 0x1234,
+  PID_VICTIM = 0x5678,
+  // base of the pids of the other tenants (domain 2 and above)
+  PID_TENANT = 0x10000
+};
 
 // Maximum number of branches
 extern uint64_t NUMBER_MAX_BRANCHES;
+
+// Random seed of the experiments
+extern uint64_t RANDOM_SEED;
+
+// Shard of the experiment sweeps (--shard i/N)
+extern uint64_t SHARD_INDEX;
+extern uint64_t SHARD_COUNT;
+
+// Common random numbers across the predictors of a trial (see Sweep.hpp)
+extern bool COMMON_RANDOM;
+
+// Trial semantics of the original experiments (see Sweep.hpp)
+extern bool BASELINE;
+
+// mask of an address space of 1 to 64 bits
+inline uint64_t addrMask(uint64_t addr_space) {
+  return addr_space >= 64 ? ~0ULL : (1ULL << addr_space) - 1;
+}
+
+// random address (or key) under a mask from rand() (31 bits per call): two
+// calls for masks of up to 32 bits, three for the wider address spaces.
+// Baseline runs keep the single rand() & mask of the original experiments,
+// which never sets bit 31.
+inline uint64_t randomAddr(uint64_t addr_mask) {
+  if (addr_mask <= 0xFFFFFFFF) {
+    if (BASELINE) {
+      return rand() & addr_mask;
+    }
+    return ((uint64_t)rand() << 31 ^ rand()) & addr_mask;
+  }
+  uint64_t addr = (uint64_t)rand() << 62 ^ (uint64_t)rand() << 31 ^ rand();
+  return addr & addr_mask;
+}
 #endif
\ No newline at end of file
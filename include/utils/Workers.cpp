@@ -0,0 +1,199 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/utils/Workers.hpp"
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// a running task: its process and the read end of its pipe
+struct Worker {
+  pid_t pid;
+  int fd;
+  uint64_t task;
+  std::vector<uint8_t> data;
+};
+
+static bool writeAll(int fd, const void *data, uint64_t size) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  while (size > 0) {
+    ssize_t written = write(fd, bytes, size);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return false;
+    }
+    bytes += written;
+    size -= written;
+  }
+  return true;
+}
+
+// fork a worker for a task, the child sends the number of values and the
+// values and exits
+static bool startWorker(
+    uint64_t task,
+    const std::function<std::vector<uint64_t>(uint64_t)> &function,
+    std::vector<Worker> &workers) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    return false;
+  }
+  // buffered output would be written by both processes
+  std::cout.flush();
+  std::cerr.flush();
+  fflush(nullptr);
+  pid_t pid = fork();
+  if (pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if (pid == 0) {
+    close(fds[0]);
+    int status = 1;
+    try {
+      std::vector<uint64_t> values = function(task);
+      uint64_t count = values.size();
+      if (writeAll(fds[1], &count, sizeof(count)) &&
+          writeAll(fds[1], values.data(), count * sizeof(uint64_t))) {
+        status = 0;
+      }
+    } catch (...) {
+    }
+    std::cout.flush();
+    std::cerr.flush();
+    _exit(status);
+  }
+  close(fds[1]);
+  Worker worker;
+  worker.pid = pid;
+  worker.fd = fds[0];
+  worker.task = task;
+  workers.push_back(worker);
+  return true;
+}
+
+// reap a worker whose pipe is closed, return false if it failed
+static bool finishWorker(Worker &worker,
+                         std::vector<std::vector<uint64_t>> &results) {
+  close(worker.fd);
+  int status = 0;
+  while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR) {
+  }
+  uint64_t count = 0;
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 ||
+      worker.data.size() < sizeof(count)) {
+    return false;
+  }
+  memcpy(&count, worker.data.data(), sizeof(count));
+  if (worker.data.size() != (count + 1) * sizeof(uint64_t)) {
+    return false;
+  }
+  std::vector<uint64_t> &values = results[worker.task];
+  values.resize(count);
+  memcpy(values.data(), worker.data.data() + sizeof(count),
+         count * sizeof(uint64_t));
+  return true;
+}
+
+uint64_t workerJobs(uint64_t jobs) {
+  if (jobs > 0) {
+    return jobs;
+  }
+  uint64_t threads = std::thread::hardware_concurrency();
+  return threads > 0 ? threads : 1;
+}
+
+bool runWorkers(uint64_t tasks, uint64_t jobs,
+                const std::function<std::vector<uint64_t>(uint64_t)> &task,
+                std::vector<std::vector<uint64_t>> &results) {
+  jobs = workerJobs(jobs);
+  results.assign(tasks, std::vector<uint64_t>());
+  std::vector<Worker> workers;
+  uint64_t next = 0;
+  bool completed = true;
+  while (true) {
+    // after a failure the running tasks are drained, no new ones started
+    while (completed && next < tasks && workers.size() < jobs) {
+      if (!startWorker(next, task, workers)) {
+        std::cerr << "Workers: cannot start a worker: " << strerror(errno)
+                  << std::endl;
+        completed = false;
+        break;
+      }
+      next++;
+    }
+    if (workers.empty()) {
+      break;
+    }
+    std::vector<pollfd> fds(workers.size());
+    for (uint64_t i = 0; i < workers.size(); i++) {
+      fds[i].fd = workers[i].fd;
+      fds[i].events = POLLIN;
+      fds[i].revents = 0;
+    }
+    if (poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      completed = false;
+      break;
+    }
+    // read the ready pipes, reap the workers at the end of their pipe
+    for (uint64_t i = workers.size(); i-- > 0;) {
+      if (fds[i].revents == 0) {
+        continue;
+      }
+      uint8_t buffer[65536];
+      ssize_t size = read(workers[i].fd, buffer, sizeof(buffer));
+      if (size < 0 && errno == EINTR) {
+        continue;
+      }
+      if (size > 0) {
+        workers[i].data.insert(workers[i].data.end(), buffer, buffer + size);
+        continue;
+      }
+      if (!finishWorker(workers[i], results)) {
+        std::cerr << "Workers: task " << workers[i].task << " failed"
+                  << std::endl;
+        completed = false;
+      }
+      workers.erase(workers.begin() + i);
+    }
+  }
+  // after a poll failure
+  for (Worker &worker : workers) {
+    finishWorker(worker, results);
+  }
+  return completed && next == tasks;
+}
@@ -0,0 +1,48 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+// Pool of worker processes for independent tasks. The simulator keeps
+// process-wide state (rand(), the branch budget and the seed), so tasks run in
+// forked processes rather than threads: every task is evaluated in a fresh
+// child of the calling process, at most jobs at a time, and sends its values
+// back through a pipe. A task sees the state of the caller at the time of the
+// call, and its side effects other than its values (and files it writes) are
+// lost with the child.
+//
+// Callers must not fork while another of their threads holds a lock that the
+// task needs (e.g., pass no writer or progress reporter to the task).
+// =============================================================================
+#ifndef WORKERS_HPP
+#define WORKERS_HPP
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// number of jobs of a pool, the hardware threads if jobs is 0
+uint64_t workerJobs(uint64_t jobs);
+
+// evaluate tasks 0 .. tasks - 1 in up to jobs worker processes, results[i]
+// are the values of task i. Return false if a worker could not be started or
+// did not complete its task.
+bool runWorkers(uint64_t tasks, uint64_t jobs,
+                const std::function<std::vector<uint64_t>(uint64_t)> &task,
+                std::vector<std::vector<uint64_t>> &results);
+#endif
@@ -19,54 +19,349 @@
 // author: iamywang
 // date: 2024/12/31
 // =============================================================================
-#include "exps/exp1_reuse.cpp"
-#include "exps/exp2_prune.cpp"
-#include "exps/exp3_occupancy.cpp"
-#include "exps/exp4_leakage.cpp"
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "include/exps/run.hpp"
+#include "include/utils/Journal.hpp"
+#include "include/utils/Progress.hpp"
+#include "include/utils/Recorder.hpp"
+#include "include/utils/ResultCache.hpp"
+#include "include/utils/ResultWriter.hpp"
+#include "include/utils/Spec.hpp"
+#include "include/utils/Sweep.hpp"
+#include "include/utils/Trace.hpp"
 
 uint64_t NUMBER_MAX_BRANCHES = 1e8;
+uint64_t RANDOM_SEED = time(NULL);
+uint64_t SHARD_INDEX = 0;
+uint64_t SHARD_COUNT = 1;
+bool COMMON_RANDOM = false;
+bool BASELINE = false;
 
-int main(int argc, char **argv) {
-  // switch to different attack
-  if (argc == 4) {
-    int max_branches = std::stoi(argv[2]);
-    int max_repeats = std::stoi(argv[3]);
-    // init experiments
-    Exp1 *exp1 = new Exp1(2, 1024, 4, 1024);
-    Exp2 *exp2 = new Exp2(2, 1024, 4, 1024);
-    Exp3 *exp3 = new Exp3(2, 1024, 4, 1024);
-    Exp4 *exp4 = new Exp4(2, 1024, 4, 1024, max_branches);
-    // switch to different attack
-    if (std::string(argv[1]) == "reuse-access") {
-      exp1->ReuseBranchAccess(max_repeats, 2);
-    } else if (std::string(argv[1]) == "reuse-collision") {
-      exp1->ReuseCollisionRate(max_repeats, 2);
-    } else if (std::string(argv[1]) == "prune-btb-prune") {
-      exp2->BTBPruningAccessIterate(max_branches, max_repeats);
-    } else if (std::string(argv[1]) == "prune-btb-collision") {
-      exp2->BTBCollisionRate(3800, 300000, max_repeats);
-    } else if (std::string(argv[1]) == "occupancy-pht-prune") {
-      exp3->PHTPruningAccessIterate(max_branches, 1024, max_repeats, 2);
-    } else if (std::string(argv[1]) == "occupancy-pht-collision") {
-      exp3->PHTCollisionRate(20, 500000, max_repeats, 2);
-    } else if (std::string(argv[1]) == "occupancy-btb-prune") {
-      exp3->BTBPruningAccessIterate(max_branches, 4096, max_repeats);
-    } else if (std::string(argv[1]) == "occupancy-btb-collision") {
-      exp3->BTBCollisionRate(600, 200000, max_repeats);
-    } else if (std::string(argv[1]) == "leakage-pht") {
-      exp4->PHTLeakage(20, 500000, max_repeats, 2);
-    } else if (std::string(argv[1]) == "leakage-btb") {
-      exp4->BTBLeakage(600, 200000, max_repeats);
+void usage() {
+  std::cout
+      << "Usage: ./branch-gauge [attack] [max_branches|max_pruning_sizes] "
+         "[max_repeats] [options]"
+      << std::endl
+      << "       ./branch-gauge tenants-interference [max_tenants] "
+         "[max_repeats] [options]"
+      << std::endl
+      << "       ./branch-gauge spec [spec file] [options]" << std::endl
+      << "       ./branch-gauge explore [spec file] [options]" << std::endl
+      << "       ./branch-gauge trace-replay [trace file] [window] [options]"
+      << std::endl
+      << "       ./branch-gauge stream-replay [lookup stream] [options]"
+      << std::endl
+      << "       ./branch-gauge convert [text trace] [trace file]" << std::endl
+      << "       ./branch-gauge merge [shard files...] [--format f] "
+         "[--output path]"
+      << std::endl
+      << "Options:" << std::endl
+      << "  --format text|binary|npy  result format (default: text)"
+      << std::endl
+      << "  --output <path>           result file (default: stderr)"
+      << std::endl
+      << "  --seed <seed>             random seed (default: time)"
+      << std::endl
+      << "  --common-random           same random draws for every predictor "
+         "of a trial"
+      << std::endl
+      << "  --baseline                trials keep the predictor tables and "
+         "one random stream"
+      << std::endl
+      << "  --journal <path>          checkpoint journal of the sweep"
+      << std::endl
+      << "  --resume                  resume the sweep from the journal"
+      << std::endl
+      << "  --checkpoint <seconds>    checkpoint interval (default: 60)"
+      << std::endl
+      << "  --cache <dir>             result cache of the trials"
+      << std::endl
+      << "  --shard <i>/<N>           evaluate the i-th of N shards "
+         "(binary or npy output)"
+      << std::endl
+      << "  --status <path>           progress, throughput and ETA of the "
+         "sweep (- for stdout)"
+      << std::endl
+      << "  --status-interval <s>     progress interval (default: 10)"
+      << std::endl
+      << "  --record <path>           record the lookup stream of the "
+         "attacks (RECORDER)"
+      << std::endl
+      << "  --jobs <n>                worker processes of explore "
+         "(default: hardware threads)"
+      << std::endl
+      << "  --tolerance <millibits>   leakage-*-mi: end a row at -/+ "
+         "millibits (default: 0)"
+      << std::endl;
+}
+
+// parse a decimal number
+bool parseNumber(const std::string &text, uint64_t &value) {
+  try {
+    value = std::stoull(text);
+  } catch (...) {
+    return false;
+  }
+  return true;
+}
+
+// parse a shard "i/N"
+bool parseShard(const std::string &text, uint64_t &index, uint64_t &count) {
+  uint64_t slash = text.find('/');
+  if (slash == std::string::npos) {
+    return false;
+  }
+  try {
+    index = std::stoull(text.substr(0, slash));
+    count = std::stoull(text.substr(slash + 1));
+  } catch (...) {
+    return false;
+  }
+  return count > 0 && index < count;
+}
+
+// merge the result files of all shards of a sweep
+int merge(int argc, char **argv) {
+  ResultFormat format = ResultFormat::FMT_TEXT;
+  std::string output = "";
+  std::vector<std::string> paths;
+  for (int i = 2; i < argc; i++) {
+    std::string option = argv[i];
+    if (option.rfind("--", 0) != 0) {
+      paths.push_back(option);
+    } else if (i + 1 == argc) {
+      usage();
+      return 1;
+    } else if (option == "--format" &&
+               ResultWriter::parseFormat(argv[i + 1], format)) {
+      i++;
+    } else if (option == "--output") {
+      output = argv[++i];
     } else {
-      std::cout
-          << "Usage: ./branch-gauge [attack] [max_branches|max_pruning_sizes] "
-             "[max_repeats]"
-          << std::endl;
+      usage();
+      return 1;
+    }
+  }
+  if (paths.empty() || (format != ResultFormat::FMT_TEXT && output.empty())) {
+    usage();
+    return 1;
+  }
+  ResultWriter *writer = new ResultWriter(format, output);
+  bool merged = mergeShards(paths, writer);
+  writer->close();
+  return merged ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+  if (argc >= 2 && std::string(argv[1]) == "merge") {
+    return merge(argc, argv);
+  }
+  if (argc >= 2 && std::string(argv[1]) == "convert") {
+    if (argc != 4) {
+      usage();
+      return 1;
+    }
+    return convertTrace(argv[2], argv[3]) ? 0 : 1;
+  }
+  // experiment from a spec file or from the command line of a mode
+  ExperimentSpec spec;
+  int first_option;
+  bool explore = argc >= 2 && std::string(argv[1]) == "explore";
+  if (argc >= 3 && (std::string(argv[1]) == "spec" || explore)) {
+    if (!loadSpec(argv[2], spec)) {
+      return 1;
+    }
+    first_option = 3;
+  } else if (argc >= 4 && std::string(argv[1]) == "trace-replay") {
+    uint64_t window;
+    if (!parseNumber(argv[3], window)) {
+      usage();
+      return 1;
+    }
+    defaultSpec(argv[1], window, 1, spec);
+    spec.trace = argv[2];
+    if (spec.window == 0) {
+      usage();
+      return 1;
+    }
+    first_option = 4;
+  } else if (argc >= 3 && std::string(argv[1]) == "stream-replay") {
+    defaultSpec(argv[1], 0, 1, spec);
+    spec.trace = argv[2];
+    first_option = 3;
+  } else if (argc >= 4) {
+    uint64_t max_branches, max_repeats;
+    if (!parseNumber(argv[2], max_branches) ||
+        !parseNumber(argv[3], max_repeats) ||
+        !defaultSpec(argv[1], max_branches, max_repeats, spec)) {
+      usage();
+      return 1;
+    }
+    // the weighted sums of the rare modes fit 64 bits up to a bound
+    if (rareMode(spec.mode) && spec.repeats > RARE_MAX_REPEATS) {
+      std::cerr << spec.mode << ": at most " << RARE_MAX_REPEATS
+                << " repeats" << std::endl;
+      return 1;
+    }
+    // the joint counts of the mutual-information modes are bounded
+    if (mutualInfoMode(spec.mode) &&
+        (spec.secrets == 0 || spec.secrets > LEAKAGE_MAX_SECRETS)) {
+      std::cerr << spec.mode << ": 1 to " << LEAKAGE_MAX_SECRETS
+                << " secrets" << std::endl;
+      return 1;
     }
+    first_option = 4;
   } else {
-    std::cout
-        << "Usage: ./branch-gauge [attack] [max_branches|max_pruning_sizes] "
-           "[max_repeats]"
-        << std::endl;
+    usage();
+    return 1;
+  }
+  // parse options
+  ResultFormat format = ResultFormat::FMT_TEXT;
+  std::string output = "";
+  std::string journal_path = "";
+  std::string cache_dir = "";
+  std::string status_path = "";
+  std::string record_path = "";
+  bool resume = false;
+  bool seeded = false;
+  uint64_t checkpoint = 60;
+  uint64_t status_interval = 10;
+  uint64_t jobs = 0;
+  for (int i = first_option; i < argc; i++) {
+    std::string option = argv[i];
+    if (option == "--resume") {
+      resume = true;
+    } else if (option == "--common-random") {
+      spec.common_random = true;
+    } else if (option == "--baseline") {
+      spec.baseline = true;
+    } else if (i + 1 == argc) {
+      usage();
+      return 1;
+    } else if (option == "--format" &&
+               ResultWriter::parseFormat(argv[i + 1], format)) {
+      i++;
+    } else if (option == "--output") {
+      output = argv[++i];
+    } else if (option == "--seed") {
+      RANDOM_SEED = std::stoull(argv[++i]);
+      seeded = true;
+    } else if (option == "--journal") {
+      journal_path = argv[++i];
+    } else if (option == "--cache") {
+      cache_dir = argv[++i];
+    } else if (option == "--checkpoint") {
+      checkpoint = std::stoull(argv[++i]);
+    } else if (option == "--status") {
+      status_path = argv[++i];
+    } else if (option == "--status-interval") {
+      status_interval = std::stoull(argv[++i]);
+    } else if (option == "--record") {
+      record_path = argv[++i];
+    } else if (option == "--jobs") {
+      jobs = std::stoull(argv[++i]);
+    } else if (option == "--tolerance") {
+      spec.leakage_tolerance = std::stoull(argv[++i]);
+    } else if (option == "--shard" &&
+               parseShard(argv[i + 1], SHARD_INDEX, SHARD_COUNT)) {
+      i++;
+    } else {
+      usage();
+      return 1;
+    }
+  }
+  if (format != ResultFormat::FMT_TEXT && output.empty()) {
+    usage();
+    return 1;
+  }
+  // shards are merged from their self-describing headers
+  if (SHARD_COUNT > 1 && format == ResultFormat::FMT_TEXT) {
+    usage();
+    return 1;
+  }
+  // a row of a tolerance ends at a different repeat in every shard, so the
+  // merged shards would not be the table of a single run
+  if (SHARD_COUNT > 1 && spec.leakage_tolerance > 0) {
+    std::cerr << "--tolerance cannot be combined with --shard" << std::endl;
+    return 1;
+  }
+  // a baseline trial depends on all trials before it, so its sweep cannot be
+  // resumed, cached or split, and its draws cannot be shared
+  if (spec.baseline &&
+      (!journal_path.empty() || !cache_dir.empty() || SHARD_COUNT > 1 ||
+       spec.common_random || explore)) {
+    std::cerr << "--baseline cannot be combined with --journal, --cache, "
+                 "--shard, --common-random or explore"
+              << std::endl;
+    return 1;
+  }
+  if (resume && journal_path.empty()) {
+    usage();
+    return 1;
+  }
+  // the cells of an exploration run in worker processes, which only share
+  // the result cache
+  if (explore && (!journal_path.empty() || !status_path.empty() ||
+                  !record_path.empty() || SHARD_COUNT > 1)) {
+    usage();
+    return 1;
+  }
+  // --seed overrides the seed of the spec, a resumed sweep continues with the
+  // seed of the interrupted run
+  if (!seeded && spec.seeded) {
+    RANDOM_SEED = spec.seed;
+  } else if (!seeded && resume) {
+    Journal::readSeed(journal_path, RANDOM_SEED);
+  }
+  ResultWriter *writer = new ResultWriter(format, output);
+  Journal *journal = nullptr;
+  if (!journal_path.empty()) {
+    journal = new Journal(journal_path, resume, checkpoint);
+  }
+  ResultCache *cache = nullptr;
+  if (!cache_dir.empty()) {
+    cache = new ResultCache(cache_dir);
+  }
+  Progress *progress = nullptr;
+  if (!status_path.empty()) {
+    progress = new Progress(status_path, status_interval);
+  }
+  if (!record_path.empty()) {
+#ifdef RECORDER
+    stream_recorder = new StreamRecorder(record_path);
+    if (!stream_recorder->open()) {
+      return 1;
+    }
+#else
+    std::cerr << "record: uncomment add_definitions(-DRECORDER) in "
+                 "CMakeLists.txt"
+              << std::endl;
+    return 1;
+#endif
+  }
+  bool known = explore ? runExplore(spec, writer, cache, jobs)
+                      : runSpec(spec, writer, journal, cache, progress);
+  writer->close();
+  if (stream_recorder != nullptr) {
+    stream_recorder->close();
+  }
+  if (progress != nullptr) {
+    progress->close();
+  }
+  if (explore) {
+    return known ? 0 : 1;
+  }
+  if (!known) {
+    // a trace that cannot be replayed has printed its error
+    if (spec.mode != "trace-replay" && spec.mode != "stream-replay") {
+      usage();
+    }
+    return 1;
   }
-}
\ No newline at end of file
+}
@@ -0,0 +1,640 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/predictors/BPUSet.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "include/utils/Counters.hpp"
+#include "include/utils/Scheduler.hpp"
+#include "include/utils/Sweep.hpp"
+
+BPUSet::BPUSet(const std::vector<uint64_t> &types, uint64_t counter_bits,
+               uint64_t counter_nums, uint64_t buffer_ways,
+               uint64_t buffer_sets, uint64_t addr_space,
+               ReplacementPolicy policy, const PHTConfig &pht,
+               const RekeyConfig &rekey, const CipherConfig &cipher,
+               const BTBConfig &btb, uint64_t domains, uint64_t offset_pht,
+               uint64_t offset_btb)
+    : types(types),
+      addr_mask(addrMask(addr_space)),
+      offset_pht(offset_pht),
+      offset_btb(offset_btb),
+      buffer_ways(buffer_ways),
+      btb_set_bits((uint64_t)std::log2(buffer_sets)) {
+  for (uint64_t type : types) {
+    // keys of the predictor
+    srand(deriveSeed(RANDOM_SEED, BPU_NAMES[type]));
+    switch (type) {
+      case BPUType::BPU_BaseBPU:
+        base_bpu = new BaseBPU(addr_space);
+        base_bpu->initPHT(counter_bits, counter_nums, offset_pht);
+        base_bpu->initBTB(buffer_ways, buffer_sets, offset_btb, policy);
+        base_bpu->initHistory(pht);
+        base_bpu->initLevels(btb);
+        break;
+      case BPUType::BPU_BSUP:
+        bsup = new BSUP(addr_space, domains);
+        bsup->initPHT(3, counter_nums, offset_pht);
+        bsup->initBTB(buffer_ways, buffer_sets, offset_btb, policy);
+        bsup->initHistory(pht);
+        bsup->initCipher(cipher);
+        bsup->initLevels(btb);
+        break;
+      case BPUType::BPU_XorBP:
+        xorbp = new XorBP(addr_space, domains);
+        xorbp->initPHT(counter_bits, counter_nums, offset_pht);
+        xorbp->initBTB(buffer_ways, buffer_sets, offset_btb, policy);
+        xorbp->initHistory(pht);
+        xorbp->initLevels(btb);
+        break;
+      case BPUType::BPU_NoisyXorBP:
+        noisyxorbp = new NoisyXorBP(addr_space, domains);
+        noisyxorbp->initPHT(counter_bits, counter_nums, offset_pht);
+        noisyxorbp->initBTB(buffer_ways, buffer_sets, offset_btb, policy);
+        noisyxorbp->initHistory(pht);
+        noisyxorbp->initRekey(rekey);
+        noisyxorbp->initCipher(cipher);
+        noisyxorbp->initLevels(btb);
+        break;
+      case BPUType::BPU_LSBP:
+        lsbp = new LSBP(addr_space, domains);
+        lsbp->initPHT(counter_bits, counter_nums, offset_pht);
+        lsbp->initBTB(buffer_ways, buffer_sets, offset_btb, policy);
+        lsbp->initHistory(pht);
+        lsbp->initCipher(cipher);
+        lsbp->initLevels(btb);
+        break;
+      case BPUType::BPU_STBPU:
+        stbpu = new STBPU(addr_space, domains);
+        stbpu->initPHT(counter_bits, counter_nums, offset_pht);
+        stbpu->initBTB(buffer_ways, buffer_sets, offset_btb, policy);
+        stbpu->initHistory(pht);
+        stbpu->initRekey(rekey);
+        stbpu->initCipher(cipher);
+        stbpu->initLevels(btb);
+        break;
+      case BPUType::BPU_HyBP:
+        hybp = new HyBP(addr_space, domains);
+        hybp->initPHT(counter_bits, counter_nums, offset_pht);
+        hybp->initBTB(buffer_ways, buffer_sets, offset_btb, policy);
+        hybp->initHistory(pht);
+        hybp->initRekey(rekey);
+        hybp->initCipher(cipher);
+        hybp->initLevels(btb);
+        break;
+    }
+  }
+#ifdef RANDOM_PID
+  srand(deriveSeed(RANDOM_SEED, "pid"));
+  attacker_pid = rand() & 0xFFFFFFFF;
+  victim_pid = rand() & 0xFFFFFFFF;
+#else
+  attacker_pid = ProcessorPID::PID_ATTACKER;
+  victim_pid = ProcessorPID::PID_VICTIM;
+#endif
+  pids = {attacker_pid, victim_pid};
+  for (uint64_t domain = NUM_ATTACK_DOMAINS; domain < domains; domain++) {
+#ifdef RANDOM_PID
+    pids.push_back(rand() & 0xFFFFFFFF);
+#else
+    pids.push_back(ProcessorPID::PID_TENANT + domain);
+#endif
+  }
+}
+
+BPUSet::~BPUSet() {
+  delete base_bpu;
+  delete bsup;
+  delete xorbp;
+  delete noisyxorbp;
+  delete lsbp;
+  delete stbpu;
+  delete hybp;
+  delete schedule;
+}
+
+void BPUSet::setSchedule(const AttackSchedule &schedule) {
+  delete this->schedule;
+  this->schedule = new AttackSchedule(schedule);
+}
+
+std::vector<uint64_t> BPUSet::allTypes() {
+  std::vector<uint64_t> types;
+  for (uint64_t type = 0; type < NUM_BPU_TYPES; type++) {
+    types.push_back(type);
+  }
+  return types;
+}
+
+bool BPUSet::parseType(const std::string &name, uint64_t &type) {
+  for (uint64_t i = 0; i < NUM_BPU_TYPES; i++) {
+    std::string bpu_name = BPU_NAMES[i];
+    if (name.size() == bpu_name.size() &&
+        std::equal(name.begin(), name.end(), bpu_name.begin(),
+                   [](char a, char b) { return tolower(a) == tolower(b); })) {
+      type = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<std::string> BPUSet::getNames() {
+  std::vector<std::string> names;
+  for (uint64_t type : types) {
+    names.push_back(BPU_NAMES[type]);
+  }
+  return names;
+}
+
+void BPUSet::reset(uint64_t type) {
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      base_bpu->reset();
+      break;
+    case BPUType::BPU_BSUP:
+      bsup->reset();
+      break;
+    case BPUType::BPU_XorBP:
+      xorbp->reset();
+      break;
+    case BPUType::BPU_NoisyXorBP:
+      noisyxorbp->reset();
+      break;
+    case BPUType::BPU_LSBP:
+      lsbp->reset();
+      break;
+    case BPUType::BPU_STBPU:
+      stbpu->reset();
+      break;
+    case BPUType::BPU_HyBP:
+      hybp->reset();
+      break;
+  }
+}
+
+void BPUSet::flush(uint64_t type) {
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      base_bpu->flush();
+      break;
+    case BPUType::BPU_BSUP:
+      bsup->flush();
+      break;
+    case BPUType::BPU_XorBP:
+      xorbp->flush();
+      break;
+    case BPUType::BPU_NoisyXorBP:
+      noisyxorbp->flush();
+      break;
+    case BPUType::BPU_LSBP:
+      lsbp->flush();
+      break;
+    case BPUType::BPU_STBPU:
+      stbpu->flush();
+      break;
+    case BPUType::BPU_HyBP:
+      hybp->flush();
+      break;
+  }
+}
+
+uint64_t BPUSet::getPHTOccupancy(uint64_t type) {
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->getPHTOccupancy();
+    case BPUType::BPU_BSUP:
+      return bsup->getPHTOccupancy();
+    case BPUType::BPU_XorBP:
+      return xorbp->getPHTOccupancy();
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->getPHTOccupancy();
+    case BPUType::BPU_LSBP:
+      return lsbp->getPHTOccupancy();
+    case BPUType::BPU_STBPU:
+      return stbpu->getPHTOccupancy();
+    default:
+      return hybp->getPHTOccupancy();
+  }
+}
+
+uint64_t BPUSet::getBTBOccupancy(uint64_t type) {
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->getBTBOccupancy();
+    case BPUType::BPU_BSUP:
+      return bsup->getBTBOccupancy();
+    case BPUType::BPU_XorBP:
+      return xorbp->getBTBOccupancy();
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->getBTBOccupancy();
+    case BPUType::BPU_LSBP:
+      return lsbp->getBTBOccupancy();
+    case BPUType::BPU_STBPU:
+      return stbpu->getBTBOccupancy();
+    default:
+      return hybp->getBTBOccupancy();
+  }
+}
+
+uint64_t BPUSet::getLookups(uint64_t type) {
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->getLookups();
+    case BPUType::BPU_BSUP:
+      return bsup->getLookups();
+    case BPUType::BPU_XorBP:
+      return xorbp->getLookups();
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->getLookups();
+    case BPUType::BPU_LSBP:
+      return lsbp->getLookups();
+    case BPUType::BPU_STBPU:
+      return stbpu->getLookups();
+    default:
+      return hybp->getLookups();
+  }
+}
+
+std::function<uint64_t(uint64_t)> BPUSet::lookupCounter() {
+  return [this](uint64_t index) { return getLookups(types[index]); };
+}
+
+uint64_t BPUSet::getPID(uint64_t domain) {
+  return pids[domain];
+}
+
+uint64_t BPUSet::getCounterBits(uint64_t type, uint64_t counter_bits) {
+  return type == BPUType::BPU_BSUP ? 3 : counter_bits;
+}
+
+bool BPUSet::lookupPHT(uint64_t type, uint64_t pc, bool taken,
+                       uint64_t domain) {
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->lookupPHT(pc, taken);
+    case BPUType::BPU_BSUP:
+      return bsup->lookupPHT(pc, taken, domain);
+    case BPUType::BPU_XorBP:
+      return xorbp->lookupPHT(pc, taken, domain);
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->lookupPHT(pc, taken, domain);
+    case BPUType::BPU_LSBP:
+      return lsbp->lookupPHT(pc, taken, getPID(domain), domain);
+    case BPUType::BPU_STBPU:
+      return stbpu->lookupPHT(pc, taken, domain);
+    default:
+      return hybp->lookupPHT(pc, taken, domain);
+  }
+}
+
+int BPUSet::lookupBTB(uint64_t type, uint64_t pc, uint64_t target,
+                      uint64_t domain) {
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->lookupBTB(pc, target);
+    case BPUType::BPU_BSUP:
+      return bsup->lookupBTB(pc, target, domain);
+    case BPUType::BPU_XorBP:
+      return xorbp->lookupBTB(pc, target, domain);
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->lookupBTB(pc, target, domain);
+    case BPUType::BPU_LSBP:
+      return lsbp->lookupBTB(pc, target, getPID(domain), domain);
+    case BPUType::BPU_STBPU:
+      return stbpu->lookupBTB(pc, target, domain);
+    default:
+      return hybp->lookupBTB(pc, target, domain);
+  }
+}
+
+int BPUSet::checkPHTSetCollision(uint64_t type, uint64_t addr1,
+                                 uint64_t domain1, uint64_t addr2,
+                                 uint64_t domain2) {
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->checkPHTSetCollision(addr1, addr2);
+    case BPUType::BPU_BSUP:
+      return bsup->checkPHTSetCollision(addr1, domain1, addr2, domain2);
+    case BPUType::BPU_XorBP:
+      return xorbp->checkPHTSetCollision(addr1, domain1, addr2, domain2);
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->checkPHTSetCollision(addr1, domain1, addr2, domain2);
+    case BPUType::BPU_LSBP:
+      return lsbp->checkPHTSetCollision(addr1, getPID(domain1), domain1, addr2,
+                                        getPID(domain2), domain2);
+    case BPUType::BPU_STBPU:
+      return stbpu->checkPHTSetCollision(addr1, domain1, addr2, domain2);
+    default:
+      return hybp->checkPHTSetCollision(addr1, domain1, addr2, domain2);
+  }
+}
+
+uint64_t BPUSet::getPHTSet(uint64_t type, uint64_t addr, uint64_t domain) {
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->getPHTSet(addr);
+    case BPUType::BPU_BSUP:
+      return bsup->getPHTSet(addr, domain);
+    case BPUType::BPU_XorBP:
+      return xorbp->getPHTSet(addr, domain);
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->getPHTSet(addr, domain);
+    case BPUType::BPU_LSBP:
+      return lsbp->getPHTSet(addr, getPID(domain), domain);
+    case BPUType::BPU_STBPU:
+      return stbpu->getPHTSet(addr, domain);
+    default:
+      return hybp->getPHTSet(addr, domain);
+  }
+}
+
+uint64_t BPUSet::getBTBSet(uint64_t type, uint64_t addr, uint64_t domain) {
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->getBTBSet(addr);
+    case BPUType::BPU_BSUP:
+      return bsup->getBTBSet(addr, domain);
+    case BPUType::BPU_XorBP:
+      return xorbp->getBTBSet(addr, domain);
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->getBTBSet(addr, domain);
+    case BPUType::BPU_LSBP:
+      return lsbp->getBTBSet(addr, getPID(domain), domain);
+    case BPUType::BPU_STBPU:
+      return stbpu->getBTBSet(addr, domain);
+    default:
+      return hybp->getBTBSet(addr, domain);
+  }
+}
+
+uint64_t BPUSet::getBTBLevel(uint64_t type, uint64_t addr, uint64_t domain) {
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->getBTBLevel(addr);
+    case BPUType::BPU_BSUP:
+      return bsup->getBTBLevel(addr, domain);
+    case BPUType::BPU_XorBP:
+      return xorbp->getBTBLevel(addr, domain);
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->getBTBLevel(addr, domain);
+    case BPUType::BPU_LSBP:
+      return lsbp->getBTBLevel(addr, getPID(domain), domain);
+    case BPUType::BPU_STBPU:
+      return stbpu->getBTBLevel(addr, domain);
+    default:
+      return hybp->getBTBLevel(addr, domain);
+  }
+}
+
+void BPUSet::getBTBLevels(uint64_t type, const std::vector<uint64_t> &addrs,
+                          uint64_t domain, std::vector<uint64_t> &levels) {
+  levels.resize(addrs.size());
+  for (uint64_t i = 0; i < addrs.size(); i++) {
+    levels[i] = getBTBLevel(type, addrs[i], domain);
+  }
+}
+
+void BPUSet::getPHTSets(uint64_t type, const std::vector<uint64_t> &addrs,
+                        uint64_t domain, std::vector<uint64_t> &sets) {
+  sets.resize(addrs.size());
+  if (type == BPUType::BPU_STBPU) {
+    stbpu->getPHTSets(addrs.data(), addrs.size(), domain, sets.data());
+    return;
+  }
+  for (uint64_t i = 0; i < addrs.size(); i++) {
+    sets[i] = getPHTSet(type, addrs[i], domain);
+  }
+}
+
+void BPUSet::getBTBSets(uint64_t type, const std::vector<uint64_t> &addrs,
+                        uint64_t domain, std::vector<uint64_t> &sets) {
+  sets.resize(addrs.size());
+  if (type == BPUType::BPU_STBPU) {
+    stbpu->getBTBSets(addrs.data(), addrs.size(), domain, sets.data());
+    return;
+  }
+  for (uint64_t i = 0; i < addrs.size(); i++) {
+    sets[i] = getBTBSet(type, addrs[i], domain);
+  }
+}
+
+std::pair<uint64_t, uint64_t> BPUSet::PHTTiming(uint64_t type,
+                                                uint64_t num_loops,
+                                                uint64_t counter_bits,
+                                                uint64_t victim_addr) {
+  COUNT_ATTACK(AttackKind::ATK_PHTTiming);
+  counter_bits = getCounterBits(type, counter_bits);
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->PHTTiming(num_loops, counter_bits, victim_addr);
+    case BPUType::BPU_BSUP:
+      return bsup->PHTTiming(num_loops, counter_bits, victim_addr);
+    case BPUType::BPU_XorBP:
+      return xorbp->PHTTiming(num_loops, counter_bits, victim_addr);
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->PHTTiming(num_loops, counter_bits, victim_addr);
+    case BPUType::BPU_LSBP:
+      return lsbp->PHTTiming(num_loops, counter_bits, victim_addr,
+                             attacker_pid, victim_pid);
+    case BPUType::BPU_STBPU:
+      return stbpu->PHTTiming(num_loops, counter_bits, victim_addr);
+    default:
+      return hybp->PHTTiming(num_loops, counter_bits, victim_addr);
+  }
+}
+
+std::pair<uint64_t, uint64_t> BPUSet::PHTSpeculative(uint64_t type,
+                                                     uint64_t num_loops,
+                                                     uint64_t counter_bits,
+                                                     uint64_t victim_addr) {
+  COUNT_ATTACK(AttackKind::ATK_PHTSpeculative);
+  counter_bits = getCounterBits(type, counter_bits);
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->PHTSpeculative(num_loops, counter_bits, victim_addr);
+    case BPUType::BPU_BSUP:
+      return bsup->PHTSpeculative(num_loops, counter_bits, victim_addr);
+    case BPUType::BPU_XorBP:
+      return xorbp->PHTSpeculative(num_loops, counter_bits, victim_addr);
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->PHTSpeculative(num_loops, counter_bits, victim_addr);
+    case BPUType::BPU_LSBP:
+      return lsbp->PHTSpeculative(num_loops, counter_bits, victim_addr,
+                                  attacker_pid, victim_pid);
+    case BPUType::BPU_STBPU:
+      return stbpu->PHTSpeculative(num_loops, counter_bits, victim_addr);
+    default:
+      return hybp->PHTSpeculative(num_loops, counter_bits, victim_addr);
+  }
+}
+
+std::pair<uint64_t, uint64_t> BPUSet::BTBTiming(uint64_t type,
+                                                uint64_t num_loops,
+                                                uint64_t victim_addr,
+                                                uint64_t target_addr) {
+  COUNT_ATTACK(AttackKind::ATK_BTBTiming);
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->BTBTiming(num_loops, victim_addr, target_addr);
+    case BPUType::BPU_BSUP:
+      return bsup->BTBTiming(num_loops, victim_addr, target_addr);
+    case BPUType::BPU_XorBP:
+      return xorbp->BTBTiming(num_loops, victim_addr, target_addr);
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->BTBTiming(num_loops, victim_addr, target_addr);
+    case BPUType::BPU_LSBP:
+      return lsbp->BTBTiming(num_loops, victim_addr, target_addr, victim_pid);
+    case BPUType::BPU_STBPU:
+      return stbpu->BTBTiming(num_loops, victim_addr, target_addr);
+    default:
+      return hybp->BTBTiming(num_loops, victim_addr, target_addr);
+  }
+}
+
+std::pair<uint64_t, uint64_t> BPUSet::BTBSpeculative(uint64_t type,
+                                                     uint64_t num_loops,
+                                                     uint64_t victim_addr,
+                                                     uint64_t target_addr,
+                                                     uint64_t covert_channel) {
+  COUNT_ATTACK(AttackKind::ATK_BTBSpeculative);
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->BTBSpeculative(num_loops, victim_addr, target_addr,
+                                      covert_channel);
+    case BPUType::BPU_BSUP:
+      return bsup->BTBSpeculative(num_loops, victim_addr, target_addr,
+                                  covert_channel);
+    case BPUType::BPU_XorBP:
+      return xorbp->BTBSpeculative(num_loops, victim_addr, target_addr,
+                                   covert_channel);
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->BTBSpeculative(num_loops, victim_addr, target_addr,
+                                        covert_channel);
+    case BPUType::BPU_LSBP:
+      return lsbp->BTBSpeculative(num_loops, victim_addr, target_addr,
+                                  covert_channel, victim_pid);
+    case BPUType::BPU_STBPU:
+      return stbpu->BTBSpeculative(num_loops, victim_addr, target_addr,
+                                   covert_channel);
+    default:
+      return hybp->BTBSpeculative(num_loops, victim_addr, target_addr,
+                                  covert_channel);
+  }
+}
+
+std::pair<std::vector<uint64_t>, uint64_t> BPUSet::BTBPrune(
+    uint64_t type, uint64_t num_loops, uint64_t victim_addr,
+    uint64_t prune_size, uint64_t eviction_size) {
+  COUNT_ATTACK(AttackKind::ATK_BTBPrune);
+  if (schedule != nullptr && schedule->enabled) {
+    return scheduledBTBPrune(type, num_loops, victim_addr, prune_size,
+                             eviction_size);
+  }
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->BTBPrune(num_loops, victim_addr, prune_size,
+                                eviction_size);
+    case BPUType::BPU_BSUP:
+      return bsup->BTBPrune(num_loops, victim_addr, prune_size, eviction_size);
+    case BPUType::BPU_XorBP:
+      return xorbp->BTBPrune(num_loops, victim_addr, prune_size, eviction_size);
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->BTBPrune(num_loops, victim_addr, prune_size,
+                                  eviction_size);
+    case BPUType::BPU_LSBP:
+      return lsbp->BTBPrune(num_loops, victim_addr, prune_size, eviction_size,
+                            attacker_pid, victim_pid);
+    case BPUType::BPU_STBPU:
+      return stbpu->BTBPrune(num_loops, victim_addr, prune_size, eviction_size);
+    default:
+      return hybp->BTBPrune(num_loops, victim_addr, prune_size, eviction_size);
+  }
+}
+
+std::pair<std::vector<uint64_t>, uint64_t> BPUSet::PHTOccupancy(
+    uint64_t type, uint64_t num_loops, uint64_t counter_bits,
+    uint64_t prune_size, uint64_t occupancy_size) {
+  COUNT_ATTACK(AttackKind::ATK_PHTOccupancy);
+  counter_bits = getCounterBits(type, counter_bits);
+  if (schedule != nullptr && schedule->enabled) {
+    return scheduledPHTOccupancy(type, num_loops, counter_bits, prune_size,
+                                 occupancy_size);
+  }
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->PHTOccupancy(num_loops, counter_bits, prune_size,
+                                    occupancy_size);
+    case BPUType::BPU_BSUP:
+      return bsup->PHTOccupancy(num_loops, counter_bits, prune_size,
+                                occupancy_size);
+    case BPUType::BPU_XorBP:
+      return xorbp->PHTOccupancy(num_loops, counter_bits, prune_size,
+                                 occupancy_size);
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->PHTOccupancy(num_loops, counter_bits, prune_size,
+                                      occupancy_size);
+    case BPUType::BPU_LSBP:
+      return lsbp->PHTOccupancy(num_loops, counter_bits, prune_size,
+                                occupancy_size, attacker_pid);
+    case BPUType::BPU_STBPU:
+      return stbpu->PHTOccupancy(num_loops, counter_bits, prune_size,
+                                 occupancy_size);
+    default:
+      return hybp->PHTOccupancy(num_loops, counter_bits, prune_size,
+                                occupancy_size);
+  }
+}
+
+std::pair<std::vector<uint64_t>, uint64_t> BPUSet::BTBOccupancy(
+    uint64_t type, uint64_t num_loops, uint64_t prune_size,
+    uint64_t occupancy_size) {
+  COUNT_ATTACK(AttackKind::ATK_BTBOccupancy);
+  if (schedule != nullptr && schedule->enabled) {
+    return scheduledBTBOccupancy(type, num_loops, prune_size, occupancy_size);
+  }
+  switch (type) {
+    case BPUType::BPU_BaseBPU:
+      return base_bpu->BTBOccupancy(num_loops, prune_size, occupancy_size);
+    case BPUType::BPU_BSUP:
+      return bsup->BTBOccupancy(num_loops, prune_size, occupancy_size);
+    case BPUType::BPU_XorBP:
+      return xorbp->BTBOccupancy(num_loops, prune_size, occupancy_size);
+    case BPUType::BPU_NoisyXorBP:
+      return noisyxorbp->BTBOccupancy(num_loops, prune_size, occupancy_size);
+    case BPUType::BPU_LSBP:
+      return lsbp->BTBOccupancy(num_loops, prune_size, occupancy_size,
+                                attacker_pid);
+    case BPUType::BPU_STBPU:
+      return stbpu->BTBOccupancy(num_loops, prune_size, occupancy_size);
+    default:
+      return hybp->BTBOccupancy(num_loops, prune_size, occupancy_size);
+  }
+}
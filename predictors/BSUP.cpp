@@ -25,16 +25,23 @@
 // =============================================================================
 #include "include/predictors/BSUP.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <vector>
 
+#include "include/utils/Cipher.hpp"
+#include "include/utils/Counters.hpp"
+#include "include/utils/Sweep.hpp"
+
 // init
 void BSUP::initPHT(uint64_t counter_bits, uint64_t counter_nums,
                    uint64_t offset_pht) {
   this->counter_bits = counter_bits;
   this->counter_nums = counter_nums;
   this->offset_pht = offset_pht;
+  pht_set_bits = (uint64_t)std::log2(counter_nums);
+  initCiphers(counter_ciphers, counter_bits);
   PHT_valid.resize(counter_nums, 0);
   PHT_counter.resize(counter_nums, 0);
 }
@@ -44,6 +51,7 @@ void BSUP::initBTB(uint64_t buffer_ways, uint64_t buffer_sets,
   this->buffer_ways = buffer_ways;
   this->buffer_sets = buffer_sets;
   this->offset_btb = offset_btb;
+  btb_set_bits = (uint64_t)std::log2(buffer_sets);
   this->buffer_replacement = buffer_replacement;
   BTB_valid.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, 0));
   BTB_src.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, -1));
@@ -51,52 +59,171 @@ void BSUP::initBTB(uint64_t buffer_ways, uint64_t buffer_sets,
   BTB_lru.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, 0));
 }
 
+void BSUP::initHistory(const PHTConfig &config) {
+  delete history;
+  history = HistoryPHT::create(config, counter_bits, counter_nums);
+}
+
+void BSUP::initLevels(const BTBConfig &config) {
+  delete btb_levels;
+  btb_levels = BTBHierarchy::create(config, buffer_ways, buffer_sets,
+                                    buffer_replacement);
+}
+
+void BSUP::initCipher(const CipherConfig &config) {
+  delete index_cipher;
+  index_cipher = BlockCipher::create(config);
+}
+
+void BSUP::reset() {
+  flush();
+  // the keyed BTB levels draw new keys with every reset
+  if (btb_levels != nullptr) {
+    btb_levels->rekey();
+  }
+}
+
+void BSUP::flush() {
+  if (history != nullptr) {
+    history->reset();
+  }
+  if (btb_levels != nullptr) {
+    btb_levels->flush();
+  }
+  std::fill(PHT_valid.begin(), PHT_valid.end(), 0);
+  std::fill(PHT_counter.begin(), PHT_counter.end(), 0);
+  for (uint64_t i = 0; i < buffer_sets; i++) {
+    std::fill(BTB_valid[i].begin(), BTB_valid[i].end(), 0);
+    std::fill(BTB_src[i].begin(), BTB_src[i].end(), -1);
+    std::fill(BTB_dest[i].begin(), BTB_dest[i].end(), -1);
+    std::fill(BTB_lru[i].begin(), BTB_lru[i].end(), 0);
+  }
+}
+
+uint64_t BSUP::getPHTOccupancy() {
+  if (history != nullptr) {
+    return history->getOccupancy();
+  }
+  return std::count(PHT_valid.begin(), PHT_valid.end(), 1);
+}
+
+uint64_t BSUP::getBTBOccupancy() {
+  if (btb_levels != nullptr) {
+    return btb_levels->getOccupancy();
+  }
+  uint64_t valid = 0;
+  for (uint64_t i = 0; i < buffer_sets; i++) {
+    valid += std::count(BTB_valid[i].begin(), BTB_valid[i].end(), 1);
+  }
+  return valid;
+}
+
+void BSUP::initCiphers(std::vector<LLBC> &ciphers, uint64_t width) {
+  ciphers.clear();
+  for (const DomainKeys &row : keys) {
+    ciphers.push_back(LLBC(row.content_key, width));
+  }
+}
+
 // encryption and decryption
-uint64_t BSUP::encrypt(uint64_t plain, uint64_t key) { return plain ^ key; }
+uint64_t BSUP::encrypt(uint64_t plain, uint64_t key) {
+  COUNT_EVENT(BPUType::BPU_BSUP, CounterEvent::EVT_CIPHER);
+  return plain ^ key;
+}
+
+uint64_t BSUP::decrypt(uint64_t cipher, uint64_t key) {
+  COUNT_EVENT(BPUType::BPU_BSUP, CounterEvent::EVT_CIPHER);
+  return cipher ^ key;
+}
+
+uint64_t BSUP::encryptCounter(uint64_t counter, uint64_t domain) {
+  COUNT_EVENT(BPUType::BPU_BSUP, CounterEvent::EVT_CIPHER);
+  return counter_ciphers[domain].encrypt(counter);
+}
 
-uint64_t BSUP::decrypt(uint64_t cipher, uint64_t key) { return cipher ^ key; }
+uint64_t BSUP::decryptCounter(uint64_t counter, uint64_t domain) {
+  COUNT_EVENT(BPUType::BPU_BSUP, CounterEvent::EVT_CIPHER);
+  return counter_ciphers[domain].decrypt(counter);
+}
+
+uint64_t BSUP::indexEncrypt(uint64_t plain, uint64_t domain) {
+  if (index_cipher == nullptr) {
+    return encrypt(plain, keys[domain].index_key);
+  }
+  COUNT_EVENT(BPUType::BPU_BSUP, CounterEvent::EVT_CIPHER);
+  return index_cipher->encrypt(plain, cipherKey(keys[domain].index_key));
+}
 
 // get set and tag in PHT and BTB
 uint64_t BSUP::getPHTSet(uint64_t pc, uint64_t domain) {
-  return encrypt(pc >> offset_pht, index_keys[domain]) % counter_nums;
+  return indexEncrypt(pc >> offset_pht, domain) % counter_nums;
 }
 
 uint64_t BSUP::getBTBSet(uint64_t pc, uint64_t domain) {
-  return encrypt(pc >> offset_btb, index_keys[domain]) % buffer_sets;
+  return indexEncrypt(pc >> offset_btb, domain) % buffer_sets;
 }
 
 uint64_t BSUP::getBTBTag(uint64_t src, uint64_t domain) {
-  return src >> offset_btb >> (int)std::log2(buffer_sets);
+  // the set of a cipher does not determine the set bits of the address, the
+  // tag keeps them
+  if (index_cipher != nullptr) {
+    return src >> offset_btb;
+  }
+  return src >> offset_btb >> btb_set_bits;
 }
 
 uint64_t BSUP::getBTBDest(uint64_t dest, uint64_t domain) {
-  // TODO: LLBC encryption, just simple XOR here
-  return encrypt(dest, content_keys[domain]);
+  COUNT_EVENT(BPUType::BPU_BSUP, CounterEvent::EVT_CIPHER);
+  return dest_ciphers[domain].encrypt(dest);
+}
+
+uint64_t BSUP::getBTBLevel(uint64_t pc, uint64_t domain) {
+  if (btb_levels == nullptr) {
+    return 0;
+  }
+  return btb_levels->getLevel(getBTBSet(pc, domain), getBTBTag(pc, domain));
+}
+
+void BSUP::getBTBDests(const uint64_t *dests, uint64_t count, uint64_t domain,
+                       uint64_t *encrypted) {
+  for (uint64_t i = 0; i < count; i++) {
+    COUNT_EVENT(BPUType::BPU_BSUP, CounterEvent::EVT_CIPHER);
+  }
+  dest_ciphers[domain].encryptBatch(dests, count, encrypted);
 }
 
 bool BSUP::lookupPHT(uint64_t pc, bool taken, uint64_t domain) {
   uint64_t index = getPHTSet(pc, domain);
+  COUNT_LOOKUP(BPUType::BPU_BSUP, CounterEvent::EVT_PHT_LOOKUP);
+  lookups++;
+  RECORD_PHT(pc, taken, domain);
+  if (history != nullptr) {
+    int outcome = history->lookup(index, taken);
+    COUNT_EVENT(BPUType::BPU_BSUP, phtEvent(outcome));
+    return outcome == 1;
+  }
   // get the highest bit
-  uint64_t counter = decrypt(PHT_counter[index], content_keys[domain]) &
-                     ((1ULL << counter_bits) - 1);
+  uint64_t counter = decryptCounter(PHT_counter[index], domain);
   bool prediction = counter >> (counter_bits - 1);
   if (PHT_valid[index] == 0) {
+    COUNT_EVENT(BPUType::BPU_BSUP, CounterEvent::EVT_PHT_INVALID);
     updatePHT(pc, taken, domain);
     return false;
   }
+  COUNT_EVENT(BPUType::BPU_BSUP, prediction == taken
+                                     ? CounterEvent::EVT_PHT_HIT
+                                     : CounterEvent::EVT_PHT_MISPREDICT);
   updatePHT(pc, taken, domain);
   return prediction == taken;
 }
 
 void BSUP::updatePHT(uint64_t pc, bool taken, uint64_t domain) {
   uint64_t index = getPHTSet(pc, domain);
-  uint64_t counter = decrypt(PHT_counter[index], content_keys[domain]) &
-                     ((1ULL << counter_bits) - 1);
+  uint64_t counter = decryptCounter(PHT_counter[index], domain);
   // check if the counter is valid
   if (PHT_valid[index] == 0) {
     PHT_valid[index] = 1;
-    PHT_counter[index] =
-        encrypt(taken, content_keys[domain]) & ((1ULL << counter_bits) - 1);
+    PHT_counter[index] = encryptCounter(taken, domain);
     return;
   }
   // update counter
@@ -111,12 +238,26 @@ void BSUP::updatePHT(uint64_t pc, bool taken, uint64_t domain) {
   } else if (counter >= (1ULL << counter_bits)) {
     counter = (1ULL << counter_bits) - 1;
   }
-  PHT_counter[index] =
-      encrypt(counter, content_keys[domain]) & ((1ULL << counter_bits) - 1);
+  PHT_counter[index] = encryptCounter(counter, domain);
 }
 
 int BSUP::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
   uint64_t index = getBTBSet(pc, domain);
+  COUNT_LOOKUP(BPUType::BPU_BSUP, CounterEvent::EVT_BTB_LOOKUP);
+  lookups++;
+  RECORD_BTB(pc, target, domain);
+  // the target is encrypted once per lookup, as by the hardware
+  uint64_t dest = getBTBDest(target, domain);
+  if (btb_levels != nullptr) {
+    int outcome = btb_levels->lookup(index, getBTBTag(pc, domain), dest);
+    uint64_t set;
+    if (outcome == -1 && btb_levels->evicted(set)) {
+      COUNT_EVICTION(BPUType::BPU_BSUP, set);
+    } else {
+      COUNT_EVENT(BPUType::BPU_BSUP, btbEvent(outcome));
+    }
+    return outcome;
+  }
   // update LRU
   for (uint64_t i = 0; i < buffer_ways; i++) {
     if (BTB_valid[index][i] == 1) {
@@ -128,13 +269,15 @@ int BSUP::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
     if (BTB_valid[index][i] == 1 &&
         BTB_src[index][i] == getBTBTag(pc, domain)) {
       // predicton state: $valid$
-      if (BTB_dest[index][i] == getBTBDest(target, domain)) {
-        updateBTB(pc, target, domain);
+      if (BTB_dest[index][i] == dest) {
+        COUNT_EVENT(BPUType::BPU_BSUP, CounterEvent::EVT_BTB_HIT);
+        writeBTB(index, i, dest);
         return 1;
       }
       // predicton state: $mispredict$
       else {
-        updateBTB(pc, target, domain);
+        COUNT_EVENT(BPUType::BPU_BSUP, CounterEvent::EVT_BTB_MISPREDICT);
+        writeBTB(index, i, dest);
         return 0;
       }
     }
@@ -142,9 +285,10 @@ int BSUP::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
   // predicton state: $invalid$
   for (uint64_t i = 0; i < buffer_ways; i++) {
     if (BTB_valid[index][i] == 0) {
+      COUNT_EVENT(BPUType::BPU_BSUP, CounterEvent::EVT_BTB_INVALID);
       BTB_valid[index][i] = 1;
       BTB_src[index][i] = getBTBTag(pc, domain);
-      updateBTB(pc, target, domain);
+      writeBTB(index, i, dest);
       return -1;
     }
   }
@@ -159,10 +303,11 @@ int BSUP::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
     }
   } else if (buffer_replacement == ReplacementPolicy::REPL_RANDOM) {
     // Random replacement
-    max_lru = rand() % buffer_ways;
+    max_lru = predictorRand() % buffer_ways;
   }
+  COUNT_EVICTION(BPUType::BPU_BSUP, index);
   BTB_src[index][max_lru] = getBTBTag(pc, domain);
-  updateBTB(pc, target, domain);
+  writeBTB(index, max_lru, dest);
   return -1;
 }
 
@@ -180,15 +325,23 @@ void BSUP::updateBTB(uint64_t pc, uint64_t target, uint64_t domain) {
   }
 }
 
+void BSUP::writeBTB(uint64_t index, uint64_t way, uint64_t dest) {
+  BTB_dest[index][way] = dest;
+  BTB_lru[index][way] = 0;
+}
+
 // regenerate branch address for test the correctness of the framework
 uint64_t BSUP::regenerateTagAddr(uint64_t set, uint64_t tag, uint64_t domain) {
-  uint64_t dectypted_set = decrypt(set, index_keys[domain]) % buffer_sets;
-  return ((tag << (int)std::log2(buffer_sets)) | dectypted_set) << offset_btb;
+  if (index_cipher != nullptr) {
+    return tag << offset_btb;
+  }
+  uint64_t dectypted_set = decrypt(set, keys[domain].index_key) % buffer_sets;
+  return ((tag << btb_set_bits) | dectypted_set) << offset_btb;
 }
 
 uint64_t BSUP::regenerateDestAddr(uint64_t dest, uint64_t domain) {
-  // TODO: LLBC encryption, just simple XOR here
-  return decrypt(dest, content_keys[domain]);
+  COUNT_EVENT(BPUType::BPU_BSUP, CounterEvent::EVT_CIPHER);
+  return dest_ciphers[domain].decrypt(dest);
 }
 
 int BSUP::checkPHTSetCollision(uint64_t addr1, uint64_t domain1, uint64_t addr2,
@@ -0,0 +1,263 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/predictors/BTBHierarchy.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "include/utils/Sweep.hpp"
+#include "include/utils/Utils.hpp"
+
+// index hash of a keyed level (the finalizer of splitmix64)
+static inline uint64_t mixLine(uint64_t set, uint64_t tag, uint64_t key) {
+  uint64_t x = set ^ tag * 0x9E3779B97F4A7C15ULL ^ key;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+std::string btbName(const BTBConfig &config) {
+  if (config.levels.empty()) {
+    return "single";
+  }
+  std::string name = BTB_INCLUSION_NAMES[config.inclusion];
+  for (const BTBLevelConfig &level : config.levels) {
+    name += "/" + std::to_string(level.sets) + "x" +
+            std::to_string(level.ways) + "-" +
+            (level.policy == ReplacementPolicy::REPL_RANDOM ? "random"
+                                                            : "lru");
+    if (level.keyed) {
+      name += "-keyed";
+    }
+  }
+  return name;
+}
+
+bool parseBTBInclusion(const std::string &name, uint64_t &inclusion) {
+  for (uint64_t i = 0; i < BTBInclusion::NUM_BTB_INCLUSIONS; i++) {
+    if (name == BTB_INCLUSION_NAMES[i]) {
+      inclusion = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool checkBTBConfig(const BTBConfig &config) {
+  if (config.levels.size() >= BTB_MAX_LEVELS ||
+      config.inclusion >= BTBInclusion::NUM_BTB_INCLUSIONS) {
+    return false;
+  }
+  for (const BTBLevelConfig &level : config.levels) {
+    if (level.sets == 0 || level.ways == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+BTBHierarchy::BTBHierarchy(const BTBConfig &config, uint64_t buffer_ways,
+                           uint64_t buffer_sets, ReplacementPolicy policy)
+    : inclusion(config.inclusion) {
+  for (const BTBLevelConfig &upper : config.levels) {
+    Level level;
+    level.sets = upper.sets;
+    level.ways = upper.ways;
+    level.policy = upper.policy;
+    level.keyed = upper.keyed;
+    level.key = upper.keyed ? drawKey() : 0;
+    levels.push_back(level);
+  }
+  Level last = {buffer_sets, buffer_ways, policy, false, 0, 0};
+  levels.push_back(last);
+  uint64_t size = 0;
+  for (Level &level : levels) {
+    level.base = size;
+    size += level.sets * level.ways;
+  }
+  entries.assign(size, Entry{0, 0, 0, 0, 0});
+}
+
+BTBHierarchy *BTBHierarchy::create(const BTBConfig &config,
+                                   uint64_t buffer_ways, uint64_t buffer_sets,
+                                   ReplacementPolicy policy) {
+  if (config.levels.empty()) {
+    return nullptr;
+  }
+  return new BTBHierarchy(config, buffer_ways, buffer_sets, policy);
+}
+
+uint64_t BTBHierarchy::drawKey() {
+  return (predictorRand() << 32) ^ predictorRand();
+}
+
+void BTBHierarchy::rekey() {
+  for (Level &level : levels) {
+    if (level.keyed) {
+      level.key = drawKey();
+    }
+  }
+  flush();
+}
+
+uint64_t BTBHierarchy::setBase(uint64_t level, uint64_t set,
+                               uint64_t tag) const {
+  const Level &current = levels[level];
+  uint64_t index = set;
+  if (current.keyed) {
+    index = mixLine(set, tag, current.key);
+  }
+  return current.base + index % current.sets * current.ways;
+}
+
+BTBHierarchy::Entry *BTBHierarchy::find(uint64_t level, uint64_t base,
+                                        uint64_t set, uint64_t tag) {
+  Entry *way = &entries[base];
+  for (uint64_t i = 0; i < levels[level].ways; i++, way++) {
+    if (way->epoch == epoch && way->tag == tag && way->set == set) {
+      return way;
+    }
+  }
+  return nullptr;
+}
+
+bool BTBHierarchy::insert(uint64_t level, uint64_t base, const Entry &line,
+                          Entry &victim) {
+  const Level &current = levels[level];
+  Entry *ways = &entries[base];
+  for (uint64_t i = 0; i < current.ways; i++) {
+    if (ways[i].epoch != epoch) {
+      ways[i] = line;
+      return false;
+    }
+  }
+  uint64_t way = 0;
+  if (current.policy == ReplacementPolicy::REPL_LRU) {
+    for (uint64_t i = 1; i < current.ways; i++) {
+      if (ways[i].stamp < ways[way].stamp) {
+        way = i;
+      }
+    }
+  } else {
+    way = predictorRand() % current.ways;
+  }
+  victim = ways[way];
+  ways[way] = line;
+  return true;
+}
+
+void BTBHierarchy::fill(uint64_t level, uint64_t base, const Entry &line) {
+  Entry victim;
+  if (!insert(level, base, line, victim)) {
+    return;
+  }
+  if (level + 1 == levels.size()) {
+    evicted_set = victim.set;
+  }
+  if (inclusion == BTBInclusion::BTB_INCLUSIVE) {
+    for (uint64_t upper = 0; upper < level; upper++) {
+      Entry *entry =
+          find(upper, setBase(upper, victim.set, victim.tag), victim.set,
+               victim.tag);
+      if (entry != nullptr) {
+        entry->epoch = 0;
+      }
+    }
+  }
+}
+
+int BTBHierarchy::lookup(uint64_t set, uint64_t tag, uint64_t dest) {
+  uint64_t count = levels.size();
+  evicted_set = -1;
+  stamp++;
+  // set of the line in every level, computed once
+  uint64_t bases[BTB_MAX_LEVELS];
+  Entry *entry = nullptr;
+  for (hit_level = 0; hit_level < count; hit_level++) {
+    bases[hit_level] = setBase(hit_level, set, tag);
+    entry = find(hit_level, bases[hit_level], set, tag);
+    if (entry != nullptr) {
+      break;
+    }
+  }
+  int outcome = -1;
+  if (entry != nullptr) {
+    outcome = entry->dest == dest ? 1 : 0;
+    entry->dest = dest;
+    entry->stamp = stamp;
+    // write a corrected target through to the copies below
+    if (outcome == 0 && inclusion != BTBInclusion::BTB_EXCLUSIVE) {
+      for (uint64_t level = hit_level + 1; level < count; level++) {
+        Entry *copy = find(level, setBase(level, set, tag), set, tag);
+        if (copy != nullptr) {
+          copy->dest = dest;
+        }
+      }
+    }
+    if (hit_level == 0) {
+      return outcome;
+    }
+  }
+  Entry line = {epoch, set, tag, dest, stamp};
+  if (inclusion != BTBInclusion::BTB_EXCLUSIVE) {
+    for (uint64_t level = 0; level < hit_level; level++) {
+      fill(level, bases[level], line);
+    }
+    return outcome;
+  }
+  // move the line to L0, the victims one level down
+  if (entry != nullptr) {
+    entry->epoch = 0;
+  }
+  Entry victim;
+  if (!insert(0, bases[0], line, victim)) {
+    return outcome;
+  }
+  for (uint64_t level = 1; level < count; level++) {
+    line = victim;
+    line.stamp = stamp;
+    if (!insert(level, setBase(level, line.set, line.tag), line, victim)) {
+      return outcome;
+    }
+  }
+  evicted_set = victim.set;
+  return outcome;
+}
+
+uint64_t BTBHierarchy::getLevel(uint64_t set, uint64_t tag) {
+  uint64_t level = 0;
+  while (level < levels.size() &&
+         find(level, setBase(level, set, tag), set, tag) == nullptr) {
+    level++;
+  }
+  return level;
+}
+
+uint64_t BTBHierarchy::getOccupancy() {
+  uint64_t valid = 0;
+  for (const Entry &entry : entries) {
+    valid += entry.epoch == epoch;
+  }
+  return valid;
+}
@@ -21,10 +21,13 @@
 // =============================================================================
 #include "include/predictors/BaseBPU.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <vector>
 
+#include "include/utils/Counters.hpp"
+#include "include/utils/Sweep.hpp"
 #include "include/utils/Utils.hpp"
 
 // init
@@ -33,6 +36,7 @@ void BaseBPU::initPHT(uint64_t counter_bits, uint64_t counter_nums,
   this->counter_bits = counter_bits;
   this->counter_nums = counter_nums;
   this->offset_pht = offset_pht;
+  pht_set_bits = (uint64_t)std::log2(counter_nums);
   PHT_valid.resize(counter_nums, 0);
   PHT_counter.resize(counter_nums, 0);
 }
@@ -43,6 +47,7 @@ void BaseBPU::initBTB(uint64_t buffer_ways, uint64_t buffer_sets,
   this->buffer_ways = buffer_ways;
   this->buffer_sets = buffer_sets;
   this->offset_btb = offset_btb;
+  btb_set_bits = (uint64_t)std::log2(buffer_sets);
   this->buffer_replacement = buffer_replacement;
   BTB_valid.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, 0));
   BTB_src.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, -1));
@@ -50,6 +55,60 @@ void BaseBPU::initBTB(uint64_t buffer_ways, uint64_t buffer_sets,
   BTB_lru.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, 0));
 }
 
+void BaseBPU::initHistory(const PHTConfig &config) {
+  delete history;
+  history = HistoryPHT::create(config, counter_bits, counter_nums);
+}
+
+void BaseBPU::initLevels(const BTBConfig &config) {
+  delete btb_levels;
+  btb_levels = BTBHierarchy::create(config, buffer_ways, buffer_sets,
+                                    buffer_replacement);
+}
+
+void BaseBPU::reset() {
+  flush();
+  // the keyed BTB levels draw new keys with every reset
+  if (btb_levels != nullptr) {
+    btb_levels->rekey();
+  }
+}
+
+void BaseBPU::flush() {
+  if (history != nullptr) {
+    history->reset();
+  }
+  if (btb_levels != nullptr) {
+    btb_levels->flush();
+  }
+  std::fill(PHT_valid.begin(), PHT_valid.end(), 0);
+  std::fill(PHT_counter.begin(), PHT_counter.end(), 0);
+  for (uint64_t i = 0; i < buffer_sets; i++) {
+    std::fill(BTB_valid[i].begin(), BTB_valid[i].end(), 0);
+    std::fill(BTB_src[i].begin(), BTB_src[i].end(), -1);
+    std::fill(BTB_dest[i].begin(), BTB_dest[i].end(), -1);
+    std::fill(BTB_lru[i].begin(), BTB_lru[i].end(), 0);
+  }
+}
+
+uint64_t BaseBPU::getPHTOccupancy() {
+  if (history != nullptr) {
+    return history->getOccupancy();
+  }
+  return std::count(PHT_valid.begin(), PHT_valid.end(), 1);
+}
+
+uint64_t BaseBPU::getBTBOccupancy() {
+  if (btb_levels != nullptr) {
+    return btb_levels->getOccupancy();
+  }
+  uint64_t valid = 0;
+  for (uint64_t i = 0; i < buffer_sets; i++) {
+    valid += std::count(BTB_valid[i].begin(), BTB_valid[i].end(), 1);
+  }
+  return valid;
+}
+
 // get set and tag in PHT and BTB
 uint64_t BaseBPU::getPHTSet(uint64_t pc) {
   return (pc >> offset_pht) % counter_nums;
@@ -60,19 +119,38 @@ uint64_t BaseBPU::getBTBSet(uint64_t pc) {
 }
 
 uint64_t BaseBPU::getBTBTag(uint64_t src) {
-  return src >> offset_btb >> (int)std::log2(buffer_sets);
+  return src >> offset_btb >> btb_set_bits;
 }
 
 uint64_t BaseBPU::getBTBDest(uint64_t dest) { return dest; }
 
+uint64_t BaseBPU::getBTBLevel(uint64_t pc) {
+  if (btb_levels == nullptr) {
+    return 0;
+  }
+  return btb_levels->getLevel(getBTBSet(pc), getBTBTag(pc));
+}
+
 bool BaseBPU::lookupPHT(uint64_t pc, bool taken) {
   uint64_t index = getPHTSet(pc);
+  COUNT_LOOKUP(BPUType::BPU_BaseBPU, CounterEvent::EVT_PHT_LOOKUP);
+  lookups++;
+  RECORD_PHT(pc, taken, phaseDomain());
+  if (history != nullptr) {
+    int outcome = history->lookup(index, taken);
+    COUNT_EVENT(BPUType::BPU_BaseBPU, phtEvent(outcome));
+    return outcome == 1;
+  }
   // get the highest bit
   bool prediction = PHT_counter[index] >> (counter_bits - 1);
   if (PHT_valid[index] == 0) {
+    COUNT_EVENT(BPUType::BPU_BaseBPU, CounterEvent::EVT_PHT_INVALID);
     updatePHT(pc, taken);
     return false;
   }
+  COUNT_EVENT(BPUType::BPU_BaseBPU, prediction == taken
+                                        ? CounterEvent::EVT_PHT_HIT
+                                        : CounterEvent::EVT_PHT_MISPREDICT);
   updatePHT(pc, taken);
   return prediction == taken;
 }
@@ -103,6 +181,20 @@ void BaseBPU::updatePHT(uint64_t pc, bool taken) {
 
 int BaseBPU::lookupBTB(uint64_t pc, uint64_t target) {
   uint64_t index = getBTBSet(pc);
+  COUNT_LOOKUP(BPUType::BPU_BaseBPU, CounterEvent::EVT_BTB_LOOKUP);
+  lookups++;
+  RECORD_BTB(pc, target, phaseDomain());
+  if (btb_levels != nullptr) {
+    int outcome =
+        btb_levels->lookup(index, getBTBTag(pc), getBTBDest(target));
+    uint64_t set;
+    if (outcome == -1 && btb_levels->evicted(set)) {
+      COUNT_EVICTION(BPUType::BPU_BaseBPU, set);
+    } else {
+      COUNT_EVENT(BPUType::BPU_BaseBPU, btbEvent(outcome));
+    }
+    return outcome;
+  }
   // update LRU
   for (uint64_t i = 0; i < buffer_ways; i++) {
     if (BTB_valid[index][i] == 1) {
@@ -114,11 +206,13 @@ int BaseBPU::lookupBTB(uint64_t pc, uint64_t target) {
     if (BTB_valid[index][i] == 1 && BTB_src[index][i] == getBTBTag(pc)) {
       // predicton state: $valid$
       if (BTB_dest[index][i] == getBTBDest(target)) {
+        COUNT_EVENT(BPUType::BPU_BaseBPU, CounterEvent::EVT_BTB_HIT);
         updateBTB(pc, target);
         return 1;
       }
       // predicton state: $mispredict$
       else {
+        COUNT_EVENT(BPUType::BPU_BaseBPU, CounterEvent::EVT_BTB_MISPREDICT);
         updateBTB(pc, target);
         return 0;
       }
@@ -127,6 +221,7 @@ int BaseBPU::lookupBTB(uint64_t pc, uint64_t target) {
   // predicton state: $invalid$
   for (uint64_t i = 0; i < buffer_ways; i++) {
     if (BTB_valid[index][i] == 0) {
+      COUNT_EVENT(BPUType::BPU_BaseBPU, CounterEvent::EVT_BTB_INVALID);
       BTB_valid[index][i] = 1;
       BTB_src[index][i] = getBTBTag(pc);
       updateBTB(pc, target);
@@ -144,8 +239,9 @@ int BaseBPU::lookupBTB(uint64_t pc, uint64_t target) {
     }
   } else if (buffer_replacement == ReplacementPolicy::REPL_RANDOM) {
     // Random replacement
-    max_lru = rand() % buffer_ways;
+    max_lru = predictorRand() % buffer_ways;
   }
+  COUNT_EVICTION(BPUType::BPU_BaseBPU, index);
   BTB_src[index][max_lru] = getBTBTag(pc);
   updateBTB(pc, target);
   return -1;
@@ -166,7 +262,7 @@ void BaseBPU::updateBTB(uint64_t pc, uint64_t target) {
 
 // regenerate branch address for test the correctness of the framework
 uint64_t BaseBPU::regenerateTagAddr(uint64_t set, uint64_t tag) {
-  return ((tag << (int)std::log2(buffer_sets)) | set) << offset_btb;
+  return ((tag << btb_set_bits) | set) << offset_btb;
 }
 
 uint64_t BaseBPU::regenerateDestAddr(uint64_t dest) { return dest; }
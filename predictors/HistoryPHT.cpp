@@ -0,0 +1,301 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/predictors/HistoryPHT.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// valid bit of a packed entry
+static const uint8_t ENTRY_VALID = 0x80;
+
+// the useful counters of TAGE are halved every 2^18 updates
+static const uint64_t TAGE_AGING_MASK = (1ULL << 18) - 1;
+
+std::string phtName(const PHTConfig &config) {
+  std::string name = PHT_MODEL_NAMES[config.model];
+  if (config.model == PHTModel::PHT_GSHARE ||
+      config.model == PHTModel::PHT_TOURNAMENT) {
+    name += "/h" + std::to_string(config.history);
+  } else if (config.model == PHTModel::PHT_TAGE) {
+    name += "/t" + std::to_string(config.tage_tables) + "/h" +
+            std::to_string(config.tage_min_history) + "-" +
+            std::to_string(config.tage_max_history) + "/tag" +
+            std::to_string(config.tage_tag_bits);
+  }
+  return name;
+}
+
+bool parsePHTModel(const std::string &name, uint64_t &model) {
+  for (uint64_t i = 0; i < PHTModel::NUM_PHT_MODELS; i++) {
+    if (name == PHT_MODEL_NAMES[i]) {
+      model = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool checkPHTConfig(const PHTConfig &config, uint64_t counter_bits,
+                    uint64_t counter_nums) {
+  if (config.model == PHTModel::PHT_BIMODAL) {
+    return true;
+  }
+  return config.model < PHTModel::NUM_PHT_MODELS && counter_bits > 0 &&
+         counter_bits <= 7 && (counter_nums & (counter_nums - 1)) == 0 &&
+         config.history > 0 && config.history <= PHT_MAX_HISTORY &&
+         config.tage_tables > 0 && config.tage_tables <= PHT_MAX_TABLES &&
+         config.tage_min_history > 0 &&
+         config.tage_min_history <= config.tage_max_history &&
+         config.tage_max_history <= PHT_MAX_HISTORY &&
+         config.tage_tag_bits > 0 && config.tage_tag_bits <= PHT_MAX_TAG_BITS;
+}
+
+void FoldedHistory::init(uint64_t length, uint64_t width) {
+  this->length = length;
+  this->width = std::max<uint64_t>(width, 1);
+  outpoint = length % this->width;
+  value = 0;
+}
+
+HistoryPHT::HistoryPHT(const PHTConfig &config, uint64_t counter_bits,
+                       uint64_t counter_nums)
+    : config(config), counter_bits(counter_bits), counter_nums(counter_nums) {
+  index_bits = (uint64_t)std::log2(counter_nums);
+  index_mask = counter_nums - 1;
+  uint64_t longest = config.model == PHTModel::PHT_TAGE
+                         ? config.tage_max_history
+                         : config.history;
+  uint64_t size = 1;
+  while (size <= longest) {
+    size <<= 1;
+  }
+  buffer.resize(size, 0);
+  mask = size - 1;
+  if (config.model == PHTModel::PHT_TAGE) {
+    base.resize(counter_nums, 0);
+    tage.resize(config.tage_tables * counter_nums, TageEntry{0, 0, 0});
+    tag_mask = (1ULL << config.tage_tag_bits) - 1;
+    // geometric history lengths
+    double growth = 1;
+    if (config.tage_tables > 1) {
+      growth = std::pow(
+          (double)config.tage_max_history / config.tage_min_history,
+          1.0 / (config.tage_tables - 1));
+    }
+    for (uint64_t t = 0; t < config.tage_tables; t++) {
+      uint64_t length = config.tage_tables == 1
+                            ? config.tage_max_history
+                            : (uint64_t)(config.tage_min_history *
+                                             std::pow(growth, t) +
+                                         0.5);
+      index_folds.emplace_back();
+      index_folds.back().init(length, index_bits);
+      tag_folds.emplace_back();
+      tag_folds.back().init(length, config.tage_tag_bits);
+    }
+  } else {
+    gshare.resize(counter_nums, 0);
+    gshare_fold.init(config.history, index_bits);
+    if (config.model == PHTModel::PHT_TOURNAMENT) {
+      base.resize(counter_nums, 0);
+      chooser.resize(counter_nums, 1);
+    }
+  }
+}
+
+HistoryPHT *HistoryPHT::create(const PHTConfig &config, uint64_t counter_bits,
+                               uint64_t counter_nums) {
+  if (config.model == PHTModel::PHT_BIMODAL) {
+    return nullptr;
+  }
+  return new HistoryPHT(config, counter_bits, counter_nums);
+}
+
+int HistoryPHT::lookupCounter(uint8_t &entry, bool taken) {
+  if ((entry & ENTRY_VALID) == 0) {
+    entry = ENTRY_VALID | taken;
+    return -1;
+  }
+  uint64_t counter = entry & ~ENTRY_VALID;
+  bool prediction = counter >> (counter_bits - 1);
+  // update counter
+  if (taken && counter < (1ULL << counter_bits) - 1) {
+    counter++;
+  } else if (!taken && counter > 0) {
+    counter--;
+  }
+  entry = ENTRY_VALID | counter;
+  return prediction == taken;
+}
+
+int HistoryPHT::lookupTournament(uint64_t set, bool taken) {
+  uint8_t &choice = chooser[set];
+  bool use_gshare = choice >= 2;
+  int bimodal_outcome = lookupCounter(base[set], taken);
+  int gshare_outcome =
+      lookupCounter(gshare[(set ^ gshare_fold.value) & index_mask], taken);
+  // train the chooser toward the component that was right
+  if (bimodal_outcome == 1 && gshare_outcome == 0 && choice > 0) {
+    choice--;
+  } else if (gshare_outcome == 1 && bimodal_outcome == 0 && choice < 3) {
+    choice++;
+  }
+  return use_gshare ? gshare_outcome : bimodal_outcome;
+}
+
+int HistoryPHT::lookupTAGE(uint64_t set, bool taken) {
+  int64_t tables = config.tage_tables;
+  // longest (provider) and second longest (alternate) matching tables
+  int64_t provider = -1;
+  int64_t alternate = -1;
+  for (int64_t t = tables - 1; t >= 0; t--) {
+    // the folds of the index and the tag have different widths, so two
+    // histories that alias in one rarely alias in the other
+    indices[t] =
+        t * counter_nums + ((set ^ index_folds[t].value) & index_mask);
+    tags[t] =
+        (set ^ tag_folds[t].value ^ (index_folds[t].value << 1)) & tag_mask;
+    // without branches, the matches follow the simulated history
+    const TageEntry &entry = tage[indices[t]];
+    bool hit = (entry.counter & ENTRY_VALID) && entry.tag == tags[t];
+    alternate = hit && provider >= 0 && alternate < 0 ? t : alternate;
+    provider = hit && provider < 0 ? t : provider;
+  }
+  int outcome;
+  if (provider < 0) {
+    outcome = lookupCounter(base[set], taken);
+  } else {
+    TageEntry &entry = tage[indices[provider]];
+    uint8_t counter = entry.counter & ~ENTRY_VALID;
+    bool prediction = counter >= 4;
+    bool alternate_prediction =
+        alternate >= 0
+            ? (tage[indices[alternate]].counter & ~ENTRY_VALID) >= 4
+            : (base[set] & ~ENTRY_VALID) >> (counter_bits - 1);
+    outcome = prediction == taken;
+    // the provider is useful if it overrides a wrong alternate prediction
+    if (prediction != alternate_prediction) {
+      if (outcome == 1 && entry.useful < 3) {
+        entry.useful++;
+      } else if (outcome == 0 && entry.useful > 0) {
+        entry.useful--;
+      }
+    }
+    if (taken && counter < 7) {
+      counter++;
+    } else if (!taken && counter > 0) {
+      counter--;
+    }
+    entry.counter = ENTRY_VALID | counter;
+  }
+  // on a mispredict allocate an entry with a longer history
+  if (outcome == 0 && provider < tables - 1) {
+    bool allocated = false;
+    for (int64_t t = provider + 1; t < tables && !allocated; t++) {
+      TageEntry &entry = tage[indices[t]];
+      if ((entry.counter & ENTRY_VALID) == 0 || entry.useful == 0) {
+        entry.tag = tags[t];
+        entry.counter = ENTRY_VALID | (taken ? 4 : 3);
+        entry.useful = 0;
+        allocated = true;
+      }
+    }
+    for (int64_t t = provider + 1; t < tables && !allocated; t++) {
+      TageEntry &entry = tage[indices[t]];
+      if (entry.useful > 0) {
+        entry.useful--;
+      }
+    }
+  }
+  // age the useful counters
+  if ((++updates & TAGE_AGING_MASK) == 0) {
+    for (TageEntry &entry : tage) {
+      entry.useful >>= 1;
+    }
+  }
+  return outcome;
+}
+
+void HistoryPHT::pushHistory(bool taken) {
+  head = (head - 1) & mask;
+  buffer[head] = taken;
+  if (config.model == PHTModel::PHT_TAGE) {
+    // local copies, the folds could alias the members for the compiler
+    uint64_t tables = config.tage_tables;
+    const uint8_t *bits = buffer.data();
+    FoldedHistory *index = index_folds.data();
+    FoldedHistory *tag = tag_folds.data();
+    for (uint64_t t = 0; t < tables; t++) {
+      uint64_t oldest = bits[(head + index[t].length) & mask];
+      index[t].update(taken, oldest);
+      tag[t].update(taken, oldest);
+    }
+  } else {
+    gshare_fold.update(taken, buffer[(head + gshare_fold.length) & mask]);
+  }
+}
+
+int HistoryPHT::lookup(uint64_t set, bool taken) {
+  int outcome;
+  switch (config.model) {
+    case PHTModel::PHT_GSHARE:
+      outcome = lookupCounter(gshare[(set ^ gshare_fold.value) & index_mask],
+                              taken);
+      break;
+    case PHTModel::PHT_TOURNAMENT:
+      outcome = lookupTournament(set, taken);
+      break;
+    default:
+      outcome = lookupTAGE(set, taken);
+      break;
+  }
+  pushHistory(taken);
+  return outcome;
+}
+
+void HistoryPHT::reset() {
+  std::fill(buffer.begin(), buffer.end(), 0);
+  head = 0;
+  std::fill(base.begin(), base.end(), 0);
+  std::fill(gshare.begin(), gshare.end(), 0);
+  std::fill(chooser.begin(), chooser.end(), 1);
+  gshare_fold.value = 0;
+  std::fill(tage.begin(), tage.end(), TageEntry{0, 0, 0});
+  for (uint64_t t = 0; t < index_folds.size(); t++) {
+    index_folds[t].value = 0;
+    tag_folds[t].value = 0;
+  }
+  updates = 0;
+}
+
+uint64_t HistoryPHT::getOccupancy() {
+  auto valid = [](uint8_t entry) { return (entry & ENTRY_VALID) != 0; };
+  uint64_t occupancy = std::count_if(base.begin(), base.end(), valid) +
+                       std::count_if(gshare.begin(), gshare.end(), valid);
+  for (const TageEntry &entry : tage) {
+    occupancy += valid(entry.counter);
+  }
+  return occupancy;
+}
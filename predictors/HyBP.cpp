@@ -26,11 +26,14 @@
 // =============================================================================
 #include "include/predictors/HyBP.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <vector>
 
-#include "include/utils/Qarma64.hpp"
+#include "include/utils/Cipher.hpp"
+#include "include/utils/Counters.hpp"
+#include "include/utils/Sweep.hpp"
 #include "include/utils/Utils.hpp"
 
 // init
@@ -39,6 +42,7 @@ void HyBP::initPHT(uint64_t counter_bits, uint64_t counter_nums,
   this->counter_bits = counter_bits;
   this->counter_nums = counter_nums;
   this->offset_pht = offset_pht;
+  pht_set_bits = (uint64_t)std::log2(counter_nums);
   PHT_valid.resize(counter_nums, 0);
   PHT_counter.resize(counter_nums, 0);
 }
@@ -48,6 +52,7 @@ void HyBP::initBTB(uint64_t buffer_ways, uint64_t buffer_sets,
   this->buffer_ways = buffer_ways;
   this->buffer_sets = buffer_sets;
   this->offset_btb = offset_btb;
+  btb_set_bits = (uint64_t)std::log2(buffer_sets);
   this->buffer_replacement = buffer_replacement;
   BTB_valid.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, 0));
   BTB_src.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, -1));
@@ -55,62 +60,184 @@ void HyBP::initBTB(uint64_t buffer_ways, uint64_t buffer_sets,
   BTB_lru.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, 0));
 }
 
+void HyBP::initHistory(const PHTConfig &config) {
+  delete history;
+  history = HistoryPHT::create(config, counter_bits, counter_nums);
+}
+
+void HyBP::initLevels(const BTBConfig &config) {
+  delete btb_levels;
+  btb_levels = BTBHierarchy::create(config, buffer_ways, buffer_sets,
+                                    buffer_replacement);
+}
+
+void HyBP::initRekey(const RekeyConfig &config) {
+  rekey.init(config);
+  initial_keys = keys;
+}
+
+void HyBP::initCipher(const CipherConfig &config) {
+  if (config.type == CipherType::CIPHER_NATIVE) {
+    return;
+  }
+  delete index_cipher;
+  index_cipher = BlockCipher::create(config);
+}
+
+void HyBP::redrawKeys() {
+  for (uint64_t domain = 0; domain < keys.size(); domain++) {
+    keys[domain].index_tweak = rekey.nextKey(addr_space);
+    keys[domain].index_w0 = rekey.nextKey(addr_space);
+    keys[domain].index_k0 = rekey.nextKey(addr_space);
+    keys[domain].content_key = rekey.nextKey(addr_space);
+  }
+  // the levels are indexed by the keyed set and tag, and rekeyed with it
+  if (btb_levels != nullptr) {
+    btb_levels->rekey();
+  }
+}
+
+void HyBP::reset() {
+  rekey.reset();
+  if (!initial_keys.empty()) {
+    keys = initial_keys;
+  }
+  flush();
+  // the keyed BTB levels draw new keys with every reset
+  if (btb_levels != nullptr) {
+    btb_levels->rekey();
+  }
+}
+
+void HyBP::flush() {
+  if (history != nullptr) {
+    history->reset();
+  }
+  if (btb_levels != nullptr) {
+    btb_levels->flush();
+  }
+  std::fill(PHT_valid.begin(), PHT_valid.end(), 0);
+  std::fill(PHT_counter.begin(), PHT_counter.end(), 0);
+  for (uint64_t i = 0; i < buffer_sets; i++) {
+    std::fill(BTB_valid[i].begin(), BTB_valid[i].end(), 0);
+    std::fill(BTB_src[i].begin(), BTB_src[i].end(), -1);
+    std::fill(BTB_dest[i].begin(), BTB_dest[i].end(), -1);
+    std::fill(BTB_lru[i].begin(), BTB_lru[i].end(), 0);
+  }
+}
+
+uint64_t HyBP::getPHTOccupancy() {
+  if (history != nullptr) {
+    return history->getOccupancy();
+  }
+  return std::count(PHT_valid.begin(), PHT_valid.end(), rekey.epoch);
+}
+
+uint64_t HyBP::getBTBOccupancy() {
+  if (btb_levels != nullptr) {
+    return btb_levels->getOccupancy();
+  }
+  uint64_t valid = 0;
+  for (uint64_t i = 0; i < buffer_sets; i++) {
+    valid += std::count(BTB_valid[i].begin(), BTB_valid[i].end(),
+                        rekey.epoch);
+  }
+  return valid;
+}
+
 // encryption and decryption
-uint64_t HyBP::encrypt(uint64_t plain, uint64_t key) { return plain ^ key; }
+uint64_t HyBP::encrypt(uint64_t plain, uint64_t key) {
+  COUNT_EVENT(BPUType::BPU_HyBP, CounterEvent::EVT_CIPHER);
+  return plain ^ key;
+}
 
-uint64_t HyBP::decrypt(uint64_t cipher, uint64_t key) { return cipher ^ key; }
+uint64_t HyBP::decrypt(uint64_t cipher, uint64_t key) {
+  COUNT_EVENT(BPUType::BPU_HyBP, CounterEvent::EVT_CIPHER);
+  return cipher ^ key;
+}
 
-uint64_t HyBP::qarma_encrypt(uint64_t plain, uint64_t domain) {
-  return qarma->qarma64_enc(plain, index_tweaks[domain], index_w0s[domain],
-                            index_k0s[domain], 1);
+uint64_t HyBP::indexEncrypt(uint64_t plain, uint64_t domain) {
+  COUNT_EVENT(BPUType::BPU_HyBP, CounterEvent::EVT_CIPHER);
+  const DomainKeys &row = keys[domain];
+  return index_cipher->encrypt(
+      plain, CipherKey{row.index_tweak, row.index_w0, row.index_k0});
 }
 
-uint64_t HyBP::qarma_decrypt(uint64_t cipher, uint64_t domain) {
-  return qarma->qarma64_dec(cipher, index_tweaks[domain], index_w0s[domain],
-                            index_k0s[domain], 1);
+uint64_t HyBP::indexDecrypt(uint64_t cipher, uint64_t domain) {
+  COUNT_EVENT(BPUType::BPU_HyBP, CounterEvent::EVT_CIPHER);
+  const DomainKeys &row = keys[domain];
+  return index_cipher->decrypt(
+      cipher, CipherKey{row.index_tweak, row.index_w0, row.index_k0});
 }
 
 // get set and tag in PHT and BTB
 uint64_t HyBP::getPHTSet(uint64_t pc, uint64_t domain) {
-  return qarma_encrypt(pc >> offset_pht, domain) % counter_nums;
+  return indexEncrypt(pc >> offset_pht, domain) % counter_nums;
 }
 
 uint64_t HyBP::getBTBSet(uint64_t pc, uint64_t domain) {
-  return qarma_encrypt(pc >> offset_btb, domain) % buffer_sets;
+  return indexEncrypt(pc >> offset_btb, domain) % buffer_sets;
 }
 
 uint64_t HyBP::getBTBTag(uint64_t src, uint64_t domain) {
-  return qarma_encrypt(src >> offset_btb, domain) >>
-         (int)std::log2(buffer_sets);
+  return indexEncrypt(src >> offset_btb, domain) >> btb_set_bits;
 }
 
 uint64_t HyBP::getBTBDest(uint64_t dest, uint64_t domain) {
-  return encrypt(dest, content_keys[domain]);
+  return encrypt(dest, keys[domain].content_key);
+}
+
+uint64_t HyBP::getBTBLevel(uint64_t pc, uint64_t domain) {
+  if (btb_levels == nullptr) {
+    return 0;
+  }
+  return btb_levels->getLevel(getBTBSet(pc, domain), getBTBTag(pc, domain));
 }
 
 bool HyBP::lookupPHT(uint64_t pc, bool taken, uint64_t domain) {
+  if (rekey.lookup(domain)) {
+    redrawKeys();
+  }
   uint64_t index = getPHTSet(pc, domain);
+  COUNT_LOOKUP(BPUType::BPU_HyBP, CounterEvent::EVT_PHT_LOOKUP);
+  lookups++;
+  RECORD_PHT(pc, taken, domain);
+  if (history != nullptr) {
+    int outcome = history->lookup(index, taken);
+    if (outcome == 0) {
+      rekey.mispredict();
+    }
+    COUNT_EVENT(BPUType::BPU_HyBP, phtEvent(outcome));
+    return outcome == 1;
+  }
   // get the highest bit
-  uint64_t counter = decrypt(PHT_counter[index], content_keys[domain]) &
+  uint64_t counter = decrypt(PHT_counter[index], keys[domain].content_key) &
                      ((1ULL << counter_bits) - 1);
   bool prediction = counter >> (counter_bits - 1);
-  if (PHT_valid[index] == 0) {
+  if (PHT_valid[index] != rekey.epoch) {
+    COUNT_EVENT(BPUType::BPU_HyBP, CounterEvent::EVT_PHT_INVALID);
     updatePHT(pc, taken, domain);
     return false;
   }
+  if (prediction != taken) {
+    rekey.mispredict();
+  }
+  COUNT_EVENT(BPUType::BPU_HyBP, prediction == taken
+                                     ? CounterEvent::EVT_PHT_HIT
+                                     : CounterEvent::EVT_PHT_MISPREDICT);
   updatePHT(pc, taken, domain);
   return prediction == taken;
 }
 
 void HyBP::updatePHT(uint64_t pc, bool taken, uint64_t domain) {
   uint64_t index = getPHTSet(pc, domain);
-  uint64_t counter = decrypt(PHT_counter[index], content_keys[domain]) &
+  uint64_t counter = decrypt(PHT_counter[index], keys[domain].content_key) &
                      ((1ULL << counter_bits) - 1);
   // check if the counter is valid
-  if (PHT_valid[index] == 0) {
-    PHT_valid[index] = 1;
+  if (PHT_valid[index] != rekey.epoch) {
+    PHT_valid[index] = rekey.epoch;
     PHT_counter[index] =
-        encrypt(taken, content_keys[domain]) & ((1ULL << counter_bits) - 1);
+        encrypt(taken, keys[domain].content_key) & ((1ULL << counter_bits) - 1);
     return;
   }
   // update counter
@@ -126,28 +253,52 @@ void HyBP::updatePHT(uint64_t pc, bool taken, uint64_t domain) {
     counter = (1ULL << counter_bits) - 1;
   }
   PHT_counter[index] =
-      encrypt(counter, content_keys[domain]) & ((1ULL << counter_bits) - 1);
+      encrypt(counter, keys[domain].content_key) & ((1ULL << counter_bits) - 1);
 }
 
 int HyBP::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
+  if (rekey.lookup(domain)) {
+    redrawKeys();
+  }
   uint64_t index = getBTBSet(pc, domain);
+  COUNT_LOOKUP(BPUType::BPU_HyBP, CounterEvent::EVT_BTB_LOOKUP);
+  lookups++;
+  RECORD_BTB(pc, target, domain);
+  if (btb_levels != nullptr) {
+    int outcome = btb_levels->lookup(index, getBTBTag(pc, domain),
+                                     getBTBDest(target, domain));
+    uint64_t set;
+    if (outcome == -1 && btb_levels->evicted(set)) {
+      COUNT_EVICTION(BPUType::BPU_HyBP, set);
+      rekey.mispredict();
+    } else {
+      COUNT_EVENT(BPUType::BPU_HyBP, btbEvent(outcome));
+    }
+    if (outcome == 0) {
+      rekey.mispredict();
+    }
+    return outcome;
+  }
   // update LRU
   for (uint64_t i = 0; i < buffer_ways; i++) {
-    if (BTB_valid[index][i] == 1) {
+    if (BTB_valid[index][i] == rekey.epoch) {
       BTB_lru[index][i]++;
     }
   }
   // check if the target is in the buffer
   for (uint64_t i = 0; i < buffer_ways; i++) {
-    if (BTB_valid[index][i] == 1 &&
+    if (BTB_valid[index][i] == rekey.epoch &&
         BTB_src[index][i] == getBTBTag(pc, domain)) {
       // predicton state: $valid$
       if (BTB_dest[index][i] == getBTBDest(target, domain)) {
+        COUNT_EVENT(BPUType::BPU_HyBP, CounterEvent::EVT_BTB_HIT);
         updateBTB(pc, target, domain);
         return 1;
       }
       // predicton state: $mispredict$
       else {
+        COUNT_EVENT(BPUType::BPU_HyBP, CounterEvent::EVT_BTB_MISPREDICT);
+        rekey.mispredict();
         updateBTB(pc, target, domain);
         return 0;
       }
@@ -155,8 +306,9 @@ int HyBP::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
   }
   // predicton state: $invalid$
   for (uint64_t i = 0; i < buffer_ways; i++) {
-    if (BTB_valid[index][i] == 0) {
-      BTB_valid[index][i] = 1;
+    if (BTB_valid[index][i] != rekey.epoch) {
+      COUNT_EVENT(BPUType::BPU_HyBP, CounterEvent::EVT_BTB_INVALID);
+      BTB_valid[index][i] = rekey.epoch;
       BTB_src[index][i] = getBTBTag(pc, domain);
       updateBTB(pc, target, domain);
       return -1;
@@ -173,8 +325,10 @@ int HyBP::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
     }
   } else if (buffer_replacement == ReplacementPolicy::REPL_RANDOM) {
     // Random replacement
-    max_lru = rand() % buffer_ways;
+    max_lru = predictorRand() % buffer_ways;
   }
+  COUNT_EVICTION(BPUType::BPU_HyBP, index);
+  rekey.mispredict();
   BTB_src[index][max_lru] = getBTBTag(pc, domain);
   updateBTB(pc, target, domain);
   return -1;
@@ -183,7 +337,7 @@ int HyBP::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
 void HyBP::updateBTB(uint64_t pc, uint64_t target, uint64_t domain) {
   uint64_t index = getBTBSet(pc, domain);
   for (uint64_t i = 0; i < buffer_ways; i++) {
-    if (BTB_valid[index][i] == 1 &&
+    if (BTB_valid[index][i] == rekey.epoch &&
         BTB_src[index][i] == getBTBTag(pc, domain)) {
       // update target
       BTB_dest[index][i] = getBTBDest(target, domain);
@@ -196,12 +350,12 @@ void HyBP::updateBTB(uint64_t pc, uint64_t target, uint64_t domain) {
 
 // regenerate branch address for test the correctness of the framework
 uint64_t HyBP::regenerateTagAddr(uint64_t set, uint64_t tag, uint64_t domain) {
-  uint64_t cipher = (tag << (int)std::log2(buffer_sets)) | set;
-  return qarma_decrypt(cipher, domain) << offset_btb;
+  uint64_t cipher = (tag << btb_set_bits) | set;
+  return indexDecrypt(cipher, domain) << offset_btb;
 }
 
 uint64_t HyBP::regenerateDestAddr(uint64_t dest, uint64_t domain) {
-  return decrypt(dest, content_keys[domain]);
+  return decrypt(dest, keys[domain].content_key);
 }
 
 int HyBP::checkPHTSetCollision(uint64_t addr1, uint64_t domain1, uint64_t addr2,
@@ -24,10 +24,14 @@
 // =============================================================================
 #include "include/predictors/LSBP.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <vector>
 
+#include "include/utils/Cipher.hpp"
+#include "include/utils/Counters.hpp"
+#include "include/utils/Sweep.hpp"
 #include "include/utils/Utils.hpp"
 
 // init
@@ -36,6 +40,7 @@ void LSBP::initPHT(uint64_t counter_bits, uint64_t counter_nums,
   this->counter_bits = counter_bits;
   this->counter_nums = counter_nums;
   this->offset_pht = offset_pht;
+  pht_set_bits = (uint64_t)std::log2(counter_nums);
   PHT_valid.resize(counter_nums, 0);
   PHT_counter.resize(counter_nums, 0);
 }
@@ -45,6 +50,7 @@ void LSBP::initBTB(uint64_t buffer_ways, uint64_t buffer_sets,
   this->buffer_ways = buffer_ways;
   this->buffer_sets = buffer_sets;
   this->offset_btb = offset_btb;
+  btb_set_bits = (uint64_t)std::log2(buffer_sets);
   this->buffer_replacement = buffer_replacement;
   BTB_valid.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, 0));
   BTB_src.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, -1));
@@ -52,33 +58,126 @@ void LSBP::initBTB(uint64_t buffer_ways, uint64_t buffer_sets,
   BTB_lru.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, 0));
 }
 
+void LSBP::initHistory(const PHTConfig &config) {
+  delete history;
+  history = HistoryPHT::create(config, counter_bits, counter_nums);
+}
+
+void LSBP::initLevels(const BTBConfig &config) {
+  delete btb_levels;
+  btb_levels = BTBHierarchy::create(config, buffer_ways, buffer_sets,
+                                    buffer_replacement);
+}
+
+void LSBP::initCipher(const CipherConfig &config) {
+  delete index_cipher;
+  index_cipher = BlockCipher::create(config);
+}
+
+void LSBP::reset() {
+  flush();
+  // the keyed BTB levels draw new keys with every reset
+  if (btb_levels != nullptr) {
+    btb_levels->rekey();
+  }
+}
+
+void LSBP::flush() {
+  if (history != nullptr) {
+    history->reset();
+  }
+  if (btb_levels != nullptr) {
+    btb_levels->flush();
+  }
+  std::fill(PHT_valid.begin(), PHT_valid.end(), 0);
+  std::fill(PHT_counter.begin(), PHT_counter.end(), 0);
+  for (uint64_t i = 0; i < buffer_sets; i++) {
+    std::fill(BTB_valid[i].begin(), BTB_valid[i].end(), 0);
+    std::fill(BTB_src[i].begin(), BTB_src[i].end(), -1);
+    std::fill(BTB_dest[i].begin(), BTB_dest[i].end(), -1);
+    std::fill(BTB_lru[i].begin(), BTB_lru[i].end(), 0);
+  }
+}
+
+uint64_t LSBP::getPHTOccupancy() {
+  if (history != nullptr) {
+    return history->getOccupancy();
+  }
+  return std::count(PHT_valid.begin(), PHT_valid.end(), 1);
+}
+
+uint64_t LSBP::getBTBOccupancy() {
+  if (btb_levels != nullptr) {
+    return btb_levels->getOccupancy();
+  }
+  uint64_t valid = 0;
+  for (uint64_t i = 0; i < buffer_sets; i++) {
+    valid += std::count(BTB_valid[i].begin(), BTB_valid[i].end(), 1);
+  }
+  return valid;
+}
+
 // encryption and decryption
-uint64_t LSBP::encrypt(uint64_t plain, uint64_t key) { return plain ^ key; }
+uint64_t LSBP::encrypt(uint64_t plain, uint64_t key) {
+  COUNT_EVENT(BPUType::BPU_LSBP, CounterEvent::EVT_CIPHER);
+  return plain ^ key;
+}
+
+uint64_t LSBP::decrypt(uint64_t cipher, uint64_t key) {
+  COUNT_EVENT(BPUType::BPU_LSBP, CounterEvent::EVT_CIPHER);
+  return cipher ^ key;
+}
 
-uint64_t LSBP::decrypt(uint64_t cipher, uint64_t key) { return cipher ^ key; }
+uint64_t LSBP::indexEncrypt(uint64_t plain, uint64_t domain) {
+  if (index_cipher == nullptr) {
+    return encrypt(plain, keys[domain].index_key);
+  }
+  COUNT_EVENT(BPUType::BPU_LSBP, CounterEvent::EVT_CIPHER);
+  return index_cipher->encrypt(plain, cipherKey(keys[domain].index_key));
+}
 
 // get set and tag in PHT and BTB
 uint64_t LSBP::getPHTSet(uint64_t pc, uint64_t pid, uint64_t domain) {
-  return encrypt(pc ^ pid, index_keys[domain]) % counter_nums;
+  return indexEncrypt(pc ^ pid, domain) % counter_nums;
 }
 
 uint64_t LSBP::getBTBSet(uint64_t pc, uint64_t pid, uint64_t domain) {
-  return encrypt(pc ^ pid, index_keys[domain]) % buffer_sets;
+  return indexEncrypt(pc ^ pid, domain) % buffer_sets;
 }
 
 uint64_t LSBP::getBTBTag(uint64_t src, uint64_t domain) { return src; }
 
 uint64_t LSBP::getBTBDest(uint64_t dest, uint64_t domain) { return dest; }
 
+uint64_t LSBP::getBTBLevel(uint64_t pc, uint64_t pid, uint64_t domain) {
+  if (btb_levels == nullptr) {
+    return 0;
+  }
+  return btb_levels->getLevel(getBTBSet(pc, pid, domain),
+                              getBTBTag(pc, domain));
+}
+
 bool LSBP::lookupPHT(uint64_t pc, bool taken, uint64_t pid, uint64_t domain) {
   uint64_t index = getPHTSet(pc, pid, domain);
+  COUNT_LOOKUP(BPUType::BPU_LSBP, CounterEvent::EVT_PHT_LOOKUP);
+  lookups++;
+  RECORD_PHT(pc, taken, domain);
+  if (history != nullptr) {
+    int outcome = history->lookup(index, taken);
+    COUNT_EVENT(BPUType::BPU_LSBP, phtEvent(outcome));
+    return outcome == 1;
+  }
   // get the highest bit
   uint64_t counter = PHT_counter[index];
   bool prediction = counter >> (counter_bits - 1);
   if (PHT_valid[index] == 0) {
+    COUNT_EVENT(BPUType::BPU_LSBP, CounterEvent::EVT_PHT_INVALID);
     updatePHT(pc, taken, pid, domain);
     return false;
   }
+  COUNT_EVENT(BPUType::BPU_LSBP, prediction == taken
+                                     ? CounterEvent::EVT_PHT_HIT
+                                     : CounterEvent::EVT_PHT_MISPREDICT);
   updatePHT(pc, taken, pid, domain);
   return prediction == taken;
 }
@@ -110,6 +209,20 @@ void LSBP::updatePHT(uint64_t pc, bool taken, uint64_t pid, uint64_t domain) {
 int LSBP::lookupBTB(uint64_t pc, uint64_t target, uint64_t pid,
                     uint64_t domain) {
   uint64_t index = getBTBSet(pc, pid, domain);
+  COUNT_LOOKUP(BPUType::BPU_LSBP, CounterEvent::EVT_BTB_LOOKUP);
+  lookups++;
+  RECORD_BTB(pc, target, domain);
+  if (btb_levels != nullptr) {
+    int outcome = btb_levels->lookup(index, getBTBTag(pc, domain),
+                                     getBTBDest(target, domain));
+    uint64_t set;
+    if (outcome == -1 && btb_levels->evicted(set)) {
+      COUNT_EVICTION(BPUType::BPU_LSBP, set);
+    } else {
+      COUNT_EVENT(BPUType::BPU_LSBP, btbEvent(outcome));
+    }
+    return outcome;
+  }
   // update LRU
   for (uint64_t i = 0; i < buffer_ways; i++) {
     if (BTB_valid[index][i] == 1) {
@@ -122,11 +235,13 @@ int LSBP::lookupBTB(uint64_t pc, uint64_t target, uint64_t pid,
         BTB_src[index][i] == getBTBTag(pc, domain)) {
       // predicton state: $valid$
       if (BTB_dest[index][i] == getBTBDest(target, domain)) {
+        COUNT_EVENT(BPUType::BPU_LSBP, CounterEvent::EVT_BTB_HIT);
         updateBTB(pc, target, pid, domain);
         return 1;
       }
       // predicton state: $mispredict$
       else {
+        COUNT_EVENT(BPUType::BPU_LSBP, CounterEvent::EVT_BTB_MISPREDICT);
         updateBTB(pc, target, pid, domain);
         return 0;
       }
@@ -135,6 +250,7 @@ int LSBP::lookupBTB(uint64_t pc, uint64_t target, uint64_t pid,
   // predicton state: $invalid$
   for (uint64_t i = 0; i < buffer_ways; i++) {
     if (BTB_valid[index][i] == 0) {
+      COUNT_EVENT(BPUType::BPU_LSBP, CounterEvent::EVT_BTB_INVALID);
       BTB_valid[index][i] = 1;
       BTB_src[index][i] = getBTBTag(pc, domain);
       updateBTB(pc, target, pid, domain);
@@ -152,8 +268,9 @@ int LSBP::lookupBTB(uint64_t pc, uint64_t target, uint64_t pid,
     }
   } else if (buffer_replacement == ReplacementPolicy::REPL_RANDOM) {
     // Random replacement
-    max_lru = rand() % buffer_ways;
+    max_lru = predictorRand() % buffer_ways;
   }
+  COUNT_EVICTION(BPUType::BPU_LSBP, index);
   BTB_src[index][max_lru] = getBTBTag(pc, domain);
   updateBTB(pc, target, pid, domain);
   return -1;
@@ -177,10 +294,14 @@ void LSBP::updateBTB(uint64_t pc, uint64_t target, uint64_t pid,
 // regenerate branch address for test the correctness of the framework
 uint64_t LSBP::regenerateTagAddr(uint64_t set, uint64_t tag, uint64_t pid,
                                  uint64_t domain) {
+  // the tag is the address
+  if (index_cipher != nullptr) {
+    return tag;
+  }
   uint64_t decrypted_set =
-      (decrypt(set, index_keys[domain]) ^ pid) % buffer_sets;
-  uint64_t partial_tag = tag >> (int)std::log2(buffer_sets);
-  return (partial_tag << (int)std::log2(buffer_sets)) | decrypted_set;
+      (decrypt(set, keys[domain].index_key) ^ pid) % buffer_sets;
+  uint64_t partial_tag = tag >> btb_set_bits;
+  return (partial_tag << btb_set_bits) | decrypted_set;
 }
 
 uint64_t LSBP::regenerateDestAddr(uint64_t dest, uint64_t pid,
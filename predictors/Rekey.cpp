@@ -0,0 +1,67 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/18
+// =============================================================================
+#include "include/predictors/Rekey.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#include "include/utils/Sweep.hpp"
+#include "include/utils/Utils.hpp"
+
+std::string rekeyName(const RekeyConfig &config) {
+  std::string name;
+  if (config.accesses != 0) {
+    name += "/a" + std::to_string(config.accesses);
+  }
+  if (config.mispredicts != 0) {
+    name += "/m" + std::to_string(config.mispredicts);
+  }
+  if (config.domain_switch) {
+    name += "/switch";
+  }
+  return name.empty() ? "none" : name.substr(1);
+}
+
+void RekeyEpochs::init(const RekeyConfig &config) {
+  this->config = config;
+  enabled = config.accesses != 0 || config.mispredicts != 0 ||
+            config.domain_switch;
+}
+
+uint64_t RekeyEpochs::nextKey(uint64_t addr_space) {
+  // splitmix64
+  uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z ^= z >> 31;
+  return z & addrMask(addr_space);
+}
+
+void RekeyEpochs::reset() {
+  accesses = 0;
+  mispredicts = 0;
+  last_domain = -1;
+  if (enabled) {
+    state = (predictorRand() << 32) ^ predictorRand();
+  }
+}
@@ -20,24 +20,108 @@
 // date: 2024/12/03
 // =============================================================================
 // STBPU is proposed in DSN 2022
-// Index  Encryption: PHT/pc+k0/hash, BTB/pc+k0/hash
-// Src    Encryption: PHT/pc+k0/hash, BTB/pc+k0/hash
-// Dest   Encryption: PHT/XOR/k1,     BTB/XOR/k1
+// Index  Encryption: PHT/pc+k0/remap, BTB/pc+k0/remap
+// Src    Encryption: PHT/pc+k0/remap, BTB/pc+k0/remap
+// Dest   Encryption: PHT/XOR/k1,      BTB/XOR/k1
 // =============================================================================
 #include "include/predictors/STBPU.hpp"
 
+#if defined(__AVX2__) || defined(__AVX512DQ__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <vector>
 
+#include "include/utils/Cipher.hpp"
+#include "include/utils/Counters.hpp"
+#include "include/utils/Sweep.hpp"
 #include "include/utils/Utils.hpp"
 
+// Remapping of the keyed address (keyedAddr) to the index and tag: a keyed
+// bijection of 64-bit words of two rounds of key XOR, multiplication by an
+// odd constant and xorshift (the finalizer of splitmix64), keyed by the
+// index hash and its halves swapped. Unlike a XOR, every index bit depends
+// on every address and key bit, and every step is invertible, so the address
+// of a (set, tag) pair is recovered exactly (regenerateTagAddr). A remap is
+// two multiplications, far below a QARMA-64 encryption.
+static const uint64_t REMAP_MUL_1 = 0xBF58476D1CE4E5B9ULL;
+static const uint64_t REMAP_MUL_2 = 0x94D049BB133111EBULL;
+
+// inverse of an odd multiplier mod 2^64 by Newton's iteration, every step
+// doubles the correct low bits (3 to start with)
+static constexpr uint64_t inverseOdd(uint64_t a) {
+  uint64_t x = a;
+  for (int i = 0; i < 5; i++) {
+    x *= 2 - a * x;
+  }
+  return x;
+}
+
+static const uint64_t REMAP_INV_1 = inverseOdd(REMAP_MUL_1);
+static const uint64_t REMAP_INV_2 = inverseOdd(REMAP_MUL_2);
+
+static inline uint64_t swapHalves(uint64_t key) {
+  return key << 32 | key >> 32;
+}
+
+static inline uint64_t remapWord(uint64_t x, uint64_t key) {
+  x ^= key;
+  x *= REMAP_MUL_1;
+  x ^= x >> 29;
+  x ^= swapHalves(key);
+  x *= REMAP_MUL_2;
+  x ^= x >> 32;
+  return x;
+}
+
+static inline uint64_t unmapWord(uint64_t x, uint64_t key) {
+  x ^= x >> 32;
+  x *= REMAP_INV_2;
+  x ^= swapHalves(key);
+  x ^= x >> 29 ^ x >> 58;
+  x *= REMAP_INV_1;
+  return x ^ key;
+}
+
+#if defined(__AVX512DQ__)
+static inline __m512i remapVector(__m512i x, __m512i key, __m512i swapped) {
+  x = _mm512_xor_si512(x, key);
+  x = _mm512_mullo_epi64(x, _mm512_set1_epi64(REMAP_MUL_1));
+  x = _mm512_xor_si512(x, _mm512_srli_epi64(x, 29));
+  x = _mm512_xor_si512(x, swapped);
+  x = _mm512_mullo_epi64(x, _mm512_set1_epi64(REMAP_MUL_2));
+  return _mm512_xor_si512(x, _mm512_srli_epi64(x, 32));
+}
+#elif defined(__AVX2__)
+// low 64 bits of the lane products, AVX2 multiplies 32-bit halves only
+static inline __m256i mullo64(__m256i a, __m256i b) {
+  __m256i low = _mm256_mul_epu32(a, b);
+  __m256i cross =
+      _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                       _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+  return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+}
+
+static inline __m256i remapVector(__m256i x, __m256i key, __m256i swapped) {
+  x = _mm256_xor_si256(x, key);
+  x = mullo64(x, _mm256_set1_epi64x(REMAP_MUL_1));
+  x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 29));
+  x = _mm256_xor_si256(x, swapped);
+  x = mullo64(x, _mm256_set1_epi64x(REMAP_MUL_2));
+  return _mm256_xor_si256(x, _mm256_srli_epi64(x, 32));
+}
+#endif
+
 // init
 void STBPU::initPHT(uint64_t counter_bits, uint64_t counter_nums,
                     uint64_t offset_pht) {
   this->counter_bits = counter_bits;
   this->counter_nums = counter_nums;
   this->offset_pht = offset_pht;
+  pht_set_bits = (uint64_t)std::log2(counter_nums);
   PHT_valid.resize(counter_nums, 0);
   PHT_counter.resize(counter_nums, 0);
 }
@@ -47,6 +131,7 @@ void STBPU::initBTB(uint64_t buffer_ways, uint64_t buffer_sets,
   this->buffer_ways = buffer_ways;
   this->buffer_sets = buffer_sets;
   this->offset_btb = offset_btb;
+  btb_set_bits = (uint64_t)std::log2(buffer_sets);
   this->buffer_replacement = buffer_replacement;
   BTB_valid.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, 0));
   BTB_src.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, -1));
@@ -54,58 +139,238 @@ void STBPU::initBTB(uint64_t buffer_ways, uint64_t buffer_sets,
   BTB_lru.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, 0));
 }
 
+void STBPU::initHistory(const PHTConfig &config) {
+  delete history;
+  history = HistoryPHT::create(config, counter_bits, counter_nums);
+}
+
+void STBPU::initLevels(const BTBConfig &config) {
+  delete btb_levels;
+  btb_levels = BTBHierarchy::create(config, buffer_ways, buffer_sets,
+                                    buffer_replacement);
+}
+
+void STBPU::initRekey(const RekeyConfig &config) {
+  rekey.init(config);
+  initial_keys = keys;
+}
+
+void STBPU::initCipher(const CipherConfig &config) {
+  delete index_cipher;
+  index_cipher = BlockCipher::create(config);
+}
+
+void STBPU::redrawKeys() {
+  for (uint64_t domain = 0; domain < keys.size(); domain++) {
+    keys[domain].index_key = rekey.nextKey(addr_space);
+    keys[domain].index_hash = rekey.nextKey(addr_space);
+    keys[domain].content_key = rekey.nextKey(addr_space);
+  }
+  // the levels are indexed by the keyed set and tag, and rekeyed with it
+  if (btb_levels != nullptr) {
+    btb_levels->rekey();
+  }
+}
+
+void STBPU::reset() {
+  rekey.reset();
+  if (!initial_keys.empty()) {
+    keys = initial_keys;
+  }
+  flush();
+  // the keyed BTB levels draw new keys with every reset
+  if (btb_levels != nullptr) {
+    btb_levels->rekey();
+  }
+}
+
+void STBPU::flush() {
+  if (history != nullptr) {
+    history->reset();
+  }
+  if (btb_levels != nullptr) {
+    btb_levels->flush();
+  }
+  std::fill(PHT_valid.begin(), PHT_valid.end(), 0);
+  std::fill(PHT_counter.begin(), PHT_counter.end(), 0);
+  for (uint64_t i = 0; i < buffer_sets; i++) {
+    std::fill(BTB_valid[i].begin(), BTB_valid[i].end(), 0);
+    std::fill(BTB_src[i].begin(), BTB_src[i].end(), -1);
+    std::fill(BTB_dest[i].begin(), BTB_dest[i].end(), -1);
+    std::fill(BTB_lru[i].begin(), BTB_lru[i].end(), 0);
+  }
+}
+
+uint64_t STBPU::getPHTOccupancy() {
+  if (history != nullptr) {
+    return history->getOccupancy();
+  }
+  return std::count(PHT_valid.begin(), PHT_valid.end(), rekey.epoch);
+}
+
+uint64_t STBPU::getBTBOccupancy() {
+  if (btb_levels != nullptr) {
+    return btb_levels->getOccupancy();
+  }
+  uint64_t valid = 0;
+  for (uint64_t i = 0; i < buffer_sets; i++) {
+    valid += std::count(BTB_valid[i].begin(), BTB_valid[i].end(),
+                        rekey.epoch);
+  }
+  return valid;
+}
+
 // encryption and decryption
-uint64_t STBPU::encrypt(uint64_t plain, uint64_t key) { return plain ^ key; }
+uint64_t STBPU::encrypt(uint64_t plain, uint64_t key) {
+  COUNT_EVENT(BPUType::BPU_STBPU, CounterEvent::EVT_CIPHER);
+  return plain ^ key;
+}
 
-uint64_t STBPU::decrypt(uint64_t cipher, uint64_t key) { return cipher ^ key; }
+uint64_t STBPU::decrypt(uint64_t cipher, uint64_t key) {
+  COUNT_EVENT(BPUType::BPU_STBPU, CounterEvent::EVT_CIPHER);
+  return cipher ^ key;
+}
+
+// the index key rotated above the address bits (the key shifted left by
+// addr_space up to 32 bits), so wider address spaces keep all key bits
+uint64_t STBPU::keyedAddr(uint64_t addr, uint64_t domain) {
+  uint64_t shift = addr_space % 64;
+  uint64_t key = keys[domain].index_key;
+  return addr ^ (shift == 0 ? key : key << shift | key >> (64 - shift));
+}
+
+uint64_t STBPU::remap(uint64_t addr, uint64_t domain) {
+  COUNT_EVENT(BPUType::BPU_STBPU, CounterEvent::EVT_CIPHER);
+  if (index_cipher != nullptr) {
+    return index_cipher->encrypt(keyedAddr(addr, domain),
+                                 cipherKey(keys[domain].index_hash));
+  }
+  return remapWord(keyedAddr(addr, domain), keys[domain].index_hash);
+}
+
+void STBPU::remapBatch(const uint64_t *addrs, uint64_t count, uint64_t domain,
+                       uint64_t *remapped) {
+  // the rotated index key is the keyed address of 0
+  uint64_t index_key = keyedAddr(0, domain);
+  uint64_t key = keys[domain].index_hash;
+  uint64_t i = 0;
+  // a cipher encrypts the keyed addresses in place (and skips the loops of
+  // the remapping below)
+  if (index_cipher != nullptr) {
+    for (; i < count; i++) {
+      remapped[i] = addrs[i] ^ index_key;
+    }
+    index_cipher->encryptBatch(remapped, count, cipherKey(key), remapped);
+  }
+#if defined(__AVX512DQ__)
+  __m512i lane_key = _mm512_set1_epi64(index_key ^ key);
+  __m512i lane_swapped = _mm512_set1_epi64(swapHalves(key));
+  for (; i + 8 <= count; i += 8) {
+    __m512i x = _mm512_loadu_si512((const void *)(addrs + i));
+    x = remapVector(x, lane_key, lane_swapped);
+    _mm512_storeu_si512((void *)(remapped + i), x);
+  }
+#elif defined(__AVX2__)
+  __m256i lane_key = _mm256_set1_epi64x(index_key ^ key);
+  __m256i lane_swapped = _mm256_set1_epi64x(swapHalves(key));
+  for (; i + 4 <= count; i += 4) {
+    __m256i x = _mm256_loadu_si256((const __m256i *)(addrs + i));
+    x = remapVector(x, lane_key, lane_swapped);
+    _mm256_storeu_si256((__m256i *)(remapped + i), x);
+  }
+#endif
+  for (; i < count; i++) {
+    remapped[i] = remapWord(addrs[i] ^ index_key, key);
+  }
+  for (i = 0; i < count; i++) {
+    COUNT_EVENT(BPUType::BPU_STBPU, CounterEvent::EVT_CIPHER);
+  }
+}
 
 // get set and tag in PHT and BTB
 uint64_t STBPU::getPHTSet(uint64_t pc, uint64_t domain) {
-  // TODO: hash function (just simple XOR here)
-  uint64_t plain = index_keys[domain] << addr_space | pc;
-  return encrypt(plain, index_hashes[domain]) % counter_nums;
+  return remap(pc, domain) % counter_nums;
 }
 
 uint64_t STBPU::getBTBSet(uint64_t pc, uint64_t domain) {
-  // TODO: hash function (just simple XOR here)
-  uint64_t plain = index_keys[domain] << addr_space | pc;
-  return encrypt(plain, index_hashes[domain]) % buffer_sets;
+  return remap(pc, domain) % buffer_sets;
 }
 
 uint64_t STBPU::getBTBTag(uint64_t src, uint64_t domain) {
-  // TODO: hash function (just simple XOR here)
-  uint64_t plain = index_keys[domain] << addr_space | src;
-  uint64_t cipher = encrypt(plain, index_hashes[domain]);
-  return cipher >> (int)std::log2(buffer_sets);
+  return remap(src, domain) >> btb_set_bits;
+}
+
+void STBPU::getPHTSets(const uint64_t *pcs, uint64_t count, uint64_t domain,
+                       uint64_t *sets) {
+  remapBatch(pcs, count, domain, sets);
+  for (uint64_t i = 0; i < count; i++) {
+    sets[i] %= counter_nums;
+  }
+}
+
+void STBPU::getBTBSets(const uint64_t *pcs, uint64_t count, uint64_t domain,
+                       uint64_t *sets) {
+  remapBatch(pcs, count, domain, sets);
+  for (uint64_t i = 0; i < count; i++) {
+    sets[i] %= buffer_sets;
+  }
 }
 
 uint64_t STBPU::getBTBDest(uint64_t dest, uint64_t domain) {
-  return encrypt(dest, content_keys[domain]);
+  return encrypt(dest, keys[domain].content_key);
+}
+
+uint64_t STBPU::getBTBLevel(uint64_t pc, uint64_t domain) {
+  if (btb_levels == nullptr) {
+    return 0;
+  }
+  return btb_levels->getLevel(getBTBSet(pc, domain), getBTBTag(pc, domain));
 }
 
 bool STBPU::lookupPHT(uint64_t pc, bool taken, uint64_t domain) {
+  if (rekey.lookup(domain)) {
+    redrawKeys();
+  }
   uint64_t index = getPHTSet(pc, domain);
+  COUNT_LOOKUP(BPUType::BPU_STBPU, CounterEvent::EVT_PHT_LOOKUP);
+  lookups++;
+  RECORD_PHT(pc, taken, domain);
+  if (history != nullptr) {
+    int outcome = history->lookup(index, taken);
+    if (outcome == 0) {
+      rekey.mispredict();
+    }
+    COUNT_EVENT(BPUType::BPU_STBPU, phtEvent(outcome));
+    return outcome == 1;
+  }
   // get the highest bit
-  uint64_t counter = decrypt(PHT_counter[index], content_keys[domain]) &
+  uint64_t counter = decrypt(PHT_counter[index], keys[domain].content_key) &
                      ((1ULL << counter_bits) - 1);
   bool prediction = counter >> (counter_bits - 1);
-  if (PHT_valid[index] == 0) {
+  if (PHT_valid[index] != rekey.epoch) {
+    COUNT_EVENT(BPUType::BPU_STBPU, CounterEvent::EVT_PHT_INVALID);
     updatePHT(pc, taken, domain);
     return false;
   }
+  if (prediction != taken) {
+    rekey.mispredict();
+  }
+  COUNT_EVENT(BPUType::BPU_STBPU, prediction == taken
+                                      ? CounterEvent::EVT_PHT_HIT
+                                      : CounterEvent::EVT_PHT_MISPREDICT);
   updatePHT(pc, taken, domain);
   return prediction == taken;
 }
 
 void STBPU::updatePHT(uint64_t pc, bool taken, uint64_t domain) {
   uint64_t index = getPHTSet(pc, domain);
-  uint64_t counter = decrypt(PHT_counter[index], content_keys[domain]) &
+  uint64_t counter = decrypt(PHT_counter[index], keys[domain].content_key) &
                      ((1ULL << counter_bits) - 1);
   // check if the counter is valid
-  if (PHT_valid[index] == 0) {
-    PHT_valid[index] = 1;
+  if (PHT_valid[index] != rekey.epoch) {
+    PHT_valid[index] = rekey.epoch;
     PHT_counter[index] =
-        encrypt(taken, content_keys[domain]) & ((1ULL << counter_bits) - 1);
+        encrypt(taken, keys[domain].content_key) & ((1ULL << counter_bits) - 1);
     return;
   }
   // update counter
@@ -121,28 +386,52 @@ void STBPU::updatePHT(uint64_t pc, bool taken, uint64_t domain) {
     counter = (1ULL << counter_bits) - 1;
   }
   PHT_counter[index] =
-      encrypt(counter, content_keys[domain]) & ((1ULL << counter_bits) - 1);
+      encrypt(counter, keys[domain].content_key) & ((1ULL << counter_bits) - 1);
 }
 
 int STBPU::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
+  if (rekey.lookup(domain)) {
+    redrawKeys();
+  }
   uint64_t index = getBTBSet(pc, domain);
+  COUNT_LOOKUP(BPUType::BPU_STBPU, CounterEvent::EVT_BTB_LOOKUP);
+  lookups++;
+  RECORD_BTB(pc, target, domain);
+  if (btb_levels != nullptr) {
+    int outcome = btb_levels->lookup(index, getBTBTag(pc, domain),
+                                     getBTBDest(target, domain));
+    uint64_t set;
+    if (outcome == -1 && btb_levels->evicted(set)) {
+      COUNT_EVICTION(BPUType::BPU_STBPU, set);
+      rekey.mispredict();
+    } else {
+      COUNT_EVENT(BPUType::BPU_STBPU, btbEvent(outcome));
+    }
+    if (outcome == 0) {
+      rekey.mispredict();
+    }
+    return outcome;
+  }
   // update LRU
   for (uint64_t i = 0; i < buffer_ways; i++) {
-    if (BTB_valid[index][i] == 1) {
+    if (BTB_valid[index][i] == rekey.epoch) {
       BTB_lru[index][i]++;
     }
   }
   // check if the target is in the buffer
   for (uint64_t i = 0; i < buffer_ways; i++) {
-    if (BTB_valid[index][i] == 1 &&
+    if (BTB_valid[index][i] == rekey.epoch &&
         BTB_src[index][i] == getBTBTag(pc, domain)) {
       // predicton state: $valid$
       if (BTB_dest[index][i] == getBTBDest(target, domain)) {
+        COUNT_EVENT(BPUType::BPU_STBPU, CounterEvent::EVT_BTB_HIT);
         updateBTB(pc, target, domain);
         return 1;
       }
       // predicton state: $mispredict$
       else {
+        COUNT_EVENT(BPUType::BPU_STBPU, CounterEvent::EVT_BTB_MISPREDICT);
+        rekey.mispredict();
         updateBTB(pc, target, domain);
         return 0;
       }
@@ -150,8 +439,9 @@ int STBPU::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
   }
   // predicton state: $invalid$
   for (uint64_t i = 0; i < buffer_ways; i++) {
-    if (BTB_valid[index][i] == 0) {
-      BTB_valid[index][i] = 1;
+    if (BTB_valid[index][i] != rekey.epoch) {
+      COUNT_EVENT(BPUType::BPU_STBPU, CounterEvent::EVT_BTB_INVALID);
+      BTB_valid[index][i] = rekey.epoch;
       BTB_src[index][i] = getBTBTag(pc, domain);
       updateBTB(pc, target, domain);
       return -1;
@@ -168,8 +458,10 @@ int STBPU::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
     }
   } else if (buffer_replacement == ReplacementPolicy::REPL_RANDOM) {
     // Random replacement
-    max_lru = rand() % buffer_ways;
+    max_lru = predictorRand() % buffer_ways;
   }
+  COUNT_EVICTION(BPUType::BPU_STBPU, index);
+  rekey.mispredict();
   BTB_src[index][max_lru] = getBTBTag(pc, domain);
   updateBTB(pc, target, domain);
   return -1;
@@ -178,7 +470,7 @@ int STBPU::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
 void STBPU::updateBTB(uint64_t pc, uint64_t target, uint64_t domain) {
   uint64_t index = getBTBSet(pc, domain);
   for (uint64_t i = 0; i < buffer_ways; i++) {
-    if (BTB_valid[index][i] == 1 &&
+    if (BTB_valid[index][i] == rekey.epoch &&
         BTB_src[index][i] == getBTBTag(pc, domain)) {
       // update target
       BTB_dest[index][i] = getBTBDest(target, domain);
@@ -191,14 +483,17 @@ void STBPU::updateBTB(uint64_t pc, uint64_t target, uint64_t domain) {
 
 // regenerate branch address for test the correctness of the framework
 uint64_t STBPU::regenerateTagAddr(uint64_t set, uint64_t tag, uint64_t domain) {
-  // TODO: hash function (just simple XOR here)
-  uint64_t cipher = (tag << (int)std::log2(buffer_sets)) | set;
-  uint64_t plain = decrypt(cipher, index_hashes[domain]);
-  return plain & ((1ULL << addr_space) - 1);
+  // the remapping is a bijection, the tag keeps all bits above the set
+  uint64_t cipher = (tag << btb_set_bits) | set;
+  uint64_t plain =
+      index_cipher != nullptr
+          ? index_cipher->decrypt(cipher, cipherKey(keys[domain].index_hash))
+          : unmapWord(cipher, keys[domain].index_hash);
+  return keyedAddr(plain, domain) & addr_mask;
 }
 
 uint64_t STBPU::regenerateDestAddr(uint64_t dest, uint64_t domain) {
-  return decrypt(dest, content_keys[domain]);
+  return decrypt(dest, keys[domain].content_key);
 }
 
 int STBPU::checkPHTSetCollision(uint64_t addr1, uint64_t domain1,
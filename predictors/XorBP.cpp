@@ -25,10 +25,13 @@
 // =============================================================================
 #include "include/predictors/XorBP.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <vector>
 
+#include "include/utils/Counters.hpp"
+#include "include/utils/Sweep.hpp"
 #include "include/utils/Utils.hpp"
 
 // init
@@ -37,6 +40,7 @@ void XorBP::initPHT(uint64_t counter_bits, uint64_t counter_nums,
   this->counter_bits = counter_bits;
   this->counter_nums = counter_nums;
   this->offset_pht = offset_pht;
+  pht_set_bits = (uint64_t)std::log2(counter_nums);
   PHT_valid.resize(counter_nums, 0);
   PHT_counter.resize(counter_nums, 0);
 }
@@ -46,6 +50,8 @@ void XorBP::initBTB(uint64_t buffer_ways, uint64_t buffer_sets,
   this->buffer_ways = buffer_ways;
   this->buffer_sets = buffer_sets;
   this->offset_btb = offset_btb;
+  btb_set_bits = (uint64_t)std::log2(buffer_sets);
+  btb_tag_mask = addr_mask >> offset_btb >> btb_set_bits;
   this->buffer_replacement = buffer_replacement;
   BTB_valid.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, 0));
   BTB_src.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, -1));
@@ -53,10 +59,70 @@ void XorBP::initBTB(uint64_t buffer_ways, uint64_t buffer_sets,
   BTB_lru.resize(buffer_sets, std::vector<uint64_t>(buffer_ways, 0));
 }
 
+void XorBP::initHistory(const PHTConfig &config) {
+  delete history;
+  history = HistoryPHT::create(config, counter_bits, counter_nums);
+}
+
+void XorBP::initLevels(const BTBConfig &config) {
+  delete btb_levels;
+  btb_levels = BTBHierarchy::create(config, buffer_ways, buffer_sets,
+                                    buffer_replacement);
+}
+
+void XorBP::reset() {
+  flush();
+  // the keyed BTB levels draw new keys with every reset
+  if (btb_levels != nullptr) {
+    btb_levels->rekey();
+  }
+}
+
+void XorBP::flush() {
+  if (history != nullptr) {
+    history->reset();
+  }
+  if (btb_levels != nullptr) {
+    btb_levels->flush();
+  }
+  std::fill(PHT_valid.begin(), PHT_valid.end(), 0);
+  std::fill(PHT_counter.begin(), PHT_counter.end(), 0);
+  for (uint64_t i = 0; i < buffer_sets; i++) {
+    std::fill(BTB_valid[i].begin(), BTB_valid[i].end(), 0);
+    std::fill(BTB_src[i].begin(), BTB_src[i].end(), -1);
+    std::fill(BTB_dest[i].begin(), BTB_dest[i].end(), -1);
+    std::fill(BTB_lru[i].begin(), BTB_lru[i].end(), 0);
+  }
+}
+
+uint64_t XorBP::getPHTOccupancy() {
+  if (history != nullptr) {
+    return history->getOccupancy();
+  }
+  return std::count(PHT_valid.begin(), PHT_valid.end(), 1);
+}
+
+uint64_t XorBP::getBTBOccupancy() {
+  if (btb_levels != nullptr) {
+    return btb_levels->getOccupancy();
+  }
+  uint64_t valid = 0;
+  for (uint64_t i = 0; i < buffer_sets; i++) {
+    valid += std::count(BTB_valid[i].begin(), BTB_valid[i].end(), 1);
+  }
+  return valid;
+}
+
 // encryption and decryption
-uint64_t XorBP::encrypt(uint64_t plain, uint64_t key) { return plain ^ key; }
+uint64_t XorBP::encrypt(uint64_t plain, uint64_t key) {
+  COUNT_EVENT(BPUType::BPU_XorBP, CounterEvent::EVT_CIPHER);
+  return plain ^ key;
+}
 
-uint64_t XorBP::decrypt(uint64_t cipher, uint64_t key) { return cipher ^ key; }
+uint64_t XorBP::decrypt(uint64_t cipher, uint64_t key) {
+  COUNT_EVENT(BPUType::BPU_XorBP, CounterEvent::EVT_CIPHER);
+  return cipher ^ key;
+}
 
 // get set and tag in PHT and BTB
 uint64_t XorBP::getPHTSet(uint64_t pc, uint64_t domain) {
@@ -68,39 +134,57 @@ uint64_t XorBP::getBTBSet(uint64_t pc, uint64_t domain) {
 }
 
 uint64_t XorBP::getBTBTag(uint64_t src, uint64_t domain) {
-  uint64_t plain_tag = src >> offset_btb >> (int)std::log2(buffer_sets);
-  uint64_t encrypted_tag = encrypt(plain_tag, content_keys[domain]);
-  return encrypted_tag & (((1ULL << addr_space) - 1) >> offset_btb >>
-                          (int)std::log2(buffer_sets));
+  uint64_t plain_tag = src >> offset_btb >> btb_set_bits;
+  uint64_t encrypted_tag = encrypt(plain_tag, keys[domain].content_key);
+  return encrypted_tag & btb_tag_mask;
 }
 
 uint64_t XorBP::getBTBDest(uint64_t dest, uint64_t domain) {
-  return encrypt(dest, content_keys[domain]);
+  return encrypt(dest, keys[domain].content_key);
+}
+
+uint64_t XorBP::getBTBLevel(uint64_t pc, uint64_t domain) {
+  if (btb_levels == nullptr) {
+    return 0;
+  }
+  return btb_levels->getLevel(getBTBSet(pc, domain), getBTBTag(pc, domain));
 }
 
 bool XorBP::lookupPHT(uint64_t pc, bool taken, uint64_t domain) {
   uint64_t index = getPHTSet(pc, domain);
+  COUNT_LOOKUP(BPUType::BPU_XorBP, CounterEvent::EVT_PHT_LOOKUP);
+  lookups++;
+  RECORD_PHT(pc, taken, domain);
+  if (history != nullptr) {
+    int outcome = history->lookup(index, taken);
+    COUNT_EVENT(BPUType::BPU_XorBP, phtEvent(outcome));
+    return outcome == 1;
+  }
   // get the highest bit
-  uint64_t counter = decrypt(PHT_counter[index], content_keys[domain]) &
+  uint64_t counter = decrypt(PHT_counter[index], keys[domain].content_key) &
                      ((1ULL << counter_bits) - 1);
   bool prediction = counter >> (counter_bits - 1);
   if (PHT_valid[index] == 0) {
+    COUNT_EVENT(BPUType::BPU_XorBP, CounterEvent::EVT_PHT_INVALID);
     updatePHT(pc, taken, domain);
     return false;
   }
+  COUNT_EVENT(BPUType::BPU_XorBP, prediction == taken
+                                      ? CounterEvent::EVT_PHT_HIT
+                                      : CounterEvent::EVT_PHT_MISPREDICT);
   updatePHT(pc, taken, domain);
   return prediction == taken;
 }
 
 void XorBP::updatePHT(uint64_t pc, bool taken, uint64_t domain) {
   uint64_t index = getPHTSet(pc, domain);
-  uint64_t counter = decrypt(PHT_counter[index], content_keys[domain]) &
+  uint64_t counter = decrypt(PHT_counter[index], keys[domain].content_key) &
                      ((1ULL << counter_bits) - 1);
   // check if the counter is valid
   if (PHT_valid[index] == 0) {
     PHT_valid[index] = 1;
     PHT_counter[index] =
-        encrypt(taken, content_keys[domain]) & ((1ULL << counter_bits) - 1);
+        encrypt(taken, keys[domain].content_key) & ((1ULL << counter_bits) - 1);
     return;
   }
   // update counter
@@ -116,11 +200,25 @@ void XorBP::updatePHT(uint64_t pc, bool taken, uint64_t domain) {
     counter = (1ULL << counter_bits) - 1;
   }
   PHT_counter[index] =
-      encrypt(counter, content_keys[domain]) & ((1ULL << counter_bits) - 1);
+      encrypt(counter, keys[domain].content_key) & ((1ULL << counter_bits) - 1);
 }
 
 int XorBP::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
   uint64_t index = getBTBSet(pc, domain);
+  COUNT_LOOKUP(BPUType::BPU_XorBP, CounterEvent::EVT_BTB_LOOKUP);
+  lookups++;
+  RECORD_BTB(pc, target, domain);
+  if (btb_levels != nullptr) {
+    int outcome = btb_levels->lookup(index, getBTBTag(pc, domain),
+                                     getBTBDest(target, domain));
+    uint64_t set;
+    if (outcome == -1 && btb_levels->evicted(set)) {
+      COUNT_EVICTION(BPUType::BPU_XorBP, set);
+    } else {
+      COUNT_EVENT(BPUType::BPU_XorBP, btbEvent(outcome));
+    }
+    return outcome;
+  }
   // update LRU
   for (uint64_t i = 0; i < buffer_ways; i++) {
     if (BTB_valid[index][i] == 1) {
@@ -133,11 +231,13 @@ int XorBP::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
         BTB_src[index][i] == getBTBTag(pc, domain)) {
       // predicton state: $valid$
       if (BTB_dest[index][i] == getBTBDest(target, domain)) {
+        COUNT_EVENT(BPUType::BPU_XorBP, CounterEvent::EVT_BTB_HIT);
         updateBTB(pc, target, domain);
         return 1;
       }
       // predicton state: $mispredict$
       else {
+        COUNT_EVENT(BPUType::BPU_XorBP, CounterEvent::EVT_BTB_MISPREDICT);
         updateBTB(pc, target, domain);
         return 0;
       }
@@ -146,6 +246,7 @@ int XorBP::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
   // predicton state: $invalid$
   for (uint64_t i = 0; i < buffer_ways; i++) {
     if (BTB_valid[index][i] == 0) {
+      COUNT_EVENT(BPUType::BPU_XorBP, CounterEvent::EVT_BTB_INVALID);
       BTB_valid[index][i] = 1;
       BTB_src[index][i] = getBTBTag(pc, domain);
       updateBTB(pc, target, domain);
@@ -163,8 +264,9 @@ int XorBP::lookupBTB(uint64_t pc, uint64_t target, uint64_t domain) {
     }
   } else if (buffer_replacement == ReplacementPolicy::REPL_RANDOM) {
     // Random replacement
-    max_lru = rand() % buffer_ways;
+    max_lru = predictorRand() % buffer_ways;
   }
+  COUNT_EVICTION(BPUType::BPU_XorBP, index);
   BTB_src[index][max_lru] = getBTBTag(pc, domain);
   updateBTB(pc, target, domain);
   return -1;
@@ -186,14 +288,13 @@ void XorBP::updateBTB(uint64_t pc, uint64_t target, uint64_t domain) {
 
 // regenerate branch address for test the correctness of the framework
 uint64_t XorBP::regenerateTagAddr(uint64_t set, uint64_t tag, uint64_t domain) {
-  uint64_t dectypted_tag = decrypt(tag, content_keys[domain]);
-  dectypted_tag = dectypted_tag & (((1ULL << addr_space) - 1) >> offset_btb >>
-                                   (int)std::log2(buffer_sets));
-  return ((dectypted_tag << (int)std::log2(buffer_sets)) | set) << offset_btb;
+  uint64_t dectypted_tag = decrypt(tag, keys[domain].content_key);
+  dectypted_tag = dectypted_tag & btb_tag_mask;
+  return ((dectypted_tag << btb_set_bits) | set) << offset_btb;
 }
 
 uint64_t XorBP::regenerateDestAddr(uint64_t dest, uint64_t domain) {
-  return decrypt(dest, content_keys[domain]);
+  return decrypt(dest, keys[domain].content_key);
 }
 
 int XorBP::checkPHTSetCollision(uint64_t addr1, uint64_t domain1,
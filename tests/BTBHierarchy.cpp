@@ -0,0 +1,169 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/19
+// =============================================================================
+// BTB hierarchy on small geometries of one set per level: back-invalidation
+// of the inclusive levels, a single copy of every line and the demotion of
+// the victims of the exclusive levels, corrected targets in every copy, and
+// no valid entry after a flush or a rekey.
+// =============================================================================
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "include/predictors/BTBHierarchy.hpp"
+#include "include/utils/Sweep.hpp"
+
+// lines of the last-level set 0, targets
+#define LINE_A 1
+#define LINE_B 2
+#define LINE_C 3
+#define LINE_D 4
+#define LINE_E 5
+
+static int failures = 0;
+
+static void expect(bool ok, const char *what, const std::string &config) {
+  if (!ok) {
+    std::cerr << config << ": " << what << std::endl;
+    failures++;
+  }
+}
+
+// the level keys and random victims of the simulator come from the stream of
+// the sweeps (Sweep.cpp), the test draws them from rand()
+uint64_t predictorRand() { return rand(); }
+
+// a hierarchy of one upper level of l0_ways ways in front of a last level
+// of last_ways ways, one set each
+static BTBHierarchy *hierarchy(uint64_t inclusion, uint64_t l0_ways,
+                               uint64_t last_ways, BTBConfig &config,
+                               bool keyed = false) {
+  BTBLevelConfig level;
+  level.sets = 1;
+  level.ways = l0_ways;
+  level.keyed = keyed;
+  config.levels = {level};
+  config.inclusion = inclusion;
+  return BTBHierarchy::create(config, last_ways, 1,
+                              ReplacementPolicy::REPL_LRU);
+}
+
+int main() {
+  srand(1);
+  BTBConfig config;
+  // an eviction out of a last level smaller than L0 invalidates the L0 copy
+  // if inclusive, and leaves it if non-inclusive non-exclusive
+  for (uint64_t inclusion :
+       {BTBInclusion::BTB_INCLUSIVE, BTBInclusion::BTB_NINE}) {
+    BTBHierarchy *btb = hierarchy(inclusion, 4, 2, config);
+    std::string name = btbName(config);
+    for (uint64_t line : {LINE_A, LINE_B, LINE_C}) {
+      expect(btb->lookup(0, line, line) == -1, "cold miss", name);
+    }
+    uint64_t set;
+    expect(btb->evicted(set) && set == 0, "eviction out of the last level",
+           name);
+    uint64_t expected = inclusion == BTBInclusion::BTB_INCLUSIVE
+                            ? btb->getLevels()
+                            : 0;
+    expect(btb->getLevel(0, LINE_A) == expected, "copy of the evicted line",
+           name);
+    expect(btb->getLevel(0, LINE_C) == 0, "filled line", name);
+    expect(btb->getOccupancy() == (expected == 0 ? 5 : 4), "occupancy", name);
+    delete btb;
+  }
+  // exclusive: a line in one level, L0 victims move down one level and the
+  // last level evicts out of the hierarchy
+  {
+    BTBHierarchy *btb = hierarchy(BTBInclusion::BTB_EXCLUSIVE, 2, 2, config);
+    std::string name = btbName(config);
+    uint64_t set;
+    btb->lookup(0, LINE_A, LINE_A);
+    btb->lookup(0, LINE_B, LINE_B);
+    expect(btb->getOccupancy() == 2, "one copy per line", name);
+    btb->lookup(0, LINE_C, LINE_C);
+    expect(btb->getLevel(0, LINE_A) == 1, "L0 victim demoted", name);
+    expect(btb->getLevel(0, LINE_C) == 0, "miss filled into L0", name);
+    expect(!btb->evicted(set), "no eviction while the last level fits", name);
+    btb->lookup(0, LINE_D, LINE_D);
+    expect(btb->getLevel(0, LINE_B) == 1, "L0 victim demoted", name);
+    expect(btb->getOccupancy() == 4, "one copy per line", name);
+    btb->lookup(0, LINE_E, LINE_E);
+    expect(btb->evicted(set) && set == 0, "eviction out of the last level",
+           name);
+    expect(btb->getLevel(0, LINE_A) == btb->getLevels(), "evicted line",
+           name);
+    expect(btb->getLevel(0, LINE_C) == 1, "L0 victim demoted", name);
+    // a hit below moves the line up and the L0 victim down
+    expect(btb->lookup(0, LINE_B, LINE_B) == 1, "hit in the last level",
+           name);
+    expect(btb->getHitLevel() == 1, "level of the hit", name);
+    expect(btb->getLevel(0, LINE_B) == 0, "line moved to L0", name);
+    expect(btb->getLevel(0, LINE_D) == 1, "L0 victim demoted", name);
+    expect(btb->getOccupancy() == 4, "one copy per line", name);
+    delete btb;
+  }
+  // a corrected target reaches every copy: the last-level copy answers with
+  // it once the L0 copy is evicted
+  for (uint64_t inclusion = 0; inclusion < BTBInclusion::NUM_BTB_INCLUSIONS;
+       inclusion++) {
+    BTBHierarchy *btb = hierarchy(inclusion, 1, 4, config);
+    std::string name = btbName(config);
+    btb->lookup(0, LINE_A, LINE_A);
+    expect(btb->lookup(0, LINE_A, LINE_E) == 0, "mispredict", name);
+    expect(btb->getHitLevel() == 0, "level of the mispredict", name);
+    btb->lookup(0, LINE_B, LINE_B);
+    expect(btb->getLevel(0, LINE_A) == 1, "L0 copy evicted", name);
+    expect(btb->lookup(0, LINE_A, LINE_E) == 1, "corrected target", name);
+    expect(btb->getHitLevel() == 1, "level of the corrected target", name);
+    delete btb;
+  }
+  // a flush or a rekey invalidates every level
+  for (bool keyed : {false, true}) {
+    BTBHierarchy *btb =
+        hierarchy(BTBInclusion::BTB_NINE, 2, 4, config, keyed);
+    std::string name = btbName(config);
+    for (bool rekey : {false, true}) {
+      for (uint64_t line : {LINE_A, LINE_B, LINE_C}) {
+        btb->lookup(0, line, line);
+      }
+      expect(btb->getOccupancy() == 5, "occupancy", name);
+      if (rekey) {
+        btb->rekey();
+      } else {
+        btb->flush();
+      }
+      expect(btb->getOccupancy() == 0, rekey ? "rekey" : "flush", name);
+      expect(btb->getLevel(0, LINE_A) == btb->getLevels(),
+             rekey ? "line after a rekey" : "line after a flush", name);
+      expect(btb->lookup(0, LINE_A, LINE_A) == -1,
+             rekey ? "lookup after a rekey" : "lookup after a flush", name);
+      btb->flush();
+    }
+    delete btb;
+  }
+  if (failures != 0) {
+    std::cerr << failures << " failures" << std::endl;
+    return 1;
+  }
+  return 0;
+}
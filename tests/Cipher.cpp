@@ -0,0 +1,135 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/19
+// =============================================================================
+// Block ciphers of the index randomization: the published test vectors of
+// PRINCE and QARMA-64, QARMA-64 against the reference implementation at every
+// round count, and encryption round-trips and the batch path of every cipher
+// and round count.
+// =============================================================================
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "include/utils/Cipher.hpp"
+#include "include/utils/Qarma64.hpp"
+
+#define CIPHER_TEST_BLOCK 0xFEDCBA9876543210ULL
+
+static int failures = 0;
+
+static void expect(bool ok, const char *what, const std::string &cipher) {
+  if (!ok) {
+    std::cerr << cipher << ": " << what << std::endl;
+    failures++;
+  }
+}
+
+// PRINCE test vectors of the PRINCE paper (ASIACRYPT 2012, appendix A):
+// plaintext, k0, k1 and ciphertext
+static const uint64_t PRINCE_VECTORS[5][4] = {
+    {0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+     0x818665AA0D02DFDAULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+     0x604AE6CA03C20ADAULL},
+    {0x0000000000000000ULL, 0xFFFFFFFFFFFFFFFFULL, 0x0000000000000000ULL,
+     0x9FB51935FC3DF524ULL},
+    {0x0000000000000000ULL, 0x0000000000000000ULL, 0xFFFFFFFFFFFFFFFFULL,
+     0x78A54CBE737BB7EFULL},
+    {0x0123456789ABCDEFULL, 0x0000000000000000ULL, 0xFEDCBA9876543210ULL,
+     0xAE25AD3CA8FA9CCFULL}};
+
+// QARMA-64 test vectors of the QARMA paper (sigma_2, the check_box of
+// Qarma64.hpp): plaintext, tweak, w0 and k0, and the ciphertexts of 5, 6 and
+// 7 rounds
+static const uint64_t QARMA_PLAIN = 0xFB623599DA6E8127ULL;
+static const CipherKey QARMA_KEY = {0x477D469DEC0B8762ULL,
+                                    0x84BE85CE9804E94BULL,
+                                    0xEC2802D4E0A488E9ULL};
+static const uint64_t QARMA_VECTORS[3] = {
+    0xC003B93999B33765ULL, 0x270A787275C48D10ULL, 0x5C06A7501B63B2FDULL};
+
+int main() {
+  // splitmix64 stream of test blocks and keys
+  std::vector<uint64_t> plain(1000);
+  uint64_t state = CIPHER_TEST_BLOCK;
+  for (uint64_t &block : plain) {
+    uint64_t x = state += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    block = x ^ (x >> 31);
+  }
+  // PRINCE: the tweak is folded into k1
+  BlockCipher *prince = BlockCipher::create({CipherType::CIPHER_PRINCE, 0});
+  for (const uint64_t *vector : PRINCE_VECTORS) {
+    CipherKey key = {0, vector[1], vector[2]};
+    expect(prince->encrypt(vector[0], key) == vector[3], "test vector",
+           "prince");
+    expect(prince->decrypt(vector[3], key) == vector[0], "test vector",
+           "prince");
+  }
+  delete prince;
+  // QARMA-64: the test vectors, and the reference at every round count
+  QARMA reference;
+  for (uint64_t rounds = 1; rounds <= 7; rounds++) {
+    BlockCipher *qarma =
+        BlockCipher::create({CipherType::CIPHER_QARMA64, rounds});
+    std::string name = cipherName({CipherType::CIPHER_QARMA64, rounds});
+    if (rounds >= 5) {
+      expect(qarma->encrypt(QARMA_PLAIN, QARMA_KEY) ==
+                 QARMA_VECTORS[rounds - 5],
+             "test vector", name);
+    }
+    for (uint64_t i = 0; i + 3 < plain.size(); i += 4) {
+      CipherKey key = {plain[i + 1], plain[i + 2], plain[i + 3]};
+      uint64_t expected = reference.qarma64_enc(plain[i], key.tweak, key.w0,
+                                                key.k0, rounds);
+      expect(qarma->encrypt(plain[i], key) == expected, "reference", name);
+      expect(reference.qarma64_dec(expected, key.tweak, key.w0, key.k0,
+                                   rounds) == plain[i],
+             "reference round-trip", name);
+    }
+    delete qarma;
+  }
+  // round-trips and the batch path of every cipher and round count
+  for (CipherType type : {CipherType::CIPHER_QARMA64,
+                          CipherType::CIPHER_PRINCE}) {
+    for (uint64_t rounds = 1; rounds <= cipherRounds(type); rounds++) {
+      BlockCipher *cipher = BlockCipher::create({type, rounds});
+      std::string name = cipherName({type, rounds});
+      CipherKey key = cipherKey(CIPHER_TEST_BLOCK ^ rounds);
+      std::vector<uint64_t> encrypted(plain.size());
+      cipher->encryptBatch(plain.data(), plain.size(), key, encrypted.data());
+      for (uint64_t i = 0; i < plain.size(); i++) {
+        expect(encrypted[i] == cipher->encrypt(plain[i], key),
+               "batch encrypt", name);
+        expect(cipher->decrypt(encrypted[i], key) == plain[i], "round-trip",
+               name);
+      }
+      delete cipher;
+    }
+  }
+  if (failures != 0) {
+    std::cerr << failures << " failures" << std::endl;
+    return 1;
+  }
+  return 0;
+}
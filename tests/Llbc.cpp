@@ -0,0 +1,83 @@
+// Copyright 2025 iamywang
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// =============================================================================
+// BranchGauge: Modeling and Quantifying Leakage in Randomization-Based Secure
+// Branch Predictors
+//
+// author: iamywang
+// date: 2026/10/19
+// =============================================================================
+// LLBC of BSUP: encryption round-trips and the batch path at every block
+// width, and known answers that pin the round-key schedule.
+// =============================================================================
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "include/utils/Llbc.hpp"
+
+#define LLBC_TEST_KEY 0x0123456789ABCDEFULL
+#define LLBC_TEST_BLOCK 0xFEDCBA9876543210ULL
+
+static int failures = 0;
+
+static void expect(bool ok, const char *what, uint64_t width) {
+  if (!ok) {
+    std::cerr << "width " << width << ": " << what << std::endl;
+    failures++;
+  }
+}
+
+int main() {
+  // splitmix64 stream of test blocks
+  std::vector<uint64_t> plain(1000);
+  uint64_t state = LLBC_TEST_BLOCK;
+  for (uint64_t &block : plain) {
+    uint64_t x = state += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    block = x ^ (x >> 31);
+  }
+  for (uint64_t width = 1; width <= 64; width++) {
+    LLBC cipher(LLBC_TEST_KEY, width);
+    uint64_t mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+    std::vector<uint64_t> encrypted(plain.size());
+    std::vector<uint64_t> decrypted(plain.size());
+    cipher.encryptBatch(plain.data(), plain.size(), encrypted.data());
+    cipher.decryptBatch(encrypted.data(), encrypted.size(), decrypted.data());
+    for (uint64_t i = 0; i < plain.size(); i++) {
+      expect(encrypted[i] == cipher.encrypt(plain[i]), "batch encrypt", width);
+      expect((encrypted[i] & ~mask) == (plain[i] & ~mask), "high bits", width);
+      expect(cipher.decrypt(encrypted[i]) == plain[i], "round-trip", width);
+      expect(decrypted[i] == plain[i], "batch round-trip", width);
+    }
+  }
+  // known answers, all rounds keyed (the round keys rotate the key by 17
+  // bits per round, modulo 64)
+  const uint64_t widths[] = {4, 8, 13, 32, 48, 64};
+  const uint64_t answers[] = {0xFEDCBA9876543212ULL, 0xFEDCBA98765432E1ULL,
+                              0xFEDCBA98765437F5ULL, 0xFEDCBA987159F5E0ULL,
+                              0xFEDCF53B09AD7DADULL, 0x5B641EAAE3A00F70ULL};
+  for (int i = 0; i < 6; i++) {
+    LLBC cipher(LLBC_TEST_KEY, widths[i]);
+    expect(cipher.encrypt(LLBC_TEST_BLOCK) == answers[i], "known answer",
+           widths[i]);
+  }
+  if (failures != 0) {
+    std::cerr << failures << " failures" << std::endl;
+    return 1;
+  }
+  return 0;
+}